@@ -277,10 +277,14 @@ AOCSMoveTuple(TupleTableSlot *slot,
 /*
  * Assumes that the segment file lock is already held.
  * Assumes that the segment file should be compacted.
+ *
+ * If sort is given, the visible tuples are put into it rather than moved
+ * right away; see AppendOnlyCompaction_WriteSorted.
  */
 static bool
 AOCSSegmentFileFullCompaction(Relation aorel,
 							  AOCSInsertDesc insertDesc,
+							  AppendOnlySort *sort,
 							  AOCSFileSegInfo *fsinfo)
 {
 	const char *relname;
@@ -355,11 +359,14 @@ AOCSSegmentFileFullCompaction(Relation aorel,
 		aoTupleId = (AOTupleId *) slot_get_ctid(slot);
 		if (AppendOnlyVisimap_IsVisible(&scanDesc->visibilityMap, aoTupleId))
 		{
-			AOCSMoveTuple(
-						  slot,
-						  insertDesc,
-						  resultRelInfo,
-						  estate);
+			if (sort)
+				AppendOnlySort_Put(sort, slot);
+			else
+				AOCSMoveTuple(
+							  slot,
+							  insertDesc,
+							  resultRelInfo,
+							  estate);
 			movedTupleCount++;
 		}
 		else
@@ -521,6 +528,7 @@ AOCSCompact(Relation aorel,
 	int			total_segfiles;
 	AOCSFileSegInfo **segfile_array;
 	AOCSInsertDesc insertDesc = NULL;
+	AppendOnlySort *sort = NULL;
 	int			i,
 				segno;
 	LockAcquireResult acquireResult;
@@ -541,6 +549,12 @@ AOCSCompact(Relation aorel,
 	if (insert_segno >= 0)
 	{
 		insertDesc = aocs_insert_init(aorel, insert_segno, false);
+
+		/*
+		 * With a sort key, the rows of all the compacted segment files are
+		 * merged into one run in sort key order.
+		 */
+		sort = AppendOnlySort_Begin(aorel, maintenance_work_mem);
 	}
 
 	for (i = 0; i < total_segfiles; i++)
@@ -594,12 +608,15 @@ AOCSCompact(Relation aorel,
 		if (AppendOnlyCompaction_ShouldCompact(aorel,
 											   fsinfo->segno, fsinfo->total_tupcount, isFull))
 		{
-			AOCSSegmentFileFullCompaction(aorel, insertDesc, fsinfo);
+			AOCSSegmentFileFullCompaction(aorel, insertDesc, sort, fsinfo);
 		}
 
 		pfree(fsinfo);
 	}
 
+	if (sort != NULL)
+		AppendOnlyCompaction_WriteSorted(aorel, sort, NULL, insertDesc);
+
 	if (insertDesc != NULL)
 		aocs_insert_finish(insertDesc);
 
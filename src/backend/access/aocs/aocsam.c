@@ -44,12 +44,15 @@
 #include "storage/freespace.h"
 #include "storage/procarray.h"
 #include "storage/smgr.h"
+#include "utils/datum.h"
 #include "utils/datumstream.h"
 #include "utils/faultinjector.h"
 #include "utils/guc.h"
 #include "utils/inval.h"
 #include "utils/lsyscache.h"
+#include "utils/memutils.h"
 #include "utils/relcache.h"
+#include "utils/spccache.h"
 #include "utils/syscache.h"
 
 
@@ -181,8 +184,15 @@ open_ds_read(Relation rel, DatumStreamRead **ds, TupleDesc relationTupleDesc,
 {
 	int			nvp = relationTupleDesc->natts;
 	StdRdOptions **opts = RelationGetAttributeOptions(rel);
+	int			prefetchDepth;
 	int			i;
 
+	/*
+	 * Each column is read from its own segment file, so ask for readahead
+	 * on every one of them.
+	 */
+	prefetchDepth = get_tablespace_io_concurrency(rel->rd_rel->reltablespace);
+
 	/* Clear all the entries to NULL first. */
 	for (i = 0; i < nvp; ++i)
 		ds[i] = NULL;
@@ -225,6 +235,9 @@ open_ds_read(Relation rel, DatumStreamRead **ds, TupleDesc relationTupleDesc,
 										   attr,
 										   RelationGetRelationName(rel),
 										    /* title */ titleBuf.data);
+		AppendOnlyStorageRead_SetPrefetchDepth(&ds[attno]->ao_read,
+											   prefetchDepth);
+		AppendOnlyStorageRead_SetDecompressAhead(&ds[attno]->ao_read);
 	}
 }
 
@@ -267,6 +280,10 @@ aocs_initscan(AOCSScanDesc scan)
 	ItemPointerSet(&scan->cdb_fake_ctid, 0, 0);
 	scan->cur_seg_row = 0;
 
+	scan->batch_nrows = 0;
+	scan->batch_nsel = 0;
+	scan->batch_next = 0;
+
 	open_ds_read(scan->aos_rel, scan->ds, scan->relationTupleDesc,
 				 scan->proj_atts, scan->num_proj_atts,
 				 scan->aos_rel->rd_appendonly->checksum);
@@ -492,6 +509,20 @@ aocs_beginscan_internal(Relation relation,
 
 	scan->ds = (DatumStreamRead **) palloc0(sizeof(DatumStreamRead *) * nvp);
 
+	scan->num_filter_atts = scan->num_proj_atts;
+	scan->filter = NULL;
+	scan->batch_late = false;
+
+	scan->batch_values = (Datum **) palloc(sizeof(Datum *) * scan->num_proj_atts);
+	scan->batch_isnull = (bool **) palloc(sizeof(bool *) * scan->num_proj_atts);
+	for (i = 0; i < scan->num_proj_atts; i++)
+	{
+		scan->batch_values[i] = (Datum *) palloc(sizeof(Datum) * AOCS_SCAN_BATCH_SIZE);
+		scan->batch_isnull[i] = (bool *) palloc(sizeof(bool) * AOCS_SCAN_BATCH_SIZE);
+	}
+	scan->batch_tids = (AOTupleId *) palloc(sizeof(AOTupleId) * AOCS_SCAN_BATCH_SIZE);
+	scan->batch_sel = (int *) palloc(sizeof(int) * AOCS_SCAN_BATCH_SIZE);
+
 	aocs_initscan(scan);
 
 	scan->blockDirectory = NULL;
@@ -505,6 +536,144 @@ aocs_beginscan_internal(Relation relation,
 	return scan;
 }
 
+/*
+ * aocs_set_filter
+ *
+ * Set up late materialization. 'filter_proj' marks the projected columns that
+ * 'filter' needs. Those are decoded for every visible row; each row is then
+ * stored in 'slot', with the other columns set to NULL, and passed to the
+ * filter. The other projected columns are only read for the rows that pass
+ * it, and their blocks that hold no such row are skipped.
+ *
+ * The filter must not have side effects: the caller still sees, and may
+ * check again, every row that passes it.
+ */
+void
+aocs_set_filter(AOCSScanDesc scan, bool *filter_proj,
+				AOCSScanFilter filter, void *arg, TupleTableSlot *slot)
+{
+	int		   *late_atts;
+	int			num_late_atts = 0;
+	int			i;
+
+	Assert(scan->filter == NULL);
+	Assert(scan->cur_seg < 0);
+
+	/* Move the filter columns to the front of proj_atts */
+	late_atts = palloc(sizeof(int) * scan->num_proj_atts);
+	scan->num_filter_atts = 0;
+	for (i = 0; i < scan->num_proj_atts; i++)
+	{
+		int			attno = scan->proj_atts[i];
+
+		if (filter_proj[attno])
+			scan->proj_atts[scan->num_filter_atts++] = attno;
+		else
+			late_atts[num_late_atts++] = attno;
+	}
+	memcpy(&scan->proj_atts[scan->num_filter_atts], late_atts,
+		   sizeof(int) * num_late_atts);
+	pfree(late_atts);
+
+	/* Nothing to gain unless some columns are left out of the filter */
+	if (scan->num_filter_atts == 0 || num_late_atts == 0)
+	{
+		scan->num_filter_atts = scan->num_proj_atts;
+		return;
+	}
+
+	scan->filter = filter;
+	scan->filter_arg = arg;
+	scan->filter_slot = slot;
+}
+
+/*
+ * aocs_set_zonemap_keys
+ *
+ * Let the scan skip blocks using the zone maps kept in the block directory.
+ * Each key describes a "column op constant" condition, where op is a btree
+ * comparison operator of the column's type: sk_strategy is its strategy
+ * number and sk_func the btree comparison function of the column's type and
+ * the constant's. Rows that fail a key may still be returned; the caller
+ * must check its quals as usual.
+ *
+ * This is a no-op if the relation has no block directory.
+ */
+void
+aocs_set_zonemap_keys(AOCSScanDesc scan, int nkeys, ScanKey keys)
+{
+	Relation	rel = scan->aos_rel;
+	int			nvp = scan->relationTupleDesc->natts;
+	int			i;
+
+	Assert(scan->num_zonemap_keys == 0);
+
+	if (nkeys == 0 || !OidIsValid(rel->rd_appendonly->blkdirrelid))
+		return;
+
+	scan->zonemap_proj = (bool *) palloc0(sizeof(bool) * nvp);
+	for (i = 0; i < nkeys; i++)
+	{
+		Assert(keys[i].sk_attno > 0 && keys[i].sk_attno <= nvp);
+		scan->zonemap_proj[keys[i].sk_attno - 1] = true;
+	}
+
+	AppendOnlyBlockDirectory_Init_forSearch(&scan->zonemapDirectory,
+											scan->appendOnlyMetaDataSnapshot,
+											(FileSegInfo **) scan->seginfo,
+											scan->total_seg,
+											rel,
+											nvp,
+											true,
+											scan->zonemap_proj);
+
+	scan->num_zonemap_keys = nkeys;
+	scan->zonemap_keys = keys;
+}
+
+/*
+ * aocs_set_dictionary_keys
+ *
+ * Give the scan boolean "column op constant" keys on variable-length
+ * columns, to evaluate on the dictionary of blocks that have one. sk_func
+ * is the operator's function; the operator must be strict. Rows failing a
+ * key are left out of the batch, so the keys must be implied by the quals
+ * of the scan.
+ */
+void
+aocs_set_dictionary_keys(AOCSScanDesc scan, int nkeys, ScanKey keys)
+{
+	int			nvp = scan->relationTupleDesc->natts;
+	int			i;
+
+	Assert(scan->num_dictionary_keys == 0);
+	Assert(scan->cur_seg < 0);
+
+	if (nkeys == 0)
+		return;
+
+	scan->dictionary_match = (bool **) palloc0(sizeof(bool *) * nvp);
+	scan->dictionary_block = (int64 *) palloc(sizeof(int64) * nvp);
+	for (i = 0; i < nkeys; i++)
+	{
+		int			attno = keys[i].sk_attno - 1;
+
+		Assert(attno >= 0 && attno < nvp);
+		if (scan->dictionary_match[attno] == NULL)
+			scan->dictionary_match[attno] = (bool *)
+				palloc(sizeof(bool) * DATUMSTREAM_DICTIONARY_MAX_COUNT);
+	}
+
+	scan->dictionary_context = AllocSetContextCreate(CurrentMemoryContext,
+													 "AOCS dictionary keys",
+													 ALLOCSET_SMALL_MINSIZE,
+													 ALLOCSET_SMALL_INITSIZE,
+													 ALLOCSET_DEFAULT_MAXSIZE);
+
+	scan->num_dictionary_keys = nkeys;
+	scan->dictionary_keys = keys;
+}
+
 void
 aocs_rescan(AOCSScanDesc scan)
 {
@@ -523,6 +692,16 @@ aocs_endscan(AOCSScanDesc scan)
 	close_cur_scan_seg(scan);
 	close_ds_read(scan->ds, scan->relationTupleDesc->natts);
 
+	for (i = 0; i < scan->num_proj_atts; i++)
+	{
+		pfree(scan->batch_values[i]);
+		pfree(scan->batch_isnull[i]);
+	}
+	pfree(scan->batch_values);
+	pfree(scan->batch_isnull);
+	pfree(scan->batch_tids);
+	pfree(scan->batch_sel);
+
 	pfree(scan->proj_atts);
 	pfree(scan->ds);
 
@@ -539,15 +718,34 @@ aocs_endscan(AOCSScanDesc scan)
 
 	AppendOnlyVisimap_Finish(&scan->visibilityMap, AccessShareLock);
 
+	if (scan->num_zonemap_keys > 0)
+	{
+		AppendOnlyBlockDirectory_End_forSearch(&scan->zonemapDirectory);
+		pfree(scan->zonemap_proj);
+	}
+
+	if (scan->num_dictionary_keys > 0)
+	{
+		for (i = 0; i < scan->relationTupleDesc->natts; i++)
+		{
+			if (scan->dictionary_match[i] != NULL)
+				pfree(scan->dictionary_match[i]);
+		}
+		pfree(scan->dictionary_match);
+		pfree(scan->dictionary_block);
+		MemoryContextDelete(scan->dictionary_context);
+	}
+
 	pfree(scan);
 }
 
 /*
  * Upgrades a Datum value from a previous version of the AOCS page format. The
- * DatumStreamRead that is passed must correspond to the column being upgraded.
+ * DatumStreamRead that is passed must correspond to the column the value was
+ * read from.
  */
-static void upgrade_datum_impl(DatumStreamRead *ds, int attno, Datum values[],
-							   bool isnull[], int formatversion)
+static void upgrade_datum_impl(DatumStreamRead *ds, Datum *value, bool isnull,
+							   int formatversion)
 {
 	bool 	convert_numeric = false;
 
@@ -565,7 +763,7 @@ static void upgrade_datum_impl(DatumStreamRead *ds, int attno, Datum values[],
 		}
 
 		/* If this Datum is a numeric, we need to convert it. */
-		convert_numeric = (ds->baseTypeOid == NUMERICOID) && !isnull[attno];
+		convert_numeric = (ds->baseTypeOid == NUMERICOID) && !isnull;
 	}
 
 	if (convert_numeric)
@@ -585,7 +783,7 @@ static void upgrade_datum_impl(DatumStreamRead *ds, int attno, Datum values[],
 		 * to it won't be affected. Store it in the upgrade space for this
 		 * DatumStream.
 		 */
-		datum = values[attno];
+		datum = *value;
 		datalen = VARSIZE_ANY(DatumGetPointer(datum));
 
 		upgradedata = datumstreamread_get_upgrade_space(ds, datalen);
@@ -599,198 +797,704 @@ static void upgrade_datum_impl(DatumStreamRead *ds, int attno, Datum values[],
 		memcpy(&numericdata[2], &tmp, 2);
 
 		/* Re-point the Datum to the upgraded numeric. */
-		values[attno] = PointerGetDatum(upgradedata);
+		*value = PointerGetDatum(upgradedata);
 	}
 }
 
-static void upgrade_datum_scan(AOCSScanDesc scan, int attno, Datum values[],
-							   bool isnull[], int formatversion)
+/*
+ * Upgrades the value of column 'attno' read by a scan. The scan decodes a
+ * column at a time, so the value is given on its own rather than as part of
+ * a row.
+ */
+static void upgrade_datum_scan(AOCSScanDesc scan, int attno, Datum *value,
+							   bool isnull, int formatversion)
 {
-	upgrade_datum_impl(scan->ds[attno], attno, values, isnull, formatversion);
+	upgrade_datum_impl(scan->ds[attno], value, isnull, formatversion);
 }
 
 static void upgrade_datum_fetch(AOCSFetchDesc fetch, int attno, Datum values[],
 								bool isnull[], int formatversion)
 {
-	upgrade_datum_impl(fetch->datumStreamFetchDesc[attno]->datumStream, attno,
-					   values, isnull, formatversion);
+	upgrade_datum_impl(fetch->datumStreamFetchDesc[attno]->datumStream,
+					   &values[attno], isnull[attno], formatversion);
 }
 
-void
-aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot)
+/*
+ * Row number of the current datum of a column.
+ */
+static inline int64
+aocs_column_rownum(DatumStreamRead *ds)
 {
-	int			ncol;
-	Datum	   *d = slot_get_values(slot);
-	bool	   *null = slot_get_isnull(slot);
+	return ds->blockFirstRowNum + datumstreamread_nth(ds);
+}
+
+/*
+ * Compare a zone map bound with the argument of a zone map key.
+ */
+static inline int32
+aocs_zonemap_cmp(ScanKey key, Datum value)
+{
+	return DatumGetInt32(FunctionCall2(&key->sk_func, value, key->sk_argument));
+}
+
+/*
+ * aocs_zonemap_check
+ *
+ * Look up the zone map of the block directory entry covering row 'rowNum'
+ * of column 'attno'. If it shows that no row of the entry can satisfy the
+ * zone map keys on that column, move scan->skip_until past the
+ * entry.
+ */
+static void
+aocs_zonemap_check(AOCSScanDesc scan, int attno, int64 rowNum)
+{
+	AppendOnlyBlockDirectoryEntry entry;
+	MinipageEntryStats *stats = &entry.stats;
 	AOTupleId	aoTupleId;
-	int64		rowNum = INT64CONST(-1);
-	int			err = 0;
 	int			i;
-	bool		isSnapshotAny = (scan->snapshot == SnapshotAny);
 
-	Assert(ScanDirectionIsForward(direction));
+	AOTupleIdInit_Init(&aoTupleId);
+	AOTupleIdInit_segmentFileNum(&aoTupleId, scan->seginfo[scan->cur_seg]->segno);
+	AOTupleIdInit_rowNum(&aoTupleId, rowNum);
 
-	ncol = slot->tts_tupleDescriptor->natts;
-	Assert(ncol <= scan->relationTupleDesc->natts);
+	if (!AppendOnlyBlockDirectory_GetEntry(&scan->zonemapDirectory,
+										   &aoTupleId, attno, &entry))
+		return;
+	if (!AppendOnlyBlockDirectoryEntry_RangeHasRow(&entry, rowNum) ||
+		!(stats->flags & MINIPAGE_STATS_VALID))
+		return;
 
-	while (1)
+	/*
+	 * With gp_blockdirectory_entry_min_range, the last entry of a minipage is
+	 * taken to cover every row after it, but its zone map only covers the
+	 * blocks that were added to it. Where it ends is unknown, so it is never
+	 * skipped.
+	 */
+	if (entry.range.lastRowNum == PG_INT64_MAX)
+		return;
+
+	for (i = 0; i < scan->num_zonemap_keys; i++)
 	{
-		AOCSFileSegInfo *curseginfo;
+		ScanKey		key = &scan->zonemap_keys[i];
+		bool		excluded;
 
-ReadNext:
-		/* If necessary, open next seg */
-		if (scan->cur_seg < 0 || err < 0)
+		if (key->sk_attno != attno + 1)
+			continue;
+
+		/* The keys are strict, so an entry of only NULLs never qualifies */
+		if (!(stats->flags & MINIPAGE_STATS_HAS_MINMAX))
+			excluded = true;
+		else
 		{
-			err = open_next_scan_seg(scan);
-			if (err < 0)
+			switch (key->sk_strategy)
 			{
-				/* No more seg, we are at the end */
-				ExecClearTuple(slot);
-				scan->cur_seg = -1;
-				return;
+				case BTLessStrategyNumber:
+					excluded = aocs_zonemap_cmp(key, stats->minValue) >= 0;
+					break;
+				case BTLessEqualStrategyNumber:
+					excluded = aocs_zonemap_cmp(key, stats->minValue) > 0;
+					break;
+				case BTEqualStrategyNumber:
+					excluded = aocs_zonemap_cmp(key, stats->minValue) > 0 ||
+						aocs_zonemap_cmp(key, stats->maxValue) < 0;
+					break;
+				case BTGreaterEqualStrategyNumber:
+					excluded = aocs_zonemap_cmp(key, stats->maxValue) < 0;
+					break;
+				case BTGreaterStrategyNumber:
+					excluded = aocs_zonemap_cmp(key, stats->maxValue) <= 0;
+					break;
+				default:
+					excluded = false;
+					break;
 			}
-			scan->cur_seg_row = 0;
 		}
 
-		Assert(scan->cur_seg >= 0);
-		curseginfo = scan->seginfo[scan->cur_seg];
+		if (excluded)
+		{
+			scan->skip_until = Max(scan->skip_until,
+								   entry.range.lastRowNum + 1);
+			return;
+		}
+	}
+}
 
-		/* Read from cur_seg */
-		for (i = 0; i < scan->num_proj_atts; i++)
+/*
+ * aocs_advance_column
+ *
+ * Advance column 'attno' to its next datum, reading the next block if
+ * needed. Returns false at the end of the segment file.
+ *
+ * With 'skip', blocks that end below scan->skip_until are skipped without
+ * reading their content. Before that, skip_until is moved past the fully
+ * hidden rows at the start of each new block, and the zone map of each new
+ * block of a column that has zone map keys is checked.
+ */
+static bool
+aocs_advance_column(AOCSScanDesc scan, int attno, bool skip)
+{
+	DatumStreamRead *ds = scan->ds[attno];
+	int			err;
+
+	err = datumstreamread_advance(ds);
+	Assert(err >= 0);
+	if (err > 0)
+		return true;
+
+	if (!skip)
+	{
+		if (datumstreamread_block(ds, scan->blockDirectory, attno) < 0)
+			return false;
+	}
+	else
+	{
+		while (1)
 		{
-			int			attno = scan->proj_atts[i];
+			int64		lastRowNum;
 
-			err = datumstreamread_advance(scan->ds[attno]);
-			Assert(err >= 0);
-			if (err == 0)
-			{
-				err = datumstreamread_block(scan->ds[attno], scan->blockDirectory, attno);
-				if (err < 0)
-				{
-					/*
-					 * Ha, cannot read next block, we need to go to next seg
-					 */
-					close_cur_scan_seg(scan);
-					goto ReadNext;
-				}
+			if (datumstreamread_block_header(ds) < 0)
+				return false;
+			lastRowNum = ds->blockFirstRowNum + ds->blockRowCount - 1;
 
-				err = datumstreamread_advance(scan->ds[attno]);
-				Assert(err > 0);
-			}
+			if (lastRowNum >= scan->skip_until)
+				scan->skip_until =
+					AppendOnlyVisimap_GetNextVisibleRowNum(&scan->visibilityMap,
+														   scan->seginfo[scan->cur_seg]->segno,
+														   Max(scan->skip_until, ds->blockFirstRowNum));
 
-			/*
-			 * Get the column's datum right here since the data structures
-			 * should still be hot in CPU data cache memory.
-			 */
-			datumstreamread_get(scan->ds[attno], &d[attno], &null[attno]);
+			if (lastRowNum >= scan->skip_until &&
+				scan->num_zonemap_keys > 0 &&
+				scan->zonemap_proj[attno])
+				aocs_zonemap_check(scan, attno, ds->blockFirstRowNum);
 
-			/*
-			 * Perform any required upgrades on the Datum we just fetched.
-			 */
-			if (curseginfo->formatversion < AORelationVersion_GetLatest())
-			{
-				upgrade_datum_scan(scan, attno, d, null,
-								   curseginfo->formatversion);
-			}
+			if (lastRowNum >= scan->skip_until)
+				break;
 
-			if (rowNum == INT64CONST(-1) &&
-				scan->ds[attno]->blockFirstRowNum != INT64CONST(-1))
-			{
-				Assert(scan->ds[attno]->blockFirstRowNum > 0);
-				rowNum = scan->ds[attno]->blockFirstRowNum +
-					datumstreamread_nth(scan->ds[attno]);
-			}
+			datumstreamread_block_skip(ds);
 		}
+		datumstreamread_block_content(ds);
+	}
 
-		AOTupleIdInit_Init(&aoTupleId);
-		AOTupleIdInit_segmentFileNum(&aoTupleId, curseginfo->segno);
+	err = datumstreamread_advance(ds);
+	Assert(err > 0);
+	return true;
+}
 
-		scan->cur_seg_row++;
-		if (rowNum == INT64CONST(-1))
-		{
-			AOTupleIdInit_rowNum(&aoTupleId, scan->cur_seg_row);
-		}
-		else
-		{
-			AOTupleIdInit_rowNum(&aoTupleId, rowNum);
-		}
+/*
+ * aocs_align_columns
+ *
+ * Move the first 'natts' projected columns forward until they are all on the
+ * same row, and that row is not below scan->skip_until. Returns false
+ * at the end of the segment file.
+ */
+static bool
+aocs_align_columns(AOCSScanDesc scan, int natts)
+{
+	while (1)
+	{
+		int64		target = scan->skip_until;
+		bool		aligned = true;
+		int			i;
+
+		for (i = 0; i < natts; i++)
+			target = Max(target, aocs_column_rownum(scan->ds[scan->proj_atts[i]]));
 
-		if (!isSnapshotAny && !AppendOnlyVisimap_IsVisible(&scan->visibilityMap, &aoTupleId))
+		for (i = 0; i < natts; i++)
 		{
-			rowNum = INT64CONST(-1);
-			goto ReadNext;
+			int			attno = scan->proj_atts[i];
+
+			while (aocs_column_rownum(scan->ds[attno]) < target)
+			{
+				if (!aocs_advance_column(scan, attno, true))
+					return false;
+			}
+			if (aocs_column_rownum(scan->ds[attno]) != target)
+				aligned = false;
 		}
-		scan->cdb_fake_ctid = *((ItemPointer) &aoTupleId);
 
-		TupSetVirtualTupleNValid(slot, ncol);
-		slot_set_ctid(slot, &(scan->cdb_fake_ctid));
-		return;
+		if (aligned && target >= scan->skip_until)
+			return true;
 	}
-
-	Assert(!"Never here");
-	return;
 }
 
-
-/* Open next file segment for write.  See SetCurrentFileSegForWrite */
-/* XXX Right now, we put each column to different files */
+/*
+ * aocs_seek_late_column
+ *
+ * Position column 'attno', which is not decoded into the batch, on row
+ * 'rowNum' of the current segment file. Blocks that end before that row are
+ * skipped without reading their content.
+ */
 static void
-OpenAOCSDatumStreams(AOCSInsertDesc desc)
+aocs_seek_late_column(AOCSScanDesc scan, int attno, int64 rowNum)
 {
-	RelFileNodeBackend rnode;
-	char	   *basepath;
-	char		fn[MAXPGPATH];
-	int32		fileSegNo;
+	DatumStreamRead *ds = scan->ds[attno];
 
-	AOCSFileSegInfo *seginfo;
+	while (rowNum >= ds->blockFirstRowNum + ds->blockRowCount)
+	{
+		if (datumstreamread_block_header(ds) < 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INTERNAL_ERROR),
+					 errmsg("unexpected end of column %d of append-only columnar relation \"%s\" before row " INT64_FORMAT,
+							attno + 1,
+							RelationGetRelationName(scan->aos_rel),
+							rowNum)));
+
+		if (rowNum >= ds->blockFirstRowNum + ds->blockRowCount)
+			datumstreamread_block_skip(ds);
+		else
+			datumstreamread_block_content(ds);
+	}
 
-	TupleDesc	tupdesc = RelationGetDescr(desc->aoi_rel);
-	int			nvp = tupdesc->natts;
-	int			i;
+	Assert(rowNum >= ds->blockFirstRowNum);
+	datumstreamread_find(ds, (int32) (rowNum - ds->blockFirstRowNum));
+}
 
-	desc->ds = (DatumStreamWrite **) palloc0(sizeof(DatumStreamWrite *) * nvp);
+/*
+ * aocs_dictionary_match
+ *
+ * If column 'attno' has dictionary keys and its current block has a
+ * dictionary, return an array that tells for each code of the block
+ * whether its value satisfies the keys. Otherwise return NULL.
+ */
+static bool *
+aocs_dictionary_match(AOCSScanDesc scan, int attno)
+{
+	DatumStreamRead *ds = scan->ds[attno];
+	bool	   *match;
+	MemoryContext oldcxt;
+	int			ncodes;
+	int			code;
+	int			i;
 
-	/*
-	 * In order to append to this file segment entry we must first acquire the
-	 * relation Append-Only segment file (transaction-scope) lock (tag
-	 * LOCKTAG_RELATION_APPENDONLY_SEGMENT_FILE) in order to guarantee
-	 * stability of the pg_aoseg information on this segment file and
-	 * exclusive right to append data to the segment file.
-	 *
-	 * NOTE: This is a transaction scope lock that must be held until commit /
-	 * abort.
-	 */
-	LockRelationAppendOnlySegmentFile(&desc->aoi_rel->rd_node,
-									  desc->cur_segno,
-									  AccessExclusiveLock,
-									   /* dontWait */ false);
+	if (scan->num_dictionary_keys == 0 ||
+		scan->dictionary_match[attno] == NULL ||
+		!datumstreamread_has_dictionary(ds))
+		return NULL;
 
-	open_ds_write(desc->aoi_rel, desc->ds, tupdesc,
-				  desc->aoi_rel->rd_appendonly->checksum);
+	match = scan->dictionary_match[attno];
+	if (scan->dictionary_block[attno] == ds->blockFileOffset)
+		return match;
 
-	/* Now open seg info file and get eof mark. */
-	seginfo = GetAOCSFileSegInfo(desc->aoi_rel,
-								 desc->appendOnlyMetaDataSnapshot,
-								 desc->cur_segno);
+	MemoryContextReset(scan->dictionary_context);
+	oldcxt = MemoryContextSwitchTo(scan->dictionary_context);
 
-	if (seginfo == NULL)
+	ncodes = datumstreamread_dictionary_count(ds);
+	for (code = 0; code < ncodes; code++)
 	{
-		InsertInitialAOCSFileSegInfo(desc->aoi_rel, desc->cur_segno, nvp);
-		seginfo = NewAOCSFileSegInfo(desc->cur_segno, nvp);
-	}
+		Datum		value = datumstreamread_dictionary(ds, code);
 
-	desc->fsInfo = seginfo;
+		match[code] = true;
+		for (i = 0; i < scan->num_dictionary_keys; i++)
+		{
+			ScanKey		key = &scan->dictionary_keys[i];
 
-	/* Never insert into a segment that is awaiting a drop */
-	Assert(desc->fsInfo->state != AOSEG_STATE_AWAITING_DROP);
+			if (key->sk_attno != attno + 1)
+				continue;
 
-	desc->rowCount = seginfo->total_tupcount;
+			if (!DatumGetBool(FunctionCall2Coll(&key->sk_func,
+												key->sk_collation,
+												value,
+												key->sk_argument)))
+			{
+				match[code] = false;
+				break;
+			}
+		}
+	}
 
-	rnode.node = desc->aoi_rel->rd_node;
-	rnode.backend = desc->aoi_rel->rd_backend;
-	basepath = relpath(rnode, MAIN_FORKNUM);
+	MemoryContextSwitchTo(oldcxt);
 
-	for (i = 0; i < nvp; ++i)
+	scan->dictionary_block[attno] = ds->blockFileOffset;
+	return match;
+}
+
+/*
+ * aocs_filter_batch
+ *
+ * Run the filter of the scan on the rows of the batch listed in
+ * scan->batch_sel, and keep only the ones that pass. Returns the new number
+ * of entries in scan->batch_sel.
+ */
+static int
+aocs_filter_batch(AOCSScanDesc scan, int nsel)
+{
+	TupleTableSlot *slot = scan->filter_slot;
+	Datum	   *d = slot_get_values(slot);
+	bool	   *null = slot_get_isnull(slot);
+	int			ncol = slot->tts_tupleDescriptor->natts;
+	int			nkept = 0;
+	int			i;
+	int			k;
+
+	/* The filter never looks at the other columns */
+	for (i = scan->num_filter_atts; i < scan->num_proj_atts; i++)
+	{
+		d[scan->proj_atts[i]] = (Datum) 0;
+		null[scan->proj_atts[i]] = true;
+	}
+
+	for (k = 0; k < nsel; k++)
+	{
+		int			row = scan->batch_sel[k];
+
+		for (i = 0; i < scan->num_filter_atts; i++)
+		{
+			int			attno = scan->proj_atts[i];
+
+			d[attno] = scan->batch_values[i][row];
+			null[attno] = scan->batch_isnull[i][row];
+		}
+		TupSetVirtualTupleNValid(slot, ncol);
+
+		/* The quals may look at ctid */
+		scan->cdb_fake_ctid = *((ItemPointer) &scan->batch_tids[row]);
+		slot_set_ctid(slot, &(scan->cdb_fake_ctid));
+
+		if (scan->filter(scan->filter_arg))
+			scan->batch_sel[nkept++] = row;
+	}
+
+	return nkept;
+}
+
+/*
+ * aocs_getnext_batch
+ *
+ * Decode the next batch of rows of the scan, column-at-a-time, into
+ * scan->batch_values and scan->batch_isnull.
+ *
+ * A batch never crosses a block boundary of any of the projected columns, so
+ * that by-reference values decoded into it stay valid until the next call.
+ * The visimap is consulted for the whole batch before any column is decoded,
+ * and only the rows that survive it, listed in the selection vector
+ * scan->batch_sel, are fetched from the datum streams.
+ *
+ * Returns the number of visible rows in the batch, or 0 at the end of the
+ * scan. Batches where every row is invisible are skipped.
+ */
+int
+aocs_getnext_batch(AOCSScanDesc scan, ScanDirection direction)
+{
+	int			err = 0;
+	int			i;
+	int			k;
+	bool		isSnapshotAny = (scan->snapshot == SnapshotAny);
+
+	Assert(ScanDirectionIsForward(direction));
+
+	scan->batch_nrows = 0;
+	scan->batch_nsel = 0;
+	scan->batch_next = 0;
+
+	while (1)
+	{
+		AOCSFileSegInfo *curseginfo;
+		int64		firstRowNum;
+		int			nrows;
+		int			nsel;
+		int			ndecode;
+		bool		skip;
+
+ReadNext:
+		/* If necessary, open next seg */
+		if (scan->cur_seg < 0 || err < 0)
+		{
+			err = open_next_scan_seg(scan);
+			if (err < 0)
+			{
+				/* No more seg, we are at the end */
+				scan->cur_seg = -1;
+				return 0;
+			}
+			scan->cur_seg_row = 0;
+			scan->skip_until = 0;
+
+			/* Block offsets start over in the new segment file */
+			if (scan->num_dictionary_keys > 0)
+			{
+				for (i = 0; i < scan->relationTupleDesc->natts; i++)
+					scan->dictionary_block[i] = INT64CONST(-1);
+			}
+
+			if (!isSnapshotAny)
+				AppendOnlyVisimap_LoadSegmentFile(&scan->visibilityMap,
+												  scan->seginfo[scan->cur_seg]->segno);
+		}
+
+		Assert(scan->cur_seg >= 0);
+		curseginfo = scan->seginfo[scan->cur_seg];
+		firstRowNum = INT64CONST(-1);
+		nrows = AOCS_SCAN_BATCH_SIZE;
+
+		/*
+		 * Blocks are skipped when the zone maps rule them out, or when the
+		 * visimap hides all their rows. This needs the first row number of
+		 * every block, which blocks written before 4.0 do not have. When the
+		 * scan builds the block directory it must see every block.
+		 */
+		skip = ((scan->num_zonemap_keys > 0 ||
+				 scan->visibilityMap.segmentCache.hasHiddenRanges) &&
+				scan->blockDirectory == NULL &&
+				curseginfo->formatversion == AORelationVersion_GetLatest());
+
+		/*
+		 * Late materialization has the same needs: the other columns are
+		 * positioned by row number.
+		 */
+		scan->batch_late = (scan->filter != NULL &&
+							scan->blockDirectory == NULL &&
+							curseginfo->formatversion == AORelationVersion_GetLatest());
+		ndecode = scan->batch_late ? scan->num_filter_atts : scan->num_proj_atts;
+
+		/* Position every decoded column on the first row of the batch */
+		for (i = 0; i < ndecode; i++)
+		{
+			if (!aocs_advance_column(scan, scan->proj_atts[i], skip))
+			{
+				/*
+				 * Ha, cannot read next block, we need to go to next seg
+				 */
+				close_cur_scan_seg(scan);
+				err = -1;
+				goto ReadNext;
+			}
+		}
+
+		/*
+		 * Skipped blocks can leave the columns on different rows. Bring them
+		 * all to the same one.
+		 */
+		if (skip && !aocs_align_columns(scan, ndecode))
+		{
+			close_cur_scan_seg(scan);
+			err = -1;
+			goto ReadNext;
+		}
+
+		/*
+		 * Find out how many rows all decoded columns can deliver from their
+		 * current block.
+		 */
+		for (i = 0; i < ndecode; i++)
+		{
+			DatumStreamRead *ds = scan->ds[scan->proj_atts[i]];
+
+			nrows = Min(nrows, datumstreamread_remaining(ds) + 1);
+
+			if (firstRowNum == INT64CONST(-1) &&
+				ds->blockFirstRowNum != INT64CONST(-1))
+			{
+				Assert(ds->blockFirstRowNum > 0);
+				firstRowNum = ds->blockFirstRowNum + datumstreamread_nth(ds);
+			}
+		}
+
+		/*
+		 * Datums upgraded from an older format are copied to a per-stream
+		 * buffer that holds a single value, so go one row at a time.
+		 */
+		if (curseginfo->formatversion < AORelationVersion_GetLatest())
+			nrows = 1;
+
+		/* Build the selection vector of visible rows */
+		nsel = 0;
+		for (k = 0; k < nrows; k++)
+		{
+			AOTupleId  *aoTupleId = &scan->batch_tids[k];
+
+			AOTupleIdInit_Init(aoTupleId);
+			AOTupleIdInit_segmentFileNum(aoTupleId, curseginfo->segno);
+			if (firstRowNum == INT64CONST(-1))
+				AOTupleIdInit_rowNum(aoTupleId, scan->cur_seg_row + k + 1);
+			else
+				AOTupleIdInit_rowNum(aoTupleId, firstRowNum + k);
+
+			if (isSnapshotAny || AppendOnlyVisimap_IsVisible(&scan->visibilityMap, aoTupleId))
+				scan->batch_sel[nsel++] = k;
+		}
+		scan->cur_seg_row += nrows;
+
+		/*
+		 * Decode the batch one column at a time. Every column is already
+		 * positioned on the first row; the remaining rows are known to be in
+		 * the current block. A column with a dictionary that dictionary keys
+		 * apply to drops the rows whose code fails them, so later columns do
+		 * not decode those.
+		 */
+		for (i = 0; i < ndecode; i++)
+		{
+			int			attno = scan->proj_atts[i];
+			DatumStreamRead *ds = scan->ds[attno];
+			Datum	   *values = scan->batch_values[i];
+			bool	   *isnull = scan->batch_isnull[i];
+			bool	   *match = aocs_dictionary_match(scan, attno);
+			int			sel = 0;
+			int			nkept = 0;
+
+			for (k = 0; k < nrows; k++)
+			{
+				if (k > 0)
+				{
+					err = datumstreamread_advance(ds);
+					Assert(err > 0);
+				}
+
+				if (sel < nsel && scan->batch_sel[sel] == k)
+				{
+					sel++;
+					datumstreamread_get(ds, &values[k], &isnull[k]);
+
+					/* The keys are strict, so a NULL never qualifies */
+					if (match != NULL &&
+						(isnull[k] || !match[datumstreamread_code(ds)]))
+						continue;
+
+					/*
+					 * Perform any required upgrades on the Datum we just
+					 * fetched.
+					 */
+					if (curseginfo->formatversion < AORelationVersion_GetLatest())
+					{
+						upgrade_datum_scan(scan, attno, &values[k], isnull[k],
+										   curseginfo->formatversion);
+					}
+					scan->batch_sel[nkept++] = k;
+				}
+			}
+			nsel = nkept;
+		}
+
+		if (scan->batch_late && nsel > 0)
+			nsel = aocs_filter_batch(scan, nsel);
+
+		if (nsel > 0)
+		{
+			scan->batch_nrows = nrows;
+			scan->batch_nsel = nsel;
+			return nsel;
+		}
+	}
+
+	Assert(!"Never here");
+	return 0;
+}
+
+void
+aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot)
+{
+	int			ncol;
+	Datum	   *d = slot_get_values(slot);
+	bool	   *null = slot_get_isnull(slot);
+	int			row;
+	int			i;
+
+	ncol = slot->tts_tupleDescriptor->natts;
+	Assert(ncol <= scan->relationTupleDesc->natts);
+
+	if (scan->batch_next >= scan->batch_nsel &&
+		aocs_getnext_batch(scan, direction) == 0)
+	{
+		ExecClearTuple(slot);
+		return;
+	}
+
+	row = scan->batch_sel[scan->batch_next++];
+	if (!scan->batch_late)
+	{
+		for (i = 0; i < scan->num_proj_atts; i++)
+		{
+			int			attno = scan->proj_atts[i];
+
+			d[attno] = scan->batch_values[i][row];
+			null[attno] = scan->batch_isnull[i][row];
+		}
+	}
+	else
+	{
+		int64		rowNum = AOTupleIdGet_rowNum(&scan->batch_tids[row]);
+
+		for (i = 0; i < scan->num_filter_atts; i++)
+		{
+			int			attno = scan->proj_atts[i];
+
+			d[attno] = scan->batch_values[i][row];
+			null[attno] = scan->batch_isnull[i][row];
+		}
+		for (; i < scan->num_proj_atts; i++)
+		{
+			int			attno = scan->proj_atts[i];
+
+			aocs_seek_late_column(scan, attno, rowNum);
+			datumstreamread_get(scan->ds[attno], &d[attno], &null[attno]);
+		}
+	}
+
+	scan->cdb_fake_ctid = *((ItemPointer) &scan->batch_tids[row]);
+
+	TupSetVirtualTupleNValid(slot, ncol);
+	slot_set_ctid(slot, &(scan->cdb_fake_ctid));
+}
+
+
+/* Open next file segment for write.  See SetCurrentFileSegForWrite */
+/* XXX Right now, we put each column to different files */
+static void
+OpenAOCSDatumStreams(AOCSInsertDesc desc)
+{
+	RelFileNodeBackend rnode;
+	char	   *basepath;
+	char		fn[MAXPGPATH];
+	int32		fileSegNo;
+
+	AOCSFileSegInfo *seginfo;
+
+	TupleDesc	tupdesc = RelationGetDescr(desc->aoi_rel);
+	int			nvp = tupdesc->natts;
+	int			i;
+
+	desc->ds = (DatumStreamWrite **) palloc0(sizeof(DatumStreamWrite *) * nvp);
+
+	/*
+	 * In order to append to this file segment entry we must first acquire the
+	 * relation Append-Only segment file (transaction-scope) lock (tag
+	 * LOCKTAG_RELATION_APPENDONLY_SEGMENT_FILE) in order to guarantee
+	 * stability of the pg_aoseg information on this segment file and
+	 * exclusive right to append data to the segment file.
+	 *
+	 * NOTE: This is a transaction scope lock that must be held until commit /
+	 * abort.
+	 */
+	LockRelationAppendOnlySegmentFile(&desc->aoi_rel->rd_node,
+									  desc->cur_segno,
+									  AccessExclusiveLock,
+									   /* dontWait */ false);
+
+	open_ds_write(desc->aoi_rel, desc->ds, tupdesc,
+				  desc->aoi_rel->rd_appendonly->checksum);
+
+	/* Now open seg info file and get eof mark. */
+	seginfo = GetAOCSFileSegInfo(desc->aoi_rel,
+								 desc->appendOnlyMetaDataSnapshot,
+								 desc->cur_segno);
+
+	if (seginfo == NULL)
+	{
+		InsertInitialAOCSFileSegInfo(desc->aoi_rel, desc->cur_segno, nvp);
+		seginfo = NewAOCSFileSegInfo(desc->cur_segno, nvp);
+	}
+
+	desc->fsInfo = seginfo;
+
+	/* Never insert into a segment that is awaiting a drop */
+	Assert(desc->fsInfo->state != AOSEG_STATE_AWAITING_DROP);
+
+	desc->rowCount = seginfo->total_tupcount;
+
+	rnode.node = desc->aoi_rel->rd_node;
+	rnode.backend = desc->aoi_rel->rd_backend;
+	basepath = relpath(rnode, MAIN_FORKNUM);
+
+	for (i = 0; i < nvp; ++i)
 	{
 		AOCSVPInfoEntry *e = getAOCSVPEntry(seginfo, i);
 
@@ -851,6 +1555,12 @@ aocs_insert_init(Relation rel, int segno, bool update_mode)
 
 	OpenAOCSDatumStreams(desc);
 
+	desc->bufferContext = AllocSetContextCreate(CurrentMemoryContext,
+												"AOCS insert buffer",
+												ALLOCSET_DEFAULT_MINSIZE,
+												ALLOCSET_DEFAULT_INITSIZE,
+												ALLOCSET_DEFAULT_MAXSIZE);
+
 	/*
 	 * Obtain the next list of fast sequences for this relation.
 	 *
@@ -888,84 +1598,78 @@ aocs_insert_init(Relation rel, int segno, bool update_mode)
 }
 
 
-Oid
-aocs_insert_values(AOCSInsertDesc idesc, Datum *d, bool *null, AOTupleId *aoTupleId)
+/*
+ * Put one datum of row rowNum into the stream of column i, writing out the
+ * block when it is full.
+ */
+static inline void
+aocs_insert_datum(AOCSInsertDesc idesc, int i, Datum datum, bool null,
+				  int64 rowNum)
 {
-	Relation	rel = idesc->aoi_rel;
-	int			i;
-
-	if (rel->rd_rel->relhasoids)
-		ereport(ERROR,
-				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
-				 errmsg("append-only column-oriented tables do not support rows with OIDs")));
-
-#ifdef FAULT_INJECTOR
-	FaultInjector_InjectFaultIfSet(
-								   AppendOnlyInsert,
-								   DDLNotSpecified,
-								   "",	/* databaseName */
-								   RelationGetRelationName(idesc->aoi_rel));	/* tableName */
-#endif
+	void	   *toFree1;
+	int			err = datumstreamwrite_put(idesc->ds[i], datum, null, &toFree1);
 
-	/* As usual, at this moment, we assume one col per vp */
-	for (i = 0; i < RelationGetNumberOfAttributes(rel); ++i)
+	if (toFree1 != NULL)
 	{
-		void	   *toFree1;
-		Datum		datum = d[i];
-		int			err = datumstreamwrite_put(idesc->ds[i], datum, null[i], &toFree1);
+		/*
+		 * Use the de-toasted and/or de-compressed as datum instead.
+		 */
+		datum = PointerGetDatum(toFree1);
+	}
+	if (err < 0)
+	{
+		int			itemCount = datumstreamwrite_nth(idesc->ds[i]);
+		void	   *toFree2;
 
-		if (toFree1 != NULL)
+		/* write the block up to this one */
+		datumstreamwrite_block(idesc->ds[i], &idesc->blockDirectory, i, false);
+		if (itemCount > 0)
 		{
 			/*
-			 * Use the de-toasted and/or de-compressed as datum instead.
+			 * since we have written all up to the new tuple, the new
+			 * blockFirstRowNum is the inserted tuple's row number
 			 */
-			datum = PointerGetDatum(toFree1);
+			idesc->ds[i]->blockFirstRowNum = rowNum;
 		}
-		if (err < 0)
-		{
-			int			itemCount = datumstreamwrite_nth(idesc->ds[i]);
-			void	   *toFree2;
-
-			/* write the block up to this one */
-			datumstreamwrite_block(idesc->ds[i], &idesc->blockDirectory, i, false);
-			if (itemCount > 0)
-			{
-				/*
-				 * since we have written all up to the new tuple, the new
-				 * blockFirstRowNum is the inserted tuple's row number
-				 */
-				idesc->ds[i]->blockFirstRowNum = idesc->lastSequence + 1;
-			}
 
-			Assert(idesc->ds[i]->blockFirstRowNum == idesc->lastSequence + 1);
+		Assert(idesc->ds[i]->blockFirstRowNum == rowNum);
 
 
-			/* now write this new item to the new block */
-			err = datumstreamwrite_put(idesc->ds[i], datum, null[i], &toFree2);
-			Assert(toFree2 == NULL);
-			if (err < 0)
-			{
-				Assert(!null[i]);
-				err = datumstreamwrite_lob(idesc->ds[i],
-										   datum,
-										   &idesc->blockDirectory,
-										   i,
-										   false);
-				Assert(err >= 0);
+		/* now write this new item to the new block */
+		err = datumstreamwrite_put(idesc->ds[i], datum, null, &toFree2);
+		Assert(toFree2 == NULL);
+		if (err < 0)
+		{
+			Assert(!null);
+			err = datumstreamwrite_lob(idesc->ds[i],
+									   datum,
+									   &idesc->blockDirectory,
+									   i,
+									   false);
+			Assert(err >= 0);
 
-				/*
-				 * A lob will live by itself in the block so this assignment
-				 * is for the block that contains tuples AFTER the one we are
-				 * inserting
-				 */
-				idesc->ds[i]->blockFirstRowNum = idesc->lastSequence + 2;
-			}
+			/*
+			 * A lob will live by itself in the block so this assignment is
+			 * for the block that contains tuples AFTER the one we are
+			 * inserting
+			 */
+			idesc->ds[i]->blockFirstRowNum = rowNum + 1;
 		}
-
-		if (toFree1 != NULL)
-			pfree(toFree1);
 	}
 
+	if (toFree1 != NULL)
+		pfree(toFree1);
+}
+
+/*
+ * Take the next row number, asking for a new list of fast sequence numbers
+ * when the allocated ones are used up.
+ */
+static void
+aocs_insert_next_sequence(AOCSInsertDesc idesc, AOTupleId *aoTupleId)
+{
+	Relation	rel = idesc->aoi_rel;
+
 	idesc->insertCount++;
 	idesc->lastSequence++;
 	if (idesc->numSequences > 0)
@@ -994,16 +1698,312 @@ aocs_insert_values(AOCSInsertDesc idesc, Datum *d, bool *null, AOTupleId *aoTupl
 		Assert(firstSequence == idesc->lastSequence + 1);
 		idesc->numSequences = NUM_FAST_SEQUENCES;
 	}
+}
+
+Oid
+aocs_insert_values(AOCSInsertDesc idesc, Datum *d, bool *null, AOTupleId *aoTupleId)
+{
+	Relation	rel = idesc->aoi_rel;
+	int			i;
+
+	if (rel->rd_rel->relhasoids)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("append-only column-oriented tables do not support rows with OIDs")));
+
+#ifdef FAULT_INJECTOR
+	FaultInjector_InjectFaultIfSet(
+								   AppendOnlyInsert,
+								   DDLNotSpecified,
+								   "",	/* databaseName */
+								   RelationGetRelationName(idesc->aoi_rel));	/* tableName */
+#endif
+
+	/* Rows buffered by aocs_insert_values_multi come first */
+	aocs_insert_flush(idesc);
+
+	/* As usual, at this moment, we assume one col per vp */
+	for (i = 0; i < RelationGetNumberOfAttributes(rel); ++i)
+		aocs_insert_datum(idesc, i, d[i], null[i], idesc->lastSequence + 1);
+
+	aocs_insert_next_sequence(idesc, aoTupleId);
 
 	return InvalidOid;
 }
 
+/*
+ * Insert descs whose buffers are allocated, least recently used first, and
+ * the memory reserved for them. Insert descs are finished at the end of
+ * their statement, and freed along with it on error, so the list is emptied
+ * at the end of every transaction, and entries of an aborted
+ * subtransaction are dropped.
+ */
+static List *aocsBufferedInserts = NIL;
+static Size aocsBufferReservedTotal = 0;
+static bool aocsBufferCallbacksRegistered = false;
+
+static void
+aocs_insert_buffer_forget(AOCSInsertDesc idesc)
+{
+	MemoryContext oldcxt;
+
+	oldcxt = MemoryContextSwitchTo(TopMemoryContext);
+	aocsBufferedInserts = list_delete_ptr(aocsBufferedInserts, idesc);
+	MemoryContextSwitchTo(oldcxt);
+
+	aocsBufferReservedTotal -= idesc->bufferReserved;
+	idesc->bufferReserved = 0;
+}
+
+static void
+aocs_insert_buffer_xact_callback(XactEvent event, void *arg)
+{
+	list_free(aocsBufferedInserts);
+	aocsBufferedInserts = NIL;
+	aocsBufferReservedTotal = 0;
+}
+
+static void
+aocs_insert_buffer_subxact_callback(SubXactEvent event, SubTransactionId mySubid,
+									SubTransactionId parentSubid, void *arg)
+{
+	ListCell   *lc;
+	ListCell   *next;
+
+	for (lc = list_head(aocsBufferedInserts); lc != NULL; lc = next)
+	{
+		AOCSInsertDesc idesc = (AOCSInsertDesc) lfirst(lc);
+
+		next = lnext(lc);
+		if (idesc->bufferSubid != mySubid)
+			continue;
+
+		if (event == SUBXACT_EVENT_COMMIT_SUB)
+			idesc->bufferSubid = parentSubid;
+		else if (event == SUBXACT_EVENT_ABORT_SUB)
+		{
+			/* The desc itself may be gone, don't touch it */
+			aocsBufferReservedTotal -= idesc->bufferReserved;
+			aocsBufferedInserts = list_delete_ptr(aocsBufferedInserts, idesc);
+		}
+	}
+}
+
+/*
+ * Write out the buffered rows of an insert desc, and free its buffers.
+ */
+static void
+aocs_insert_release_buffer(AOCSInsertDesc idesc)
+{
+	if (idesc->bufferValues == NULL)
+		return;
+
+	aocs_insert_flush(idesc);
+
+	MemoryContextResetAndDeleteChildren(idesc->bufferContext);
+	idesc->bufferValues = NULL;
+	idesc->bufferNulls = NULL;
+	idesc->bufferDatumContext = NULL;
+
+	if (idesc->bufferReserved != 0)
+		aocs_insert_buffer_forget(idesc);
+}
+
+/*
+ * Make sure the buffers of an insert desc are allocated, and mark it as the
+ * most recently used. Allocating them may release the buffers of the least
+ * recently used insert descs, to stay within AOCS_INSERT_BUFFER_TOTAL_SIZE.
+ */
+static void
+aocs_insert_reserve_buffer(AOCSInsertDesc idesc)
+{
+	int			natts = RelationGetNumberOfAttributes(idesc->aoi_rel);
+	MemoryContext oldcxt;
+	Size		reserve;
+	int			i;
+
+	if (idesc->bufferValues != NULL && idesc->bufferReserved != 0)
+	{
+		if (llast(aocsBufferedInserts) != idesc)
+		{
+			oldcxt = MemoryContextSwitchTo(TopMemoryContext);
+			aocsBufferedInserts = list_delete_ptr(aocsBufferedInserts, idesc);
+			aocsBufferedInserts = lappend(aocsBufferedInserts, idesc);
+			MemoryContextSwitchTo(oldcxt);
+		}
+		return;
+	}
+
+	if (!aocsBufferCallbacksRegistered)
+	{
+		RegisterXactCallback(aocs_insert_buffer_xact_callback, NULL);
+		RegisterSubXactCallback(aocs_insert_buffer_subxact_callback, NULL);
+		aocsBufferCallbacksRegistered = true;
+	}
+
+	/* The arrays, and at most a buffer's worth of by-reference values */
+	reserve = natts * AOCS_INSERT_BUFFER_ROWS * (sizeof(Datum) + sizeof(bool)) +
+		AOCS_INSERT_BUFFER_SIZE;
+
+	while (aocsBufferedInserts != NIL &&
+		   aocsBufferReservedTotal + reserve > AOCS_INSERT_BUFFER_TOTAL_SIZE)
+		aocs_insert_release_buffer((AOCSInsertDesc) linitial(aocsBufferedInserts));
+
+	/*
+	 * The buffers may already be there if they were forgotten when a
+	 * subtransaction aborted.
+	 */
+	oldcxt = MemoryContextSwitchTo(idesc->bufferContext);
+	if (idesc->bufferValues == NULL)
+	{
+		idesc->bufferValues = palloc(natts * sizeof(Datum *));
+		idesc->bufferNulls = palloc(natts * sizeof(bool *));
+		for (i = 0; i < natts; i++)
+		{
+			idesc->bufferValues[i] = palloc(AOCS_INSERT_BUFFER_ROWS * sizeof(Datum));
+			idesc->bufferNulls[i] = palloc(AOCS_INSERT_BUFFER_ROWS * sizeof(bool));
+		}
+		idesc->bufferDatumContext =
+			AllocSetContextCreate(idesc->bufferContext,
+								  "AOCS insert buffer values",
+								  ALLOCSET_DEFAULT_MINSIZE,
+								  ALLOCSET_DEFAULT_INITSIZE,
+								  ALLOCSET_DEFAULT_MAXSIZE);
+	}
+
+	MemoryContextSwitchTo(TopMemoryContext);
+	aocsBufferedInserts = lappend(aocsBufferedInserts, idesc);
+	MemoryContextSwitchTo(oldcxt);
+
+	idesc->bufferReserved = reserve;
+	idesc->bufferSubid = GetCurrentSubTransactionId();
+	aocsBufferReservedTotal += reserve;
+}
+
+/*
+ * Insert nrows rows, given as arrays of values and nulls per row.
+ *
+ * The rows are transposed into per-column buffers, and only written to the
+ * column streams once enough rows have been collected, or by
+ * aocs_insert_flush.  Each column then fills and compresses its blocks in
+ * one pass over the buffered rows, instead of every row visiting every
+ * column's stream in turn.  The values are copied, so the caller may reuse
+ * the arrays right away.  The rows get their row numbers right away, and are
+ * returned in aoTupleIds.
+ *
+ * Like the partial block of each column, the buffered rows are only visible
+ * to scans once aocs_insert_finish has written them.
+ */
+void
+aocs_insert_values_multi(AOCSInsertDesc idesc, int nrows,
+						 Datum **values, bool **nulls, AOTupleId *aoTupleIds)
+{
+	Relation	rel = idesc->aoi_rel;
+	TupleDesc	tupleDesc = RelationGetDescr(rel);
+	int			natts = tupleDesc->natts;
+	int			r;
+	int			i;
+
+	if (rel->rd_rel->relhasoids)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("append-only column-oriented tables do not support rows with OIDs")));
+
+	aocs_insert_reserve_buffer(idesc);
+
+	for (r = 0; r < nrows; r++)
+	{
+		MemoryContext oldcxt;
+		int			row = idesc->bufferRows;
+
+#ifdef FAULT_INJECTOR
+		FaultInjector_InjectFaultIfSet(
+									   AppendOnlyInsert,
+									   DDLNotSpecified,
+									   "",	/* databaseName */
+									   RelationGetRelationName(idesc->aoi_rel));	/* tableName */
+#endif
+
+		oldcxt = MemoryContextSwitchTo(idesc->bufferDatumContext);
+		for (i = 0; i < natts; i++)
+		{
+			Form_pg_attribute attr = tupleDesc->attrs[i];
+			Datum		datum = values[r][i];
+			bool		null = nulls[r][i];
+
+			if (!null && !attr->attbyval)
+			{
+				/*
+				 * The stream would de-toast the value anyway, so do it now
+				 * rather than keep a pointer to the toast table.
+				 */
+				if (attr->attlen == -1 &&
+					(VARATT_IS_EXTERNAL(DatumGetPointer(datum)) ||
+					 VARATT_IS_COMPRESSED(DatumGetPointer(datum))))
+					datum = PointerGetDatum(heap_tuple_untoast_attr((struct varlena *)
+																	DatumGetPointer(datum)));
+				else
+					datum = datumCopy(datum, false, attr->attlen);
+
+				idesc->bufferSize += datumGetSize(datum, false, attr->attlen);
+			}
+
+			idesc->bufferValues[i][row] = datum;
+			idesc->bufferNulls[i][row] = null;
+		}
+		MemoryContextSwitchTo(oldcxt);
+
+		idesc->bufferRows++;
+		aocs_insert_next_sequence(idesc, &aoTupleIds[r]);
+
+		if (idesc->bufferRows == AOCS_INSERT_BUFFER_ROWS ||
+			idesc->bufferSize >= AOCS_INSERT_BUFFER_SIZE)
+			aocs_insert_flush(idesc);
+	}
+}
+
+/*
+ * Write the rows buffered by aocs_insert_values_multi to the column streams,
+ * one column at a time.
+ */
+void
+aocs_insert_flush(AOCSInsertDesc idesc)
+{
+	int			natts = RelationGetNumberOfAttributes(idesc->aoi_rel);
+	int			nrows = idesc->bufferRows;
+	int64		firstRowNum;
+	int			i;
+
+	if (nrows == 0)
+		return;
+
+	firstRowNum = idesc->lastSequence - nrows + 1;
+
+	for (i = 0; i < natts; i++)
+	{
+		Datum	   *values = idesc->bufferValues[i];
+		bool	   *nulls = idesc->bufferNulls[i];
+		int			r;
+
+		for (r = 0; r < nrows; r++)
+			aocs_insert_datum(idesc, i, values[r], nulls[r], firstRowNum + r);
+	}
+
+	idesc->bufferRows = 0;
+	idesc->bufferSize = 0;
+	MemoryContextReset(idesc->bufferDatumContext);
+}
+
 void
 aocs_insert_finish(AOCSInsertDesc idesc)
 {
 	Relation	rel = idesc->aoi_rel;
 	int			i;
 
+	aocs_insert_release_buffer(idesc);
+	MemoryContextDelete(idesc->bufferContext);
+	idesc->bufferContext = NULL;
+
 	for (i = 0; i < rel->rd_att->natts; ++i)
 	{
 		datumstreamwrite_block(idesc->ds[i], &idesc->blockDirectory, i, false);
@@ -1058,12 +2058,21 @@ fetchFromCurrentBlock(AOCSFetchDesc aocsFetchDesc,
 	DatumStreamFetchDesc datumStreamFetchDesc =
 	aocsFetchDesc->datumStreamFetchDesc[colno];
 	DatumStreamRead *datumStream = datumStreamFetchDesc->datumStream;
-	Datum		value;
-	bool		null;
+	Datum	   *values;
+	bool	   *nulls;
+	int			formatversion;
 	int			rowNumInBlock = rowNum - datumStreamFetchDesc->currentBlock.firstRowNum;
 
 	Assert(rowNumInBlock >= 0);
 
+	/*
+	 * Every row number in the block header's range has a datum in the block,
+	 * so a caller that only asks whether the row exists does not need the
+	 * contents. Skip reading and decompressing them.
+	 */
+	if (slot == NULL)
+		return;
+
 	/*
 	 * MPP-17061: gotContents could be false in the case of aborted rows. As
 	 * described in the repro in MPP-17061, if aocs_fetch is trying to fetch
@@ -1079,26 +2088,19 @@ fetchFromCurrentBlock(AOCSFetchDesc aocsFetchDesc,
 
 	datumstreamread_find(datumStream, rowNumInBlock);
 
-	if (slot != NULL)
-	{
-		Datum	   *values = slot_get_values(slot);
-		bool	   *nulls = slot_get_isnull(slot);
-		int			formatversion = datumStream->ao_read.formatVersion;
+	values = slot_get_values(slot);
+	nulls = slot_get_isnull(slot);
+	formatversion = datumStream->ao_read.formatVersion;
 
-		datumstreamread_get(datumStream, &(values[colno]), &(nulls[colno]));
+	datumstreamread_get(datumStream, &(values[colno]), &(nulls[colno]));
 
-		/*
-		 * Perform any required upgrades on the Datum we just fetched.
-		 */
-		if (formatversion < AORelationVersion_GetLatest())
-		{
-			upgrade_datum_fetch(aocsFetchDesc, colno, values, nulls,
-								formatversion);
-		}
-	}
-	else
+	/*
+	 * Perform any required upgrades on the Datum we just fetched.
+	 */
+	if (formatversion < AORelationVersion_GetLatest())
 	{
-		datumstreamread_get(datumStream, &value, &null);
+		upgrade_datum_fetch(aocsFetchDesc, colno, values, nulls,
+							formatversion);
 	}
 }
 
@@ -151,6 +151,15 @@ AppendOnlyCompaction_ShouldCompact(
 		 */
 		result = true;
 	}
+	else if (isFull && RelationGetAppendOnlySortKey(aoRelation) != NULL)
+	{
+		/*
+		 * A full vacuum of a table with a sort key rewrites the segment
+		 * file even without obsolete data, to merge its rows with those of
+		 * the other segment files in sort key order.
+		 */
+		result = true;
+	}
 	else
 	{
 		hideRatio = AppendOnlyCompaction_GetHideRatio(hiddenTupcount, segmentTotalTupcount);
@@ -329,14 +338,53 @@ AppendOnlyThrowAwayTuple(Relation rel,
 		   AOTupleIdGet_segmentFileNum(oldAoTupleId), AOTupleIdGet_rowNum(oldAoTupleId));
 }
 
+/*
+ * Write out the rows collected by the compaction of an append-only relation
+ * with a sort key, in sort key order, and insert their index entries. Exactly
+ * one of aoInsertDesc and aocsInsertDesc is given. Ends the sort.
+ */
+void
+AppendOnlyCompaction_WriteSorted(Relation aorel,
+								 AppendOnlySort *sort,
+								 AppendOnlyInsertDesc aoInsertDesc,
+								 struct AOCSInsertDescData *aocsInsertDesc)
+{
+	ResultRelInfo *resultRelInfo;
+	EState	   *estate;
+
+	Assert((aoInsertDesc != NULL) != (aocsInsertDesc != NULL));
+
+	estate = CreateExecutorState();
+	resultRelInfo = makeNode(ResultRelInfo);
+	resultRelInfo->ri_RangeTableIndex = 1;	/* dummy */
+	resultRelInfo->ri_RelationDesc = aorel;
+	resultRelInfo->ri_TrigDesc = NULL;	/* we don't fire triggers */
+	resultRelInfo->ri_aoInsertDesc = aoInsertDesc;
+	resultRelInfo->ri_aocsInsertDesc = aocsInsertDesc;
+	resultRelInfo->ri_aoSort = sort;
+	ExecOpenIndices(resultRelInfo);
+	estate->es_result_relations = resultRelInfo;
+	estate->es_num_result_relations = 1;
+	estate->es_result_relation_info = resultRelInfo;
+
+	ExecFlushAppendOnlySort(estate, resultRelInfo);
+
+	ExecCloseIndices(resultRelInfo);
+	FreeExecutorState(estate);
+}
+
 /*
  * Assumes that the segment file lock is already held.
  * Assumes that the segment file should be compacted.
  *
+ * If sort is given, the visible tuples are put into it, to be written
+ * out in sort key order by AppendOnlyCompaction_WriteSorted, rather than
+ * moved right away.
  */
 static void
 AppendOnlySegmentFileFullCompaction(Relation aorel,
 									AppendOnlyInsertDesc insertDesc,
+									AppendOnlySort *sort,
 									FileSegInfo *fsinfo)
 {
 	const char *relname;
@@ -414,12 +462,15 @@ AppendOnlySegmentFileFullCompaction(Relation aorel,
 		aoTupleId = (AOTupleId *) slot_get_ctid(slot);
 		if (AppendOnlyVisimap_IsVisible(&scanDesc->visibilityMap, aoTupleId))
 		{
-			AppendOnlyMoveTuple(tuple,
-								slot,
-								mt_bind,
-								insertDesc,
-								resultRelInfo,
-								estate);
+			if (sort)
+				AppendOnlySort_Put(sort, slot);
+			else
+				AppendOnlyMoveTuple(tuple,
+									slot,
+									mt_bind,
+									insertDesc,
+									resultRelInfo,
+									estate);
 			movedTupleCount++;
 		}
 		else
@@ -667,6 +718,7 @@ AppendOnlyCompact(Relation aorel,
 	int			total_segfiles;
 	FileSegInfo **segfile_array;
 	AppendOnlyInsertDesc insertDesc = NULL;
+	AppendOnlySort *sort;
 	int			i,
 				segno;
 	FileSegInfo *fsinfo;
@@ -684,6 +736,12 @@ AppendOnlyCompact(Relation aorel,
 
 	insertDesc = appendonly_insert_init(aorel, insert_segno, false);
 
+	/*
+	 * With a sort key, the rows of all the compacted segment files are
+	 * merged into one run in sort key order.
+	 */
+	sort = AppendOnlySort_Begin(aorel, maintenance_work_mem);
+
 	for (i = 0; i < total_segfiles; i++)
 	{
 		segno = segfile_array[i]->segno;
@@ -731,11 +789,15 @@ AppendOnlyCompact(Relation aorel,
 		{
 			AppendOnlySegmentFileFullCompaction(aorel,
 												insertDesc,
+												sort,
 												fsinfo);
 		}
 		pfree(fsinfo);
 	}
 
+	if (sort)
+		AppendOnlyCompaction_WriteSorted(aorel, sort, insertDesc, NULL);
+
 	appendonly_insert_finish(insertDesc);
 
 	if (segfile_array)
@@ -0,0 +1,293 @@
+/*------------------------------------------------------------------------------
+ *
+ * Code dealing with append-only tables that have a sort key.
+ *
+ * An append-only table created WITH (sortkey='a, b') keeps its rows roughly
+ * clustered on those columns. Each INSERT or COPY statement sorts the rows
+ * it loads into a segment file before they are written, so every load
+ * appends one sorted run, and the compaction done by VACUUM sorts the
+ * visible rows of the segment files it rewrites, which merges the runs of
+ * earlier loads.
+ *
+ * The sort is an ordinary tuplesort bounded by the given work memory, which
+ * spills to disk for large loads.
+ *
+ * Copyright (c) 2013-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/access/appendonly/appendonly_sortkey.c
+ *
+ *------------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/appendonly_sortkey.h"
+#include "lib/stringinfo.h"
+#include "nodes/pg_list.h"
+#include "parser/parse_oper.h"
+#include "utils/builtins.h"
+#include "utils/lsyscache.h"
+#include "utils/tuplesort.h"
+
+struct AppendOnlySort
+{
+	Tuplesortstate *tuplesortstate;
+	bool		sorted;
+};
+
+/*
+ * Split a sortkey option into the names of its columns.
+ */
+static List *
+AppendOnlySortKey_Split(const char *sortkey)
+{
+	char	   *rawstring;
+	List	   *namelist;
+
+	/* the names point into rawstring, left to the memory context */
+	rawstring = pstrdup(sortkey);
+	if (!SplitIdentifierString(rawstring, ',', &namelist) ||
+		namelist == NIL)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid parameter value for \"sortkey\": \"%s\"",
+						sortkey)));
+
+	return namelist;
+}
+
+/*
+ * Parse a sortkey option into the attribute numbers of its columns.
+ *
+ * Returns the number of columns; errors out for an unknown column, a system
+ * column, or a column without a default ordering.
+ */
+static int
+AppendOnlySortKey_Parse(const char *sortkey, TupleDesc tupdesc,
+						AttrNumber *attNums, Oid *sortOperators,
+						Oid *sortCollations)
+{
+	List	   *namelist;
+	ListCell   *lc;
+	int			nkeys = 0;
+
+	namelist = AppendOnlySortKey_Split(sortkey);
+
+	if (list_length(namelist) > tupdesc->natts)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("too many columns in \"sortkey\": \"%s\"",
+						sortkey)));
+
+	foreach(lc, namelist)
+	{
+		char	   *colname = (char *) lfirst(lc);
+		Form_pg_attribute attr = NULL;
+		Oid			ltOpr;
+		int			i;
+
+		for (i = 0; i < tupdesc->natts; i++)
+		{
+			if (!tupdesc->attrs[i]->attisdropped &&
+				strcmp(NameStr(tupdesc->attrs[i]->attname), colname) == 0)
+			{
+				attr = tupdesc->attrs[i];
+				break;
+			}
+		}
+		if (attr == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_COLUMN),
+					 errmsg("column \"%s\" named in \"sortkey\" does not exist",
+							colname)));
+
+		get_sort_group_operators(attr->atttypid,
+								 false, false, false,
+								 &ltOpr, NULL, NULL, NULL);
+		if (!OidIsValid(ltOpr))
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_FUNCTION),
+					 errmsg("could not identify an ordering operator for type %s",
+							format_type_be(attr->atttypid)),
+					 errdetail("The column \"%s\" named in \"sortkey\" must have a sortable type.",
+							   colname)));
+
+		attNums[nkeys] = attr->attnum;
+		sortOperators[nkeys] = ltOpr;
+		sortCollations[nkeys] = attr->attcollation;
+		nkeys++;
+	}
+
+	list_free(namelist);
+
+	return nkeys;
+}
+
+/*
+ * Is the column one of those of a sortkey option?
+ *
+ * The option names the columns, so ALTER TABLE must keep it in step with
+ * them: RENAME COLUMN rewrites it, and a column in it cannot be dropped or
+ * change its type.
+ */
+bool
+AppendOnlySortKey_HasColumn(const char *sortkey, const char *colname)
+{
+	List	   *namelist = AppendOnlySortKey_Split(sortkey);
+	ListCell   *lc;
+	bool		found = false;
+
+	foreach(lc, namelist)
+	{
+		if (strcmp((char *) lfirst(lc), colname) == 0)
+		{
+			found = true;
+			break;
+		}
+	}
+
+	list_free(namelist);
+
+	return found;
+}
+
+/*
+ * Return a sortkey option naming a renamed column by its new name, or NULL
+ * if the column is not in the option.
+ */
+char *
+AppendOnlySortKey_RenameColumn(const char *sortkey, const char *oldname,
+							   const char *newname)
+{
+	List	   *namelist;
+	ListCell   *lc;
+	StringInfoData buf;
+
+	if (!AppendOnlySortKey_HasColumn(sortkey, oldname))
+		return NULL;
+
+	namelist = AppendOnlySortKey_Split(sortkey);
+
+	initStringInfo(&buf);
+	foreach(lc, namelist)
+	{
+		const char *colname = (const char *) lfirst(lc);
+
+		if (strcmp(colname, oldname) == 0)
+			colname = newname;
+
+		if (buf.len > 0)
+			appendStringInfoString(&buf, ", ");
+		appendStringInfoString(&buf, quote_identifier(colname));
+	}
+
+	list_free(namelist);
+
+	return buf.data;
+}
+
+/*
+ * Check the sortkey option of a new relation against its columns.
+ */
+void
+AppendOnlySortKey_Validate(const char *sortkey, TupleDesc tupdesc)
+{
+	AttrNumber *attNums = palloc(tupdesc->natts * sizeof(AttrNumber));
+	Oid		   *sortOperators = palloc(tupdesc->natts * sizeof(Oid));
+	Oid		   *sortCollations = palloc(tupdesc->natts * sizeof(Oid));
+
+	AppendOnlySortKey_Parse(sortkey, tupdesc, attNums, sortOperators,
+							sortCollations);
+
+	pfree(attNums);
+	pfree(sortOperators);
+	pfree(sortCollations);
+}
+
+/*
+ * Start sorting rows for an append-only relation, in the current memory
+ * context.
+ *
+ * Returns NULL if the relation has no sort key, or if its rows cannot be
+ * sorted before they are written. Rows with OIDs are one such case: the OID
+ * is assigned when the row is inserted, after the sort.
+ */
+AppendOnlySort *
+AppendOnlySort_Begin(Relation rel, int workMem)
+{
+	AppendOnlySort *sort;
+	TupleDesc	tupdesc = RelationGetDescr(rel);
+	char	   *sortkey;
+	AttrNumber *attNums;
+	Oid		   *sortOperators;
+	Oid		   *sortCollations;
+	bool	   *nullsFirstFlags;
+	int			nkeys;
+
+	Assert(RelationIsAppendOptimized(rel));
+
+	sortkey = RelationGetAppendOnlySortKey(rel);
+	if (sortkey == NULL || rel->rd_rel->relhasoids)
+		return NULL;
+
+	attNums = palloc(tupdesc->natts * sizeof(AttrNumber));
+	sortOperators = palloc(tupdesc->natts * sizeof(Oid));
+	sortCollations = palloc(tupdesc->natts * sizeof(Oid));
+	nullsFirstFlags = palloc0(tupdesc->natts * sizeof(bool));
+
+	nkeys = AppendOnlySortKey_Parse(sortkey, tupdesc, attNums,
+									sortOperators, sortCollations);
+
+	sort = palloc(sizeof(AppendOnlySort));
+	sort->tuplesortstate = tuplesort_begin_heap(NULL, tupdesc, nkeys,
+												attNums, sortOperators,
+												sortCollations,
+												nullsFirstFlags,
+												workMem, false);
+	sort->sorted = false;
+
+	pfree(attNums);
+	pfree(sortOperators);
+	pfree(sortCollations);
+	pfree(nullsFirstFlags);
+
+	return sort;
+}
+
+/*
+ * Add the row in the slot to the sort. The row is copied.
+ */
+void
+AppendOnlySort_Put(AppendOnlySort *sort, TupleTableSlot *slot)
+{
+	Assert(!sort->sorted);
+
+	tuplesort_puttupleslot(sort->tuplesortstate, slot);
+}
+
+/*
+ * Fetch the next row in sort key order into the slot. The first call sorts
+ * the rows put so far; no more rows can be put after that.
+ *
+ * Returns false, and clears the slot, when all rows have been returned.
+ */
+bool
+AppendOnlySort_Next(AppendOnlySort *sort, TupleTableSlot *slot)
+{
+	if (!sort->sorted)
+	{
+		tuplesort_performsort(sort->tuplesortstate);
+		sort->sorted = true;
+	}
+
+	return tuplesort_gettupleslot(sort->tuplesortstate, true, slot);
+}
+
+void
+AppendOnlySort_End(AppendOnlySort *sort)
+{
+	tuplesort_end(sort->tuplesortstate);
+	pfree(sort);
+}
@@ -18,8 +18,11 @@
 #include "access/appendonly_visimap_store.h"
 #include "access/appendonlytid.h"
 #include "access/hash.h"
+#include "catalog/aovisimap.h"
 #include "cdb/cdbappendonlyblockdirectory.h"
+#include "miscadmin.h"
 #include "storage/fd.h"
+#include "utils/fmgroids.h"
 #include "utils/guc.h"
 #include "utils/memutils.h"
 
@@ -139,9 +142,211 @@ AppendOnlyVisimap_Init(
 								appendOnlyMetaDataSnapshot,
 								visiMap->memoryContext);
 
+	visiMap->segmentCache.segmentFileNum = -1;
+	visiMap->segmentCache.memoryContext = NULL;
+
 	MemoryContextSwitchTo(oldContext);
 }
 
+/*
+ * Loads the visibility information of a whole segment file into the
+ * segment file cache, replacing what it held before. Visibility checks for
+ * rows of that segment file are then answered from the cache.
+ *
+ * Fully hidden ranges of rows are always cached. The bitmaps of the other
+ * ranges are cached as long as they fit in work_mem; ranges whose bitmap is
+ * left out are looked up the usual way.
+ *
+ * Meant for read-only scans; the current visibility map entry must not
+ * have unsaved changes.
+ */
+void
+AppendOnlyVisimap_LoadSegmentFile(
+								  AppendOnlyVisimap *visiMap,
+								  int segno)
+{
+	AppendOnlyVisimapSegmentCache *cache = &visiMap->segmentCache;
+	AppendOnlyVisimapEntry *visiMapEntry = &visiMap->visimapEntry;
+	ScanKeyData scanKey;
+	IndexScanDesc indexScan;
+	MemoryContext oldContext;
+	int			maxRanges = 0;
+	Size		budget = (Size) work_mem * 1024L;
+	Size		used = 0;
+
+	Assert(visiMap);
+	Assert(!AppendOnlyVisimapEntry_HasChanged(visiMapEntry));
+
+	elogif(Debug_appendonly_print_visimap, LOG,
+		   "Append-only visi map: Load segment file %d", segno);
+
+	if (cache->memoryContext == NULL)
+		cache->memoryContext = AllocSetContextCreate(visiMap->memoryContext,
+													 "VisiMapSegmentCacheContext",
+													 ALLOCSET_DEFAULT_MINSIZE,
+													 ALLOCSET_DEFAULT_INITSIZE,
+													 ALLOCSET_DEFAULT_MAXSIZE);
+	else
+		MemoryContextReset(cache->memoryContext);
+
+	cache->segmentFileNum = -1;
+	cache->ranges = NULL;
+	cache->numRanges = 0;
+	cache->currentRange = 0;
+	cache->hasHiddenRanges = false;
+
+	ScanKeyInit(&scanKey,
+				Anum_pg_aovisimap_segno,	/* segno */
+				BTEqualStrategyNumber,
+				F_INT4EQ,
+				Int32GetDatum(segno));
+
+	indexScan = AppendOnlyVisimapStore_BeginScan(&visiMap->visimapStore,
+												 1,
+												 &scanKey);
+
+	/* The index returns the entries in firstRowNum order */
+	while (AppendOnlyVisimapStore_GetNext(&visiMap->visimapStore,
+										  indexScan,
+										  ForwardScanDirection,
+										  visiMapEntry,
+										  NULL))
+	{
+		AppendOnlyVisimapCacheRange *range;
+		int			hiddenCount;
+
+		hiddenCount = AppendOnlyVisimapEntry_GetHiddenTupleCount(visiMapEntry);
+		if (hiddenCount == 0)
+			continue;
+
+		oldContext = MemoryContextSwitchTo(cache->memoryContext);
+
+		if (cache->numRanges == maxRanges)
+		{
+			maxRanges = (maxRanges == 0) ? 16 : maxRanges * 2;
+			if (cache->ranges == NULL)
+				cache->ranges = palloc(sizeof(AppendOnlyVisimapCacheRange) * maxRanges);
+			else
+				cache->ranges = repalloc(cache->ranges,
+										 sizeof(AppendOnlyVisimapCacheRange) * maxRanges);
+		}
+
+		range = &cache->ranges[cache->numRanges++];
+		range->firstRowNum = visiMapEntry->firstRowNum;
+		range->bitmap = NULL;
+		range->allHidden = (hiddenCount == APPENDONLY_VISIMAP_MAX_RANGE);
+		range->cached = true;
+
+		if (range->allHidden)
+			cache->hasHiddenRanges = true;
+		else
+		{
+			Size		size = offsetof(Bitmapset, words) +
+				visiMapEntry->bitmap->nwords * sizeof(bitmapword);
+
+			if (used + size <= budget)
+			{
+				range->bitmap = bms_copy(visiMapEntry->bitmap);
+				used += size;
+			}
+			else
+				range->cached = false;
+		}
+
+		MemoryContextSwitchTo(oldContext);
+	}
+
+	AppendOnlyVisimapStore_EndScan(&visiMap->visimapStore, indexScan);
+	AppendOnlyVisimapEntry_Reset(visiMapEntry);
+
+	cache->segmentFileNum = segno;
+}
+
+/*
+ * Returns the cached range of rows that covers the given row number, or NULL
+ * if no row of that range is hidden.
+ *
+ * Scans look up increasing row numbers, so the range of the last lookup and
+ * the one after it are tried before searching the whole array.
+ */
+static AppendOnlyVisimapCacheRange *
+AppendOnlyVisimap_FindCacheRange(
+								 AppendOnlyVisimapSegmentCache *cache,
+								 int64 rowNum)
+{
+	AppendOnlyVisimapCacheRange *ranges = cache->ranges;
+	int64		firstRowNum;
+	int			current = cache->currentRange;
+	int			low;
+	int			high;
+
+	if (cache->numRanges == 0)
+		return NULL;
+
+	firstRowNum = (rowNum / APPENDONLY_VISIMAP_MAX_RANGE) * APPENDONLY_VISIMAP_MAX_RANGE;
+
+	if (ranges[current].firstRowNum == firstRowNum)
+		return &ranges[current];
+	if (ranges[current].firstRowNum < firstRowNum)
+	{
+		if (current + 1 == cache->numRanges ||
+			ranges[current + 1].firstRowNum > firstRowNum)
+			return NULL;
+		if (ranges[current + 1].firstRowNum == firstRowNum)
+		{
+			cache->currentRange = current + 1;
+			return &ranges[current + 1];
+		}
+	}
+
+	low = 0;
+	high = cache->numRanges - 1;
+	while (low <= high)
+	{
+		int			mid = low + (high - low) / 2;
+
+		if (ranges[mid].firstRowNum == firstRowNum)
+		{
+			cache->currentRange = mid;
+			return &ranges[mid];
+		}
+		if (ranges[mid].firstRowNum < firstRowNum)
+			low = mid + 1;
+		else
+			high = mid - 1;
+	}
+	return NULL;
+}
+
+/*
+ * Returns the first row number, not below rowNum, that is not part of a
+ * fully hidden range of rows of the given segment file. Scans can skip the
+ * rows in between without looking at them.
+ *
+ * Only the segment file cache is consulted: unless the segment file has
+ * been loaded with AppendOnlyVisimap_LoadSegmentFile, rowNum is returned.
+ */
+int64
+AppendOnlyVisimap_GetNextVisibleRowNum(
+									   AppendOnlyVisimap *visiMap,
+									   int segno,
+									   int64 rowNum)
+{
+	AppendOnlyVisimapSegmentCache *cache = &visiMap->segmentCache;
+	AppendOnlyVisimapCacheRange *range;
+
+	Assert(visiMap);
+
+	if (cache->segmentFileNum != segno || !cache->hasHiddenRanges)
+		return rowNum;
+
+	while ((range = AppendOnlyVisimap_FindCacheRange(cache, rowNum)) != NULL &&
+		   range->allHidden)
+		rowNum = range->firstRowNum + APPENDONLY_VISIMAP_MAX_RANGE;
+
+	return rowNum;
+}
+
 /*
  * Moves the visibility map entry so that the given
  * AO tuple id is covered by it.
@@ -197,6 +402,22 @@ AppendOnlyVisimap_IsVisible(
 		   "(tupleId) = %s",
 		   AOTupleIdToString(aoTupleId));
 
+	if (visiMap->segmentCache.segmentFileNum ==
+		AOTupleIdGet_segmentFileNum(aoTupleId))
+	{
+		AppendOnlyVisimapCacheRange *range;
+		int64		rowNum = AOTupleIdGet_rowNum(aoTupleId);
+
+		range = AppendOnlyVisimap_FindCacheRange(&visiMap->segmentCache,
+												 rowNum);
+		if (range == NULL)
+			return true;
+		if (range->allHidden)
+			return false;
+		if (range->cached)
+			return !bms_is_member(rowNum - range->firstRowNum, range->bitmap);
+	}
+
 	if (!AppendOnlyVisimapEntry_CoversTuple(&visiMap->visimapEntry,
 											aoTupleId))
 	{
@@ -57,6 +57,7 @@
 #include "utils/faultinjector.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/spccache.h"
 
 #define SCANNED_SEGNO  \
 	(&scan->aos_segfile_arr[ \
@@ -197,6 +198,9 @@ SetNextFileSegForRead(AppendOnlyScanDesc scan)
 								   NameStr(scan->aos_rd->rd_rel->relname),
 								   scan->title,
 								   &scan->storageAttributes);
+		AppendOnlyStorageRead_SetPrefetchDepth(
+								   &scan->storageRead,
+								   get_tablespace_io_concurrency(scan->aos_rd->rd_rel->reltablespace));
 
 		/*
 		 * There is no guarantee that the current memory context will be
@@ -336,6 +340,10 @@ SetNextFileSegForRead(AppendOnlyScanDesc scan)
 												 &scan->executorReadBlock,
 												  /* blockFirstRowNum */ 1);
 
+	/* Preload the visibility information of the whole segment file */
+	if (scan->snapshot != SnapshotAny)
+		AppendOnlyVisimap_LoadSegmentFile(&scan->visibilityMap, segno);
+
 	/* ready to go! */
 	scan->aos_need_new_segfile = false;
 
@@ -1258,19 +1266,44 @@ getNextBlock(AppendOnlyScanDesc scan)
 			return false;
 	}
 
-	if (!AppendOnlyExecutorReadBlock_GetBlockInfo(
-												  &scan->storageRead,
-												  &scan->executorReadBlock))
+	while (1)
 	{
-		if (scan->blockDirectory)
+		AppendOnlyExecutorReadBlock *executorReadBlock = &scan->executorReadBlock;
+		int64		nextVisibleRowNum;
+
+		if (!AppendOnlyExecutorReadBlock_GetBlockInfo(
+													  &scan->storageRead,
+													  executorReadBlock))
 		{
-			AppendOnlyBlockDirectory_End_forInsert(scan->blockDirectory);
+			if (scan->blockDirectory)
+			{
+				AppendOnlyBlockDirectory_End_forInsert(scan->blockDirectory);
+			}
+
+			/* done reading the file */
+			CloseScannedFileSeg(scan);
+
+			return false;
 		}
 
-		/* done reading the file */
-		CloseScannedFileSeg(scan);
+		/*
+		 * The scan building the block directory must see every block.
+		 * Otherwise skip the blocks whose rows the visimap all hides,
+		 * without reading their content.
+		 */
+		if (scan->blockDirectory)
+			break;
 
-		return false;
+		nextVisibleRowNum =
+			AppendOnlyVisimap_GetNextVisibleRowNum(&scan->visibilityMap,
+												   executorReadBlock->segmentFileNum,
+												   executorReadBlock->blockFirstRowNum);
+		if (nextVisibleRowNum <
+			executorReadBlock->blockFirstRowNum + executorReadBlock->rowCount)
+			break;
+
+		AppendOnlyExecutionReadBlock_FinishedScanBlock(executorReadBlock);
+		AppendOnlyStorageRead_SkipCurrentBlock(&scan->storageRead);
 	}
 
 	if (scan->blockDirectory)
@@ -1939,6 +1972,14 @@ fetchFromCurrentBlock(AppendOnlyFetchDesc aoFetchDesc,
 	Assert(rowNum >= aoFetchDesc->currentBlock.firstRowNum);
 	Assert(rowNum <= aoFetchDesc->currentBlock.lastRowNum);
 
+	/*
+	 * Every row number in the block header's range has a tuple in the block,
+	 * so a caller that only asks whether the row exists does not need the
+	 * contents. Skip reading and decompressing them.
+	 */
+	if (slot == NULL)
+		return true;
+
 	if (!aoFetchDesc->currentBlock.gotContents)
 	{
 		/*
@@ -22,6 +22,7 @@
 #include "parser/parse_oper.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/typcache.h"
 #include "utils/guc.h"
 #include "utils/fmgroids.h"
 #include "cdb/cdbappendonlyam.h"
@@ -36,6 +37,16 @@ minipage_size(uint32 nEntry)
 		sizeof(MinipageEntry) * nEntry;
 }
 
+/*
+ * Size of a minipage that also carries the zone maps of its entries.
+ */
+static inline uint32
+minipage_stats_size(uint32 nEntry)
+{
+	return minipage_size(nEntry) +
+		sizeof(MinipageEntryStats) * nEntry;
+}
+
 static void load_last_minipage(
 				   AppendOnlyBlockDirectory *blockDirectory,
 				   int64 lastSequence,
@@ -61,7 +72,8 @@ static bool insert_new_entry(AppendOnlyBlockDirectory *blockDirectory,
 				 int64 firstRowNum,
 				 int64 fileOffset,
 				 int64 rowCount,
-				 bool addColAction);
+				 bool addColAction,
+				 MinipageEntryStats *stats);
 
 void
 AppendOnlyBlockDirectoryEntry_GetBeginRange(
@@ -150,7 +162,9 @@ init_internal(AppendOnlyBlockDirectory *blockDirectory)
 		&blockDirectory->minipages[groupNo];
 
 		minipageInfo->minipage =
-			palloc0(minipage_size(NUM_MINIPAGE_ENTRIES));
+			palloc0(minipage_stats_size(NUM_MINIPAGE_ENTRIES));
+		minipageInfo->stats =
+			palloc0(sizeof(MinipageEntryStats) * NUM_MINIPAGE_ENTRIES);
 		minipageInfo->numMinipageEntries = 0;
 	}
 
@@ -392,6 +406,7 @@ set_directoryentry_range(
 	}
 
 	directoryEntry->range.lastRowNum = entry->firstRowNum + entry->rowCount - 1;
+	directoryEntry->stats = minipageInfo->stats[entry_no];
 	if (next_entry == NULL && gp_blockdirectory_entry_min_range != 0)
 	{
 		directoryEntry->range.lastRowNum = (~(((int64) 1) << 63));	/* set to the maximal
@@ -673,7 +688,75 @@ AppendOnlyBlockDirectory_InsertEntry(
 									 bool addColAction)
 {
 	return insert_new_entry(blockDirectory, columnGroupNo, firstRowNum,
-							fileOffset, rowCount, addColAction);
+							fileOffset, rowCount, addColAction, NULL);
+}
+
+/*
+ * AppendOnlyBlockDirectory_InsertEntryWithStats
+ *
+ * Same as AppendOnlyBlockDirectory_InsertEntry, but also records the zone
+ * map of the new block. 'stats' may be NULL if there is none.
+ */
+bool
+AppendOnlyBlockDirectory_InsertEntryWithStats(
+											  AppendOnlyBlockDirectory *blockDirectory,
+											  int columnGroupNo,
+											  int64 firstRowNum,
+											  int64 fileOffset,
+											  int64 rowCount,
+											  bool addColAction,
+											  MinipageEntryStats *stats)
+{
+	return insert_new_entry(blockDirectory, columnGroupNo, firstRowNum,
+							fileOffset, rowCount, addColAction, stats);
+}
+
+/*
+ * Fold the zone map of a block into the zone map of the entry that covers
+ * it. The result is only valid if both are.
+ */
+static void
+merge_entry_stats(AppendOnlyBlockDirectory *blockDirectory,
+				  int columnGroupNo,
+				  MinipageEntryStats *entryStats,
+				  MinipageEntryStats *stats)
+{
+	TypeCacheEntry *typentry;
+	FmgrInfo   *cmpProc;
+
+	if (stats == NULL ||
+		!(entryStats->flags & MINIPAGE_STATS_VALID) ||
+		!(stats->flags & MINIPAGE_STATS_VALID))
+	{
+		entryStats->flags = 0;
+		return;
+	}
+
+	entryStats->nullCount += stats->nullCount;
+
+	if (!(stats->flags & MINIPAGE_STATS_HAS_MINMAX))
+		return;
+
+	if (!(entryStats->flags & MINIPAGE_STATS_HAS_MINMAX))
+	{
+		entryStats->minValue = stats->minValue;
+		entryStats->maxValue = stats->maxValue;
+		entryStats->flags |= MINIPAGE_STATS_HAS_MINMAX;
+		return;
+	}
+
+	Assert(blockDirectory->isAOCol);
+	typentry = lookup_type_cache(blockDirectory->aoRel->rd_att->attrs[columnGroupNo]->atttypid,
+								 TYPECACHE_CMP_PROC_FINFO);
+	cmpProc = &typentry->cmp_proc_finfo;
+	Assert(OidIsValid(cmpProc->fn_oid));
+
+	if (DatumGetInt32(FunctionCall2(cmpProc, stats->minValue,
+									entryStats->minValue)) < 0)
+		entryStats->minValue = stats->minValue;
+	if (DatumGetInt32(FunctionCall2(cmpProc, stats->maxValue,
+									entryStats->maxValue)) > 0)
+		entryStats->maxValue = stats->maxValue;
 }
 
 /*
@@ -688,7 +771,8 @@ insert_new_entry(
 				 int64 firstRowNum,
 				 int64 fileOffset,
 				 int64 rowCount,
-				 bool addColAction)
+				 bool addColAction,
+				 MinipageEntryStats *stats)
 {
 	MinipageEntry *entry = NULL;
 	MinipagePerColumnGroup *minipageInfo;
@@ -733,7 +817,12 @@ insert_new_entry(
 
 		if (gp_blockdirectory_entry_min_range > 0 &&
 			fileOffset - entry->fileOffset < gp_blockdirectory_entry_min_range)
+		{
+			/* The last entry now covers this block too */
+			merge_entry_stats(blockDirectory, columnGroupNo,
+							  &minipageInfo->stats[lastEntryNo], stats);
 			return true;
+		}
 
 		/* Update the rowCount in the latest entry */
 		Assert(entry->rowCount <= firstRowNum - entry->firstRowNum);
@@ -764,6 +853,8 @@ insert_new_entry(
 		 */
 		MemSet(minipageInfo->minipage->entry, 0,
 			   minipageInfo->numMinipageEntries * sizeof(MinipageEntry));
+		MemSet(minipageInfo->stats, 0,
+			   minipageInfo->numMinipageEntries * sizeof(MinipageEntryStats));
 		minipageInfo->numMinipageEntries = 0;
 	}
 
@@ -774,6 +865,12 @@ insert_new_entry(
 	entry->fileOffset = fileOffset;
 	entry->rowCount = rowCount;
 
+	if (stats != NULL)
+		minipageInfo->stats[minipageInfo->numMinipageEntries] = *stats;
+	else
+		MemSet(&minipageInfo->stats[minipageInfo->numMinipageEntries], 0,
+			   sizeof(MinipageEntryStats));
+
 	minipageInfo->numMinipageEntries++;
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
@@ -916,7 +1013,7 @@ copy_out_minipage(MinipagePerColumnGroup *minipageInfo,
 	value = (struct varlena *)
 		DatumGetPointer(minipage_value);
 	detoast_value = pg_detoast_datum(value);
-	Assert(VARSIZE(detoast_value) <= minipage_size(NUM_MINIPAGE_ENTRIES));
+	Assert(VARSIZE(detoast_value) <= minipage_stats_size(NUM_MINIPAGE_ENTRIES));
 
 	memcpy(minipageInfo->minipage, detoast_value, VARSIZE(detoast_value));
 	if (detoast_value != value)
@@ -925,6 +1022,15 @@ copy_out_minipage(MinipagePerColumnGroup *minipageInfo,
 	Assert(minipageInfo->minipage->nEntry <= NUM_MINIPAGE_ENTRIES);
 
 	minipageInfo->numMinipageEntries = minipageInfo->minipage->nEntry;
+
+	/* The zone maps, if any, follow the entries */
+	if (minipageInfo->minipage->version == MINIPAGE_VERSION_STATS)
+		memcpy(minipageInfo->stats,
+			   &minipageInfo->minipage->entry[minipageInfo->numMinipageEntries],
+			   sizeof(MinipageEntryStats) * minipageInfo->numMinipageEntries);
+	else
+		MemSet(minipageInfo->stats, 0,
+			   sizeof(MinipageEntryStats) * minipageInfo->numMinipageEntries);
 }
 
 
@@ -1126,6 +1232,24 @@ find_minipage_entry(Minipage *minipage,
 		return -1;
 }
 
+/*
+ * minipage_has_stats
+ *
+ * Does any entry of the in-memory minipage have a zone map?
+ */
+static bool
+minipage_has_stats(MinipagePerColumnGroup *minipageInfo)
+{
+	uint32		i;
+
+	for (i = 0; i < minipageInfo->numMinipageEntries; i++)
+	{
+		if (minipageInfo->stats[i].flags != 0)
+			return true;
+	}
+	return false;
+}
+
 /*
  * write_minipage
  *
@@ -1160,9 +1284,27 @@ write_minipage(AppendOnlyBlockDirectory *blockDirectory,
 		Int64GetDatum(minipageInfo->minipage->entry[0].firstRowNum);
 	nulls[Anum_pg_aoblkdir_firstrownum - 1] = false;
 
-	SET_VARSIZE(minipageInfo->minipage,
-				minipage_size(minipageInfo->numMinipageEntries));
 	minipageInfo->minipage->nEntry = minipageInfo->numMinipageEntries;
+	if (minipage_has_stats(minipageInfo))
+	{
+		/*
+		 * Store the zone maps right after the entries. The in-memory
+		 * minipage has room for them, and the entries past nEntry are not
+		 * in use.
+		 */
+		memcpy(&minipageInfo->minipage->entry[minipageInfo->numMinipageEntries],
+			   minipageInfo->stats,
+			   sizeof(MinipageEntryStats) * minipageInfo->numMinipageEntries);
+		minipageInfo->minipage->version = MINIPAGE_VERSION_STATS;
+		SET_VARSIZE(minipageInfo->minipage,
+					minipage_stats_size(minipageInfo->numMinipageEntries));
+	}
+	else
+	{
+		minipageInfo->minipage->version = 0;
+		SET_VARSIZE(minipageInfo->minipage,
+					minipage_size(minipageInfo->numMinipageEntries));
+	}
 	values[Anum_pg_aoblkdir_minipage - 1] =
 		PointerGetDatum(minipageInfo->minipage);
 	nulls[Anum_pg_aoblkdir_minipage - 1] = false;
@@ -1236,6 +1378,7 @@ AppendOnlyBlockDirectory_End_forInsert(
 		}
 
 		pfree(minipageInfo->minipage);
+		pfree(minipageInfo->stats);
 	}
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
@@ -1272,6 +1415,8 @@ AppendOnlyBlockDirectory_End_forSearch(
 	{
 		if (blockDirectory->minipages[groupNo].minipage != NULL)
 			pfree(blockDirectory->minipages[groupNo].minipage);
+		if (blockDirectory->minipages[groupNo].stats != NULL)
+			pfree(blockDirectory->minipages[groupNo].stats);
 	}
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
@@ -1321,6 +1466,7 @@ AppendOnlyBlockDirectory_End_addCol(
 							  groupNo, minipageInfo->numMinipageEntries)));
 		}
 		pfree(minipageInfo->minipage);
+		pfree(minipageInfo->stats);
 	}
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
@@ -982,6 +982,49 @@ restart:
 	{
 		BM_HRL_WORD word = words->cwords[result->lastScanWordNo];
 
+		/*
+		 * A fill word that starts on a tidbitmap word boundary covers whole
+		 * tidbitmap words: set them all at once, or skip them for a fill of
+		 * zeros, rather than expanding the fill one HRL word at a time.
+		 */
+		if (IS_FILL_WORD(words->hwords, result->lastScanWordNo) &&
+			hrlwordno == 0 && FILL_LENGTH(word) >= nhrlwords)
+		{
+			uint64		nleft;
+			uint64		nfill;
+			int			ntbmwords;
+
+			nleft = (end - result->nextTid + BM_HRL_WORD_SIZE - 1) /
+				BM_HRL_WORD_SIZE;
+			nfill = Min(FILL_LENGTH(word), nleft);
+			ntbmwords = nfill / nhrlwords;
+			nfill = ntbmwords * nhrlwords;
+
+			if (ntbmwords > 0)
+			{
+				Assert(newwordno + ntbmwords <= WORDS_PER_PAGE);
+
+				if (GET_FILL_BIT(word) == 1)
+				{
+					int			i;
+
+					for (i = 0; i < ntbmwords; i++)
+						entry->words[newwordno + i] = ~((tbm_bitmapword) 0);
+				}
+
+				words->cwords[result->lastScanWordNo] -= nfill;
+				if (FILL_LENGTH(words->cwords[result->lastScanWordNo]) == 0)
+				{
+					result->lastScanWordNo++;
+					words->nwords--;
+				}
+
+				result->nextTid += nfill * BM_HRL_WORD_SIZE;
+				newwordno += ntbmwords;
+				continue;
+			}
+		}
+
 		if (IS_FILL_WORD(words->hwords, result->lastScanWordNo))
 		{
 			if (GET_FILL_BIT(word) == 1)
@@ -126,6 +126,14 @@ static relopt_string stringRelOpts_gp[] =
 		},
 		0, false, NULL, ""
 	},
+	{
+		{
+			SOPT_SORTKEY,
+			"AO tables sort key columns",
+			RELOPT_KIND_HEAP
+		},
+		0, true, NULL, NULL
+	},
 	/* list terminator */
 	{{NULL}}
 };
@@ -318,6 +326,7 @@ resetAOStorageOpts(StdRdOptions *ao_opts)
 	ao_opts->compresslevel = AO_DEFAULT_COMPRESSLEVEL;
 	ao_opts->compresstype[0] = '\0';
 	ao_opts->orientation[0] = '\0';
+	ao_opts->sortkey = 0;
 }
 
 /*
@@ -721,6 +730,20 @@ transformAOStdRdOptions(StdRdOptions *opts, Datum withOpts)
 				astate = accumArrayResult(astate, PointerGetDatum(t), false,
 										  TEXTOID, CurrentMemoryContext);
 			}
+			soptLen = strlen(SOPT_SORTKEY);
+			if (withLen > soptLen &&
+				pg_strncasecmp(strval, SOPT_SORTKEY, soptLen) == 0 &&
+				opts->sortkey != 0)
+			{
+				strval = (char *) opts + opts->sortkey;
+				len = VARHDRSZ + strlen(SOPT_SORTKEY) + 1 + strlen(strval);
+				/* +1 leaves room for sprintf's trailing null */
+				t = (text *) palloc(len + 1);
+				SET_VARSIZE(t, len);
+				sprintf(VARDATA(t), "%s=%s", SOPT_SORTKEY, strval);
+				astate = accumArrayResult(astate, PointerGetDatum(t), false,
+										  TEXTOID, CurrentMemoryContext);
+			}
 
 			/*
 			 * Record fillfactor only if it's specified in WITH clause.
@@ -854,6 +877,7 @@ validate_and_adjust_options(StdRdOptions *result,
 	relopt_value *complevel_opt;
 	relopt_value *checksum_opt;
 	relopt_value *orientation_opt;
+	relopt_value *sortkey_opt;
 
 	/* fillfactor */
 	fillfactor_opt = get_option_set(options, num_options, SOPT_FILLFACTOR);
@@ -1100,6 +1124,23 @@ validate_and_adjust_options(StdRdOptions *result,
 		}
 	}
 
+	/* sort key */
+	sortkey_opt = get_option_set(options, num_options, SOPT_SORTKEY);
+	if (sortkey_opt != NULL)
+	{
+		if (!KIND_IS_RELATION(kind) && validate)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("usage of parameter \"sortkey\" in a non "
+							"relation object is not supported")));
+
+		if (!result->appendonly && validate)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("invalid option \"sortkey\" for base relation. "
+							"Only valid for Append Only relations")));
+	}
+
 	if (result->appendonly && result->compresstype[0])
 		if (result->compresslevel == AO_DEFAULT_COMPRESSLEVEL)
 			result->compresslevel = setDefaultCompressionLevel(result->compresstype);
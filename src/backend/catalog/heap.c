@@ -31,6 +31,7 @@
  */
 #include "postgres.h"
 
+#include "access/appendonly_sortkey.h"
 #include "access/sysattr.h"
 #include "access/transam.h"
 #include "access/reloptions.h"
@@ -1394,6 +1395,9 @@ heap_create_with_catalog(const char *relname,
 				relstorage = RELSTORAGE_AOCOLS;
 			else
 				relstorage = RELSTORAGE_AOROWS;
+			if (StdRdOptionsGetSortKey(stdRdOptions) != NULL)
+				AppendOnlySortKey_Validate(StdRdOptionsGetSortKey(stdRdOptions),
+										   tupdesc);
 			reloptions = transformAOStdRdOptions(stdRdOptions, reloptions);
 		}
 	}
@@ -210,6 +210,16 @@ CREATE VIEW pg_prepared_xacts AS
 CREATE VIEW pg_prepared_statements AS
     SELECT * FROM pg_prepared_statement() AS P;
 
+CREATE VIEW gp_prepared_statement_plan_cache AS
+    SELECT P.name, P.statement, P.cached_plans, P.hits, P.misses,
+           CASE WHEN P.hits + P.misses > 0
+                THEN P.hits::float8 / (P.hits + P.misses)
+           END AS hit_rate
+    FROM gp_prepared_statement_plan_cache() AS P;
+
+CREATE VIEW gp_optimizer_profile AS
+    SELECT * FROM gp_optimizer_profile() AS P;
+
 CREATE VIEW pg_seclabels AS
 SELECT
 	l.objoid, l.classoid, l.objsubid,
@@ -0,0 +1,468 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbappendonlydecompress.c
+ *	  Decompress Append-Only Storage blocks in worker threads.
+ *
+ * A scan of a compressed append-only columnar table spends most of its time
+ * decompressing the blocks of its columns one after another.  This module
+ * keeps a small pool of threads per backend that decompress blocks handed to
+ * them, so that the next block of every column can be decompressed while
+ * the scan is still busy with the current ones.
+ *
+ * The backend is not thread safe, so the worker threads do nothing but call
+ * the zlib or zstd library on memory the backend gave them: no palloc, no
+ * elog, no catalog access.  All memory is allocated and freed by the backend
+ * thread, in a memory context of its own.  That context hangs off
+ * TopMemoryContext rather than the query's, as the pool outlives queries;
+ * it is therefore not charged to the query.  The buffers of a job are not
+ * freed while a worker may still be using them; jobs left over by an
+ * aborted query are waited for and released through a resource owner
+ * callback.
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/cdb/cdbappendonlydecompress.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <pthread.h>
+#include <zlib.h>
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#endif
+
+#include "cdb/cdbappendonlydecompress.h"
+#include "cdb/cdbgang.h"
+#include "miscadmin.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+#include "utils/resowner.h"
+
+typedef enum AppendOnlyDecompressKind
+{
+	AppendOnlyDecompressKind_Zlib,
+	AppendOnlyDecompressKind_Zstd
+} AppendOnlyDecompressKind;
+
+typedef enum AppendOnlyDecompressState
+{
+	AppendOnlyDecompressState_Queued,
+	AppendOnlyDecompressState_Running,
+	AppendOnlyDecompressState_Done
+} AppendOnlyDecompressState;
+
+struct AppendOnlyDecompressJob
+{
+	/*
+	 * Set up by the backend before the job is queued, read-only afterwards.
+	 */
+	AppendOnlyDecompressKind kind;
+	uint8	   *compressed;
+	int32		compressedLen;
+	uint8	   *uncompressed;
+	int32		uncompressedLen;
+
+	/*
+	 * Protected by decompressLock.  The result fields are set by whoever
+	 * runs the job before it becomes Done.
+	 */
+	AppendOnlyDecompressState state;
+	AppendOnlyDecompressJob *nextQueued;
+	int32		resultLen;
+	const char *errorStr;
+
+	/*
+	 * Only touched by the backend.
+	 */
+	ResourceOwner owner;
+	AppendOnlyDecompressJob *prev;
+	AppendOnlyDecompressJob *next;
+};
+
+/* Queue of jobs no worker has picked up yet */
+static pthread_mutex_t decompressLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t decompressQueued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t decompressDone = PTHREAD_COND_INITIALIZER;
+static AppendOnlyDecompressJob *decompressQueueHead = NULL;
+static AppendOnlyDecompressJob *decompressQueueTail = NULL;
+
+static int	decompressWorkerCount = 0;
+
+/* All jobs not released yet, for the resource owner callback */
+static AppendOnlyDecompressJob *decompressJobs = NULL;
+static MemoryContext decompressContext = NULL;
+static bool decompressCallbackRegistered = false;
+
+#ifdef HAVE_LIBZSTD
+/* For jobs the backend ends up running itself */
+static ZSTD_DCtx *backendZstdContext = NULL;
+#endif
+
+static void AppendOnlyDecompress_StartWorkers(void);
+static void *AppendOnlyDecompress_WorkerMain(void *arg);
+static void AppendOnlyDecompress_Run(AppendOnlyDecompressJob *job,
+						 void *zstdContext);
+static void AppendOnlyDecompress_Wait(AppendOnlyDecompressJob *job);
+static void AppendOnlyDecompress_AbortCallback(ResourceReleasePhase phase,
+								   bool isCommit,
+								   bool isTopLevel,
+								   void *arg);
+
+static bool
+AppendOnlyDecompress_GetKind(char *compressType,
+							 AppendOnlyDecompressKind *kind)
+{
+	if (compressType == NULL)
+		return false;
+
+	if (pg_strcasecmp(compressType, "zlib") == 0)
+	{
+		*kind = AppendOnlyDecompressKind_Zlib;
+		return true;
+	}
+#ifdef HAVE_LIBZSTD
+	if (pg_strcasecmp(compressType, "zstd") == 0)
+	{
+		*kind = AppendOnlyDecompressKind_Zstd;
+		return true;
+	}
+#endif
+
+	return false;
+}
+
+/*
+ * Can blocks compressed with compressType be decompressed by the worker
+ * threads?  False when gp_appendonly_decompress_workers is zero.
+ */
+bool
+AppendOnlyDecompress_Supported(char *compressType)
+{
+	AppendOnlyDecompressKind kind;
+
+	if (gp_appendonly_decompress_workers <= 0)
+		return false;
+
+	return AppendOnlyDecompress_GetKind(compressType, &kind);
+}
+
+/*
+ * Start worker threads until there are gp_appendonly_decompress_workers of
+ * them.  Threads are never stopped; idle ones just wait for the next job.
+ */
+static void
+AppendOnlyDecompress_StartWorkers(void)
+{
+	while (decompressWorkerCount < gp_appendonly_decompress_workers)
+	{
+		pthread_t	thread;
+		int			pthread_err;
+
+		pthread_err = gp_pthread_create(&thread,
+										AppendOnlyDecompress_WorkerMain,
+										NULL,
+										"AppendOnlyDecompress_StartWorkers");
+		if (pthread_err != 0)
+		{
+			elog(LOG, "could not create append-only decompression thread: error %d",
+				 pthread_err);
+			break;
+		}
+		pthread_detach(thread);
+
+		decompressWorkerCount++;
+	}
+}
+
+static void *
+AppendOnlyDecompress_WorkerMain(void *arg)
+{
+	void	   *zstdContext = NULL;
+
+	gp_set_thread_sigmasks();
+
+#ifdef HAVE_LIBZSTD
+	zstdContext = ZSTD_createDCtx();
+#endif
+
+	pthread_mutex_lock(&decompressLock);
+	for (;;)
+	{
+		AppendOnlyDecompressJob *job;
+
+		while (decompressQueueHead == NULL)
+			pthread_cond_wait(&decompressQueued, &decompressLock);
+
+		job = decompressQueueHead;
+		decompressQueueHead = job->nextQueued;
+		if (decompressQueueHead == NULL)
+			decompressQueueTail = NULL;
+		job->nextQueued = NULL;
+		job->state = AppendOnlyDecompressState_Running;
+		pthread_mutex_unlock(&decompressLock);
+
+		AppendOnlyDecompress_Run(job, zstdContext);
+
+		pthread_mutex_lock(&decompressLock);
+		job->state = AppendOnlyDecompressState_Done;
+		pthread_cond_broadcast(&decompressDone);
+	}
+
+	return NULL;
+}
+
+/*
+ * Decompress the job's block.  Runs in a worker thread or in the backend,
+ * and so must not use anything but the compression library.
+ */
+static void
+AppendOnlyDecompress_Run(AppendOnlyDecompressJob *job, void *zstdContext)
+{
+	switch (job->kind)
+	{
+		case AppendOnlyDecompressKind_Zlib:
+			{
+				unsigned long uncompressedLen = job->uncompressedLen;
+				int			rc;
+
+				rc = uncompress(job->uncompressed, &uncompressedLen,
+								job->compressed, job->compressedLen);
+				if (rc != Z_OK)
+					job->errorStr = zError(rc);
+				job->resultLen = (int32) uncompressedLen;
+			}
+			break;
+
+		case AppendOnlyDecompressKind_Zstd:
+#ifdef HAVE_LIBZSTD
+			{
+				size_t		uncompressedLen;
+
+				if (zstdContext == NULL)
+				{
+					job->errorStr = "could not create zstd decompression context";
+					break;
+				}
+
+				uncompressedLen = ZSTD_decompressDCtx((ZSTD_DCtx *) zstdContext,
+													  job->uncompressed,
+													  job->uncompressedLen,
+													  job->compressed,
+													  job->compressedLen);
+				if (ZSTD_isError(uncompressedLen))
+					job->errorStr = ZSTD_getErrorName(uncompressedLen);
+				else
+					job->resultLen = (int32) uncompressedLen;
+			}
+#endif
+			break;
+	}
+}
+
+/*
+ * Hand a compressed block to the worker threads.  The compressed bytes are
+ * copied, so the caller's buffer can be reused right away.
+ *
+ * Returns NULL when no worker thread could be started; the caller then
+ * decompresses the block itself.
+ */
+AppendOnlyDecompressJob *
+AppendOnlyDecompress_Start(char *compressType,
+						   uint8 *compressed,
+						   int32 compressedLen,
+						   int32 uncompressedLen)
+{
+	AppendOnlyDecompressKind kind;
+	AppendOnlyDecompressJob *job;
+	char	   *memory;
+
+	Assert(compressedLen > 0);
+	Assert(uncompressedLen > 0);
+
+	if (!AppendOnlyDecompress_GetKind(compressType, &kind))
+		return NULL;
+
+	AppendOnlyDecompress_StartWorkers();
+	if (decompressWorkerCount == 0)
+		return NULL;
+
+	if (decompressContext == NULL)
+		decompressContext = AllocSetContextCreate(TopMemoryContext,
+												  "AppendOnlyDecompressContext",
+												  ALLOCSET_DEFAULT_MINSIZE,
+												  ALLOCSET_DEFAULT_INITSIZE,
+												  ALLOCSET_DEFAULT_MAXSIZE);
+	if (!decompressCallbackRegistered)
+	{
+		RegisterResourceReleaseCallback(AppendOnlyDecompress_AbortCallback, NULL);
+		decompressCallbackRegistered = true;
+	}
+
+	/* The job, then the (aligned) uncompressed buffer, then the compressed */
+	memory = MemoryContextAlloc(decompressContext,
+								MAXALIGN(sizeof(AppendOnlyDecompressJob)) +
+								MAXALIGN(uncompressedLen) +
+								compressedLen);
+	job = (AppendOnlyDecompressJob *) memory;
+	memset(job, 0, sizeof(AppendOnlyDecompressJob));
+	job->kind = kind;
+	job->uncompressed = (uint8 *) (memory + MAXALIGN(sizeof(AppendOnlyDecompressJob)));
+	job->uncompressedLen = uncompressedLen;
+	job->compressed = job->uncompressed + MAXALIGN(uncompressedLen);
+	job->compressedLen = compressedLen;
+	memcpy(job->compressed, compressed, compressedLen);
+
+	job->owner = CurrentResourceOwner;
+	job->prev = NULL;
+	job->next = decompressJobs;
+	if (decompressJobs)
+		decompressJobs->prev = job;
+	decompressJobs = job;
+
+	pthread_mutex_lock(&decompressLock);
+	job->state = AppendOnlyDecompressState_Queued;
+	if (decompressQueueTail)
+		decompressQueueTail->nextQueued = job;
+	else
+		decompressQueueHead = job;
+	decompressQueueTail = job;
+	pthread_cond_signal(&decompressQueued);
+	pthread_mutex_unlock(&decompressLock);
+
+	return job;
+}
+
+/*
+ * Wait until the job is done.  A job no worker has picked up yet is taken
+ * off the queue and run by the backend, rather than waiting for a worker
+ * to become free.
+ */
+static void
+AppendOnlyDecompress_Wait(AppendOnlyDecompressJob *job)
+{
+	bool		runHere = false;
+
+	pthread_mutex_lock(&decompressLock);
+	if (job->state == AppendOnlyDecompressState_Queued)
+	{
+		AppendOnlyDecompressJob *prev = NULL;
+		AppendOnlyDecompressJob *queued;
+
+		for (queued = decompressQueueHead; queued != job; queued = queued->nextQueued)
+			prev = queued;
+
+		if (prev)
+			prev->nextQueued = job->nextQueued;
+		else
+			decompressQueueHead = job->nextQueued;
+		if (decompressQueueTail == job)
+			decompressQueueTail = prev;
+		job->nextQueued = NULL;
+		job->state = AppendOnlyDecompressState_Running;
+		runHere = true;
+	}
+	else
+	{
+		while (job->state != AppendOnlyDecompressState_Done)
+			pthread_cond_wait(&decompressDone, &decompressLock);
+	}
+	pthread_mutex_unlock(&decompressLock);
+
+	if (runHere)
+	{
+		void	   *zstdContext = NULL;
+
+#ifdef HAVE_LIBZSTD
+		if (job->kind == AppendOnlyDecompressKind_Zstd)
+		{
+			if (backendZstdContext == NULL)
+				backendZstdContext = ZSTD_createDCtx();
+			zstdContext = backendZstdContext;
+		}
+#endif
+		AppendOnlyDecompress_Run(job, zstdContext);
+
+		pthread_mutex_lock(&decompressLock);
+		job->state = AppendOnlyDecompressState_Done;
+		pthread_mutex_unlock(&decompressLock);
+	}
+}
+
+/*
+ * Wait for the job to finish and return the decompressed content.  The
+ * content stays valid until the job is released.
+ */
+uint8 *
+AppendOnlyDecompress_Finish(AppendOnlyDecompressJob *job)
+{
+	AppendOnlyDecompress_Wait(job);
+
+	if (job->errorStr != NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("could not decompress append-only block: %s",
+						job->errorStr)));
+
+	if (job->resultLen != job->uncompressedLen)
+		elog(ERROR,
+			 "Uncompress returned length %d which is different than the "
+			 "expected length %d",
+			 job->resultLen,
+			 job->uncompressedLen);
+
+	return job->uncompressed;
+}
+
+/*
+ * Release the job and its buffers, waiting for a worker still busy with it.
+ */
+void
+AppendOnlyDecompress_Release(AppendOnlyDecompressJob *job)
+{
+	AppendOnlyDecompress_Wait(job);
+
+	if (job->prev)
+		job->prev->next = job->next;
+	else
+		decompressJobs = job->next;
+	if (job->next)
+		job->next->prev = job->prev;
+
+	pfree(job);
+}
+
+/*
+ * Release the jobs of a resource owner that is being released, typically
+ * because the query was aborted in the middle of a scan.
+ */
+static void
+AppendOnlyDecompress_AbortCallback(ResourceReleasePhase phase,
+								   bool isCommit,
+								   bool isTopLevel,
+								   void *arg)
+{
+	AppendOnlyDecompressJob *curr;
+	AppendOnlyDecompressJob *next;
+
+	if (phase != RESOURCE_RELEASE_AFTER_LOCKS)
+		return;
+
+	next = decompressJobs;
+	while (next)
+	{
+		curr = next;
+		next = curr->next;
+
+		if (curr->owner == CurrentResourceOwner)
+		{
+			if (isCommit)
+				elog(WARNING, "append-only decompression job leak: %p still referenced", curr);
+
+			AppendOnlyDecompress_Release(curr);
+		}
+	}
+}
@@ -22,12 +22,16 @@
 #include <unistd.h>
 
 #include "catalog/pg_compression.h"
+#include "cdb/cdbappendonlydecompress.h"
 #include "cdb/cdbappendonlystorage.h"
 #include "cdb/cdbappendonlystoragelayer.h"
 #include "cdb/cdbappendonlystorageformat.h"
 #include "cdb/cdbappendonlystorageread.h"
 #include "utils/guc.h"
 
+static void AppendOnlyStorageRead_InternalGetBuffer(AppendOnlyStorageRead *storageRead,
+										uint8 **header, uint8 **content);
+
 
 /*----------------------------------------------------------------
  * Initialization
@@ -137,6 +141,70 @@ AppendOnlyStorageRead_Init(AppendOnlyStorageRead *storageRead,
 	storageRead->isActive = true;
 }
 
+/*
+ * Set how many large reads past the current one the operating system is
+ * asked to read ahead, so that reading the next blocks of a segment file
+ * overlaps with the processing of the current ones.  Scans pass the
+ * effective_io_concurrency of the relation's tablespace.  Zero disables
+ * readahead.
+ */
+void
+AppendOnlyStorageRead_SetPrefetchDepth(AppendOnlyStorageRead *storageRead,
+									   int prefetchDepth)
+{
+	Assert(storageRead != NULL);
+	Assert(storageRead->isActive);
+	Assert(prefetchDepth >= 0);
+
+	BufferedReadSetPrefetch(&storageRead->bufferedRead,
+							(int64) prefetchDepth * storageRead->largeReadLen);
+}
+
+/*
+ * Have the next block of the segment file decompressed by the worker
+ * threads of cdbappendonlydecompress.c while the caller is still busy with
+ * the current one.  Only for sequential reading: each time the content of
+ * a compressed block has been taken, the header of the following block is
+ * read ahead and its decompression started.
+ *
+ * Nothing happens unless gp_appendonly_decompress_workers is set and the
+ * compression type is one the worker threads know.
+ */
+void
+AppendOnlyStorageRead_SetDecompressAhead(AppendOnlyStorageRead *storageRead)
+{
+	Assert(storageRead != NULL);
+	Assert(storageRead->isActive);
+
+	storageRead->decompressAhead =
+		(storageRead->storageAttributes.compress &&
+		 AppendOnlyDecompress_Supported(storageRead->storageAttributes.compressType));
+}
+
+/*
+ * Forget the block read ahead, and stop decompressing it.
+ */
+static void
+AppendOnlyStorageRead_ForgetAhead(AppendOnlyStorageRead *storageRead)
+{
+	if (storageRead->aheadJob != NULL)
+	{
+		AppendOnlyDecompress_Release(storageRead->aheadJob);
+		storageRead->aheadJob = NULL;
+	}
+	if (storageRead->currentJob != NULL)
+	{
+		AppendOnlyDecompress_Release(storageRead->currentJob);
+		storageRead->currentJob = NULL;
+	}
+	if (storageRead->lentJob != NULL)
+	{
+		AppendOnlyDecompress_Release(storageRead->lentJob);
+		storageRead->lentJob = NULL;
+	}
+	storageRead->haveAhead = false;
+}
+
 /*
  * Return (read-only) pointer to relation name.
  */
@@ -172,6 +240,8 @@ AppendOnlyStorageRead_FinishSession(AppendOnlyStorageRead *storageRead)
 	if (!storageRead->isActive)
 		return;
 
+	AppendOnlyStorageRead_ForgetAhead(storageRead);
+
 	oldMemoryContext = MemoryContextSwitchTo(storageRead->memoryContext);
 
 	/*
@@ -435,6 +505,8 @@ AppendOnlyStorageRead_SetTemporaryRange(AppendOnlyStorageRead *storageRead,
 	Assert(afterFileOffset >= 0);
 	Assert(afterFileOffset <= storageRead->logicalEof);
 
+	AppendOnlyStorageRead_ForgetAhead(storageRead);
+
 	BufferedReadSetTemporaryRange(&storageRead->bufferedRead,
 								  beginFileOffset,
 								  afterFileOffset);
@@ -454,6 +526,8 @@ AppendOnlyStorageRead_CloseFile(AppendOnlyStorageRead *storageRead)
 	if (storageRead->file == -1)
 		return;
 
+	AppendOnlyStorageRead_ForgetAhead(storageRead);
+
 	FileClose(storageRead->file);
 
 	storageRead->file = -1;
@@ -777,13 +851,10 @@ AppendOnlyStorageRead_LogBlockHeader(AppendOnlyStorageRead *storageRead,
 }
 
 /*
- * Get information on the next Append-Only Storage Block.
- *
- * Return true if another block was found.  Otherwise, we have reached the
- * end of the current segment file.
+ * Do read the header of the next Append-Only Storage Block.
  */
-bool
-AppendOnlyStorageRead_ReadNextBlock(AppendOnlyStorageRead *storageRead)
+static bool
+AppendOnlyStorageRead_InternalReadNextBlock(AppendOnlyStorageRead *storageRead)
 {
 	uint8	   *header;
 	AOHeaderCheckError checkError;
@@ -1041,6 +1112,82 @@ AppendOnlyStorageRead_ReadNextBlock(AppendOnlyStorageRead *storageRead)
 	return true;
 }
 
+/*
+ * Get information on the next Append-Only Storage Block.
+ *
+ * Return true if another block was found.  Otherwise, we have reached the
+ * end of the current segment file.
+ */
+bool
+AppendOnlyStorageRead_ReadNextBlock(AppendOnlyStorageRead *storageRead)
+{
+	if (storageRead->haveAhead)
+	{
+		/* Already read, and maybe decompressed, ahead */
+		Assert(storageRead->currentJob == NULL);
+
+		memcpy(&storageRead->current,
+			   &storageRead->aheadCurrent,
+			   sizeof(AppendOnlyStorageReadCurrent));
+		storageRead->currentJob = storageRead->aheadJob;
+		storageRead->aheadJob = NULL;
+		storageRead->haveAhead = false;
+
+		return storageRead->aheadFound;
+	}
+
+	return AppendOnlyStorageRead_InternalReadNextBlock(storageRead);
+}
+
+/*
+ * Read the header of the block after the current one and start
+ * decompressing it in a worker thread.
+ *
+ * Only called once the content of the current block has been copied or
+ * decompressed out of the read buffer, since reading ahead may reuse it.
+ */
+static void
+AppendOnlyStorageRead_StartAhead(AppendOnlyStorageRead *storageRead)
+{
+	AppendOnlyStorageReadCurrent saveCurrent;
+
+	if (!storageRead->decompressAhead || storageRead->haveAhead)
+		return;
+
+	memcpy(&saveCurrent,
+		   &storageRead->current,
+		   sizeof(AppendOnlyStorageReadCurrent));
+
+	storageRead->aheadFound =
+		AppendOnlyStorageRead_InternalReadNextBlock(storageRead);
+
+	if (storageRead->aheadFound &&
+		!storageRead->current.isLarge &&
+		storageRead->current.isCompressed)
+	{
+		uint8	   *header;
+		uint8	   *content;
+
+		AppendOnlyStorageRead_InternalGetBuffer(storageRead,
+												&header,
+												&content);
+
+		storageRead->aheadJob =
+			AppendOnlyDecompress_Start(storageRead->storageAttributes.compressType,
+									   content,
+									   storageRead->current.compressedLen,
+									   storageRead->current.uncompressedLen);
+	}
+
+	memcpy(&storageRead->aheadCurrent,
+		   &storageRead->current,
+		   sizeof(AppendOnlyStorageReadCurrent));
+	memcpy(&storageRead->current,
+		   &saveCurrent,
+		   sizeof(AppendOnlyStorageReadCurrent));
+	storageRead->haveAhead = true;
+}
+
 /*
  * Get information on the next Append-Only Storage Block.
  *
@@ -1162,10 +1309,19 @@ AppendOnlyStorageRead_InternalGetBuffer(AppendOnlyStorageRead *storageRead,
 	 * do not save any pointers to the prior buffer call.  This why
 	 * AppendOnlyStorageFormat_GetHeaderInfo passes back the offset to the
 	 * data, not a pointer.
+	 *
+	 * The buffer already covers the block when it was read ahead, but no
+	 * worker thread took it.
 	 */
-	*header = BufferedReadGrowBuffer(&storageRead->bufferedRead,
-									 storageRead->current.overallBlockLen,
-									 &availableLen);
+	if (storageRead->bufferedRead.bufferLen == storageRead->current.overallBlockLen)
+	{
+		*header = BufferedReadGetCurrentBuffer(&storageRead->bufferedRead);
+		availableLen = storageRead->bufferedRead.bufferLen;
+	}
+	else
+		*header = BufferedReadGrowBuffer(&storageRead->bufferedRead,
+										 storageRead->current.overallBlockLen,
+										 &availableLen);
 
 	if (storageRead->current.overallBlockLen != availableLen)
 		ereport(ERROR,
@@ -1367,6 +1523,20 @@ AppendOnlyStorageRead_Content(AppendOnlyStorageRead *storageRead,
 			contentNext += regularContentLen;
 		}
 	}
+	else if (storageRead->currentJob != NULL)
+	{
+		/*
+		 * "Small" content that was decompressed ahead.
+		 */
+		memcpy(contentOut,
+			   AppendOnlyDecompress_Finish(storageRead->currentJob),
+			   storageRead->current.uncompressedLen);
+
+		AppendOnlyDecompress_Release(storageRead->currentJob);
+		storageRead->currentJob = NULL;
+
+		AppendOnlyStorageRead_StartAhead(storageRead);
+	}
 	else
 	{
 		uint8	   *header;
@@ -1437,10 +1607,46 @@ AppendOnlyStorageRead_Content(AppendOnlyStorageRead *storageRead,
 					 storageRead->segmentFileName,
 					 storageRead->current.headerOffsetInFile,
 					 storageRead->bufferCount);
+
+			AppendOnlyStorageRead_StartAhead(storageRead);
 		}
 	}
 }
 
+/*
+ * Return the decompressed content of the current *small* compressed block,
+ * if it was decompressed ahead.  Otherwise return NULL, and the caller uses
+ * AppendOnlyStorageRead_Content.
+ *
+ * No copy is made: the content stays valid until the content of the next
+ * block is asked for.
+ */
+uint8 *
+AppendOnlyStorageRead_DecompressedContent(AppendOnlyStorageRead *storageRead)
+{
+	uint8	   *content;
+
+	Assert(storageRead != NULL);
+	Assert(storageRead->isActive);
+
+	if (storageRead->currentJob == NULL)
+		return NULL;
+
+	Assert(!storageRead->current.isLarge);
+	Assert(storageRead->current.isCompressed);
+
+	content = AppendOnlyDecompress_Finish(storageRead->currentJob);
+
+	if (storageRead->lentJob != NULL)
+		AppendOnlyDecompress_Release(storageRead->lentJob);
+	storageRead->lentJob = storageRead->currentJob;
+	storageRead->currentJob = NULL;
+
+	AppendOnlyStorageRead_StartAhead(storageRead);
+
+	return content;
+}
+
 /*
  * Skip the current block found with ~_GetBlockInfo.
  *
@@ -1456,7 +1662,15 @@ AppendOnlyStorageRead_SkipCurrentBlock(AppendOnlyStorageRead *storageRead)
 	Assert(storageRead != NULL);
 	Assert(storageRead->isActive);
 
-	if (storageRead->current.isLarge)
+	if (storageRead->currentJob != NULL)
+	{
+		/*
+		 * Read and decompressed ahead, and nothing more to read.
+		 */
+		AppendOnlyDecompress_Release(storageRead->currentJob);
+		storageRead->currentJob = NULL;
+	}
+	else if (storageRead->current.isLarge)
 	{
 		int64		largeContentPosition;	/* Position of the large content
 											 * metadata block. */
@@ -20,6 +20,8 @@
 #include "utils/guc.h"
 #include "miscadmin.h"
 
+static void BufferedReadPrefetch(
+			   BufferedRead *bufferedRead);
 static void BufferedReadIo(
 			   BufferedRead *bufferedRead);
 static uint8 *BufferedReadUseBeforeBuffer(
@@ -110,6 +112,27 @@ BufferedReadInit(
 	 */
 	bufferedRead->haveTemporaryLimitInEffect = false;
 	bufferedRead->temporaryLimitFileLen = 0;
+
+	/*
+	 * Readahead support.
+	 */
+	bufferedRead->prefetchLen = 0;
+	bufferedRead->prefetchPosition = 0;
+}
+
+/*
+ * Set how many bytes past the current large read to ask the operating system
+ * to read ahead.  Zero disables readahead.
+ */
+void
+BufferedReadSetPrefetch(
+						BufferedRead *bufferedRead,
+						int64 prefetchLen)
+{
+	Assert(bufferedRead != NULL);
+	Assert(prefetchLen >= 0);
+
+	bufferedRead->prefetchLen = prefetchLen;
 }
 
 /*
@@ -143,6 +166,8 @@ BufferedReadSetFile(
 	bufferedRead->haveTemporaryLimitInEffect = false;
 	bufferedRead->temporaryLimitFileLen = 0;
 
+	bufferedRead->prefetchPosition = 0;
+
 	if (fileLen > 0)
 	{
 		/*
@@ -156,6 +181,60 @@ BufferedReadSetFile(
 	}
 }
 
+/*
+ * Ask the operating system to start reading the range past the large read
+ * about to be done, so that it arrives while the caller is still busy with
+ * (e.g. decompressing) the blocks of this one.  The range already asked for
+ * is remembered, so in the steady state each large read asks for one more
+ * large read worth at the far end of the window.
+ */
+static void
+BufferedReadPrefetch(
+					 BufferedRead *bufferedRead)
+{
+#ifdef USE_PREFETCH
+	int64		inEffectFileLen;
+	int64		prefetchBegin;
+	int64		prefetchEnd;
+
+	if (bufferedRead->haveTemporaryLimitInEffect)
+		inEffectFileLen = bufferedRead->temporaryLimitFileLen;
+	else
+		inEffectFileLen = bufferedRead->fileLen;
+
+	prefetchBegin = bufferedRead->largeReadPosition +
+		bufferedRead->largeReadLen;
+	if (prefetchBegin < bufferedRead->prefetchPosition)
+		prefetchBegin = bufferedRead->prefetchPosition;
+
+	prefetchEnd = bufferedRead->largeReadPosition +
+		bufferedRead->largeReadLen +
+		bufferedRead->prefetchLen;
+	if (prefetchEnd > inEffectFileLen)
+		prefetchEnd = inEffectFileLen;
+	if (prefetchEnd - prefetchBegin > INT_MAX)
+		prefetchEnd = prefetchBegin + INT_MAX;
+
+	if (prefetchBegin >= prefetchEnd)
+		return;
+
+	/* The advice is only a hint, so ignore any failure. */
+	(void) FilePrefetch(bufferedRead->file,
+						prefetchBegin,
+						(int) (prefetchEnd - prefetchBegin));
+
+	elogif(Debug_appendonly_print_read_block, LOG,
+		   "Append-Only storage read: table \"%s\", segment file \"%s\", prefetch position " INT64_FORMAT ", "
+		   "prefetch length " INT64_FORMAT,
+		   bufferedRead->relationName,
+		   bufferedRead->filePathName,
+		   prefetchBegin,
+		   prefetchEnd - prefetchBegin);
+
+	bufferedRead->prefetchPosition = prefetchEnd;
+#endif   /* USE_PREFETCH */
+}
+
 /*
  * Perform a large read i/o.
  */
@@ -171,6 +250,9 @@ BufferedReadIo(
 	Assert(bufferedRead->largeReadLen > 0);
 	largeReadMemory = bufferedRead->largeReadMemory;
 
+	if (bufferedRead->prefetchLen > 0)
+		BufferedReadPrefetch(bufferedRead);
+
 #ifdef USE_ASSERT_CHECKING
 	{
 		int64		currentReadPosition;
@@ -414,6 +496,9 @@ BufferedReadSetTemporaryRange(
 		}
 	}
 
+	bufferedRead->haveTemporaryLimitInEffect = true;
+	bufferedRead->temporaryLimitFileLen = afterFileOffset;
+
 	if (newReadNeeded)
 	{
 		int64		remainingFileLen;
@@ -444,13 +529,12 @@ BufferedReadSetTemporaryRange(
 
 		bufferedRead->largeReadPosition = beginFileOffset;
 
+		/* We may have seeked backward, past what was read ahead. */
+		bufferedRead->prefetchPosition = 0;
+
 		if (bufferedRead->largeReadLen > 0)
 			BufferedReadIo(bufferedRead);
 	}
-
-	bufferedRead->haveTemporaryLimitInEffect = true;
-	bufferedRead->temporaryLimitFileLen = afterFileOffset;
-
 }
 
 /*
@@ -699,6 +783,8 @@ BufferedReadCompleteFile(
 
 	bufferedRead->largeReadPosition = 0;
 	bufferedRead->largeReadLen = 0;
+
+	bufferedRead->prefetchPosition = 0;
 }
 
 
@@ -32,6 +32,7 @@
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/tqual.h"
+#include "utils/typcache.h"
 
 /* initial estimate for number of logical indexes */
 #define INITIAL_NUM_LOGICAL_INDEXES_ESTIMATE 100
@@ -103,7 +104,10 @@ static bool collapseIndexes(PartitionIndexNode **partitionIndexNode,
 				LogicalIndexInfoHashEntry **entry);
 static void createIndexHashTables(void);
 static IndexInfo *populateIndexInfo(Relation indRel);
-static Node *mergeIntervals(Node *intervalFst, Node *intervalSnd);
+static Node *collapseIntervals(Node *intervalFst, Node *intervalSnd);
+static List *mergeIntervalList(List *intervals);
+static Node *makeIntervalDisjunction(List *intervals);
+static int	intervalStartCmp(const void *a, const void *b, void *arg);
 static void extractStartEndRange(Node *clause, Node **ppnodeStart, Node **ppnodeEnd);
 static void extractOpExprComponents(OpExpr *opexpr, Var **ppvar, Const **ppconst, Oid *opno);
 
@@ -952,7 +956,7 @@ get_relation_part_constraints(Oid rootOid, List **defaultLevels)
 	List	   *partkeys = rel_partition_keys_ordered(rootOid);
 	int			nLevels = list_length(partkeys);
 
-	Node	   *allCons = NULL;
+	List	   *allCons = NIL;
 
 	for (int level = 0; level < nLevels; level++)
 	{
@@ -963,6 +967,7 @@ get_relation_part_constraints(Oid rootOid, List **defaultLevels)
 		Assert(NULL != pn);
 		List	   *partOids = all_partition_relids(pn);
 
+		List	   *levelCons = NIL;
 		Node	   *partCons = NULL;
 		ListCell   *lc = NULL;
 
@@ -980,25 +985,22 @@ get_relation_part_constraints(Oid rootOid, List **defaultLevels)
 				continue;
 			}
 
-			/* OR them to current constraints */
-			if (NULL == allCons)
-			{
-				allCons = partCons;
-			}
-			else
-			{
-				allCons = (Node *) mergeIntervals(allCons, partCons);
-			}
+			levelCons = lappend(levelCons, partCons);
 		}
+
+		/* OR them to current constraints */
+		allCons = list_concat(allCons, mergeIntervalList(levelCons));
+		list_free(levelCons);
 	}
 
-	if (NULL == allCons)
+	list_free(partkeys);
+
+	if (NIL == allCons)
 	{
-		allCons = makeBoolConst(false /* value */ , false /* isnull */ );
+		return (Node *) makeBoolConst(false /* value */ , false /* isnull */ );
 	}
 
-	list_free(partkeys);
-	return allCons;
+	return makeIntervalDisjunction(allCons);
 }
 
 /*
@@ -1045,7 +1047,7 @@ generateLogicalIndexPred(LogicalIndexes *li,
 						 Oid root,
 						 int *numLogicalIndexes)
 {
-	Node	   *conList;
+	List	   *conList;
 	ListCell   *lc;
 	AttrNumber *indexKeys;
 
@@ -1065,6 +1067,7 @@ generateLogicalIndexPred(LogicalIndexes *li,
 		li->logicalIndexInfo[*curIdx]->indType = entry->indType;
 
 		/* fetch the partList from the logical index hash entry */
+		conList = NIL;
 		foreach(lc, entry->partList)
 		{
 			Oid			partOid = lfirst_oid(lc);
@@ -1072,20 +1075,17 @@ generateLogicalIndexPred(LogicalIndexes *li,
 			if (partOid != root)
 			{
 				/* fetch part constraint mapped to root */
-				conList = getPartConstraints(partOid, root, NIL /* partKey */ );
-
-				/* OR them to current constraints */
-				if (li->logicalIndexInfo[*curIdx]->partCons)
-				{
-					li->logicalIndexInfo[*curIdx]->partCons = mergeIntervals(li->logicalIndexInfo[*curIdx]->partCons, conList);
-				}
-				else
-				{
-					li->logicalIndexInfo[*curIdx]->partCons = conList;
-				}
+				conList = lappend(conList, getPartConstraints(partOid, root, NIL /* partKey */ ));
 			}
 		}
 
+		/* OR them to current constraints */
+		if (NIL != conList)
+		{
+			li->logicalIndexInfo[*curIdx]->partCons = makeIntervalDisjunction(mergeIntervalList(conList));
+			list_free(conList);
+		}
+
 		(*curIdx)++;
 		(*numLogicalIndexes)++;
 	}
@@ -1305,16 +1305,15 @@ dumpPartsIndexInfo(PartitionIndexNode *n, int level)
 }
 
 /*
- * 	mergeIntervals
- *   merge the two intervals by creating a disjunction of the given intervals, or collapsing
- *   them into one interval when possible
+ * 	collapseIntervals
+ *   collapse the two intervals into one interval when possible
  *
  *   This function's arguments represent two range constraints, which the function attempts
  *   to collapse into one if they share a common boundary. If no collapse is possible,
- *   the function returns a disjunction of the two intervals.
+ *   the function returns NULL.
  */
 static Node *
-mergeIntervals(Node *intervalFst, Node *intervalSnd)
+collapseIntervals(Node *intervalFst, Node *intervalSnd)
 {
 	Node	   *pnodeStart1 = NULL;
 	Node	   *pnodeEnd1 = NULL;
@@ -1397,7 +1396,183 @@ mergeIntervals(Node *intervalFst, Node *intervalSnd)
 			return (Node *) makeBoolConst(true /* value */ , false /* isnull */ );
 		}
 	}
-	return (Node *) make_orclause(list_make2(intervalFst, intervalSnd));
+	return NULL;
+}
+
+/*
+ * An interval to be merged with others, along with the constant its start is
+ * sorted by, if any
+ */
+typedef struct IntervalSortItem
+{
+	Node	   *interval;
+	Var		   *startVar;
+	Const	   *startConst;
+} IntervalSortItem;
+
+typedef struct IntervalSortContext
+{
+	FmgrInfo   *cmpFinfo;
+	Oid			collation;
+} IntervalSortContext;
+
+/*
+ * intervalStartCmp
+ *   qsort_arg comparator of intervals by their start, unbounded ones first
+ */
+static int
+intervalStartCmp(const void *a, const void *b, void *arg)
+{
+	const IntervalSortItem *itemA = (const IntervalSortItem *) a;
+	const IntervalSortItem *itemB = (const IntervalSortItem *) b;
+	IntervalSortContext *cxt = (IntervalSortContext *) arg;
+
+	if (NULL == itemA->startConst || NULL == itemB->startConst)
+	{
+		return (NULL != itemA->startConst) - (NULL != itemB->startConst);
+	}
+
+	return DatumGetInt32(FunctionCall2Coll(cxt->cmpFinfo, cxt->collation,
+										   itemA->startConst->constvalue,
+										   itemB->startConst->constvalue));
+}
+
+/*
+ * 	mergeIntervalList
+ *   merge the given intervals into as few intervals as possible, and return the list
+ *   of the resulting intervals, whose disjunction is equivalent to that of the given ones
+ *
+ *   The intervals are sorted by their start first, so that the ones sharing a boundary
+ *   are collapsed in one pass, whatever the order of the parts they come from. For a
+ *   table with many range parts, this gives a short list of intervals rather than a
+ *   disjunction with an interval per part. If the intervals are not all ranges over
+ *   the same column with a constant start, they are merged in the given order.
+ */
+static List *
+mergeIntervalList(List *intervals)
+{
+	int			nintervals = list_length(intervals);
+	IntervalSortItem *items;
+	IntervalSortItem *first = NULL;
+	bool		sortable = true;
+	ListCell   *lc;
+	int			i = 0;
+	List	   *result = NIL;
+	Node	   *current = NULL;
+
+	if (nintervals <= 1)
+	{
+		return list_copy(intervals);
+	}
+
+	items = palloc(nintervals * sizeof(IntervalSortItem));
+	foreach(lc, intervals)
+	{
+		Node	   *interval = (Node *) lfirst(lc);
+		Node	   *pnodeStart = NULL;
+		Node	   *pnodeEnd = NULL;
+		Oid			opnoStart = InvalidOid;
+
+		items[i].interval = interval;
+		items[i].startVar = NULL;
+		items[i].startConst = NULL;
+
+		extractStartEndRange(interval, &pnodeStart, &pnodeEnd);
+		if (NULL != pnodeStart)
+		{
+			extractOpExprComponents((OpExpr *) pnodeStart, &items[i].startVar,
+									&items[i].startConst, &opnoStart);
+		}
+
+		if (NULL == pnodeStart && NULL == pnodeEnd)
+		{
+			/* not a range */
+			sortable = false;
+		}
+		else if (NULL != pnodeStart)
+		{
+			if (NULL == items[i].startConst || items[i].startConst->constisnull)
+			{
+				sortable = false;
+			}
+			else if (NULL == first)
+			{
+				first = &items[i];
+			}
+			else if (!equal(items[i].startVar, first->startVar) ||
+					 items[i].startConst->consttype != first->startConst->consttype)
+			{
+				sortable = false;
+			}
+		}
+		i++;
+	}
+
+	if (sortable && NULL != first)
+	{
+		TypeCacheEntry *typentry = lookup_type_cache(first->startConst->consttype,
+													 TYPECACHE_CMP_PROC_FINFO);
+
+		if (OidIsValid(typentry->cmp_proc_finfo.fn_oid))
+		{
+			IntervalSortContext cxt;
+
+			cxt.cmpFinfo = &typentry->cmp_proc_finfo;
+			cxt.collation = first->startConst->constcollid;
+			qsort_arg(items, nintervals, sizeof(IntervalSortItem),
+					  intervalStartCmp, &cxt);
+		}
+	}
+
+	for (i = 0; i < nintervals; i++)
+	{
+		Node	   *collapsed = NULL;
+
+		if (NULL != current)
+		{
+			collapsed = collapseIntervals(current, items[i].interval);
+		}
+
+		if (NULL != collapsed)
+		{
+			current = collapsed;
+		}
+		else
+		{
+			if (NULL != current)
+			{
+				result = lappend(result, current);
+			}
+			current = items[i].interval;
+		}
+	}
+	result = lappend(result, current);
+
+	pfree(items);
+
+	return result;
+}
+
+/*
+ * 	makeIntervalDisjunction
+ *   make the disjunction of a non-empty list of intervals, which it takes over
+ */
+static Node *
+makeIntervalDisjunction(List *intervals)
+{
+	Node	   *interval;
+
+	Assert(NIL != intervals);
+
+	if (1 < list_length(intervals))
+	{
+		return (Node *) make_orclause(intervals);
+	}
+
+	interval = (Node *) linitial(intervals);
+	list_free(intervals);
+
+	return interval;
 }
 
 /*
@@ -3104,27 +3104,147 @@ all_interior_partition_relids(PartitionNode *pn)
 	return interior_relids;
 }
 
+/*
+ * Count the parts of the given partitioning level, i.e. the rules of its
+ * pg_partition entry, and tell whether one of them is a default part.
+ *
+ *   SELECT count(*), bool_or(parisdefault)
+ *   FROM pg_partition_rule WHERE paroid = :1
+ */
+static int
+count_level_parts(Relation partrulerel, Oid paroid, bool *hasDefault)
+{
+	ScanKeyData scankey;
+	SysScanDesc sscan;
+	HeapTuple	tuple;
+	int			count = 0;
+
+	*hasDefault = false;
+
+	ScanKeyInit(&scankey, Anum_pg_partition_rule_paroid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(paroid));
+	sscan = systable_beginscan(partrulerel, PartitionRuleParoidParparentruleParruleordIndexId, true,
+							   SnapshotNow, 1, &scankey);
+
+	while (HeapTupleIsValid(tuple = systable_getnext(sscan)))
+	{
+		if (((Form_pg_partition_rule) GETSTRUCT(tuple))->parisdefault)
+			*hasDefault = true;
+		count++;
+	}
+
+	systable_endscan(sscan);
+
+	return count;
+}
+
 /*
  * Return the number of leaf parts of the partitioned table with the given oid
+ *
+ * All leaves are at the deepest level of the partitioning, so this counts the
+ * rules of that level instead of building the whole partition hierarchy.
  */
 int
 countLeafPartTables(Oid rootOid)
 {
+	Relation	partrel;
+	Relation	partrulerel;
+	ScanKeyData scankey;
+	SysScanDesc sscan;
+	HeapTuple	tuple;
+	Oid			leafParoid = InvalidOid;
+	int			maxdepth = -1;
+	bool		hasDefault;
+	int			count;
+
 	Assert(rel_is_partitioned(rootOid));
 
-	PartitionNode *pn = get_parts(rootOid, 0 /* level */ , 0 /* parent */ , false /* inctemplate */ ,
-								  true /* include subparts */ );
+	/* SELECT * FROM pg_partition WHERE parrelid = :1 */
+	partrel = heap_open(PartitionRelationId, AccessShareLock);
+
+	ScanKeyInit(&scankey, Anum_pg_partition_parrelid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(rootOid));
+	sscan = systable_beginscan(partrel, PartitionParrelidIndexId, true,
+							   SnapshotNow, 1, &scankey);
+
+	while (HeapTupleIsValid(tuple = systable_getnext(sscan)))
+	{
+		Form_pg_partition part = (Form_pg_partition) GETSTRUCT(tuple);
+
+		/* not interested in templates */
+		if (!part->paristemplate && part->parlevel > maxdepth)
+		{
+			maxdepth = part->parlevel;
+			leafParoid = HeapTupleGetOid(tuple);
+		}
+	}
+
+	systable_endscan(sscan);
+	heap_close(partrel, AccessShareLock);
 
-	List	   *lRelOids = all_leaf_partition_relids(pn);
+	Assert(OidIsValid(leafParoid));
 
-	Assert(list_length(lRelOids) > 0);
-	int			count = list_length(lRelOids);
+	partrulerel = heap_open(PartitionRuleRelationId, AccessShareLock);
+	count = count_level_parts(partrulerel, leafParoid, &hasDefault);
+	heap_close(partrulerel, AccessShareLock);
 
-	list_free(lRelOids);
-	pfree(pn);
+	Assert(count > 0);
 	return count;
 }
 
+/*
+ * Return the levels of the partitioned table with the given oid that have a
+ * default part, as an integer list.
+ *
+ * This gives the default levels that get_relation_part_constraints() also
+ * returns, from the partitioning rules alone, without fetching and merging
+ * the constraints of every part.
+ */
+List *
+rel_partition_default_levels(Oid rootOid)
+{
+	Relation	partrel;
+	Relation	partrulerel;
+	ScanKeyData scankey;
+	SysScanDesc sscan;
+	HeapTuple	tuple;
+	List	   *defaultLevels = NIL;
+
+	if (!rel_is_partitioned(rootOid))
+		return NIL;
+
+	partrel = heap_open(PartitionRelationId, AccessShareLock);
+	partrulerel = heap_open(PartitionRuleRelationId, AccessShareLock);
+
+	ScanKeyInit(&scankey, Anum_pg_partition_parrelid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(rootOid));
+	sscan = systable_beginscan(partrel, PartitionParrelidIndexId, true,
+							   SnapshotNow, 1, &scankey);
+
+	while (HeapTupleIsValid(tuple = systable_getnext(sscan)))
+	{
+		Form_pg_partition part = (Form_pg_partition) GETSTRUCT(tuple);
+		bool		hasDefault;
+
+		/* not interested in templates */
+		if (part->paristemplate)
+			continue;
+
+		count_level_parts(partrulerel, HeapTupleGetOid(tuple), &hasDefault);
+		if (hasDefault)
+			defaultLevels = lappend_int(defaultLevels, part->parlevel);
+	}
+
+	systable_endscan(sscan);
+	heap_close(partrulerel, AccessShareLock);
+	heap_close(partrel, AccessShareLock);
+
+	return defaultLevels;
+}
+
 /* Return the pg_class Oids of the relations representing the parts
  * of the PartitionRule tree headed by the argument PartitionRule.
  *
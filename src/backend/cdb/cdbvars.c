@@ -227,6 +227,8 @@ double		gp_motion_cost_per_row = 0;
 int			gp_segments_for_planner = 0;
 
 int			gp_hashagg_default_nbatches = 32;
+int			gp_hashagg_stream_bypass_rows = 100000;
+double		gp_hashagg_stream_bypass_ratio = 0.8;
 
 bool		gp_adjust_selectivity_for_outerjoins = TRUE;
 bool		gp_selectivity_damping_for_scans = false;
@@ -281,6 +283,9 @@ double		gp_workfile_limit_per_query = 0;
 int			gp_workfile_limit_files_per_query = 0;
 int			gp_workfile_bytes_to_checksum = 16;
 
+/* Number of BFZ blocks to read ahead when scanning a workfile; 0 disables */
+int			gp_workfile_prefetch_blocks = 8;
+
 /* The type of work files that HashJoin should use */
 int			gp_workfile_type_hashjoin = 0;
 
@@ -52,6 +52,7 @@
 #include "utils/rel.h"
 #include "utils/snapmgr.h"
 
+#include "access/appendonly_sortkey.h"
 #include "access/appendonlywriter.h"
 #include "access/fileam.h"
 #include "cdb/cdbappendonlyam.h"
@@ -3796,7 +3797,23 @@ CopyFrom(CopyState cstate)
 			} else {
 				List	   *recheckIndexes = NIL;
 
-				if (relstorage == RELSTORAGE_AOROWS)
+				/*
+				 * Rows for an append-only table with a sort key are written
+				 * out in sort key order once all of them have been read.
+				 */
+				if (relstorage_is_ao(relstorage) &&
+					resultRelInfo->ri_aoSort == NULL &&
+					!(resultRelInfo->ri_TrigDesc &&
+					  resultRelInfo->ri_TrigDesc->trig_insert_after_row) &&
+					RelationGetAppendOnlySortKey(resultRelInfo->ri_RelationDesc) != NULL)
+					ExecBeginAppendOnlySort(estate, resultRelInfo);
+
+				if (resultRelInfo->ri_aoSort)
+				{
+					AppendOnlySort_Put(resultRelInfo->ri_aoSort, slot);
+					ItemPointerSetInvalid(&insertedTid);
+				}
+				else if (relstorage == RELSTORAGE_AOROWS)
 				{
 					MemTuple	mtuple;
 
@@ -3833,7 +3850,7 @@ CopyFrom(CopyState cstate)
 					insertedTid = tuple->t_self;
 				}
 
-				if (resultRelInfo->ri_NumIndices > 0)
+				if (resultRelInfo->ri_NumIndices > 0 && !resultRelInfo->ri_aoSort)
 					recheckIndexes = ExecInsertIndexTuples(slot, &insertedTid,
 														   estate);
 
@@ -3887,6 +3904,14 @@ CopyFrom(CopyState cstate)
 
 	MemoryContextSwitchTo(estate->es_query_cxt);
 
+	/* Write out the rows held back for AO tables with a sort key */
+	resultRelInfo = estate->es_result_relations;
+	for (i = estate->es_num_result_relations; i > 0; i--)
+	{
+		ExecFlushAppendOnlySort(estate, resultRelInfo);
+		resultRelInfo++;
+	}
+
 	/*
 	 * Done reading input data and sending it off to the segment
 	 * databases Now we would like to end the copy command on
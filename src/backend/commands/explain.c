@@ -67,6 +67,8 @@ static void report_triggers(ResultRelInfo *rInfo, bool show_relname,
 static void ExplainDXL(Query *query, ExplainState *es,
 							const char *queryString,
 							ParamListInfo params);
+static void ExplainOptimizerProfile(const OptimizerProfile *profile,
+						ExplainState *es);
 #endif
 static double elapsed_time(instr_time *starttime);
 static void ExplainNode(PlanState *planstate, List *ancestors,
@@ -184,6 +186,8 @@ ExplainQuery(ExplainStmt *stmt, const char *queryString,
 		}
 		else if (strcmp(opt->defname, "dxl") == 0)
 			es.dxl = defGetBoolean(opt);
+		else if (strcmp(opt->defname, "optimizer_profile") == 0)
+			es.optimizer_profile = defGetBoolean(opt);
 		else
 			ereport(ERROR,
 					(errcode(ERRCODE_SYNTAX_ERROR),
@@ -352,6 +356,62 @@ ExplainDXL(Query *query, ExplainState *es, const char *queryString,
 	/* Free the memory we used. */
 	MemoryContextSwitchTo(oldcxt);
 }
+
+/*
+ * ExplainOptimizerProfile -
+ *	  print out where ORCA spent its time and memory optimizing the query
+ *
+ * Metadata is fetched and constants are evaluated within the other phases,
+ * so their times overlap.
+ */
+static void
+ExplainOptimizerProfile(const OptimizerProfile *profile, ExplainState *es)
+{
+	const double *time = profile->phase_time;
+	long		peak_kb = (long) ((profile->peak_memory + 1023) / 1024);
+
+	if (es->format == EXPLAIN_FORMAT_TEXT)
+	{
+		ExplainPropertyStringInfo("Optimizer Profile", es,
+								  "Query to DXL %.3f ms, Search %.3f ms, DXL to Plan %.3f ms",
+								  time[OPTIMIZER_PHASE_QUERY_TO_DXL],
+								  time[OPTIMIZER_PHASE_SEARCH],
+								  time[OPTIMIZER_PHASE_DXL_TO_PLSTMT]);
+		ExplainPropertyStringInfo("Optimizer Metadata", es,
+								  "%.3f ms, %ld fetched, %ld from shared cache",
+								  time[OPTIMIZER_PHASE_METADATA],
+								  (long) profile->md_fetches,
+								  (long) profile->md_shared_hits);
+		ExplainPropertyStringInfo("Optimizer Constant Evaluation", es,
+								  "%.3f ms, %ld expressions",
+								  time[OPTIMIZER_PHASE_CONST_EVAL],
+								  (long) profile->const_exprs);
+		if (OptimizerProfilePeakMemoryKnown())
+			ExplainPropertyStringInfo("Optimizer Peak Memory", es, "%ldkB", peak_kb);
+		else
+			ExplainPropertyText("Optimizer Peak Memory", "unknown", es);
+		return;
+	}
+
+	ExplainOpenGroup("Optimizer Profile", "Optimizer Profile", true, es);
+	ExplainPropertyFloat("Query to DXL Time",
+						 time[OPTIMIZER_PHASE_QUERY_TO_DXL], 3, es);
+	ExplainPropertyFloat("Search Time", time[OPTIMIZER_PHASE_SEARCH], 3, es);
+	ExplainPropertyFloat("DXL to Plan Time",
+						 time[OPTIMIZER_PHASE_DXL_TO_PLSTMT], 3, es);
+	ExplainPropertyFloat("Metadata Time", time[OPTIMIZER_PHASE_METADATA], 3, es);
+	ExplainPropertyLong("Metadata Fetches", (long) profile->md_fetches, es);
+	ExplainPropertyLong("Shared Metadata Cache Hits",
+						(long) profile->md_shared_hits, es);
+	ExplainPropertyFloat("Constant Evaluation Time",
+						 time[OPTIMIZER_PHASE_CONST_EVAL], 3, es);
+	ExplainPropertyLong("Constant Expressions", (long) profile->const_exprs, es);
+	if (OptimizerProfilePeakMemoryKnown())
+		ExplainPropertyLong("Peak Memory", peak_kb, es);
+	else
+		ExplainPropertyText("Peak Memory", "unknown", es);
+	ExplainCloseGroup("Optimizer Profile", "Optimizer Profile", true, es);
+}
 #endif
 
 /*
@@ -385,10 +445,22 @@ ExplainOneQuery(Query *query, IntoClause *into, ExplainState *es,
 	else
 	{
 		PlannedStmt *plan;
+		uint64		nprofiles = OptimizerProfileCount();
 
 		/* plan the query */
 		plan = pg_plan_query(query, 0, params);
 
+		/*
+		 * Keep the profile of the optimization if ORCA produced the plan, as
+		 * planning the next query of a multi-query statement overwrites it.
+		 */
+		es->optprofile = NULL;
+		if (es->optimizer_profile && OptimizerProfileCount() != nprofiles)
+		{
+			es->optprofile = palloc(sizeof(OptimizerProfile));
+			memcpy(es->optprofile, OptimizerProfileLast(), sizeof(OptimizerProfile));
+		}
+
 		/*
 		 * GPDB_92_MERGE_FIXME: it really should be an optimizer's responsibility
 		 * to correctly set the into-clause and into-policy of the PlannedStmt.
@@ -640,7 +712,16 @@ ExplainOnePlan(PlannedStmt *plannedstmt, IntoClause *into, ExplainState *es,
 		ExplainProperty("Optimizer", "legacy query optimizer", false, es);
 #ifdef USE_ORCA
 	else
+	{
 		ExplainPropertyStringInfo("Optimizer", es, "PQO version %s", OptVersion());
+
+		/* the plan comes from a cheaper search, see optimizer_search_time_budget */
+		if (queryDesc->plannedstmt->budgetExceeded)
+			ExplainProperty("Optimizer Budget", "exceeded", false, es);
+
+		if (es->optprofile != NULL)
+			ExplainOptimizerProfile(es->optprofile, es);
+	}
 #endif
 
 	/* We only list the non-default GUCs in verbose mode */
@@ -814,6 +814,94 @@ pg_prepared_statement(PG_FUNCTION_ARGS)
 	return (Datum) 0;
 }
 
+/*
+ * This set returning function reports, for each prepared statement, how
+ * many plans built by ORCA for specific parameter values are cached, and how
+ * often an execution could reuse one of them. Returns a set of (name,
+ * statement, cached_plans, hits, misses).
+ */
+Datum
+gp_prepared_statement_plan_cache(PG_FUNCTION_ARGS)
+{
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not " \
+						"allowed in this context")));
+
+	/* need to build tuplestore in query context */
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	/*
+	 * build tupdesc for result tuples. This must match the definition of the
+	 * gp_prepared_statement_plan_cache view in system_views.sql
+	 */
+	tupdesc = CreateTemplateTupleDesc(5, false);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "name",
+					   TEXTOID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "statement",
+					   TEXTOID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "cached_plans",
+					   INT4OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "hits",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "misses",
+					   INT8OID, -1, 0);
+
+	tupstore =
+		tuplestore_begin_heap(rsinfo->allowedModes & SFRM_Materialize_Random,
+							  false, work_mem);
+
+	/* generate junk in short-term context */
+	MemoryContextSwitchTo(oldcontext);
+
+	/* hash table might be uninitialized */
+	if (prepared_queries)
+	{
+		HASH_SEQ_STATUS hash_seq;
+		PreparedStatement *prep_stmt;
+
+		hash_seq_init(&hash_seq, prepared_queries);
+		while ((prep_stmt = hash_seq_search(&hash_seq)) != NULL)
+		{
+			CachedPlanSource *plansource = prep_stmt->plansource;
+			Datum		values[5];
+			bool		nulls[5];
+
+			MemSet(nulls, 0, sizeof(nulls));
+
+			values[0] = CStringGetTextDatum(prep_stmt->stmt_name);
+			values[1] = CStringGetTextDatum(plansource->query_string);
+			values[2] = Int32GetDatum(list_length(plansource->value_plans));
+			values[3] = Int64GetDatum(plansource->num_value_plan_hits);
+			values[4] = Int64GetDatum(plansource->num_value_plan_misses);
+
+			tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+		}
+	}
+
+	/* clean up and return the tuplestore */
+	tuplestore_donestoring(tupstore);
+
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+
+	return (Datum) 0;
+}
+
 /*
  * This utility function takes a C array of Oids, and returns a Datum
  * pointing to a one-dimensional Postgres array of regtypes. An empty
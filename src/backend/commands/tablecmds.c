@@ -18,6 +18,7 @@
 
 #include "access/aocs_compaction.h"
 #include "access/aomd.h"
+#include "access/appendonly_sortkey.h"
 #include "access/appendonlywriter.h"
 #include "access/bitmap.h"
 #include "access/genam.h"
@@ -2781,6 +2782,69 @@ renameatt_check(Oid myrelid, Form_pg_class classform, bool recursing)
 						NameStr(classform->relname))));
 }
 
+/*
+ * The sortkey option of an append-only table names its columns; when one of
+ * them is renamed, store the option with the new name.
+ */
+static void
+renameatt_sortkey(Relation rel, const char *oldattname,
+				  const char *newattname)
+{
+	char	   *sortkey = RelationGetAppendOnlySortKey(rel);
+	char	   *newsortkey;
+	Relation	pgclass;
+	HeapTuple	tuple;
+	HeapTuple	newtuple;
+	Datum		datum;
+	bool		isnull;
+	Datum		repl_val[Natts_pg_class];
+	bool		repl_null[Natts_pg_class];
+	bool		repl_repl[Natts_pg_class];
+	static char *validnsps[] = HEAP_RELOPT_NAMESPACES;
+
+	if (!RelationIsAppendOptimized(rel) || sortkey == NULL)
+		return;
+
+	newsortkey = AppendOnlySortKey_RenameColumn(sortkey, oldattname,
+												newattname);
+	if (newsortkey == NULL)
+		return;
+
+	pgclass = heap_open(RelationRelationId, RowExclusiveLock);
+
+	tuple = SearchSysCache1(RELOID, ObjectIdGetDatum(RelationGetRelid(rel)));
+	if (!HeapTupleIsValid(tuple))
+		elog(ERROR, "cache lookup failed for relation %u",
+			 RelationGetRelid(rel));
+
+	datum = SysCacheGetAttr(RELOID, tuple, Anum_pg_class_reloptions,
+							&isnull);
+	Assert(!isnull);
+
+	memset(repl_val, 0, sizeof(repl_val));
+	memset(repl_null, false, sizeof(repl_null));
+	memset(repl_repl, false, sizeof(repl_repl));
+
+	repl_val[Anum_pg_class_reloptions - 1] =
+		transformRelOptions(datum,
+							list_make1(makeDefElem(SOPT_SORTKEY,
+												   (Node *) makeString(newsortkey))),
+							NULL, validnsps, false, false);
+	repl_repl[Anum_pg_class_reloptions - 1] = true;
+
+	newtuple = heap_modify_tuple(tuple, RelationGetDescr(pgclass),
+								 repl_val, repl_null, repl_repl);
+
+	simple_heap_update(pgclass, &newtuple->t_self, newtuple);
+
+	CatalogUpdateIndexes(pgclass, newtuple);
+
+	heap_freetuple(newtuple);
+	ReleaseSysCache(tuple);
+
+	heap_close(pgclass, RowExclusiveLock);
+}
+
 /*
  *		renameatt_internal		- workhorse for renameatt
  */
@@ -2922,6 +2986,8 @@ renameatt_internal(Oid myrelid,
 
 	heap_close(attrelation, RowExclusiveLock);
 
+	renameatt_sortkey(targetrelation, oldattname, newattname);
+
 	/* MPP-6929, MPP-7600: metadata tracking */
 	if ((Gp_role == GP_ROLE_DISPATCH)
 		&& MetaTrackValidKindNsp(targetrelation->rd_rel))
@@ -8323,6 +8389,16 @@ ATExecDropColumn(List **wqueue, Relation rel, const char *colName,
 		RemovePartitionEncodingByRelidAttribute(RelationGetRelid(rel), attnum);
 	}
 
+	/* nor one the rows are sorted on */
+	if (RelationIsAppendOptimized(rel) &&
+		RelationGetAppendOnlySortKey(rel) != NULL &&
+		AppendOnlySortKey_HasColumn(RelationGetAppendOnlySortKey(rel),
+									colName))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot drop sort key column \"%s\"",
+						colName)));
+
 	ReleaseSysCache(tuple);
 
 	if (GpPolicyIsPartitioned(rel->rd_cdbpolicy))
@@ -10466,6 +10542,16 @@ ATPrepAlterColumnType(List **wqueue,
 				 errmsg("cannot alter inherited column \"%s\"",
 						colName)));
 
+	/* Nor columns the rows are sorted on */
+	if (RelationIsAppendOptimized(rel) &&
+		RelationGetAppendOnlySortKey(rel) != NULL &&
+		AppendOnlySortKey_HasColumn(RelationGetAppendOnlySortKey(rel),
+									colName))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot alter type of sort key column \"%s\"",
+						colName)));
+
 	/* Look up the target type */
 	typenameTypeIdAndMod(NULL, typeName, &targettype, &targettypmod);
 
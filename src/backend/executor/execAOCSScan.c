@@ -14,11 +14,185 @@
  */
 #include "postgres.h"
 
+#include "access/nbtree.h"
+#include "catalog/pg_am.h"
+#include "catalog/pg_proc.h"
+#include "catalog/pg_type.h"
+#include "commands/defrem.h"
+#include "optimizer/clauses.h"
+#include "utils/guc.h"
+#include "utils/lsyscache.h"
 #include "utils/snapmgr.h"
 #include "executor/executor.h"
 #include "nodes/execnodes.h"
 #include "cdb/cdbaocsam.h"
 
+/*
+ * If 'opexpr' has the form "column op constant", or "constant op column",
+ * with a non-NULL constant and a column of the scanned relation, return the
+ * column and the constant, and in *opno the operator as if the column were on
+ * the left. A binary-compatible cast of the column is looked through when
+ * 'relabel' is set.
+ */
+static bool
+ExtractAOCSVarOpConst(Scan *plan, TupleDesc tupdesc, OpExpr *opexpr,
+					  bool relabel, Var **var, Const **con, Oid *opno)
+{
+	Node	   *leftop;
+	Node	   *rightop;
+
+	if (!IsA(opexpr, OpExpr) || list_length(opexpr->args) != 2)
+		return false;
+
+	leftop = (Node *) linitial(opexpr->args);
+	rightop = (Node *) lsecond(opexpr->args);
+	*opno = opexpr->opno;
+
+	if (relabel && IsA(rightop, RelabelType))
+		rightop = (Node *) ((RelabelType *) rightop)->arg;
+	if (IsA(leftop, Const) && IsA(rightop, Var))
+	{
+		Node	   *tmp = leftop;
+
+		leftop = rightop;
+		rightop = tmp;
+		*opno = get_commutator(*opno);
+		if (!OidIsValid(*opno))
+			return false;
+	}
+	if (relabel && IsA(leftop, RelabelType))
+		leftop = (Node *) ((RelabelType *) leftop)->arg;
+	if (!IsA(leftop, Var) || !IsA(rightop, Const))
+		return false;
+
+	*var = (Var *) leftop;
+	*con = (Const *) rightop;
+	if ((*var)->varno != plan->scanrelid || (*var)->varlevelsup != 0 ||
+		(*var)->varattno <= 0 || (*var)->varattno > tupdesc->natts ||
+		(*con)->constisnull)
+		return false;
+
+	return true;
+}
+
+/*
+ * Turn the quals of the scan that have the form "column op constant", where
+ * op is a btree comparison operator of the column's type, into scan keys for
+ * aocs_set_zonemap_keys(). Only pass-by-value columns keep zone maps.
+ */
+static void
+InitAOCSZonemapKeys(ScanState *scanState, AOCSScanOpaqueData *opaque)
+{
+	Scan	   *plan = (Scan *) scanState->ps.plan;
+	TupleDesc	tupdesc = scanState->ss_currentRelation->rd_att;
+	ListCell   *lc;
+
+	opaque->nzonemapkeys = 0;
+	opaque->zonemapkeys = NULL;
+
+	foreach(lc, plan->plan.qual)
+	{
+		Var		   *var;
+		Const	   *con;
+		Oid			opno;
+		Oid			typid;
+		Oid			opclass;
+		Oid			opfamily;
+		Oid			lefttype;
+		Oid			righttype;
+		Oid			cmpproc;
+		int			strategy;
+
+		if (!ExtractAOCSVarOpConst(plan, tupdesc, (OpExpr *) lfirst(lc), false,
+								   &var, &con, &opno))
+			continue;
+
+		typid = tupdesc->attrs[var->varattno - 1]->atttypid;
+		if (!tupdesc->attrs[var->varattno - 1]->attbyval ||
+			var->vartype != typid)
+			continue;
+
+		opclass = GetDefaultOpClass(typid, BTREE_AM_OID);
+		if (!OidIsValid(opclass))
+			continue;
+		opfamily = get_opclass_family(opclass);
+
+		if (!op_in_opfamily(opno, opfamily))
+			continue;
+		get_op_opfamily_properties(opno, opfamily, false,
+								   &strategy, &lefttype, &righttype);
+		if (lefttype != typid)
+			continue;
+
+		cmpproc = get_opfamily_proc(opfamily, lefttype, righttype, BTORDER_PROC);
+		if (!RegProcedureIsValid(cmpproc))
+			continue;
+
+		if (opaque->zonemapkeys == NULL)
+			opaque->zonemapkeys = (ScanKey)
+				palloc(sizeof(ScanKeyData) * list_length(plan->plan.qual));
+
+		ScanKeyInit(&opaque->zonemapkeys[opaque->nzonemapkeys++],
+					var->varattno,
+					strategy,
+					cmpproc,
+					con->constvalue);
+	}
+}
+
+/*
+ * Turn the quals of the scan that have the form "column op constant" on a
+ * variable-length column, where op is strict and immutable, into scan keys
+ * for aocs_set_dictionary_keys(). Blocks of such columns may be dictionary
+ * encoded, and then the quals are evaluated once per distinct value.
+ */
+static void
+InitAOCSDictionaryKeys(ScanState *scanState, AOCSScanOpaqueData *opaque)
+{
+	Scan	   *plan = (Scan *) scanState->ps.plan;
+	TupleDesc	tupdesc = scanState->ss_currentRelation->rd_att;
+	ListCell   *lc;
+
+	opaque->ndictionarykeys = 0;
+	opaque->dictionarykeys = NULL;
+
+	foreach(lc, plan->plan.qual)
+	{
+		OpExpr	   *opexpr = (OpExpr *) lfirst(lc);
+		Var		   *var;
+		Const	   *con;
+		Oid			opno;
+		RegProcedure opproc;
+
+		if (!ExtractAOCSVarOpConst(plan, tupdesc, opexpr, true,
+								   &var, &con, &opno))
+			continue;
+
+		if (tupdesc->attrs[var->varattno - 1]->attlen != -1)
+			continue;
+
+		opproc = get_opcode(opno);
+		if (!RegProcedureIsValid(opproc) ||
+			!op_strict(opno) ||
+			func_volatile(opproc) != PROVOLATILE_IMMUTABLE ||
+			get_func_rettype(opproc) != BOOLOID)
+			continue;
+
+		if (opaque->dictionarykeys == NULL)
+			opaque->dictionarykeys = (ScanKey)
+				palloc(sizeof(ScanKeyData) * list_length(plan->plan.qual));
+
+		ScanKeyEntryInitialize(&opaque->dictionarykeys[opaque->ndictionarykeys++],
+							   0,
+							   var->varattno,
+							   InvalidStrategy,
+							   InvalidOid,
+							   opexpr->inputcollid,
+							   opproc,
+							   con->constvalue);
+	}
+}
+
 static void
 InitAOCSScanOpaque(ScanState *scanState)
 {
@@ -53,6 +227,50 @@ InitAOCSScanOpaque(ScanState *scanState)
 	{
 		opaque->proj[0] = true;
 	}
+
+	if (gp_appendonly_zonemap_skip)
+		InitAOCSZonemapKeys(scanState, opaque);
+	else
+	{
+		opaque->nzonemapkeys = 0;
+		opaque->zonemapkeys = NULL;
+	}
+
+	InitAOCSDictionaryKeys(scanState, opaque);
+
+	/*
+	 * Let the scan evaluate the quals on their own columns, and read the
+	 * other columns only for the rows that pass. The quals are evaluated
+	 * again by ExecScan, so they must be free of side effects.
+	 */
+	opaque->filter_proj = NULL;
+	if (gp_appendonly_late_materialization &&
+		scanState->ps.qual != NIL &&
+		!contain_volatile_functions((Node *) scanState->ps.plan->qual) &&
+		!contain_subplans((Node *) scanState->ps.plan->qual))
+	{
+		opaque->filter_proj = palloc0(sizeof(bool) * opaque->ncol);
+		GetNeededColumnsForScan((Node *) scanState->ps.plan->qual,
+								opaque->filter_proj, opaque->ncol);
+	}
+}
+
+/*
+ * Row filter for aocs_set_filter(): evaluate the quals of the scan on the
+ * row stored in the scan tuple slot.
+ */
+static bool
+AOCSScanFilterQual(void *arg)
+{
+	ScanState  *scanState = (ScanState *) arg;
+	ExprContext *econtext = scanState->ps.ps_ExprContext;
+	bool		result;
+
+	econtext->ecxt_scantuple = scanState->ss_ScanTupleSlot;
+	result = ExecQual(scanState->ps.qual, econtext, false);
+	ResetExprContext(econtext);
+
+	return result;
 }
 
 static void
@@ -64,6 +282,12 @@ FreeAOCSScanOpaque(ScanState *scanState)
 	AOCSScanOpaqueData *opaque = (AOCSScanOpaqueData *)state->opaque;
 	Assert(opaque->proj != NULL);
 	pfree(opaque->proj);
+	if (opaque->zonemapkeys != NULL)
+		pfree(opaque->zonemapkeys);
+	if (opaque->dictionarykeys != NULL)
+		pfree(opaque->dictionarykeys);
+	if (opaque->filter_proj != NULL)
+		pfree(opaque->filter_proj);
 	pfree(state->opaque);
 	state->opaque = NULL;
 }
@@ -111,6 +335,23 @@ BeginScanAOCSRelation(ScanState *scanState)
 					   NULL /* relationTupleDesc */,
 					   node->opaque->proj);
 
+	if (node->opaque->nzonemapkeys > 0)
+		aocs_set_zonemap_keys(node->opaque->scandesc,
+							  node->opaque->nzonemapkeys,
+							  node->opaque->zonemapkeys);
+
+	if (node->opaque->ndictionarykeys > 0)
+		aocs_set_dictionary_keys(node->opaque->scandesc,
+								 node->opaque->ndictionarykeys,
+								 node->opaque->dictionarykeys);
+
+	if (node->opaque->filter_proj != NULL)
+		aocs_set_filter(node->opaque->scandesc,
+						node->opaque->filter_proj,
+						AOCSScanFilterQual,
+						scanState,
+						node->ss.ss_ScanTupleSlot);
+
 	node->ss.scan_state = SCAN_SCAN;
 }
  
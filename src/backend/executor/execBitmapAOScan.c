@@ -23,6 +23,7 @@
 #include "executor/nodeBitmapAppendOnlyscan.h"
 #include "miscadmin.h"
 #include "nodes/tidbitmap.h"
+#include "optimizer/var.h"
 #include "parser/parsetree.h"
 #include "pgstat.h"
 #include "utils/memutils.h"
@@ -57,6 +58,15 @@ BitmapAOScanBegin(ScanState *scanState)
 		appendOnlyMetaDataSnapshot = GetTransactionSnapshot();
 	}
 
+	/*
+	 * When the target list and the qual reference no column at all, as in
+	 * SELECT count(*), the rows of exact bitmap pages need not be read; it
+	 * is enough to check that they exist and are visible.
+	 */
+	node->noColumnsNeeded =
+		!contain_var_clause((Node *) node->ss.ps.plan->targetlist) &&
+		!contain_var_clause((Node *) node->ss.ps.plan->qual);
+
 	if (scanState->tableType == TableTypeAppendOnly)
 	{
 		node->scanDesc =
@@ -249,6 +259,35 @@ BitmapAOScanNext(ScanState *scanState)
 
 		tbm_convert_appendonly_tid_out(&psudeoHeapTid, &aoTid);
 
+		/*
+		 * If nothing needs the columns and the page needs no recheck, only
+		 * ask whether the row exists, which does not decompress its block,
+		 * and return a row of NULLs in its place.
+		 */
+		if (node->noColumnsNeeded &&
+			!node->isLossyBitmapPage && !node->recheckTuples)
+		{
+			bool		found;
+
+			if (scanState->tableType == TableTypeAppendOnly)
+				found = appendonly_fetch((AppendOnlyFetchDesc)node->scanDesc, &aoTid, NULL);
+			else
+			{
+				Assert(scanState->tableType == TableTypeAOCS);
+				found = aocs_fetch((AOCSFetchDesc)node->scanDesc, &aoTid, NULL);
+			}
+
+			if (!found)
+				continue;
+
+			ExecStoreAllNullTuple(slot);
+			slot_set_ctid(slot, (ItemPointer) &aoTid);
+
+			pgstat_count_heap_fetch(node->ss.ss_currentRelation);
+
+			return slot;
+		}
+
 		if (scanState->tableType == TableTypeAppendOnly)
 		{
 			appendonly_fetch((AppendOnlyFetchDesc)node->scanDesc, &aoTid, slot);
@@ -934,6 +934,7 @@ agg_hash_initial_pass(AggState *aggstate)
 				   aggstate->numaggs * sizeof(AggStatePerGroupData));
 			initialize_aggregates(aggstate, aggstate->peragg, hashtable->groupaggs->aggs,
 								  &(aggstate->mem_manager));
+			hashtable->num_stream_groups++;
 		}
 			
 		/* Advance the aggregates */
@@ -944,6 +945,27 @@ agg_hash_initial_pass(AggState *aggstate)
 		/* Reset per-input-tuple context after each tuple */
 		ResetExprContext(tmpcontext);
 
+		/*
+		 * The bottom stage of a two stage aggregation only pays off if it
+		 * folds many input rows into each group. Once we have seen
+		 * gp_hashagg_stream_bypass_rows rows, check how well it did; if most
+		 * rows formed a group of their own, return what we have and let the
+		 * caller pass the remaining rows through without grouping them.
+		 */
+		if (streaming && gp_hashagg_stream_bypass_rows > 0 &&
+			hashtable->num_tuples == (uint64) gp_hashagg_stream_bypass_rows &&
+			hashtable->num_stream_groups >
+			hashtable->num_tuples * gp_hashagg_stream_bypass_ratio)
+		{
+			Assert(tuple_remaining);
+			elog(HHA_MSG_LVL, "HashAgg: " INT64_FORMAT " groups from " INT64_FORMAT
+				 " input tuples, bypassing the hash table from now on.",
+				 hashtable->num_stream_groups, hashtable->num_tuples);
+			hashtable->stream_bypass = true;
+			ExecClearTuple(aggstate->hashslot);
+			break;
+		}
+
 		if (streaming && !HAVE_FREESPACE(hashtable))
 		{
 			Assert(tuple_remaining);
@@ -1675,6 +1697,22 @@ agg_hash_stream(AggState *aggstate)
 	return agg_hash_initial_pass(aggstate);
 }
 
+/*
+ * Function: agg_hash_begin_bypass
+ *
+ * Called when a streaming hashed aggregation has returned the groups
+ * in its hash table and starts to pass input tuples through one by one
+ * (see agg_hash_initial_pass). Free the groups; from now on the group
+ * buffer only holds the transition values of the current input tuple.
+ */
+void
+agg_hash_begin_bypass(AggState *aggstate)
+{
+	Assert(aggstate->hhashtable->stream_bypass);
+
+	reset_agg_hash_table(aggstate, 0 /* don't reallocate buckets */);
+}
+
 /*
  * Function: agg_hash_load
  *
@@ -2092,6 +2130,17 @@ agg_hash_explain(AggState *aggstate)
 		appendStringInfo(hbuf, ".\n");
 	}
 
+	/* If streaming gave up grouping */
+	if (hashtable->stream_bypass)
+	{
+		appendStringInfo(hbuf,
+				INT64_FORMAT " groups from the first " INT64_FORMAT " input rows"
+				"; passed " INT64_FORMAT " rows through without grouping.\n",
+				hashtable->num_stream_groups,
+				hashtable->num_tuples,
+				hashtable->num_bypass_tuples);
+	}
+
 	/* Hash chain statistics */
 	if (hashtable->chainlength.vcnt > 0)
 	{
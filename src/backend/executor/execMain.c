@@ -40,6 +40,7 @@
 #include "postgres.h"
 
 #include "access/aosegfiles.h"
+#include "access/appendonly_sortkey.h"
 #include "access/appendonlywriter.h"
 #include "access/fileam.h"
 #include "access/sysattr.h"
@@ -2282,6 +2283,7 @@ InitResultRelInfo(ResultRelInfo *resultRelInfo,
 	resultRelInfo->ri_projectReturning = NULL;
 	resultRelInfo->ri_aoInsertDesc = NULL;
 	resultRelInfo->ri_aocsInsertDesc = NULL;
+	resultRelInfo->ri_aoSort = NULL;
 	resultRelInfo->ri_extInsertDesc = NULL;
 	resultRelInfo->ri_deleteDesc = NULL;
 	resultRelInfo->ri_updateDesc = NULL;
@@ -2364,6 +2366,116 @@ CloseResultRelInfo(ResultRelInfo *resultRelInfo)
 	}
 }
 
+/*
+ * ExecBeginAppendOnlySort
+ *
+ * Start collecting the rows that ExecInsert, or COPY, loads into an
+ * append-only relation with a sort key. Leaves ri_aoSort NULL if the rows
+ * cannot be sorted.
+ *
+ * All the sorts of a statement share its work_mem. A statement loading into
+ * a partitioned table may write to many leaf partitions, so each of its
+ * sorts gets a slice of work_mem, and once APPENDONLY_SORT_MAX_OPEN of them
+ * are open the oldest one is written out before another one starts. Its
+ * partition then gets more than one sorted run from the statement.
+ */
+void
+ExecBeginAppendOnlySort(EState *estate, ResultRelInfo *resultRelInfo)
+{
+	MemoryContext oldcxt;
+	int			workMem = work_mem;
+
+	Assert(resultRelInfo->ri_aoSort == NULL);
+
+	if (estate->es_result_partitions)
+	{
+		if (list_length(estate->es_aoSorts) >= APPENDONLY_SORT_MAX_OPEN)
+			ExecFlushAppendOnlySort(estate,
+									(ResultRelInfo *) linitial(estate->es_aoSorts));
+
+		workMem = Max(work_mem / APPENDONLY_SORT_MAX_OPEN, 64);
+	}
+
+	oldcxt = MemoryContextSwitchTo(estate->es_query_cxt);
+	resultRelInfo->ri_aoSort = AppendOnlySort_Begin(resultRelInfo->ri_RelationDesc,
+													workMem);
+	if (resultRelInfo->ri_aoSort)
+		estate->es_aoSorts = lappend(estate->es_aoSorts, resultRelInfo);
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * ExecFlushAppendOnlySort
+ *
+ * Write out the rows that ExecInsert, or COPY, collected for an append-only
+ * relation with a sort key, in sort key order, and insert their index
+ * entries. Must be called before CloseResultRelInfo; recurses into the
+ * partitions.
+ *
+ * This may also happen in the middle of a row, when ExecBeginAppendOnlySort
+ * makes room for another sort, so the rows are written using a per-tuple
+ * context of their own, leaving that of the current row alone.
+ */
+void
+ExecFlushAppendOnlySort(EState *estate, ResultRelInfo *resultRelInfo)
+{
+	if (resultRelInfo->ri_aoSort)
+	{
+		Relation	rel = resultRelInfo->ri_RelationDesc;
+		ResultRelInfo *saveResultRelInfo = estate->es_result_relation_info;
+		ExprContext *saveExprContext = estate->es_per_tuple_exprcontext;
+		TupleTableSlot *slot;
+		ItemPointerData tid;
+
+		slot = MakeSingleTupleTableSlot(RelationGetDescr(rel));
+		estate->es_result_relation_info = resultRelInfo;
+		estate->es_per_tuple_exprcontext = NULL;
+
+		while (AppendOnlySort_Next(resultRelInfo->ri_aoSort, slot))
+		{
+			CHECK_FOR_INTERRUPTS();
+
+			ResetPerTupleExprContext(estate);
+
+			if (RelationIsAoRows(rel))
+			{
+				MemTuple	mtuple = ExecFetchSlotMemTuple(slot, false);
+
+				appendonly_insert(resultRelInfo->ri_aoInsertDesc, mtuple,
+								  InvalidOid, (AOTupleId *) &tid);
+			}
+			else
+			{
+				Assert(RelationIsAoCols(rel));
+				aocs_insert(resultRelInfo->ri_aocsInsertDesc, slot);
+				tid = *slot_get_ctid(slot);
+			}
+
+			if (resultRelInfo->ri_NumIndices > 0)
+				list_free(ExecInsertIndexTuples(slot, &tid, estate));
+		}
+
+		AppendOnlySort_End(resultRelInfo->ri_aoSort);
+		resultRelInfo->ri_aoSort = NULL;
+		estate->es_aoSorts = list_delete_ptr(estate->es_aoSorts, resultRelInfo);
+		ExecDropSingleTupleTableSlot(slot);
+		if (estate->es_per_tuple_exprcontext)
+			FreeExprContext(estate->es_per_tuple_exprcontext, true);
+		estate->es_per_tuple_exprcontext = saveExprContext;
+		estate->es_result_relation_info = saveResultRelInfo;
+	}
+
+	if (resultRelInfo->ri_partition_hash)
+	{
+		HASH_SEQ_STATUS hash_seq_status;
+		ResultPartHashEntry *entry;
+
+		hash_seq_init(&hash_seq_status, resultRelInfo->ri_partition_hash);
+		while ((entry = hash_seq_search(&hash_seq_status)) != NULL)
+			ExecFlushAppendOnlySort(estate, &entry->resultRelInfo);
+	}
+}
+
 /*
  * ResultRelInfoSetSegno
  *
@@ -2708,6 +2820,14 @@ ExecEndPlan(PlanState *planstate, EState *estate)
 	 */
 	ExecResetTupleTable(estate->es_tupleTable, false);
 
+	/* Write out the rows held back for AO tables with a sort key */
+	resultRelInfo = estate->es_result_relations;
+	for (i = 0; i < estate->es_num_result_relations; i++)
+	{
+		ExecFlushAppendOnlySort(estate, resultRelInfo);
+		resultRelInfo++;
+	}
+
 	/* Report how many tuples we may have inserted into AO tables */
 	SendAOTupCounts(estate);
 
@@ -152,6 +152,8 @@ CreateExecutorState(void)
 	estate->es_result_relation_info = NULL;
 
 	estate->es_trig_target_relations = NIL;
+
+	estate->es_aoSorts = NIL;
 	estate->es_trig_tuple_slot = NULL;
 	estate->es_trig_oldtup_slot = NULL;
 	estate->es_trig_newtup_slot = NULL;
@@ -190,6 +190,7 @@ static bool find_unaggregated_cols_walker(Node *node, Bitmapset **colnos);
 static void clear_agg_object(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_direct(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table(AggState *aggstate);
+static TupleTableSlot *agg_retrieve_stream_bypass(AggState *aggstate);
 static void ExecAggExplainEnd(PlanState *planstate, struct StringInfoData *buf);
 
 
@@ -1157,7 +1158,8 @@ ExecAgg(AggState *node)
 		 */
 		for (;;)
 		{
-			if (!node->hhashtable->is_spilling)
+			if (!node->hhashtable->is_spilling &&
+				node->hashaggstatus != HASHAGG_STREAM_BYPASS)
 			{
 				tuple = agg_retrieve_hash_table(node);
 				node->agg_done = false; /* Not done 'til batches used up. */
@@ -1193,10 +1195,23 @@ ExecAgg(AggState *node)
 
 				case HASHAGG_STREAMING:
 					Assert(streaming);
-					if (!agg_hash_stream(node))
+					if (node->hhashtable->stream_bypass)
+					{
+						agg_hash_begin_bypass(node);
+						node->hashaggstatus = HASHAGG_STREAM_BYPASS;
+					}
+					else if (!agg_hash_stream(node))
 						node->hashaggstatus = HASHAGG_END_OF_PASSES;
 					continue;
 
+				case HASHAGG_STREAM_BYPASS:
+					Assert(streaming);
+					tuple = agg_retrieve_stream_bypass(node);
+					if (tuple != NULL)
+						return tuple;
+					node->hashaggstatus = HASHAGG_END_OF_PASSES;
+					continue;
+
 				case HASHAGG_BEFORE_FIRST_PASS:
 				default:
 					elog(ERROR, "hybrid hash aggregation sequencing error");
@@ -1807,6 +1822,96 @@ agg_retrieve_hash_table(AggState *aggstate)
 	return NULL;
 }
 
+/*
+ * ExecAgg for a streaming hashed Agg that has stopped grouping: aggregate
+ * each input tuple as a group of its own and return it right away.
+ */
+static TupleTableSlot *
+agg_retrieve_stream_bypass(AggState *aggstate)
+{
+	ExprContext *econtext;
+	ExprContext *tmpcontext;
+	Datum	   *aggvalues;
+	bool	   *aggnulls;
+	AggStatePerAgg peragg;
+	AggStatePerGroup perpassthru;
+	TupleTableSlot *outerslot;
+	MPool	   *group_buf;
+	int			aggno;
+	Agg		   *node = (Agg *) aggstate->ss.ps.plan;
+	bool        input_has_grouping = node->inputHasGrouping;
+	bool        is_final_rollup_agg =
+		(node->lastAgg ||
+		 (input_has_grouping && node->numNullCols == 0));
+
+	Assert(node->streaming && aggstate->hhashtable->stream_bypass);
+
+	econtext = aggstate->ss.ps.ps_ExprContext;
+	tmpcontext = aggstate->tmpcontext;
+	aggvalues = econtext->ecxt_aggvalues;
+	aggnulls = econtext->ecxt_aggnulls;
+	peragg = aggstate->peragg;
+	perpassthru = aggstate->perpassthru;
+	group_buf = aggstate->hhashtable->group_buf;
+
+	for (;;)
+	{
+		outerslot = ExecProcNode(outerPlanState(aggstate));
+		if (TupIsNull(outerslot))
+			return NULL;
+
+		aggstate->hhashtable->num_bypass_tuples++;
+
+		ResetExprContext(econtext);
+
+		/*
+		 * Pass-by-ref transition values are allocated from the hash table's
+		 * group buffer. The tuple we returned last time is no longer
+		 * referenced, so release them once in a while.
+		 */
+		if (mpool_bytes_used(group_buf) > 64 * 1024)
+			mpool_reset(group_buf);
+
+		initialize_aggregates(aggstate, peragg, perpassthru, &(aggstate->mem_manager));
+
+		ResetExprContext(tmpcontext);
+		tmpcontext->ecxt_outertuple = outerslot;
+		advance_aggregates(aggstate, perpassthru, &(aggstate->mem_manager));
+
+		for (aggno = 0; aggno < aggstate->numaggs; aggno++)
+		{
+			AggStatePerAgg peraggstate = &peragg[aggno];
+			AggStatePerGroup pergroupstate = &perpassthru[aggno];
+
+			Assert(peraggstate->numSortCols == 0);
+			finalize_aggregate(aggstate, peraggstate, pergroupstate,
+							   &aggvalues[aggno], &aggnulls[aggno]);
+		}
+
+		econtext->ecxt_outertuple = outerslot;
+
+		if (is_final_rollup_agg && input_has_grouping)
+		{
+			econtext->group_id =
+				get_grouping_groupid(econtext->ecxt_outertuple,
+					 node->grpColIdx[node->numCols - node->numNullCols - 1]);
+			econtext->grouping =
+				get_grouping_groupid(econtext->ecxt_outertuple,
+					 node->grpColIdx[node->numCols - node->numNullCols - 2]);
+		}
+		else
+		{
+			econtext->group_id = node->rollupGSTimes;
+			econtext->grouping = node->grouping;
+		}
+
+		if (ExecQual(aggstate->ss.ps.qual, econtext, false))
+			return ExecProject(aggstate->ss.ps.ps_ProjInfo, NULL);
+		else
+			InstrCountFiltered1(aggstate, 1);
+	}
+}
+
 /* -----------------
  * ExecInitAgg
  *
@@ -2427,7 +2532,7 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 	/* ROLLUP */
 	aggstate->perpassthru = NULL;
 
-	if (node->inputHasGrouping)
+	if (node->inputHasGrouping || node->streaming)
 	{
 		AggStatePerGroup perpassthru;
 
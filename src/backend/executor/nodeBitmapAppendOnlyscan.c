@@ -35,6 +35,7 @@
 #include "executor/nodeBitmapAppendOnlyscan.h"
 #include "miscadmin.h"
 #include "nodes/tidbitmap.h"
+#include "optimizer/var.h"
 #include "parser/parsetree.h"
 #include "pgstat.h"
 #include "utils/memutils.h"
@@ -327,8 +328,7 @@ BitmapAppendOnlyScanNext(BitmapAppendOnlyScanState *node)
 			continue;
 		}
 
-		if (node->baos_lossy || tbmres->recheck)
-			need_recheck = true;
+		need_recheck = (node->baos_lossy || tbmres->recheck);
 
 		/*
 		 * Must account for lossy page info...
@@ -359,6 +359,34 @@ BitmapAppendOnlyScanNext(BitmapAppendOnlyScanState *node)
 
 		tbm_convert_appendonly_tid_out(&psudeoHeapTid, &aoTid);
 
+		/*
+		 * If nothing needs the columns and the page needs no recheck, only
+		 * ask whether the row exists, which does not decompress its block,
+		 * and return a row of NULLs in its place.
+		 */
+		if (node->baos_nocolumns && !need_recheck)
+		{
+			bool		found;
+
+			if (aoFetchDesc != NULL)
+				found = appendonly_fetch(aoFetchDesc, &aoTid, NULL);
+			else
+			{
+				Assert(aocsFetchDesc != NULL);
+				found = aocs_fetch(aocsFetchDesc, &aoTid, NULL);
+			}
+
+			if (!found)
+				continue;
+
+			ExecStoreAllNullTuple(slot);
+			slot_set_ctid(slot, (ItemPointer) &aoTid);
+
+			pgstat_count_heap_fetch(node->ss.ss_currentRelation);
+
+			return slot;
+		}
+
 		if (aoFetchDesc != NULL)
 		{
 			appendonly_fetch(aoFetchDesc, &aoTid, slot);
@@ -553,6 +581,15 @@ ExecInitBitmapAppendOnlyScan(BitmapAppendOnlyScan *node, EState *estate, int efl
 	scanstate->baos_cindex = 0;
 	scanstate->baos_ntuples = 0;
 
+	/*
+	 * When the target list and the qual reference no column at all, as in
+	 * SELECT count(*), the rows of exact bitmap pages need not be read; it
+	 * is enough to check that they exist and are visible.
+	 */
+	scanstate->baos_nocolumns =
+		!contain_var_clause((Node *) node->scan.plan.targetlist) &&
+		!contain_var_clause((Node *) node->scan.plan.qual);
+
 	/*
 	 * Miscellaneous initialization
 	 *
@@ -49,6 +49,7 @@
 #include "utils/rel.h"
 #include "utils/tqual.h"
 
+#include "access/appendonly_sortkey.h"
 #include "access/fileam.h"
 #include "access/transam.h"
 #include "cdb/cdbaocsam.h"
@@ -398,6 +399,21 @@ ExecInsert(TupleTableSlot *parentslot,
 		if (resultRelationDesc->rd_att->constr)
 			ExecConstraints(resultRelInfo, slot, estate);
 
+		/*
+		 * An append-only table with a sort key gets the rows of the
+		 * statement in sort key order: they are collected here, and written
+		 * out by ExecFlushAppendOnlySort when the statement ends. Not when
+		 * AFTER ROW triggers or RETURNING need the row to be inserted now.
+		 */
+		if ((rel_is_aorows || rel_is_aocols) &&
+			resultRelInfo->ri_aoSort == NULL &&
+			!isUpdate &&
+			!projectReturning &&
+			!(resultRelInfo->ri_TrigDesc &&
+			  resultRelInfo->ri_TrigDesc->trig_insert_after_row) &&
+			RelationGetAppendOnlySortKey(resultRelationDesc) != NULL)
+			ExecBeginAppendOnlySort(estate, resultRelInfo);
+
 		/*
 		 * insert the tuple
 		 *
@@ -406,7 +422,14 @@ ExecInsert(TupleTableSlot *parentslot,
 		 *
 		 * NOTE: for append-only relations we use the append-only access methods.
 		 */
-		if (rel_is_aorows)
+		if (resultRelInfo->ri_aoSort)
+		{
+			AppendOnlySort_Put(resultRelInfo->ri_aoSort, slot);
+			newId = InvalidOid;
+			ItemPointerSetInvalid(&lastTid);
+			(resultRelInfo->ri_aoprocessed)++;
+		}
+		else if (rel_is_aorows)
 		{
 			MemTuple	mtuple;
 
@@ -481,7 +504,7 @@ ExecInsert(TupleTableSlot *parentslot,
 		/*
 		 * insert index entries for tuple
 		 */
-		if (resultRelInfo->ri_NumIndices > 0)
+		if (resultRelInfo->ri_NumIndices > 0 && !resultRelInfo->ri_aoSort)
 			recheckIndexes = ExecInsertIndexTuples(slot, &lastTid,
 												   estate);
 	}
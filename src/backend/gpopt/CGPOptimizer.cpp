@@ -15,6 +15,7 @@
 
 #include "gpopt/CGPOptimizer.h"
 #include "gpopt/utils/COptTasks.h"
+#include "gpopt/translate/CStatsBucketCache.h"
 
 // the following headers are needed to reference optimizer library initializers
 #include "naucrates/init.h"
@@ -164,6 +165,7 @@ CGPOptimizer::InitGPOPT ()
 void
 CGPOptimizer::TerminateGPOPT ()
 {
+  gpdxl::CStatsBucketCache::Shutdown();
   gpopt_terminate();
   gpdxl_terminate();
   gpos_terminate();
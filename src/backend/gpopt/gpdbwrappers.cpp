@@ -28,10 +28,14 @@
 
 #include "naucrates/exception.h"
 
+#include "naucrates/md/IMDId.h"
+
 #include "gpopt/gpdbwrappers.h"
 #include "catalog/pg_collation.h"
 
 #include "utils/ext_alloc.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
 
 #define GP_WRAP_START	\
 	sigjmp_buf local_sigjmp_buf;	\
@@ -613,6 +617,22 @@ gpdb::ExtractNodesPlan
 	return NIL;
 }
 
+Bitmapset *
+gpdb::ExtractPlanParamIds
+	(
+	Plan *pl,
+	Plan **known,
+	int num_known
+	)
+{
+	GP_WRAP_START;
+	{
+		return extract_plan_paramids(pl, known, num_known);
+	}
+	GP_WRAP_END;
+	return NULL;
+}
+
 List *
 gpdb::ExtractNodesExpression
 	(
@@ -1024,22 +1044,125 @@ gpdb::GetCheckConstraintOids
 	return NULL;
 }
 
+// part constraints merged in the current optimization, by relation: the
+// relation and each of its partitioned indexes need the same one. NULL
+// outside of an optimization.
+typedef struct PartConstraintCacheEntry
+{
+	Oid			rel_oid;
+	Node	   *part_constraint;
+} PartConstraintCacheEntry;
+
+static HTAB *part_constraint_cache = NULL;
+static MemoryContext part_constraint_cache_cxt = NULL;
+
+// start reusing the part constraints merged from here on
+void
+gpdb::StartPartConstraintCache
+	(
+	void
+	)
+{
+	GP_WRAP_START;
+	{
+		HASHCTL		hash_ctl;
+
+		EndPartConstraintCache();
+
+		part_constraint_cache_cxt = AllocSetContextCreate(TopMemoryContext,
+														  "ORCA part constraints",
+														  ALLOCSET_SMALL_MINSIZE,
+														  ALLOCSET_SMALL_INITSIZE,
+														  ALLOCSET_DEFAULT_MAXSIZE);
+
+		MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+		hash_ctl.keysize = sizeof(Oid);
+		hash_ctl.entrysize = sizeof(PartConstraintCacheEntry);
+		hash_ctl.hash = oid_hash;
+		hash_ctl.hcxt = part_constraint_cache_cxt;
+
+		part_constraint_cache = hash_create("ORCA part constraints", 16, &hash_ctl,
+											HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+		return;
+	}
+	GP_WRAP_END;
+}
+
+// forget the part constraints merged since StartPartConstraintCache
+void
+gpdb::EndPartConstraintCache
+	(
+	void
+	)
+{
+	// No GP_WRAP_START/END needed here, deleting a memory context cannot
+	// throw an ereport().
+	part_constraint_cache = NULL;
+	if (NULL != part_constraint_cache_cxt)
+	{
+		MemoryContextDelete(part_constraint_cache_cxt);
+		part_constraint_cache_cxt = NULL;
+	}
+}
+
 Node *
 gpdb::GetRelationPartContraints
 	(
-	Oid rel_oid,
-	List **default_levels
+	Oid rel_oid
 	)
 {
 	GP_WRAP_START;
 	{
+		PartConstraintCacheEntry *entry;
+		List	   *default_levels = NIL;
+		Node	   *part_constraint;
+		bool		found;
+
+		if (NULL != part_constraint_cache)
+		{
+			entry = (PartConstraintCacheEntry *) hash_search(part_constraint_cache, &rel_oid, HASH_FIND, NULL);
+			if (NULL != entry)
+			{
+				return entry->part_constraint;
+			}
+		}
+
 		/* catalog tables: pg_partition, pg_partition_rule, pg_constraint */
-		return get_relation_part_constraints(rel_oid, default_levels);
+		part_constraint = get_relation_part_constraints(rel_oid, &default_levels);
+		list_free(default_levels);
+
+		if (NULL == part_constraint_cache)
+		{
+			return part_constraint;
+		}
+
+		MemoryContext oldcxt = MemoryContextSwitchTo(part_constraint_cache_cxt);
+		part_constraint = (Node *) copyObject(part_constraint);
+		MemoryContextSwitchTo(oldcxt);
+
+		entry = (PartConstraintCacheEntry *) hash_search(part_constraint_cache, &rel_oid, HASH_ENTER, &found);
+		entry->part_constraint = part_constraint;
+		return part_constraint;
 	}
 	GP_WRAP_END;
 	return NULL;
 }
 
+List *
+gpdb::GetRelationPartDefaultLevels
+	(
+	Oid rel_oid
+	)
+{
+	GP_WRAP_START;
+	{
+		/* catalog tables: pg_partition, pg_partition_rule */
+		return rel_partition_default_levels(rel_oid);
+	}
+	GP_WRAP_END;
+	return NIL;
+}
+
 bool
 gpdb::HasExternalPartition
 	(
@@ -2939,6 +3062,50 @@ gpdb::EvaluateExpr
 	return NULL;
 }
 
+// Creates a context to evaluate many constant expressions in, which
+// remembers their results until it is freed
+ConstExprEvalContext *
+gpdb::CreateConstExprEvalContext()
+{
+	GP_WRAP_START;
+	{
+		return ::CreateConstExprEvalContext();
+	}
+	GP_WRAP_END;
+	return NULL;
+}
+
+// Evaluates the expressions in 'exprs' and returns their results as a list of
+// Consts. Caller keeps ownership of 'exprs' and takes ownership of the result
+List *
+gpdb::EvaluateExprs
+	(
+	ConstExprEvalContext *cxt,
+	List *exprs
+	)
+{
+	GP_WRAP_START;
+	{
+		return evaluate_exprs(cxt, exprs);
+	}
+	GP_WRAP_END;
+	return NIL;
+}
+
+void
+gpdb::FreeConstExprEvalContext
+	(
+	ConstExprEvalContext *cxt
+	)
+{
+	GP_WRAP_START;
+	{
+		::FreeConstExprEvalContext(cxt);
+		return;
+	}
+	GP_WRAP_END;
+}
+
 // interpret the value of "With oids" option from a list of defelems
 bool
 gpdb::InterpretOidsOption
@@ -3044,16 +3211,35 @@ gpdb::CountLeafPartTables
 }
 
 /*
- * To detect changes to catalog tables that require resetting the Metadata
- * Cache, we use the normal PostgreSQL catalog cache invalidation mechanism.
- * We register a callback to a cache on all the catalog tables that contain
- * information that's contained in the ORCA metadata cache.
-
- * There is no fine-grained mechanism in the metadata cache for invalidating
- * individual entries ATM, so we just blow the whole cache whenever anything
- * changes. The callback simply increments a counter. Whenever we start
- * planning a query, we check the counter to see if it has changed since the
- * last planned query, and reset the whole cache if it has.
+ * To detect changes to catalog tables that affect the Metadata Cache, we use
+ * the normal PostgreSQL catalog cache invalidation mechanism. We register a
+ * callback to a cache on all the catalog tables that contain information
+ * that's contained in the ORCA metadata cache.
+ *
+ * Every object that the metadata provider hands to the cache is registered
+ * here, by its kind and the OID of the GPDB object it was built from (see
+ * MDCacheRegisterObject()). The callbacks only remember which relations and
+ * which syscache entries were invalidated. Whenever we start planning a
+ * query, MDCacheInvalidatedObjects() maps those to the registered objects,
+ * which are then evicted from the cache one by one. An invalidation that
+ * touches none of them, like creating a temporary table, analyzing a table
+ * that no query has planned, or creating a function, evicts nothing.
+ *
+ * A syscache callback only gets the hash value of the invalidated entry's
+ * key, so an object is considered invalidated when the hash of its own key
+ * matches. A hash collision merely evicts an object that was still valid.
+ *
+ * The whole cache is still reset when a syscache is flushed as a whole, when
+ * all relcache entries are invalidated, or when a catalog changes whose
+ * entries cannot be mapped to cache objects by OID: scalar comparisons and
+ * casts are looked up by their argument types, and partitioning information
+ * is spread over several catalogs. We also reset the whole cache if too many
+ * invalidations pile up between two queries.
+ *
+ * If optimizer_mdcache_shared_size is set, the objects are also shared with
+ * the other backends, see utils/cache/mdsharedcache.c. The shared objects
+ * are dropped by the backend that sends the invalidation messages, using
+ * the same syscache hash values (see mdcache_object_syscache_deps()).
  *
  * To make sure we've covered all catalog tables that contain information
  * that's stored in the metadata cache, there are "catalog tables: xxx"
@@ -3062,20 +3248,142 @@ gpdb::CountLeafPartTables
  * anything fetched via the wrapper functions in this file can end up in the
  * metadata cache and hence need to have an invalidation callback registered.
  */
-static bool mdcache_invalidation_counter_registered = false;
-static int64 mdcache_invalidation_counter = 0;
-static int64 last_mdcache_invalidation_counter = 0;
+#define MDCACHE_MAX_PENDING_INVALIDATIONS 10000
+
+/* A syscache entry invalidated since the last query was planned */
+typedef struct MDCacheSyscacheInval
+{
+	int			cacheid;
+	uint32		hashvalue;
+} MDCacheSyscacheInval;
+
+static bool mdcache_invalidation_callbacks_registered = false;
+static bool mdcache_reset_pending = false;
+
+/* registered cache objects, MDCacheObjectKey entries */
+static HTAB *mdcache_objects = NULL;
+
+/* pending invalidations: relation OIDs, and MDCacheSyscacheInval entries */
+static HTAB *mdcache_invalidated_rels = NULL;
+static HTAB *mdcache_invalidated_syscache = NULL;
+
+static HTAB *
+mdcache_create_hash(const char *name, Size keysize, long nelem)
+{
+	HASHCTL		hash_ctl;
+
+	MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+	hash_ctl.keysize = keysize;
+	hash_ctl.entrysize = keysize;
+	hash_ctl.hash = tag_hash;
+	hash_ctl.hcxt = TopMemoryContext;
+
+	return hash_create(name, nelem, &hash_ctl,
+					   HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+}
 
 static void
-mdsyscache_invalidation_counter_callback(Datum arg, int cacheid, uint32 hashvalue)
+mdcache_forget_invalidations(void)
 {
-	mdcache_invalidation_counter++;
+	if (mdcache_invalidated_rels != NULL)
+	{
+		hash_destroy(mdcache_invalidated_rels);
+		mdcache_invalidated_rels = NULL;
+	}
+	if (mdcache_invalidated_syscache != NULL)
+	{
+		hash_destroy(mdcache_invalidated_syscache);
+		mdcache_invalidated_syscache = NULL;
+	}
+}
+
+static long
+mdcache_pending_invalidations(void)
+{
+	long		n = 0;
+
+	if (mdcache_invalidated_rels != NULL)
+		n += hash_get_num_entries(mdcache_invalidated_rels);
+	if (mdcache_invalidated_syscache != NULL)
+		n += hash_get_num_entries(mdcache_invalidated_syscache);
+
+	return n;
 }
 
+/*
+ * Give up on tracking individual invalidations, and reset the whole cache
+ * before the next query is planned.
+ */
 static void
-mdrelcache_invalidation_counter_callback(Datum arg, Oid relid)
+mdcache_request_reset(void)
 {
-	mdcache_invalidation_counter++;
+	mdcache_reset_pending = true;
+	mdcache_forget_invalidations();
+}
+
+static bool
+mdsyscache_is_fine_grained(int cacheid)
+{
+	switch (cacheid)
+	{
+		case AGGFNOID:
+		case CONSTROID:
+		case PROCOID:
+		case STATRELATTINH:
+		case TYPEOID:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static void
+mdsyscache_invalidation_callback(Datum arg, int cacheid, uint32 hashvalue)
+{
+	MDCacheSyscacheInval inval;
+
+	if (mdcache_reset_pending)
+		return;
+
+	/* a hash value of 0 means that the whole syscache was flushed */
+	if (hashvalue == 0 || !mdsyscache_is_fine_grained(cacheid) ||
+		mdcache_pending_invalidations() >= MDCACHE_MAX_PENDING_INVALIDATIONS)
+	{
+		mdcache_request_reset();
+		return;
+	}
+
+	if (mdcache_invalidated_syscache == NULL)
+		mdcache_invalidated_syscache =
+			mdcache_create_hash("ORCA MD cache syscache invalidations",
+								sizeof(MDCacheSyscacheInval), 64);
+
+	MemSet(&inval, 0, sizeof(inval));
+	inval.cacheid = cacheid;
+	inval.hashvalue = hashvalue;
+	hash_search(mdcache_invalidated_syscache, &inval, HASH_ENTER, NULL);
+}
+
+static void
+mdrelcache_invalidation_callback(Datum arg, Oid relid)
+{
+	if (mdcache_reset_pending)
+		return;
+
+	/* InvalidOid means that all relcache entries were invalidated */
+	if (!OidIsValid(relid) ||
+		mdcache_pending_invalidations() >= MDCACHE_MAX_PENDING_INVALIDATIONS)
+	{
+		mdcache_request_reset();
+		return;
+	}
+
+	if (mdcache_invalidated_rels == NULL)
+		mdcache_invalidated_rels =
+			mdcache_create_hash("ORCA MD cache relcache invalidations",
+								sizeof(Oid), 64);
+
+	hash_search(mdcache_invalidated_rels, &relid, HASH_ENTER, NULL);
 }
 
 static void
@@ -3137,16 +3445,107 @@ register_mdcache_invalidation_callbacks(void)
 	for (i = 0; i < lengthof(metadata_caches); i++)
 	{
 		CacheRegisterSyscacheCallback(metadata_caches[i],
-									  &mdsyscache_invalidation_counter_callback,
+									  &mdsyscache_invalidation_callback,
 									  (Datum) 0);
 	}
 
 	/* also register the relcache callback */
-	CacheRegisterRelcacheCallback(&mdrelcache_invalidation_counter_callback,
+	CacheRegisterRelcacheCallback(&mdrelcache_invalidation_callback,
 								  (Datum) 0);
 }
 
-// Has there been any catalog changes since last call?
+/*
+ * Has the syscache entry of cacheid with the given hash value been
+ * invalidated since the last query was planned?
+ */
+static bool
+mdcache_syscache_entry_invalidated(int cacheid, uint32 hashvalue)
+{
+	MDCacheSyscacheInval inval;
+	bool		found;
+
+	MemSet(&inval, 0, sizeof(inval));
+	inval.cacheid = cacheid;
+	inval.hashvalue = hashvalue;
+	hash_search(mdcache_invalidated_syscache, &inval, HASH_FIND, &found);
+
+	return found;
+}
+
+/*
+ * The syscache entries that the cache object with the given key was built
+ * from. Only the fine-grained syscaches are listed; a change to the others
+ * resets the whole cache.
+ */
+static void
+mdcache_object_syscache_deps(const MDCacheObjectKey *key, MDSharedCacheDeps *deps)
+{
+	static const int oid_caches[] = {AGGFNOID, CONSTROID, PROCOID, TYPEOID};
+	AttrNumber	attno;
+	unsigned int i;
+
+	deps->nsyscache = 0;
+
+	switch (key->mdid_type)
+	{
+		case IMDId::EmdidColStats:
+			/* statistics of the relation itself, or of its children */
+			attno = (AttrNumber) (key->pos + 1);
+			deps->syscache[0].cacheid = STATRELATTINH;
+			deps->syscache[0].hashvalue =
+				GetSysCacheHashValue3(STATRELATTINH,
+									  ObjectIdGetDatum(key->oid),
+									  Int16GetDatum(attno),
+									  BoolGetDatum(false));
+			deps->syscache[1].cacheid = STATRELATTINH;
+			deps->syscache[1].hashvalue =
+				GetSysCacheHashValue3(STATRELATTINH,
+									  ObjectIdGetDatum(key->oid),
+									  Int16GetDatum(attno),
+									  BoolGetDatum(true));
+			deps->nsyscache = 2;
+			break;
+
+		case IMDId::EmdidGPDB:
+			/* types, functions, aggregates and check constraints */
+			for (i = 0; i < lengthof(oid_caches); i++)
+			{
+				deps->syscache[i].cacheid = oid_caches[i];
+				deps->syscache[i].hashvalue =
+					GetSysCacheHashValue1(oid_caches[i],
+										  ObjectIdGetDatum(key->oid));
+			}
+			deps->nsyscache = lengthof(oid_caches);
+			break;
+
+		default:
+			break;
+	}
+}
+
+/*
+ * Has a syscache entry that the cache object with the given key was built
+ * from been invalidated?
+ */
+static bool
+mdcache_object_syscache_invalidated(MDCacheObjectKey *key)
+{
+	MDSharedCacheDeps deps;
+	int			i;
+
+	mdcache_object_syscache_deps(key, &deps);
+
+	for (i = 0; i < deps.nsyscache; i++)
+	{
+		if (mdcache_syscache_entry_invalidated(deps.syscache[i].cacheid,
+											   deps.syscache[i].hashvalue))
+			return true;
+	}
+	return false;
+}
+
+// Has there been any catalog changes since last call, that require
+// resetting the whole cache?
 bool
 gpdb::MDCacheNeedsReset
 		(
@@ -3155,16 +3554,23 @@ gpdb::MDCacheNeedsReset
 {
 	GP_WRAP_START;
 	{
-		if (!mdcache_invalidation_counter_registered)
+		if (!mdcache_invalidation_callbacks_registered)
 		{
 			register_mdcache_invalidation_callbacks();
-			mdcache_invalidation_counter_registered = true;
+			mdcache_invalidation_callbacks_registered = true;
 		}
-		if (last_mdcache_invalidation_counter == mdcache_invalidation_counter)
+		if (!mdcache_reset_pending)
 			return false;
 		else
 		{
-			last_mdcache_invalidation_counter = mdcache_invalidation_counter;
+			/* the cache starts out empty again */
+			mdcache_reset_pending = false;
+			mdcache_forget_invalidations();
+			if (mdcache_objects != NULL)
+			{
+				hash_destroy(mdcache_objects);
+				mdcache_objects = NULL;
+			}
 			return true;
 		}
 	}
@@ -3173,6 +3579,260 @@ gpdb::MDCacheNeedsReset
 	return true;
 }
 
+// Remember that the metadata cache holds an object
+void
+gpdb::MDCacheRegisterObject
+		(
+			int mdid_type,
+			Oid oid,
+			int32 pos,
+			Oid relid
+		)
+{
+	GP_WRAP_START;
+	{
+		MDCacheObjectKey key;
+
+		if (mdcache_objects == NULL)
+			mdcache_objects = mdcache_create_hash("ORCA MD cache objects",
+												  sizeof(MDCacheObjectKey),
+												  1024);
+
+		MemSet(&key, 0, sizeof(key));
+		key.mdid_type = mdid_type;
+		key.oid = oid;
+		key.pos = pos;
+		key.relid = relid;
+		hash_search(mdcache_objects, &key, HASH_ENTER, NULL);
+		return;
+	}
+	GP_WRAP_END;
+}
+
+// Return the registered objects whose catalog entries changed since the last
+// call, and forget about them
+List *
+gpdb::MDCacheInvalidatedObjects
+		(
+			void
+		)
+{
+	GP_WRAP_START;
+	{
+		List	   *result = NIL;
+		List	   *roots = NIL;
+		ListCell   *lc;
+		HASH_SEQ_STATUS status;
+		MDCacheObjectKey *key;
+
+		if (mdcache_objects == NULL || mdcache_pending_invalidations() == 0)
+		{
+			mdcache_forget_invalidations();
+			return NIL;
+		}
+
+		/*
+		 * The metadata of a partitioned table covers its partitions too, so
+		 * a change to a partition invalidates the root as well.
+		 * catalog tables: pg_partition, pg_partition_rule
+		 */
+		if (mdcache_invalidated_rels != NULL)
+		{
+			Oid		   *relid;
+
+			hash_seq_init(&status, mdcache_invalidated_rels);
+			while ((relid = (Oid *) hash_seq_search(&status)) != NULL)
+			{
+				if (rel_is_child_partition(*relid))
+					roots = lappend_oid(roots, rel_partition_get_root(*relid));
+			}
+			foreach(lc, roots)
+			{
+				Oid			root = lfirst_oid(lc);
+
+				if (OidIsValid(root))
+					hash_search(mdcache_invalidated_rels, &root, HASH_ENTER, NULL);
+			}
+			list_free(roots);
+		}
+
+		hash_seq_init(&status, mdcache_objects);
+		while ((key = (MDCacheObjectKey *) hash_seq_search(&status)) != NULL)
+		{
+			bool		invalidated = false;
+
+			/* relations, indexes, triggers and statistics of relations */
+			if (mdcache_invalidated_rels != NULL && OidIsValid(key->relid))
+				hash_search(mdcache_invalidated_rels, &key->relid, HASH_FIND,
+							&invalidated);
+
+			/* types, functions, aggregates, constraints and statistics */
+			if (!invalidated && mdcache_invalidated_syscache != NULL)
+				invalidated = mdcache_object_syscache_invalidated(key);
+
+			if (invalidated)
+			{
+				MDCacheObjectKey *copy = (MDCacheObjectKey *) palloc(sizeof(MDCacheObjectKey));
+
+				*copy = *key;
+				result = lappend(result, copy);
+
+				/* removing the current entry is OK during a seq scan */
+				hash_search(mdcache_objects, key, HASH_REMOVE, NULL);
+			}
+		}
+
+		mdcache_forget_invalidations();
+
+		return result;
+	}
+	GP_WRAP_END;
+
+	return NIL;
+}
+
+// Can the metadata cache shared by all backends be used? Not if the
+// current transaction changed the catalogs.
+bool
+gpdb::MDSharedCacheUsable
+		(
+			void
+		)
+{
+	GP_WRAP_START;
+	{
+		return ::MDSharedCacheUsable();
+	}
+	GP_WRAP_END;
+
+	return false;
+}
+
+// Look up an object in the shared metadata cache
+char *
+gpdb::MDSharedCacheLookup
+		(
+			const char *name,
+			MDCacheObjectKey *object
+		)
+{
+	GP_WRAP_START;
+	{
+		return ::MDSharedCacheLookup(name, object);
+	}
+	GP_WRAP_END;
+
+	return NULL;
+}
+
+// Get ready to build an object for the shared metadata cache
+uint64
+gpdb::MDSharedCacheStartBuild
+		(
+			void
+		)
+{
+	GP_WRAP_START;
+	{
+		uint64		generation = ::MDSharedCacheGeneration();
+
+		/*
+		 * Catch up with the catalog changes whose invalidation messages were
+		 * queued before we read the generation, so that the object reflects
+		 * them.
+		 */
+		AcceptInvalidationMessages();
+
+		return generation;
+	}
+	GP_WRAP_END;
+
+	return 0;
+}
+
+// Add an object to the shared metadata cache, to be dropped when the catalog
+// entries it was built from change
+void
+gpdb::MDSharedCacheInsert
+		(
+			const char *name,
+			const MDCacheObjectKey *object,
+			const char *dxl,
+			uint64 generation
+		)
+{
+	GP_WRAP_START;
+	{
+		MDSharedCacheDeps deps;
+		List	   *rels = NIL;
+		ListCell   *lc;
+		int			i = 0;
+
+		mdcache_object_syscache_deps(object, &deps);
+
+		/*
+		 * The metadata of a partitioned table covers its partitions too, so
+		 * a change to a partition drops it as well.
+		 * catalog tables: pg_partition, pg_inherits
+		 */
+		if (OidIsValid(object->relid))
+		{
+			if (rel_is_partitioned(object->relid))
+				rels = find_all_inheritors(object->relid, NoLock, NULL);
+			else
+				rels = list_make1_oid(object->relid);
+		}
+
+		deps.nrels = list_length(rels);
+		deps.rels = (Oid *) palloc((deps.nrels + 1) * sizeof(Oid));
+		foreach(lc, rels)
+			deps.rels[i++] = lfirst_oid(lc);
+
+		::MDSharedCacheInsert(name, object, &deps, dxl, generation);
+
+		pfree(deps.rels);
+		list_free(rels);
+		return;
+	}
+	GP_WRAP_END;
+}
+
+// Return the OIDs of the tables a query refers to, each once. Views are
+// left out, as their rewritten queries already refer to the underlying
+// tables.
+List *
+gpdb::GetQueryRelationOids
+		(
+			Query *query
+		)
+{
+	GP_WRAP_START;
+	{
+		List	   *rels = NIL;
+		List	   *inval_items = NIL;
+		List	   *result = NIL;
+		ListCell   *lc;
+
+		extract_query_dependencies((Node *) query, &rels, &inval_items);
+
+		foreach(lc, rels)
+		{
+			Oid			relid = lfirst_oid(lc);
+
+			if (get_rel_relkind(relid) == RELKIND_RELATION)
+				result = list_append_unique_oid(result, relid);
+		}
+
+		list_free(rels);
+		list_free_deep(inval_items);
+
+		return result;
+	}
+	GP_WRAP_END;
+
+	return NIL;
+}
+
 // Functions for ORCA's memory consumption to be tracked by GPDB
 void *
 gpdb::OptimizerAlloc
@@ -3202,7 +3862,17 @@ gpdb::OptimizerFree
 	GP_WRAP_END;
 }
 
-// returns true if a query cancel is requested in GPDB
+// time and memory budget of the current optimization
+static struct
+{
+	bool		enforced;		// abort the optimization when exceeded?
+	bool		exceeded;
+	TimestampTz	deadline;		// 0 if there is no time budget
+	uint64		memory_limit;	// 0 if there is no memory budget
+} optimizer_budget;
+
+// returns true if a query cancel is requested in GPDB, or if the
+// optimization budget is exceeded while it is enforced
 bool
 gpdb::IsAbortRequested
 	(
@@ -3211,7 +3881,140 @@ gpdb::IsAbortRequested
 {
 	// No GP_WRAP_START/END needed here. We just check these global flags,
 	// it cannot throw an ereport().
-	return (QueryCancelPending || ProcDiePending);
+	return (QueryCancelPending || ProcDiePending ||
+			(optimizer_budget.enforced && IsOptimizerBudgetExceeded()));
+}
+
+// start measuring the time and memory used by an optimization; 0 means no
+// limit. The memory is counted in the optimizer's allocations that are
+// outstanding, relative to those at the start.
+void
+gpdb::StartOptimizerBudget
+	(
+	int time_ms,
+	int memory_kb
+	)
+{
+	optimizer_budget.enforced = false;
+	optimizer_budget.exceeded = false;
+	optimizer_budget.deadline = 0;
+	optimizer_budget.memory_limit = 0;
+
+	if (0 < time_ms)
+	{
+		optimizer_budget.deadline = TimestampTzPlusMilliseconds(GetCurrentTimestamp(), time_ms);
+	}
+	if (0 < memory_kb)
+	{
+		optimizer_budget.memory_limit = GetOptimizerOutstandingMemoryBalance() + (uint64) memory_kb * 1024;
+	}
+}
+
+// abort the optimization once the budget is exceeded?
+void
+gpdb::EnforceOptimizerBudget
+	(
+	bool enforce
+	)
+{
+	optimizer_budget.enforced = enforce;
+}
+
+// returns true if the optimization has used up its budget
+bool
+gpdb::IsOptimizerBudgetExceeded
+	(
+	void
+	)
+{
+	// No GP_WRAP_START/END needed here, it is called from the abort check
+	// and neither call can throw an ereport().
+	if (!optimizer_budget.exceeded)
+	{
+		optimizer_budget.exceeded =
+			(0 != optimizer_budget.deadline && GetCurrentTimestamp() >= optimizer_budget.deadline) ||
+			(0 != optimizer_budget.memory_limit && GetOptimizerOutstandingMemoryBalance() >= optimizer_budget.memory_limit);
+	}
+
+	return optimizer_budget.exceeded;
+}
+
+// stop measuring the optimization
+void
+gpdb::EndOptimizerBudget
+	(
+	void
+	)
+{
+	optimizer_budget.enforced = false;
+	optimizer_budget.exceeded = false;
+	optimizer_budget.deadline = 0;
+	optimizer_budget.memory_limit = 0;
+}
+
+// No GP_WRAP_START/END needed in the profiling functions below, they only
+// update counters and cannot throw an ereport().
+
+// start profiling the phases of an optimization
+void
+gpdb::BeginOptimizerProfile
+	(
+	void
+	)
+{
+	OptimizerProfileBegin();
+}
+
+// finish profiling an optimization and add it to the session's totals
+void
+gpdb::EndOptimizerProfile
+	(
+	void
+	)
+{
+	OptimizerProfileEnd();
+}
+
+// enter a phase of the optimization
+void
+gpdb::StartOptimizerPhase
+	(
+	OptimizerPhase phase,
+	instr_time *start
+	)
+{
+	OptimizerProfileStartPhase(phase, start);
+}
+
+// leave a phase of the optimization entered at 'start'
+void
+gpdb::EndOptimizerPhase
+	(
+	OptimizerPhase phase,
+	instr_time *start
+	)
+{
+	OptimizerProfileEndPhase(phase, start);
+}
+
+// count an object fetched by the MD provider
+void
+gpdb::CountOptimizerMDFetch
+	(
+	bool shared_hit
+	)
+{
+	OptimizerProfileCountMDFetch(shared_hit);
+}
+
+// count constant expressions evaluated for the optimizer
+void
+gpdb::CountOptimizerConstExprs
+	(
+	int nexprs
+	)
+{
+	OptimizerProfileCountConstExprs(nexprs);
 }
 
 GpPolicy *
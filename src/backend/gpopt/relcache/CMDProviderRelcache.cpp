@@ -17,12 +17,18 @@
 #include "postgres.h"
 #include "gpopt/relcache/CMDProviderRelcache.h"
 #include "gpopt/translate/CTranslatorRelcacheToDXL.h"
+#include "gpopt/utils/CAutoOptimizerPhase.h"
 #include "gpopt/mdcache/CMDAccessor.h"
 
 #include "naucrates/dxl/CDXLUtils.h"
+#include "naucrates/md/CMDIdColStats.h"
+#include "naucrates/md/CMDIdGPDB.h"
+#include "naucrates/md/CMDIdRelStats.h"
 
 #include "naucrates/exception.h"
 
+#include "gpopt/gpdbwrappers.h"
+
 using namespace gpos;
 using namespace gpdxl;
 using namespace gpmd;
@@ -45,12 +51,232 @@ CMDProviderRelcache::CMDProviderRelcache
 	GPOS_ASSERT(NULL != m_mp);
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDProviderRelcache::GetObjectKey
+//
+//	@doc:
+//		Compute the key under which the invalidation tracking in gpdbwrappers
+//		knows an object, so that a change to the catalog entries it was
+//		built from evicts just this object. Returns false for casts and
+//		scalar comparisons, which are not tracked; any change to the
+//		catalogs they come from resets the whole cache.
+//
+//---------------------------------------------------------------------------
+BOOL
+CMDProviderRelcache::GetObjectKey
+	(
+	IMDId *mdid,
+	IMDCacheObject *md_obj,
+	MDCacheObjectKey *key
+	)
+{
+	key->mdid_type = mdid->MdidType();
+	key->pos = 0;
+
+	switch (mdid->MdidType())
+	{
+		case IMDId::EmdidGPDB:
+		{
+			OID oid = CMDIdGPDB::CastMdid(mdid)->Oid();
+
+			key->oid = oid;
+			key->relid = InvalidOid;
+
+			// a change to a trigger or a check constraint invalidates its
+			// relation rather than the object itself
+			switch (md_obj->MDType())
+			{
+				case IMDCacheObject::EmdtRel:
+				case IMDCacheObject::EmdtInd:
+					key->relid = oid;
+					break;
+				case IMDCacheObject::EmdtTrigger:
+					key->relid = gpdb::GetTriggerRelid(oid);
+					break;
+				case IMDCacheObject::EmdtCheckConstraint:
+					key->relid = gpdb::GetCheckConstraintRelid(oid);
+					break;
+				default:
+					break;
+			}
+			return true;
+		}
+
+		case IMDId::EmdidRelStats:
+		{
+			OID rel_oid = CMDIdGPDB::CastMdid(CMDIdRelStats::CastMdid(mdid)->GetRelMdId())->Oid();
+
+			key->oid = rel_oid;
+			key->relid = rel_oid;
+			return true;
+		}
+
+		case IMDId::EmdidColStats:
+		{
+			CMDIdColStats *mdid_col_stats = CMDIdColStats::CastMdid(mdid);
+			OID rel_oid = CMDIdGPDB::CastMdid(mdid_col_stats->GetRelMdId())->Oid();
+
+			key->oid = rel_oid;
+			key->pos = (int32) mdid_col_stats->Position();
+			key->relid = rel_oid;
+			return true;
+		}
+
+		default:
+			return false;
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDProviderRelcache::GetSharedCacheName
+//
+//	@doc:
+//		The name of an object in the metadata cache shared by all backends,
+//		which is its mdid string. Returns false if the name does not fit.
+//
+//---------------------------------------------------------------------------
+BOOL
+CMDProviderRelcache::GetSharedCacheName
+	(
+	IMDId *mdid,
+	CHAR *name
+	)
+{
+	const WCHAR *mdid_str = mdid->GetBuffer();
+	ULONG i;
+
+	for (i = 0; mdid_str[i] != 0; i++)
+	{
+		// mdid strings are made of digits and dots
+		if (i + 1 >= MDSHAREDCACHE_NAMELEN || mdid_str[i] > 0x7f)
+		{
+			return false;
+		}
+		name[i] = (CHAR) mdid_str[i];
+	}
+	name[i] = '\0';
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDProviderRelcache::LookupShared
+//
+//	@doc:
+//		Look up the DXL of an object in the metadata cache shared by all
+//		backends. On a hit, the DXL is returned in dxl and the object is
+//		registered for invalidation. On a miss, name and generation are set
+//		up for adding the object to the shared cache once it is built.
+//		Returns false if the shared cache can't be used.
+//
+//---------------------------------------------------------------------------
+BOOL
+CMDProviderRelcache::LookupShared
+	(
+	IMDId *md_id,
+	CHAR *name,
+	CHAR **dxl,
+	uint64 *generation
+	)
+{
+	*dxl = NULL;
+	*generation = 0;
+
+	if (!gpdb::MDSharedCacheUsable() || !GetSharedCacheName(md_id, name))
+	{
+		return false;
+	}
+
+	MDCacheObjectKey key;
+	*dxl = gpdb::MDSharedCacheLookup(name, &key);
+
+	if (NULL != *dxl)
+	{
+		gpdb::MDCacheRegisterObject(key.mdid_type, key.oid, key.pos, key.relid);
+	}
+	else
+	{
+		*generation = gpdb::MDSharedCacheStartBuild();
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDProviderRelcache::BuildObject
+//
+//	@doc:
+//		Build an object from the catalogs in the provided memory pool, and
+//		register it for invalidation. If shared_name is given, the object's
+//		DXL is added to the shared cache under that name. If str is given,
+//		the object's DXL is returned in it.
+//
+//---------------------------------------------------------------------------
+IMDCacheObject *
+CMDProviderRelcache::BuildObject
+	(
+	IMemoryPool *mp,
+	CMDAccessor *md_accessor,
+	IMDId *md_id,
+	const CHAR *shared_name,
+	uint64 generation,
+	CWStringDynamic **str
+	)
+	const
+{
+	IMDCacheObject *md_obj = CTranslatorRelcacheToDXL::RetrieveObject(mp, md_accessor, md_id);
+
+	GPOS_ASSERT(NULL != md_obj);
+
+	MDCacheObjectKey key;
+	BOOL tracked = GetObjectKey(md_id, md_obj, &key);
+	if (tracked)
+	{
+		gpdb::MDCacheRegisterObject(key.mdid_type, key.oid, key.pos, key.relid);
+	}
+
+	// objects that are not tracked can't be dropped from the shared cache
+	// one by one either, so they are not shared
+	BOOL share = (NULL != shared_name && tracked);
+
+	if (NULL == str && !share)
+	{
+		return md_obj;
+	}
+
+	CWStringDynamic *dxl_str = CDXLUtils::SerializeMDObj(m_mp, md_obj, true /*fSerializeHeaders*/, false /*findent*/);
+
+	if (share)
+	{
+		CHAR *dxl = CDXLUtils::CreateMultiByteCharStringFromWCString(m_mp, dxl_str->GetBuffer());
+		gpdb::MDSharedCacheInsert(shared_name, &key, dxl, generation);
+		GPOS_DELETE_ARRAY(dxl);
+	}
+
+	if (NULL != str)
+	{
+		*str = dxl_str;
+	}
+	else
+	{
+		GPOS_DELETE(dxl_str);
+	}
+
+	return md_obj;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CMDProviderRelcache::GetMDObjDXLStr
 //
 //	@doc:
-//		Returns the DXL of the requested object in the provided memory pool
+//		Returns the DXL of the requested object in the provided memory pool.
+//		The DXL is taken from the metadata cache shared by all backends if
+//		the object is there, and added to it otherwise.
 //
 //---------------------------------------------------------------------------
 CWStringBase *
@@ -62,11 +288,24 @@ CMDProviderRelcache::GetMDObjDXLStr
 	)
 	const
 {
-	IMDCacheObject *md_obj = CTranslatorRelcacheToDXL::RetrieveObject(mp, md_accessor, md_id);
+	CAutoOptimizerPhase phase(OPTIMIZER_PHASE_METADATA);
 
-	GPOS_ASSERT(NULL != md_obj);
+	CHAR name[MDSHAREDCACHE_NAMELEN];
+	CHAR *dxl = NULL;
+	uint64 generation = 0;
+	BOOL use_shared_cache = LookupShared(md_id, name, &dxl, &generation);
+	gpdb::CountOptimizerMDFetch(NULL != dxl);
+
+	if (NULL != dxl)
+	{
+		CWStringDynamic *str = CDXLUtils::CreateDynamicStringFromCharArray(m_mp, dxl);
+		gpdb::GPDBFree(dxl);
 
-	CWStringDynamic *str = CDXLUtils::SerializeMDObj(m_mp, md_obj, true /*fSerializeHeaders*/, false /*findent*/);
+		return str;
+	}
+
+	CWStringDynamic *str = NULL;
+	IMDCacheObject *md_obj = BuildObject(mp, md_accessor, md_id, use_shared_cache ? name : NULL, generation, &str);
 
 	// cleanup DXL object
 	md_obj->Release();
@@ -74,4 +313,47 @@ CMDProviderRelcache::GetMDObjDXLStr
 	return str;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDProviderRelcache::GetMDObj
+//
+//	@doc:
+//		Returns the requested object itself, built in the provided memory
+//		pool, for adding it to the MD cache directly. Unlike going through
+//		GetMDObjDXLStr, this doesn't serialize the object to DXL only to have
+//		the MD accessor parse it again, except to share it with the other
+//		backends.
+//
+//---------------------------------------------------------------------------
+IMDCacheObject *
+CMDProviderRelcache::GetMDObj
+	(
+	IMemoryPool *mp,
+	CMDAccessor *md_accessor,
+	IMDId *md_id
+	)
+	const
+{
+	CAutoOptimizerPhase phase(OPTIMIZER_PHASE_METADATA);
+
+	CHAR name[MDSHAREDCACHE_NAMELEN];
+	CHAR *dxl = NULL;
+	uint64 generation = 0;
+	BOOL use_shared_cache = LookupShared(md_id, name, &dxl, &generation);
+	gpdb::CountOptimizerMDFetch(NULL != dxl);
+
+	if (NULL != dxl)
+	{
+		CWStringDynamic *str = CDXLUtils::CreateDynamicStringFromCharArray(m_mp, dxl);
+		gpdb::GPDBFree(dxl);
+
+		IMDCacheObject *md_obj = CDXLUtils::ParseDXLToIMDIdCacheObj(mp, str, NULL /*xsd_file_path*/);
+		GPOS_DELETE(str);
+
+		return md_obj;
+	}
+
+	return BuildObject(mp, md_accessor, md_id, use_shared_cache ? name : NULL, generation, NULL /*str*/);
+}
+
 // EOF
@@ -0,0 +1,238 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2019 Pivotal Software, Inc.
+//
+//	@filename:
+//		CStatsBucketCache.cpp
+//
+//	@doc:
+//		Implementation of the cache of the histogram buckets translated from
+//		pg_statistic entries
+//
+//	@test:
+//
+//---------------------------------------------------------------------------
+
+#include "postgres.h"
+#include "access/htup.h"
+#include "utils/guc.h"
+
+#include "gpopt/translate/CStatsBucketCache.h"
+
+#include "gpos/memory/CMemoryPoolManager.h"
+
+using namespace gpdxl;
+
+IMemoryPool *CStatsBucketCache::m_mp = NULL;
+
+CStatsBucketCache::StatsKeyToEntryMap *CStatsBucketCache::m_entries = NULL;
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CStatsBucketCache::SStatsKey::HashValue
+//
+//	@doc:
+//		Hash of a pg_statistic entry version
+//
+//---------------------------------------------------------------------------
+ULONG
+CStatsBucketCache::SStatsKey::HashValue
+	(
+	const SStatsKey *key
+	)
+{
+	ULONG hash = gpos::HashValue<OID>(&key->m_rel_oid);
+	hash = gpos::CombineHashes(hash, gpos::HashValue<INT>(&key->m_attno));
+	hash = gpos::CombineHashes(hash, gpos::HashValue<ULONG>(&key->m_xmin));
+
+	return gpos::CombineHashes(hash, key->m_data_hash);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CStatsBucketCache::SStatsKey::Equals
+//
+//	@doc:
+//		Are two pg_statistic entry versions the same?
+//
+//---------------------------------------------------------------------------
+BOOL
+CStatsBucketCache::SStatsKey::Equals
+	(
+	const SStatsKey *key_a,
+	const SStatsKey *key_b
+	)
+{
+	return key_a->m_rel_oid == key_b->m_rel_oid &&
+			key_a->m_attno == key_b->m_attno &&
+			key_a->m_xmin == key_b->m_xmin &&
+			key_a->m_block == key_b->m_block &&
+			key_a->m_offset == key_b->m_offset &&
+			key_a->m_data_hash == key_b->m_data_hash;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CStatsBucketCache::InitKey
+//
+//	@doc:
+//		Identify the version of a pg_statistic tuple. An ANALYZE replaces
+//		the tuple, which gives it a new xmin and location. The hash of its
+//		contents tells apart tuples whose xmin was overwritten by freezing,
+//		that happen to end up at the same location.
+//
+//---------------------------------------------------------------------------
+void
+CStatsBucketCache::InitKey
+	(
+	SStatsKey *key,
+	OID rel_oid,
+	INT attno,
+	const HeapTupleData *stats_tup
+	)
+{
+	HeapTupleHeader header = stats_tup->t_data;
+
+	key->m_rel_oid = rel_oid;
+	key->m_attno = attno;
+	key->m_xmin = HeapTupleHeaderGetXmin(header);
+	key->m_block = ItemPointerGetBlockNumber(&stats_tup->t_self);
+	key->m_offset = ItemPointerGetOffsetNumber(&stats_tup->t_self);
+	key->m_data_hash = gpos::HashByteArray((BYTE *) header + header->t_hoff, stats_tup->t_len - header->t_hoff);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CStatsBucketCache::GetMemoryPool
+//
+//	@doc:
+//		Memory pool to build buckets to be cached in, or NULL if the cache is
+//		disabled. Called before building buckets rather than when adding
+//		them, so that emptying a full cache doesn't free buckets in use.
+//
+//---------------------------------------------------------------------------
+IMemoryPool *
+CStatsBucketCache::GetMemoryPool()
+{
+	if (0 == optimizer_stats_cache_size)
+	{
+		Shutdown();
+		return NULL;
+	}
+
+	if (NULL != m_mp && m_mp->TotalAllocatedSize() > (ULLONG) optimizer_stats_cache_size * 1024L)
+	{
+		Shutdown();
+	}
+
+	if (NULL == m_mp)
+	{
+		m_mp = CMemoryPoolManager::GetMemoryPoolMgr()->Create(CMemoryPoolManager::EatTracker, false /* fThreadSafe */, gpos::ullong_max);
+		m_entries = GPOS_NEW(m_mp) StatsKeyToEntryMap(m_mp);
+	}
+
+	return m_mp;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CStatsBucketCache::Lookup
+//
+//	@doc:
+//		Cached buckets of a column for the given pg_statistic tuple, or NULL.
+//		The number of distinct values depends on reltuples as well as on the
+//		tuple, so the buckets are only used if it hasn't changed.
+//
+//---------------------------------------------------------------------------
+CDXLBucketArray *
+CStatsBucketCache::Lookup
+	(
+	OID rel_oid,
+	INT attno,
+	const HeapTupleData *stats_tup,
+	OID att_type,
+	CDouble num_distinct,
+	CDouble *null_freq
+	)
+{
+	if (NULL == m_entries)
+	{
+		return NULL;
+	}
+
+	SStatsKey key;
+	InitKey(&key, rel_oid, attno, stats_tup);
+
+	SStatsEntry *entry = m_entries->Find(&key);
+	if (NULL == entry || entry->m_att_type != att_type || entry->m_num_distinct != num_distinct)
+	{
+		return NULL;
+	}
+
+	*null_freq = entry->m_null_freq;
+	entry->m_buckets->AddRef();
+
+	return entry->m_buckets;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CStatsBucketCache::Insert
+//
+//	@doc:
+//		Cache the buckets of a column, built in the cache's memory pool
+//
+//---------------------------------------------------------------------------
+void
+CStatsBucketCache::Insert
+	(
+	OID rel_oid,
+	INT attno,
+	const HeapTupleData *stats_tup,
+	OID att_type,
+	CDouble num_distinct,
+	CDouble null_freq,
+	CDXLBucketArray *buckets
+	)
+{
+	GPOS_ASSERT(NULL != m_entries);
+
+	SStatsKey *key = GPOS_NEW(m_mp) SStatsKey;
+	InitKey(key, rel_oid, attno, stats_tup);
+
+	// an entry for the same tuple built with a different number of
+	// distinct values is left in place
+	if (NULL != m_entries->Find(key))
+	{
+		GPOS_DELETE(key);
+		return;
+	}
+
+	buckets->AddRef();
+	m_entries->Insert(key, GPOS_NEW(m_mp) SStatsEntry(att_type, num_distinct, null_freq, buckets));
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CStatsBucketCache::Shutdown
+//
+//	@doc:
+//		Free the cache
+//
+//---------------------------------------------------------------------------
+void
+CStatsBucketCache::Shutdown()
+{
+	if (NULL == m_mp)
+	{
+		return;
+	}
+
+	m_entries->Release();
+	m_entries = NULL;
+
+	CMemoryPoolManager::GetMemoryPoolMgr()->Destroy(m_mp);
+	m_mp = NULL;
+}
+
+// EOF
@@ -83,7 +83,9 @@ CTranslatorDXLToPlStmt::CTranslatorDXLToPlStmt
 	m_result_rel_list(NULL),
 	m_external_scan_counter(0),
 	m_num_of_segments(num_of_segments),
-	m_partition_selector_counter(0)
+	m_partition_selector_counter(0),
+	m_param_plans(NULL),
+	m_param_plans_size(0)
 {
 	m_translator_dxl_to_scalar = GPOS_NEW(m_mp) CTranslatorDXLToScalar(m_mp, m_md_accessor, m_num_of_segments);
 	InitTranslators();
@@ -100,6 +102,10 @@ CTranslatorDXLToPlStmt::CTranslatorDXLToPlStmt
 CTranslatorDXLToPlStmt::~CTranslatorDXLToPlStmt()
 {
 	GPOS_DELETE(m_translator_dxl_to_scalar);
+	if (NULL != m_param_plans)
+	{
+		GPOS_DELETE_ARRAY(m_param_plans);
+	}
 }
 
 //---------------------------------------------------------------------------
@@ -392,26 +398,57 @@ CTranslatorDXLToPlStmt::SetInitPlanSliceInformation(SubPlan * subplan)
 //		CTranslatorDXLToPlStmt::SetParamIds
 //
 //	@doc:
-//		Set the bitmapset with the param_ids defined in the plan
+//		Set the bitmapset with the param_ids defined in the plan.
+//
+//		The children of a node are translated, and have their param ids set,
+//		before the node itself, so only the node's own expressions need to
+//		be searched; the param ids of the children are taken from their
+//		allParam. Searching the whole subtree at every node instead would
+//		take time quadratic in the depth of the plan.
 //
 //---------------------------------------------------------------------------
 void
 CTranslatorDXLToPlStmt::SetParamIds(Plan* plan)
 {
-	List *params_node_list = gpdb::ExtractNodesPlan(plan, T_Param, true);
+	Bitmapset *bitmapset = gpdb::ExtractPlanParamIds(plan, m_param_plans, (int) m_param_plans_size);
 
-	ListCell *lc = NULL;
+	plan->extParam = bitmapset;
+	plan->allParam = bitmapset;
 
-	Bitmapset  *bitmapset = NULL;
+	if (0 > plan->plan_node_id)
+	{
+		return;
+	}
 
-	ForEach (lc, params_node_list)
+	// remember the node, so that the search from its parent stops at it
+	ULONG plan_id = (ULONG) plan->plan_node_id;
+	if (plan_id >= m_param_plans_size)
 	{
-		Param *param = (Param*) lfirst(lc);
-		bitmapset = gpdb::BmsAddMember(bitmapset, param->paramid);
+		ULONG size = 2 * m_param_plans_size;
+		if (size < 64)
+		{
+			size = 64;
+		}
+		if (size <= plan_id)
+		{
+			size = plan_id + 1;
+		}
+
+		Plan **param_plans = GPOS_NEW_ARRAY(m_mp, Plan*, size);
+		for (ULONG ul = 0; ul < size; ul++)
+		{
+			param_plans[ul] = (ul < m_param_plans_size) ? m_param_plans[ul] : NULL;
+		}
+
+		if (NULL != m_param_plans)
+		{
+			GPOS_DELETE_ARRAY(m_param_plans);
+		}
+		m_param_plans = param_plans;
+		m_param_plans_size = size;
 	}
 
-	plan->extParam = bitmapset;
-	plan->allParam = bitmapset;
+	m_param_plans[plan_id] = plan;
 }
 
 
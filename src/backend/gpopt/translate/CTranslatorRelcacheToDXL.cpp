@@ -44,6 +44,7 @@
 #include "gpopt/translate/CTranslatorUtils.h"
 #include "gpopt/translate/CTranslatorRelcacheToDXL.h"
 #include "gpopt/translate/CTranslatorScalarToDXL.h"
+#include "gpopt/translate/CStatsBucketCache.h"
 #include "gpopt/mdcache/CMDAccessor.h"
 
 #include "gpos/base.h"
@@ -1334,12 +1335,11 @@ CTranslatorRelcacheToDXL::RetrievePartTableIndex
 	const ULONG num_of_levels = gpdb::ListLength(part_keys);
 	gpdb::ListFree(part_keys);
 
-	/* get relation constraints
-	 * default_levels_rel indicates the levels on which default partitions exists
-	 * for the partitioned table
+	/* default_levels_rel indicates the levels on which default partitions exists
+	 * for the partitioned table; the relation's part constraint is only fetched
+	 * below if the index needs it
 	 */
-	List *default_levels_rel = NIL;
-	Node *part_constraints_rel = gpdb::GetRelationPartContraints(rel_oid, &default_levels_rel);
+	List *default_levels_rel = gpdb::GetRelationPartDefaultLevels(rel_oid);
 
 	BOOL is_unbounded = (NULL == part_constraint) && (NIL == default_levels);
 	for (ULONG ul = 0; ul < num_of_levels; ul++)
@@ -1374,8 +1374,9 @@ CTranslatorRelcacheToDXL::RetrievePartTableIndex
 	{
 		if (NIL == default_levels)
 		{
-			// NULL part constraints means all non-default partitions -> get constraint from the part table
-			part_constraint = part_constraints_rel;
+			// NULL part constraints means all non-default partitions -> get constraint from the part table,
+			// merged once for the relation and all its indexes
+			part_constraint = gpdb::GetRelationPartContraints(rel_oid);
 		}
 		else
 		{
@@ -2451,122 +2452,151 @@ CTranslatorRelcacheToDXL::RetrieveColStats
 	}
 	num_distinct = num_distinct.Ceil();
 
-	BOOL is_dummy_stats = false;
-	// most common values and their frequencies extracted from the pg_statistic
-	// tuple for a given column
-	AttStatsSlot mcv_slot;
+	CDouble num_ndv_buckets(0.0);
+	CDouble num_freq_buckets(0.0);
+	CDouble distinct_remaining(0.0);
+	CDouble freq_remaining(0.0);
 
-	(void)	gpdb::GetAttrStatsSlot
-			(
-					&mcv_slot,
-					stats_tup,
-					STATISTIC_KIND_MCV,
-					InvalidOid,
-					ATTSTATSSLOT_VALUES | ATTSTATSSLOT_NUMBERS
-			);
-	if (InvalidOid != mcv_slot.valuetype && mcv_slot.valuetype != att_type)
-	{
-		char msgbuf[NAMEDATALEN * 2 + 100];
-		snprintf(msgbuf, sizeof(msgbuf), "Type mismatch between attribute %ls of table %ls having type %d and statistic having type %d, please ANALYZE the table again",
-				 md_col->Mdname().GetMDName()->GetBuffer(), md_rel->Mdname().GetMDName()->GetBuffer(), att_type, mcv_slot.valuetype);
-		GpdbEreport(ERRCODE_SUCCESSFUL_COMPLETION,
-					NOTICE,
-					msgbuf,
-					NULL);
+	// We only want to create statistics buckets if the column is NOT a text, varchar, char or bpchar type
+	// For the above column types we will use NDVRemain and NullFreq to do cardinality estimation.
+	BOOL should_create_buckets = CTranslatorUtils::ShouldCreateStatsBucket(att_type);
 
-		gpdb::FreeAttrStatsSlot(&mcv_slot);
-		is_dummy_stats = true;
+	// translating the MCVs and histogram into buckets is expensive for wide
+	// statistics, so the buckets are reused until the pg_statistic entry changes
+	CDXLBucketArray *dxl_stats_bucket_array_transformed = NULL;
+	if (should_create_buckets)
+	{
+		dxl_stats_bucket_array_transformed =
+			CStatsBucketCache::Lookup(rel_oid, attno, stats_tup, att_type, num_distinct, &null_freq);
 	}
 
-	else if (mcv_slot.nvalues != mcv_slot.nnumbers)
+	if (NULL == dxl_stats_bucket_array_transformed)
 	{
-		char msgbuf[NAMEDATALEN * 2 + 100];
-		snprintf(msgbuf, sizeof(msgbuf), "The number of most common values and frequencies do not match on column %ls of table %ls.",
-				 md_col->Mdname().GetMDName()->GetBuffer(), md_rel->Mdname().GetMDName()->GetBuffer());
-		GpdbEreport(ERRCODE_SUCCESSFUL_COMPLETION,
-					NOTICE,
-					msgbuf,
-					NULL);
+		BOOL is_dummy_stats = false;
+		// most common values and their frequencies extracted from the pg_statistic
+		// tuple for a given column
+		AttStatsSlot mcv_slot;
 
-		// if the number of MCVs(nvalues) and number of MCFs(nnumbers) do not match, we discard the MCVs and MCFs
-		gpdb::FreeAttrStatsSlot(&mcv_slot);
-		is_dummy_stats = true;
-	}
-	else
-	{
-		// fix mcv and null frequencies (sometimes they can add up to more than 1.0)
-		NormalizeFrequencies(mcv_slot.numbers, (ULONG) mcv_slot.nvalues, &null_freq);
+		(void)	gpdb::GetAttrStatsSlot
+				(
+						&mcv_slot,
+						stats_tup,
+						STATISTIC_KIND_MCV,
+						InvalidOid,
+						ATTSTATSSLOT_VALUES | ATTSTATSSLOT_NUMBERS
+				);
+		if (InvalidOid != mcv_slot.valuetype && mcv_slot.valuetype != att_type)
+		{
+			char msgbuf[NAMEDATALEN * 2 + 100];
+			snprintf(msgbuf, sizeof(msgbuf), "Type mismatch between attribute %ls of table %ls having type %d and statistic having type %d, please ANALYZE the table again",
+					 md_col->Mdname().GetMDName()->GetBuffer(), md_rel->Mdname().GetMDName()->GetBuffer(), att_type, mcv_slot.valuetype);
+			GpdbEreport(ERRCODE_SUCCESSFUL_COMPLETION,
+						NOTICE,
+						msgbuf,
+						NULL);
+
+			gpdb::FreeAttrStatsSlot(&mcv_slot);
+			is_dummy_stats = true;
+		}
 
-		// total MCV frequency
-		CDouble sum_mcv_freq = 0.0;
-		for (int i = 0; i < mcv_slot.nvalues; i++)
+		else if (mcv_slot.nvalues != mcv_slot.nnumbers)
 		{
-			sum_mcv_freq = sum_mcv_freq + CDouble(mcv_slot.numbers[i]);
+			char msgbuf[NAMEDATALEN * 2 + 100];
+			snprintf(msgbuf, sizeof(msgbuf), "The number of most common values and frequencies do not match on column %ls of table %ls.",
+					 md_col->Mdname().GetMDName()->GetBuffer(), md_rel->Mdname().GetMDName()->GetBuffer());
+			GpdbEreport(ERRCODE_SUCCESSFUL_COMPLETION,
+						NOTICE,
+						msgbuf,
+						NULL);
+
+			// if the number of MCVs(nvalues) and number of MCFs(nnumbers) do not match, we discard the MCVs and MCFs
+			gpdb::FreeAttrStatsSlot(&mcv_slot);
+			is_dummy_stats = true;
 		}
-	}
+		else
+		{
+			// fix mcv and null frequencies (sometimes they can add up to more than 1.0)
+			NormalizeFrequencies(mcv_slot.numbers, (ULONG) mcv_slot.nvalues, &null_freq);
 
-	// histogram values extracted from the pg_statistic tuple for a given column
-	AttStatsSlot hist_slot;
+			// total MCV frequency
+			CDouble sum_mcv_freq = 0.0;
+			for (int i = 0; i < mcv_slot.nvalues; i++)
+			{
+				sum_mcv_freq = sum_mcv_freq + CDouble(mcv_slot.numbers[i]);
+			}
+		}
 
-	// get histogram datums from pg_statistic entry
-	(void) gpdb::GetAttrStatsSlot
-			(
-					&hist_slot,
-					stats_tup,
-					STATISTIC_KIND_HISTOGRAM,
-					InvalidOid,
-					ATTSTATSSLOT_VALUES
-			);
-
-	if (InvalidOid != hist_slot.valuetype && hist_slot.valuetype != att_type)
-	{
-		char msgbuf[NAMEDATALEN * 2 + 100];
-		snprintf(msgbuf, sizeof(msgbuf), "Type mismatch between attribute %ls of table %ls having type %d and statistic having type %d, please ANALYZE the table again",
-				 md_col->Mdname().GetMDName()->GetBuffer(), md_rel->Mdname().GetMDName()->GetBuffer(), att_type, hist_slot.valuetype);
-		GpdbEreport(ERRCODE_SUCCESSFUL_COMPLETION,
-					NOTICE,
-					msgbuf,
-					NULL);
+		// histogram values extracted from the pg_statistic tuple for a given column
+		AttStatsSlot hist_slot;
 
-		gpdb::FreeAttrStatsSlot(&hist_slot);
-		is_dummy_stats = true;
-	}
+		// get histogram datums from pg_statistic entry
+		(void) gpdb::GetAttrStatsSlot
+				(
+						&hist_slot,
+						stats_tup,
+						STATISTIC_KIND_HISTOGRAM,
+						InvalidOid,
+						ATTSTATSSLOT_VALUES
+				);
 
-	if (is_dummy_stats)
-	{
-		dxl_stats_bucket_array->Release();
-		mdid_col_stats->AddRef();
+		if (InvalidOid != hist_slot.valuetype && hist_slot.valuetype != att_type)
+		{
+			char msgbuf[NAMEDATALEN * 2 + 100];
+			snprintf(msgbuf, sizeof(msgbuf), "Type mismatch between attribute %ls of table %ls having type %d and statistic having type %d, please ANALYZE the table again",
+					 md_col->Mdname().GetMDName()->GetBuffer(), md_rel->Mdname().GetMDName()->GetBuffer(), att_type, hist_slot.valuetype);
+			GpdbEreport(ERRCODE_SUCCESSFUL_COMPLETION,
+						NOTICE,
+						msgbuf,
+						NULL);
+
+			gpdb::FreeAttrStatsSlot(&hist_slot);
+			is_dummy_stats = true;
+		}
 
-		CDouble col_width = CStatistics::DefaultColumnWidth;
-		gpdb::FreeHeapTuple(stats_tup);
-		return CDXLColStats::CreateDXLDummyColStats(mp, mdid_col_stats, md_colname, col_width);
-	}
+		if (is_dummy_stats)
+		{
+			dxl_stats_bucket_array->Release();
+			mdid_col_stats->AddRef();
 
-	CDouble num_ndv_buckets(0.0);
-	CDouble num_freq_buckets(0.0);
-	CDouble distinct_remaining(0.0);
-	CDouble freq_remaining(0.0);
+			CDouble col_width = CStatistics::DefaultColumnWidth;
+			gpdb::FreeHeapTuple(stats_tup);
+			return CDXLColStats::CreateDXLDummyColStats(mp, mdid_col_stats, md_colname, col_width);
+		}
 
-	// We only want to create statistics buckets if the column is NOT a text, varchar, char or bpchar type
-	// For the above column types we will use NDVRemain and NullFreq to do cardinality estimation.
-	if (CTranslatorUtils::ShouldCreateStatsBucket(att_type))
-	{
-		// transform all the bits and pieces from pg_statistic
-		// to a single bucket structure
-		CDXLBucketArray *dxl_stats_bucket_array_transformed =
-		TransformStatsToDXLBucketArray
-		(
-		 mp,
-		 att_type,
-		 num_distinct,
-		 null_freq,
-		 mcv_slot.values,
-		 mcv_slot.numbers,
-		 ULONG(mcv_slot.nvalues),
-		 hist_slot.values,
-		 ULONG(hist_slot.nvalues)
-		 );
+		if (should_create_buckets)
+		{
+			// build the buckets to be cached in the cache's memory pool
+			IMemoryPool *cache_mp = CStatsBucketCache::GetMemoryPool();
+
+			// transform all the bits and pieces from pg_statistic
+			// to a single bucket structure
+			dxl_stats_bucket_array_transformed =
+			TransformStatsToDXLBucketArray
+			(
+			 NULL != cache_mp ? cache_mp : mp,
+			 att_type,
+			 num_distinct,
+			 null_freq,
+			 mcv_slot.values,
+			 mcv_slot.numbers,
+			 ULONG(mcv_slot.nvalues),
+			 hist_slot.values,
+			 ULONG(hist_slot.nvalues)
+			 );
+
+			if (NULL != cache_mp)
+			{
+				CStatsBucketCache::Insert(rel_oid, attno, stats_tup, att_type, num_distinct, null_freq, dxl_stats_bucket_array_transformed);
+			}
+		}
 
+		// free up allocated datum and float4 arrays
+		gpdb::FreeAttrStatsSlot(&mcv_slot);
+		gpdb::FreeAttrStatsSlot(&hist_slot);
+	}
+
+	if (should_create_buckets)
+	{
 		GPOS_ASSERT(NULL != dxl_stats_bucket_array_transformed);
 
 		const ULONG num_buckets = dxl_stats_bucket_array_transformed->Size();
@@ -2598,10 +2628,6 @@ CTranslatorRelcacheToDXL::RetrieveColStats
  		freq_remaining = 1 - null_freq;
 	}
 
-	// free up allocated datum and float4 arrays
-	gpdb::FreeAttrStatsSlot(&mcv_slot);
-	gpdb::FreeAttrStatsSlot(&hist_slot);
-
 	gpdb::FreeHeapTuple(stats_tup);
 
 	// create col stats object
@@ -3507,9 +3533,9 @@ CTranslatorRelcacheToDXL::RetrievePartConstraintForRel
 	bool has_index
 	)
 {
-	// get the part constraints
-	List *default_levels_rel = NIL;
-	Node *node = gpdb::GetRelationPartContraints(rel_oid, &default_levels_rel);
+	// get the default partitions from the partitioning rules alone: merging the
+	// constraints of every part is only needed if there are indices
+	List *default_levels_rel = gpdb::GetRelationPartDefaultLevels(rel_oid);
 
 	// don't retrieve part constraints if there are no indices
 	// and no default partitions at any level
@@ -3548,6 +3574,8 @@ CTranslatorRelcacheToDXL::RetrievePartConstraintForRel
 	}
 	else
 	{
+		Node *node = gpdb::GetRelationPartContraints(rel_oid);
+
 		CDXLColDescrArray *dxl_col_descr_array = GPOS_NEW(mp) CDXLColDescrArray(mp);
 		const ULONG num_columns = mdcol_array->Size();
 		for (ULONG ul = 0; ul < num_columns; ul++)
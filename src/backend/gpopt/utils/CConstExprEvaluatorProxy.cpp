@@ -19,6 +19,7 @@
 #include "executor/executor.h"
 
 #include "gpopt/utils/CConstExprEvaluatorProxy.h"
+#include "gpopt/utils/CAutoOptimizerPhase.h"
 
 #include "gpopt/gpdbwrappers.h"
 #include "gpopt/translate/CTranslatorScalarToDXL.h"
@@ -53,28 +54,35 @@ CConstExprEvaluatorProxy::CEmptyMappingColIdVar::VarFromDXLNodeScId
 
 //---------------------------------------------------------------------------
 //	@function:
-//		CConstExprEvaluatorProxy::EvaluateExpr
+//		CConstExprEvaluatorProxy::~CConstExprEvaluatorProxy
 //
 //	@doc:
-//		Evaluate 'expr', assumed to be a constant expression, and return the DXL representation
-// 		of the result. Caller keeps ownership of 'expr' and takes ownership of the returned pointer.
+//		Dtor, frees the executor context along with the results it remembers
+//
+//---------------------------------------------------------------------------
+CConstExprEvaluatorProxy::~CConstExprEvaluatorProxy()
+{
+	if (NULL != m_eval_cxt)
+	{
+		gpdb::FreeConstExprEvalContext(m_eval_cxt);
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CConstExprEvaluatorProxy::TranslateResultToDXL
+//
+//	@doc:
+//		Translate the result of evaluating an expression to DXL, raising an
+//		exception if it is not a Const
 //
 //---------------------------------------------------------------------------
 CDXLNode *
-CConstExprEvaluatorProxy::EvaluateExpr
+CConstExprEvaluatorProxy::TranslateResultToDXL
 	(
-	const CDXLNode *dxl_expr
+	Expr *result
 	)
 {
-	// Translate DXL -> GPDB Expr
-	Expr *expr = m_dxl2scalar_translator.TranslateDXLToScalar(dxl_expr, &m_emptymapcidvar);
-	GPOS_ASSERT(NULL != expr);
-
-	// Evaluate the expression
-	Expr *result = gpdb::EvaluateExpr(expr,
-						gpdb::ExprType((Node *)expr),
-						gpdb::ExprTypeMod((Node *)expr));
-
 	if (!IsA(result, Const))
 	{
 		#ifdef GPOS_DEBUG
@@ -85,11 +93,86 @@ CConstExprEvaluatorProxy::EvaluateExpr
 
 	Const *const_result = (Const *)result;
 	CDXLDatum *datum_dxl = CTranslatorScalarToDXL::TranslateConstToDXL(m_mp, m_md_accessor, const_result);
-	CDXLNode *dxl_result = GPOS_NEW(m_mp) CDXLNode(m_mp, GPOS_NEW(m_mp) CDXLScalarConstValue(m_mp, datum_dxl));
-	gpdb::GPDBFree(result);
-	gpdb::GPDBFree(expr);
+	return GPOS_NEW(m_mp) CDXLNode(m_mp, GPOS_NEW(m_mp) CDXLScalarConstValue(m_mp, datum_dxl));
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CConstExprEvaluatorProxy::EvaluateExpr
+//
+//	@doc:
+//		Evaluate 'expr', assumed to be a constant expression, and return the DXL representation
+// 		of the result. Caller keeps ownership of 'expr' and takes ownership of the returned pointer.
+//
+//---------------------------------------------------------------------------
+CDXLNode *
+CConstExprEvaluatorProxy::EvaluateExpr
+	(
+	const CDXLNode *dxl_expr
+	)
+{
+	CDXLNodeArray *dxl_exprs = GPOS_NEW(m_mp) CDXLNodeArray(m_mp);
+	const_cast<CDXLNode *>(dxl_expr)->AddRef();
+	dxl_exprs->Append(const_cast<CDXLNode *>(dxl_expr));
+
+	CDXLNodeArray *dxl_results = EvaluateExprs(dxl_exprs);
+	dxl_exprs->Release();
+
+	CDXLNode *dxl_result = (*dxl_results)[0];
+	dxl_result->AddRef();
+	dxl_results->Release();
 
 	return dxl_result;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CConstExprEvaluatorProxy::EvaluateExprs
+//
+//	@doc:
+//		Evaluate the constant expressions in 'exprs' in one executor context
+//		and return the DXL representations of the results. Caller keeps
+//		ownership of 'exprs' and takes ownership of the returned array.
+//
+//---------------------------------------------------------------------------
+CDXLNodeArray *
+CConstExprEvaluatorProxy::EvaluateExprs
+	(
+	const CDXLNodeArray *dxl_exprs
+	)
+{
+	CAutoOptimizerPhase phase(OPTIMIZER_PHASE_CONST_EVAL);
+
+	// Translate DXL -> GPDB Expr
+	List *exprs = NIL;
+	const ULONG num_exprs = dxl_exprs->Size();
+	for (ULONG ul = 0; ul < num_exprs; ul++)
+	{
+		Expr *expr = m_dxl2scalar_translator.TranslateDXLToScalar((*dxl_exprs)[ul], &m_emptymapcidvar);
+		GPOS_ASSERT(NULL != expr);
+		exprs = gpdb::LAppend(exprs, expr);
+	}
+
+	if (NULL == m_eval_cxt)
+	{
+		m_eval_cxt = gpdb::CreateConstExprEvalContext();
+	}
+
+	// Evaluate the expressions
+	List *results = gpdb::EvaluateExprs(m_eval_cxt, exprs);
+	gpdb::CountOptimizerConstExprs(num_exprs);
+
+	CDXLNodeArray *dxl_results = GPOS_NEW(m_mp) CDXLNodeArray(m_mp);
+	ListCell *lc = NULL;
+	ForEach(lc, results)
+	{
+		dxl_results->Append(TranslateResultToDXL((Expr *) lfirst(lc)));
+	}
+
+	gpdb::ListFreeDeep(results);
+	gpdb::ListFreeDeep(exprs);
+
+	return dxl_results;
+}
+
 // EOF
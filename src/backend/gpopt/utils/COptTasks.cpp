@@ -15,6 +15,7 @@
 
 #include "gpopt/utils/gpdbdefs.h"
 #include "gpopt/utils/CConstExprEvaluatorProxy.h"
+#include "gpopt/utils/CAutoOptimizerPhase.h"
 #include "gpopt/utils/COptTasks.h"
 #include "gpopt/relcache/CMDProviderRelcache.h"
 #include "gpopt/config/CConfigParamMapping.h"
@@ -41,6 +42,7 @@
 #include "gpos/io/COstreamFile.h"
 #include "gpos/io/COstreamString.h"
 #include "gpos/memory/CAutoMemoryPool.h"
+#include "gpos/memory/CCacheAccessor.h"
 #include "gpos/task/CAutoTraceFlag.h"
 #include "gpos/common/CAutoP.h"
 
@@ -53,6 +55,7 @@
 #include "gpopt/engine/CCTEConfig.h"
 #include "gpopt/mdcache/CAutoMDAccessor.h"
 #include "gpopt/mdcache/CMDCache.h"
+#include "gpopt/mdcache/CMDKey.h"
 #include "gpopt/minidump/CMinidumperUtils.h"
 #include "gpopt/optimizer/COptimizer.h"
 #include "gpopt/optimizer/COptimizerConfig.h"
@@ -65,6 +68,7 @@
 #include "naucrates/base/CQueryToDXLResult.h"
 
 #include "naucrates/md/IMDId.h"
+#include "naucrates/md/CMDIdColStats.h"
 #include "naucrates/md/CMDIdRelStats.h"
 
 #include "naucrates/md/CSystemId.h"
@@ -644,6 +648,285 @@ COptTasks::GetCostModel
 	return cost_model;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::EvictInvalidatedMDObjects
+//
+//	@doc:
+//		Evict the objects in the MD cache that were built from catalog
+//		entries changed since the last query, instead of resetting the whole
+//		cache
+//
+//---------------------------------------------------------------------------
+void
+COptTasks::EvictInvalidatedMDObjects
+	(
+	IMemoryPool *mp
+	)
+{
+	List *invalidated_objects = gpdb::MDCacheInvalidatedObjects();
+	ListCell *lc = NULL;
+
+	ForEach (lc, invalidated_objects)
+	{
+		MDCacheObjectKey *key = (MDCacheObjectKey *) lfirst(lc);
+		IMDId *mdid = NULL;
+
+		switch (key->mdid_type)
+		{
+			case IMDId::EmdidGPDB:
+				mdid = GPOS_NEW(mp) CMDIdGPDB(key->oid);
+				break;
+			case IMDId::EmdidRelStats:
+				mdid = GPOS_NEW(mp) CMDIdRelStats(GPOS_NEW(mp) CMDIdGPDB(key->oid));
+				break;
+			case IMDId::EmdidColStats:
+				mdid = GPOS_NEW(mp) CMDIdColStats(GPOS_NEW(mp) CMDIdGPDB(key->oid), (ULONG) key->pos);
+				break;
+			default:
+				GPOS_ASSERT(!"Unexpected MD cache object");
+				continue;
+		}
+
+		{
+			// the accessor releases the entry when it goes out of scope,
+			// which deletes it if it was marked for deletion
+			CMDKey md_key(mdid);
+			CCacheAccessor<IMDCacheObject*, CMDKey*> cache_accessor(CMDCache::Pcache());
+
+			if (NULL != cache_accessor.Lookup(&md_key))
+			{
+				cache_accessor.MarkForDeletion();
+			}
+		}
+
+		mdid->Release();
+	}
+
+	gpdb::ListFreeDeep(invalidated_objects);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::CacheQueryMDObjects
+//
+//	@doc:
+//		Add the relation and relation statistics objects of the relations a
+//		query refers to, which are the bulk of the metadata of a query over
+//		partitioned tables, to the MD cache. They are handed over by the
+//		relcache provider as built, instead of being serialized to DXL and
+//		parsed back, as the MD accessor would do when it misses them.
+//
+//---------------------------------------------------------------------------
+void
+COptTasks::CacheQueryMDObjects
+	(
+	IMemoryPool *mp,
+	CMDAccessor *md_accessor,
+	CMDProviderRelcache *relcache_provider,
+	Query *query
+	)
+{
+	List *rel_oids = gpdb::GetQueryRelationOids(query);
+	ListCell *lc = NULL;
+
+	ForEach (lc, rel_oids)
+	{
+		CMDIdGPDB *rel_mdid = GPOS_NEW(mp) CMDIdGPDB(lfirst_oid(lc));
+		rel_mdid->AddRef();
+		IMDId *mdids[] =
+			{
+			rel_mdid,
+			GPOS_NEW(mp) CMDIdRelStats(rel_mdid)
+			};
+
+		for (ULONG ul = 0; ul < GPOS_ARRAY_SIZE(mdids); ul++)
+		{
+			CMDKey md_key(mdids[ul]);
+			CCacheAccessor<IMDCacheObject*, CMDKey*> cache_accessor(CMDCache::Pcache());
+
+			if (NULL == cache_accessor.Lookup(&md_key))
+			{
+				// the object and its key live in the memory pool of the
+				// cache entry
+				IMemoryPool *cache_mp = cache_accessor.Pmp();
+				IMDCacheObject *md_obj = relcache_provider->GetMDObj(cache_mp, md_accessor, mdids[ul]);
+				CMDKey *cache_key = GPOS_NEW(cache_mp) CMDKey(md_obj->MDId());
+
+				cache_accessor.Insert(cache_key, md_obj);
+			}
+		}
+
+		mdids[0]->Release();
+		mdids[1]->Release();
+	}
+
+	gpdb::ListFree(rel_oids);
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::GetBudgetFallbackTraceflags
+//
+//	@doc:
+//		Trace flags that disable the xforms of the next cheaper join order
+//		search than the configured one, or NULL if it is already the
+//		cheapest: an exhaustive search falls back to the greedy one, which
+//		falls back to the join order of the query
+//
+//---------------------------------------------------------------------------
+CBitSet *
+COptTasks::GetBudgetFallbackTraceflags
+	(
+	IMemoryPool *mp
+	)
+{
+	switch (optimizer_join_order)
+	{
+		case JOIN_ORDER_EXHAUSTIVE_SEARCH:
+			return CXform::PbsJoinOrderOnGreedyXforms(mp);
+		case JOIN_ORDER_GREEDY_SEARCH:
+			return CXform::PbsJoinOrderInQueryXforms(mp);
+		default:
+			return NULL;
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::OptimizeWithinBudget
+//
+//	@doc:
+//		Optimize a query DXL, keeping to optimizer_search_time_budget and
+//		optimizer_search_memory_budget.
+//
+//		The search can't be stopped at an arbitrary point with a complete
+//		plan at hand. So the configured search is aborted when the budget
+//		runs out, and the query is then optimized again with a cheaper
+//		join order search, which is polynomial in the number of joins. That
+//		second search isn't bounded by the budget, so an optimization that
+//		runs out of it takes somewhat longer than the budget.
+//
+//---------------------------------------------------------------------------
+CDXLNode *
+COptTasks::OptimizeWithinBudget
+	(
+	IMemoryPool *mp,
+	CMDAccessor *md_accessor,
+	CDXLNode *query_dxl,
+	CDXLNodeArray *query_output_dxlnode_array,
+	CDXLNodeArray *cte_dxlnode_array,
+	IConstExprEvaluator *expr_evaluator,
+	ULONG num_segments,
+	CSearchStageArray *search_strategy_arr,
+	COptimizerConfig *optimizer_config,
+	BOOL *budget_exceeded
+	)
+{
+	*budget_exceeded = false;
+
+	CBitSet *fallback_trace_flags = NULL;
+	if (0 < optimizer_search_time_budget || 0 < optimizer_search_memory_budget)
+	{
+		fallback_trace_flags = GetBudgetFallbackTraceflags(mp);
+	}
+
+	if (NULL == fallback_trace_flags)
+	{
+		return COptimizer::PdxlnOptimize
+					(
+					mp,
+					md_accessor,
+					query_dxl,
+					query_output_dxlnode_array,
+					cte_dxlnode_array,
+					expr_evaluator,
+					num_segments,
+					gp_session_id,
+					gp_command_count,
+					search_strategy_arr,
+					optimizer_config
+					);
+	}
+
+	// each search takes over the search strategy, keep it for the second one
+	CRefCount::SafeAddRef(search_strategy_arr);
+
+	CDXLNode *plan_dxl = NULL;
+	gpdb::EnforceOptimizerBudget(true);
+	GPOS_TRY
+	{
+		plan_dxl = COptimizer::PdxlnOptimize
+								(
+								mp,
+								md_accessor,
+								query_dxl,
+								query_output_dxlnode_array,
+								cte_dxlnode_array,
+								expr_evaluator,
+								num_segments,
+								gp_session_id,
+								gp_command_count,
+								search_strategy_arr,
+								optimizer_config
+								);
+	}
+	GPOS_CATCH_EX(ex)
+	{
+		gpdb::EnforceOptimizerBudget(false);
+
+		if (!GPOS_MATCH_EX(ex, CException::ExmaSystem, CException::ExmiAbort) ||
+			!gpdb::IsOptimizerBudgetExceeded())
+		{
+			CRefCount::SafeRelease(search_strategy_arr);
+			fallback_trace_flags->Release();
+			GPOS_RETHROW(ex);
+		}
+
+		GPOS_RESET_EX;
+	}
+	GPOS_CATCH_END;
+
+	gpdb::EnforceOptimizerBudget(false);
+
+	if (NULL != plan_dxl)
+	{
+		CRefCount::SafeRelease(search_strategy_arr);
+		fallback_trace_flags->Release();
+
+		return plan_dxl;
+	}
+
+	// the budget ran out, optimize with the cheaper search
+	CBitSet *enabled_trace_flags = NULL;
+	CBitSet *disabled_trace_flags = NULL;
+	SetTraceflags(mp, fallback_trace_flags, &enabled_trace_flags, &disabled_trace_flags);
+
+	plan_dxl = COptimizer::PdxlnOptimize
+							(
+							mp,
+							md_accessor,
+							query_dxl,
+							query_output_dxlnode_array,
+							cte_dxlnode_array,
+							expr_evaluator,
+							num_segments,
+							gp_session_id,
+							gp_command_count,
+							search_strategy_arr,
+							optimizer_config
+							);
+
+	ResetTraceflags(enabled_trace_flags, disabled_trace_flags);
+	CRefCount::SafeRelease(enabled_trace_flags);
+	CRefCount::SafeRelease(disabled_trace_flags);
+	fallback_trace_flags->Release();
+
+	*budget_exceeded = true;
+
+	return plan_dxl;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptTasks::OptimizeTask
@@ -690,9 +973,14 @@ COptTasks::OptimizeTask
 		CMDCache::Reset();
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
 	}
-	else if (CMDCache::ULLGetCacheQuota() != (ULLONG) optimizer_mdcache_size * 1024L)
+	else
 	{
-		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		EvictInvalidatedMDObjects(mp);
+
+		if (CMDCache::ULLGetCacheQuota() != (ULLONG) optimizer_mdcache_size * 1024L)
+		{
+			CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		}
 	}
 
 
@@ -707,6 +995,15 @@ COptTasks::OptimizeTask
 	IMdIdArray *col_stats = NULL;
 	MdidHashSet *rel_stats = NULL;
 
+	// the budget counts the time and memory spent on the whole task
+	gpdb::StartOptimizerBudget(optimizer_search_time_budget, optimizer_search_memory_budget);
+
+	// profile where the task spends its time and memory
+	gpdb::BeginOptimizerProfile();
+
+	// the relation and its indexes share a part constraint
+	gpdb::StartPartConstraintCache();
+
 	GPOS_TRY
 	{
 		// set trace flags
@@ -720,6 +1017,8 @@ COptTasks::OptimizeTask
 			// scope for MD accessor
 			CMDAccessor mda(mp, CMDCache::Pcache(), default_sysid, relcache_provider);
 
+			CacheQueryMDObjects(mp, &mda, relcache_provider, (Query*) opt_ctxt->m_query);
+
 			// ColId generator
 			CIdGenerator colid_generator(GPDXL_COL_ID_START);
 			CIdGenerator cteid_generator(GPDXL_CTE_ID_START);
@@ -752,7 +1051,11 @@ COptTasks::OptimizeTask
 			IConstExprEvaluator *expr_evaluator =
 					GPOS_NEW(mp) CConstExprEvaluatorDXL(mp, &mda, &expr_eval_proxy);
 
-			CDXLNode *query_dxl = query_to_dxl_translator->TranslateQueryToDXL();
+			CDXLNode *query_dxl = NULL;
+			{
+				CAutoOptimizerPhase phase(OPTIMIZER_PHASE_QUERY_TO_DXL);
+				query_dxl = query_to_dxl_translator->TranslateQueryToDXL();
+			}
 			CDXLNodeArray *query_output_dxlnode_array = query_to_dxl_translator->GetQueryOutputCols();
 			CDXLNodeArray *cte_dxlnode_array = query_to_dxl_translator->GetCTEs();
 			GPOS_ASSERT(NULL != query_output_dxlnode_array);
@@ -761,20 +1064,23 @@ COptTasks::OptimizeTask
 						(!optimizer_enable_motions_masteronly_queries && !query_to_dxl_translator->HasDistributedTables());
 			CAutoTraceFlag atf(EopttraceDisableMotions, is_master_only);
 
-			plan_dxl = COptimizer::PdxlnOptimize
-									(
-									mp,
-									&mda,
-									query_dxl,
-									query_output_dxlnode_array,
-									cte_dxlnode_array,
-									expr_evaluator,
-									num_segments,
-									gp_session_id,
-									gp_command_count,
-									search_strategy_arr,
-									optimizer_config
-									);
+			BOOL budget_exceeded = false;
+			{
+				CAutoOptimizerPhase phase(OPTIMIZER_PHASE_SEARCH);
+				plan_dxl = OptimizeWithinBudget
+										(
+										mp,
+										&mda,
+										query_dxl,
+										query_output_dxlnode_array,
+										cte_dxlnode_array,
+										expr_evaluator,
+										num_segments,
+										search_strategy_arr,
+										optimizer_config,
+										&budget_exceeded
+										);
+			}
 
 			if (opt_ctxt->m_should_serialize_plan_dxl)
 			{
@@ -790,7 +1096,9 @@ COptTasks::OptimizeTask
 			{
 				// always use opt_ctxt->m_query->can_set_tag as the query_to_dxl_translator->Pquery() is a mutated Query object
 				// that may not have the correct can_set_tag
+				CAutoOptimizerPhase phase(OPTIMIZER_PHASE_DXL_TO_PLSTMT);
 				opt_ctxt->m_plan_stmt = (PlannedStmt *) gpdb::CopyObject(ConvertToPlanStmtFromDXL(mp, &mda, plan_dxl, opt_ctxt->m_query->canSetTag));
+				opt_ctxt->m_plan_stmt->budgetExceeded = budget_exceeded;
 			}
 
 			CStatisticsConfig *stats_conf = optimizer_config->GetStatsConf();
@@ -819,6 +1127,8 @@ COptTasks::OptimizeTask
 		CRefCount::SafeRelease(trace_flags);
 		CRefCount::SafeRelease(plan_dxl);
 		CMDCache::Shutdown();
+		gpdb::EndPartConstraintCache();
+		gpdb::EndOptimizerBudget();
 
 		if (GPOS_MATCH_EX(ex, gpdxl::ExmaGPDB, gpdxl::ExmiGPDBError))
 		{
@@ -838,6 +1148,9 @@ COptTasks::OptimizeTask
 	GPOS_CATCH_END;
 
 	// cleanup
+	gpdb::EndPartConstraintCache();
+	gpdb::EndOptimizerProfile();
+	gpdb::EndOptimizerBudget();
 	ResetTraceflags(enabled_trace_flags, disabled_trace_flags);
 	CRefCount::SafeRelease(enabled_trace_flags);
 	CRefCount::SafeRelease(disabled_trace_flags);
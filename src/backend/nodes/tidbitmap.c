@@ -1497,6 +1497,10 @@ opstream_begin_iterate(StreamNode *self, StreamBMIterator *iterator)
 
 		iterator->input.stream = lappend(iterator->input.stream, inIter);
 	}
+
+	/* The pages pulled from the inputs, reused on every pull. */
+	iterator->inputentries = (PagetableEntry *)
+		palloc(list_length(input) * sizeof(PagetableEntry));
 }
 
 static void
@@ -1511,6 +1515,7 @@ opstream_end_iterate(StreamBMIterator *self)
 		tbm_stream_end_iterate(inIter);
 	}
 	list_free(self->input.stream);
+	pfree(self->inputentries);
 }
 
 /*
@@ -1540,9 +1545,9 @@ opstream_iterate(StreamBMIterator *iterator, PagetableEntry *e)
 	 */
 	ListCell   *map;
 	BlockNumber minblockno;
-	ListCell   *cell;
+	int			ninputs;
+	int			i;
 	int			wordnum;
-	List	   *matches;
 	bool		empty;
 
 
@@ -1567,16 +1572,16 @@ opstream_iterate(StreamBMIterator *iterator, PagetableEntry *e)
 restart:
 	e->blockno = InvalidBlockNumber;
 	empty = false;
-	matches = NIL;
+	ninputs = 0;
 	minblockno = InvalidBlockNumber;
 	Assert(PointerIsValid(iterator->input.stream));
 	foreach(map, iterator->input.stream)
 	{
 		StreamBMIterator *inIter = lfirst(map);
-		PagetableEntry *new;
+		PagetableEntry *new = &iterator->inputentries[ninputs++];
 		bool		r;
 
-		new = (PagetableEntry *) palloc0(sizeof(PagetableEntry));
+		MemSet(new, 0, sizeof(PagetableEntry));
 
 		/* set the desired block */
 		inIter->nextblock = iterator->nextblock;
@@ -1598,11 +1603,10 @@ restart:
 				minblockno = Min(minblockno, new->blockno);
 			else
 				minblockno = Max(minblockno, new->blockno);
-			matches = lappend(matches, (void *) new);
 		}
 		else
 		{
-			pfree(new);
+			new->blockno = InvalidBlockNumber;
 
 			if (n->type == BMS_AND)
 			{
@@ -1623,9 +1627,13 @@ restart:
 	 * Now we iterate through the actual matches and perform the desired
 	 * operation on those from the same minimum block
 	 */
-	foreach(cell, matches)
+	for (i = 0; i < ninputs; i++)
 	{
-		PagetableEntry *tmp = (PagetableEntry *) lfirst(cell);
+		PagetableEntry *tmp = &iterator->inputentries[i];
+
+		/* this input had no more pages */
+		if (tmp->blockno == InvalidBlockNumber)
+			continue;
 
 		if (tmp->blockno == minblockno)
 		{
@@ -1644,15 +1652,22 @@ restart:
 				e->ischunk = true;
 				/* XXX: we can just return now... I think :) */
 				iterator->nextblock = minblockno + 1;
-				list_free_deep(matches);
 				return res;
 			}
-			/* union/intersect existing output and new matches */
-			for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++)
+
+			/*
+			 * Union/intersect existing output and new matches. The operator
+			 * is tested outside the loops to keep them branch-free, so that
+			 * the compiler can vectorize them.
+			 */
+			if (n->type == BMS_OR)
 			{
-				if (n->type == BMS_OR)
+				for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++)
 					e->words[wordnum] |= tmp->words[wordnum];
-				else
+			}
+			else
+			{
+				for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++)
 					e->words[wordnum] &= tmp->words[wordnum];
 			}
 		}
@@ -1677,11 +1692,8 @@ restart:
 		/* start again */
 		empty = false;
 		MemSet(e->words, 0, sizeof(tbm_bitmapword) * WORDS_PER_PAGE);
-		list_free_deep(matches);
 		goto restart;
 	}
-	else
-		list_free_deep(matches);
 	if (res)
 		iterator->nextblock = minblockno + 1;
 
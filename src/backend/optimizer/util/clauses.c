@@ -21,6 +21,7 @@
 
 #include "postgres.h"
 
+#include "access/hash.h"
 #include "catalog/pg_aggregate.h"
 #include "catalog/pg_language.h"
 #include "catalog/pg_operator.h"
@@ -46,6 +47,7 @@
 #include "utils/acl.h"
 #include "utils/builtins.h"
 #include "utils/datum.h"
+#include "utils/hsearch.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/syscache.h"
@@ -137,6 +139,9 @@ static Expr *inline_function(Oid funcid, Oid result_type, Oid result_collid,
 				bool funcvariadic,
 				HeapTuple func_tuple,
 				eval_const_expressions_context *context);
+static Const *evaluate_expr_in_estate(EState *estate, MemoryContext workcxt,
+						Expr *expr, Oid result_type, int32 result_typmod,
+						Oid result_collation);
 static Node *substitute_actual_parameters(Node *expr, int nargs, List *args,
 							 int *usecounts);
 static Node *substitute_actual_parameters_mutator(Node *node,
@@ -4764,12 +4769,7 @@ evaluate_expr(Expr *expr, Oid result_type, int32 result_typmod,
 			  Oid result_collation)
 {
 	EState	   *estate;
-	ExprState  *exprstate;
-	MemoryContext oldcontext;
-	Datum		const_val;
-	bool		const_is_null;
-	int16		resultTypLen;
-	bool		resultTypByVal;
+	Const	   *result;
 
 	/*
 	 * To use the executor, we need an EState.
@@ -4777,7 +4777,34 @@ evaluate_expr(Expr *expr, Oid result_type, int32 result_typmod,
 	estate = CreateExecutorState();
 
 	/* We can use the estate's working context to avoid memory leaks. */
-	oldcontext = MemoryContextSwitchTo(estate->es_query_cxt);
+	result = evaluate_expr_in_estate(estate, estate->es_query_cxt, expr,
+									 result_type, result_typmod,
+									 result_collation);
+
+	/* Release all the junk we just created */
+	FreeExecutorState(estate);
+
+	return (Expr *) result;
+}
+
+/*
+ * Evaluate a constant expression with the given EState, building its
+ * execution state in 'workcxt'. The result is made in the caller's memory
+ * context.
+ */
+static Const *
+evaluate_expr_in_estate(EState *estate, MemoryContext workcxt, Expr *expr,
+						Oid result_type, int32 result_typmod,
+						Oid result_collation)
+{
+	ExprState  *exprstate;
+	MemoryContext oldcontext;
+	Datum		const_val;
+	bool		const_is_null;
+	int16		resultTypLen;
+	bool		resultTypByVal;
+
+	oldcontext = MemoryContextSwitchTo(workcxt);
 
 	/* Make sure any opfuncids are filled in. */
 	fix_opfuncids((Node *) expr);
@@ -4821,16 +4848,155 @@ evaluate_expr(Expr *expr, Oid result_type, int32 result_typmod,
 			const_val = datumCopy(const_val, resultTypByVal, resultTypLen);
 	}
 
-	/* Release all the junk we just created */
-	FreeExecutorState(estate);
-
 	/*
 	 * Make the constant result node.
 	 */
-	return (Expr *) makeConst(result_type, result_typmod, result_collation,
-							  resultTypLen,
-							  const_val, const_is_null,
-							  resultTypByVal);
+	return makeConst(result_type, result_typmod, result_collation,
+					 resultTypLen,
+					 const_val, const_is_null,
+					 resultTypByVal);
+}
+
+/*
+ * An executor context to evaluate many constant expressions in, such as the
+ * ones the ORCA optimizer folds while optimizing a query. Setting up an
+ * EState for every expression, as evaluate_expr() does, dominates the cost
+ * of folding simple expressions like the casts of the elements of a long IN
+ * list. The results of non-volatile expressions are remembered for the life
+ * of the context, so an expression that is folded again, in another part of
+ * the plan search, is not evaluated again.
+ */
+struct ConstExprEvalContext
+{
+	EState	   *estate;
+	MemoryContext exprcxt;		/* execution state of the current expression */
+	HTAB	   *results;		/* ConstExprEvalResult, by nodeToString() of
+								 * the expression */
+};
+
+typedef struct ConstExprEvalResult
+{
+	char	   *exprstr;		/* hash key, must be first */
+	Const	   *result;
+} ConstExprEvalResult;
+
+static uint32
+const_expr_eval_hash(const void *key, Size keysize)
+{
+	const char *exprstr = *(char *const *) key;
+
+	return DatumGetUInt32(hash_any((const unsigned char *) exprstr,
+								   strlen(exprstr)));
+}
+
+static int
+const_expr_eval_match(const void *key1, const void *key2, Size keysize)
+{
+	return strcmp(*(char *const *) key1, *(char *const *) key2);
+}
+
+/*
+ * Create a context to evaluate constant expressions in, in the current
+ * memory context.
+ */
+ConstExprEvalContext *
+CreateConstExprEvalContext(void)
+{
+	ConstExprEvalContext *cxt;
+	HASHCTL		hash_ctl;
+
+	cxt = palloc(sizeof(ConstExprEvalContext));
+	cxt->estate = CreateExecutorState();
+	cxt->exprcxt = AllocSetContextCreate(cxt->estate->es_query_cxt,
+										 "ConstExprEvalContext",
+										 ALLOCSET_SMALL_MINSIZE,
+										 ALLOCSET_SMALL_INITSIZE,
+										 ALLOCSET_DEFAULT_MAXSIZE);
+
+	MemSet(&hash_ctl, 0, sizeof(hash_ctl));
+	hash_ctl.keysize = sizeof(char *);
+	hash_ctl.entrysize = sizeof(ConstExprEvalResult);
+	hash_ctl.hash = const_expr_eval_hash;
+	hash_ctl.match = const_expr_eval_match;
+	hash_ctl.hcxt = cxt->estate->es_query_cxt;
+	cxt->results = hash_create("ConstExprEvalContext results", 256, &hash_ctl,
+							   HASH_ELEM | HASH_FUNCTION | HASH_COMPARE |
+							   HASH_CONTEXT);
+
+	return cxt;
+}
+
+/*
+ * Evaluate a list of constant expressions in the given context, and return
+ * the list of their results as Consts, made in the caller's memory context.
+ */
+List *
+evaluate_exprs(ConstExprEvalContext *cxt, List *exprs)
+{
+	List	   *results = NIL;
+	ListCell   *lc;
+
+	foreach(lc, exprs)
+	{
+		Expr	   *expr = (Expr *) lfirst(lc);
+		char	   *exprstr = NULL;
+		ConstExprEvalResult *entry;
+		Const	   *result;
+		MemoryContext oldcontext;
+
+		if (!contain_volatile_functions((Node *) expr))
+		{
+			exprstr = nodeToString(expr);
+			entry = (ConstExprEvalResult *) hash_search(cxt->results, &exprstr,
+														HASH_FIND, NULL);
+			if (entry != NULL)
+			{
+				pfree(exprstr);
+				results = lappend(results, copyObject(entry->result));
+				continue;
+			}
+		}
+
+		result = evaluate_expr_in_estate(cxt->estate, cxt->exprcxt, expr,
+										 exprType((Node *) expr),
+										 exprTypmod((Node *) expr),
+										 exprCollation((Node *) expr));
+
+		/*
+		 * Release the execution state of the expression, calling any shutdown
+		 * callbacks it registered, so that it doesn't accumulate over many
+		 * expressions.
+		 */
+		ReScanExprContext(GetPerTupleExprContext(cxt->estate));
+		MemoryContextReset(cxt->exprcxt);
+
+		if (exprstr != NULL)
+		{
+			oldcontext = MemoryContextSwitchTo(cxt->estate->es_query_cxt);
+			entry = (ConstExprEvalResult *) hash_search(cxt->results, &exprstr,
+														HASH_ENTER, NULL);
+			entry->exprstr = pstrdup(exprstr);
+			entry->result = copyObject(result);
+			MemoryContextSwitchTo(oldcontext);
+
+			pfree(exprstr);
+		}
+
+		results = lappend(results, result);
+	}
+
+	return results;
+}
+
+/*
+ * Free a context made by CreateConstExprEvalContext(), along with the
+ * results it remembers.
+ */
+void
+FreeConstExprEvalContext(ConstExprEvalContext *cxt)
+{
+	FreeExecutorState(cxt->estate);
+	pfree(cxt);
 }
 
 
@@ -0,0 +1,230 @@
+/*-------------------------------------------------------------------------
+ *
+ * optprofile.c
+ *	  Per-phase profile of the optimizations done by ORCA
+ *
+ * ORCA reports where an optimization spends its time and memory here: the
+ * wall time of each phase, the most optimizer memory in use, and how often
+ * metadata had to be fetched from the catalogs. The profile of the last
+ * optimization is shown by EXPLAIN (optimizer_profile), and the totals of
+ * the session by the gp_optimizer_profile view.
+ *
+ * Optimizer memory is only measured when ORCA allocates through GPDB, with
+ * optimizer_use_gpdb_allocators; without it the peak memory is unknown.
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/optimizer/util/optprofile.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "catalog/pg_type.h"
+#include "funcapi.h"
+#include "optimizer/optprofile.h"
+#include "utils/builtins.h"
+#include "utils/ext_alloc.h"
+#include "utils/guc.h"
+
+/* profile of the optimization in progress, or of the last one */
+static OptimizerProfile CurrentProfile;
+
+/* totals of the optimizations of the session */
+static OptimizerProfile SessionProfile;
+
+/* number of optimizations profiled in the session */
+static uint64 NumProfiles = 0;
+
+static bool ProfileActive = false;
+
+/* balance of optimizer memory at the start of the optimization */
+static uint64 StartMemoryBalance = 0;
+
+/*
+ * Phases may be entered recursively, e.g. metadata is fetched while the
+ * metadata of another object is translated. Only the outermost call is
+ * timed.
+ */
+static int	PhaseDepth[NUM_OPTIMIZER_PHASES];
+
+/*
+ * Start profiling an optimization
+ */
+void
+OptimizerProfileBegin(void)
+{
+	MemSet(&CurrentProfile, 0, sizeof(CurrentProfile));
+	MemSet(PhaseDepth, 0, sizeof(PhaseDepth));
+
+	StartMemoryBalance = GetOptimizerOutstandingMemoryBalance();
+	ResetOptimizerMemoryHighWaterMark();
+
+	ProfileActive = true;
+}
+
+/*
+ * Finish profiling an optimization, and add it to the session's totals.
+ * An optimization that errors out is not counted.
+ */
+void
+OptimizerProfileEnd(void)
+{
+	int			i;
+
+	if (!ProfileActive)
+		return;
+
+	CurrentProfile.peak_memory =
+		GetOptimizerMemoryHighWaterMark() - StartMemoryBalance;
+
+	for (i = 0; i < NUM_OPTIMIZER_PHASES; i++)
+		SessionProfile.phase_time[i] += CurrentProfile.phase_time[i];
+	SessionProfile.peak_memory = Max(SessionProfile.peak_memory,
+									 CurrentProfile.peak_memory);
+	SessionProfile.md_fetches += CurrentProfile.md_fetches;
+	SessionProfile.md_shared_hits += CurrentProfile.md_shared_hits;
+	SessionProfile.const_exprs += CurrentProfile.const_exprs;
+
+	NumProfiles++;
+	ProfileActive = false;
+}
+
+void
+OptimizerProfileStartPhase(OptimizerPhase phase, instr_time *start)
+{
+	if (!ProfileActive)
+		return;
+
+	if (PhaseDepth[phase]++ == 0)
+		INSTR_TIME_SET_CURRENT(*start);
+}
+
+void
+OptimizerProfileEndPhase(OptimizerPhase phase, instr_time *start)
+{
+	instr_time	duration;
+
+	if (!ProfileActive || PhaseDepth[phase] == 0)
+		return;
+
+	if (--PhaseDepth[phase] > 0)
+		return;
+
+	INSTR_TIME_SET_CURRENT(duration);
+	INSTR_TIME_SUBTRACT(duration, *start);
+	CurrentProfile.phase_time[phase] += INSTR_TIME_GET_MILLISEC(duration);
+}
+
+/*
+ * Count an object fetched by the metadata provider, and whether it was
+ * found in the shared metadata cache rather than built from the catalogs
+ */
+void
+OptimizerProfileCountMDFetch(bool shared_hit)
+{
+	if (!ProfileActive)
+		return;
+
+	CurrentProfile.md_fetches++;
+	if (shared_hit)
+		CurrentProfile.md_shared_hits++;
+}
+
+void
+OptimizerProfileCountConstExprs(int nexprs)
+{
+	if (!ProfileActive)
+		return;
+
+	CurrentProfile.const_exprs += nexprs;
+}
+
+/*
+ * Number of optimizations profiled in the session. A caller can tell
+ * whether OptimizerProfileLast() describes a plan it asked for by checking
+ * that this changed.
+ */
+uint64
+OptimizerProfileCount(void)
+{
+	return NumProfiles;
+}
+
+const OptimizerProfile *
+OptimizerProfileLast(void)
+{
+	return &CurrentProfile;
+}
+
+/*
+ * Is the peak memory of the profiles measured? It is counted by the GPDB
+ * allocators, which ORCA only uses with optimizer_use_gpdb_allocators.
+ */
+bool
+OptimizerProfilePeakMemoryKnown(void)
+{
+	return optimizer_use_gpdb_allocators;
+}
+
+/*
+ * SQL-callable function returning the totals of the optimizations done by
+ * ORCA in this session
+ */
+Datum
+gp_optimizer_profile(PG_FUNCTION_ARGS)
+{
+	TupleDesc	tupdesc;
+	HeapTuple	tuple;
+	Datum		values[10];
+	bool		nulls[10];
+
+	/*
+	 * build tupdesc for result tuples. This must match the definition of the
+	 * gp_optimizer_profile view in system_views.sql
+	 */
+	tupdesc = CreateTemplateTupleDesc(10, false);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "queries",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "query_to_dxl_ms",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "metadata_ms",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "search_ms",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "dxl_to_plan_ms",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "const_eval_ms",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 7, "peak_memory_kb",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 8, "md_fetches",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 9, "md_shared_cache_hits",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 10, "const_exprs",
+					   INT8OID, -1, 0);
+	tupdesc = BlessTupleDesc(tupdesc);
+
+	MemSet(nulls, 0, sizeof(nulls));
+
+	values[0] = Int64GetDatum((int64) NumProfiles);
+	values[1] = Float8GetDatum(SessionProfile.phase_time[OPTIMIZER_PHASE_QUERY_TO_DXL]);
+	values[2] = Float8GetDatum(SessionProfile.phase_time[OPTIMIZER_PHASE_METADATA]);
+	values[3] = Float8GetDatum(SessionProfile.phase_time[OPTIMIZER_PHASE_SEARCH]);
+	values[4] = Float8GetDatum(SessionProfile.phase_time[OPTIMIZER_PHASE_DXL_TO_PLSTMT]);
+	values[5] = Float8GetDatum(SessionProfile.phase_time[OPTIMIZER_PHASE_CONST_EVAL]);
+	if (OptimizerProfilePeakMemoryKnown())
+		values[6] = Int64GetDatum((int64) ((SessionProfile.peak_memory + 1023) / 1024));
+	else
+		nulls[6] = true;
+	values[7] = Int64GetDatum(SessionProfile.md_fetches);
+	values[8] = Int64GetDatum(SessionProfile.md_shared_hits);
+	values[9] = Int64GetDatum(SessionProfile.const_exprs);
+
+	tuple = heap_form_tuple(tupdesc, values, nulls);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
+}
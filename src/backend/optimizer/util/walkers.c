@@ -677,6 +677,72 @@ extract_nodes_walker(Node *node, extract_context *context)
 								  (void *) context);
 }
 
+typedef struct extract_paramids_context
+{
+	plan_tree_base_prefix base; /* Required prefix for plan_tree_walker/mutator */
+	Plan	   *root;
+	Plan	  **known;
+	int			nknown;
+	Bitmapset  *paramids;
+} extract_paramids_context;
+
+static bool extract_plan_paramids_walker(Node *node, extract_paramids_context *context);
+
+/**
+ * Collect the paramids of the Params in a plan tree, i.e. of the nodes that
+ * extract_nodes_plan(pl, T_Param, true) returns.
+ *
+ * 'known' is an array of plan nodes indexed by plan_node_id. The allParam of
+ * a node below 'pl' that is found in it is taken to hold the paramids of the
+ * node's subtree, which is not searched again. A plan built bottom up can so
+ * have the allParam of every node set in time linear in its size.
+ */
+Bitmapset *
+extract_plan_paramids(Plan *pl, Plan **known, int nknown)
+{
+	extract_paramids_context context;
+	Assert(pl);
+	context.base.node = NULL;
+	context.root = pl;
+	context.known = known;
+	context.nknown = nknown;
+	context.paramids = NULL;
+	extract_plan_paramids_walker((Node *) pl, &context);
+	return context.paramids;
+}
+
+static bool
+extract_plan_paramids_walker(Node *node, extract_paramids_context *context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Param))
+	{
+		context->paramids = bms_add_member(context->paramids,
+										   ((Param *) node)->paramid);
+		return false;
+	}
+	/* Like extract_nodes_walker, do not descend into SubPlans */
+	if (IsA(node, SubPlan))
+		return false;
+	if (node != (Node *) context->root &&
+		nodeTag(node) >= T_Plan_Start && nodeTag(node) < T_Plan_End)
+	{
+		Plan	   *plan = (Plan *) node;
+
+		if (plan->plan_node_id >= 0 && plan->plan_node_id < context->nknown &&
+			context->known[plan->plan_node_id] == plan)
+		{
+			context->paramids = bms_add_members(context->paramids,
+												plan->allParam);
+			return false;
+		}
+	}
+
+	return plan_tree_walker(node, extract_plan_paramids_walker,
+							(void *) context);
+}
+
 /**
  * Extract nodes with specific tag.
  * Same as above, but starts off a scalar expression node rather than a PlannedStmt
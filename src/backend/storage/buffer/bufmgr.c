@@ -81,6 +81,13 @@ int			bgwriter_lru_maxpages = 100;
 double		bgwriter_lru_multiplier = 2.0;
 bool		track_io_timing = false;
 
+/*
+ * The effective_io_concurrency setting, i.e. the number of simultaneous
+ * requests the disk subsystem is expected to handle.  Tablespaces can
+ * override it, see get_tablespace_io_concurrency.
+ */
+int			effective_io_concurrency = 0;
+
 /*
  * How many buffers PrefetchBuffer callers should try to stay ahead of their
  * ReadBuffer calls by.  This is maintained by the assign hook for
@@ -32,6 +32,12 @@ static const struct{
 {
     {{"none", "false", "no", "off", "0", 0}, bfz_nothing_init},
     {{"zlib", 0}, bfz_zlib_init},
+#ifdef HAVE_LIBZSTD
+    {{"zstd", 0}, bfz_zstd_init},
+#endif
+#ifdef HAVE_LIBLZ4
+    {{"lz4", 0}, bfz_lz4_init},
+#endif
     {{0}}
 };
 
@@ -279,6 +285,7 @@ bfz_create_internal(const char *fileName, bool open_existing,
 	bfz_handle->has_checksum = gp_workfile_checksumming;
 
 	bfz_handle->numBlocks = bfz_handle->blockNo = bfz_handle->chosenBlockNo = 0;
+	bfz_handle->prefetchPos = 0;
 	
 	fs = bfz_handle->freeable_stuff;
 	fs->tot_bytes = 0;
@@ -390,6 +397,7 @@ bfz_scan_begin(bfz_t * thiz)
 				errmsg("could not seek in temporary file: %m")));
 
 	thiz->mode = BFZ_MODE_SCAN;
+	thiz->prefetchPos = 0;
 
 	/*
 	 * Allocating in the TopMemoryContext since this memory context
@@ -406,6 +414,41 @@ bfz_scan_begin(bfz_t * thiz)
 	MemoryContextSwitchTo(oldcxt);
 }
 
+/*
+ * bfz_readahead
+ *		Ask the kernel to start reading the part of the file that follows
+ *		the current read position.
+ *
+ * The compression algorithms call this before every read from the
+ * underlying file. We keep a window of gp_workfile_prefetch_blocks blocks
+ * in flight ahead of the read position, and extend it each time half of
+ * it has been consumed. That way the disk reads for the next half of the
+ * window overlap with decompressing and checksumming the current one,
+ * instead of every refill stalling on a synchronous read.
+ */
+void
+bfz_readahead(bfz_t * thiz)
+{
+	int64		window;
+	int64		pos;
+	int64		start;
+
+	Assert(thiz->mode == BFZ_MODE_SCAN);
+
+	if (gp_workfile_prefetch_blocks <= 0)
+		return;
+
+	window = (int64) gp_workfile_prefetch_blocks * BFZ_BUFFER_SIZE;
+
+	pos = FileSeek(thiz->file, 0, SEEK_CUR);
+	if (pos < 0 || pos + window / 2 < thiz->prefetchPos)
+		return;
+
+	start = Max(pos, thiz->prefetchPos);
+	(void) FilePrefetch(thiz->file, start, (int) (pos + window - start));
+	thiz->prefetchPos = pos + window;
+}
+
 void
 bfz_write_ex(bfz_t * thiz, const char *buffer, int size)
 {
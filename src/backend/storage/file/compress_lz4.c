@@ -0,0 +1,373 @@
+/* compress_lz4.c */
+#include "postgres.h"
+
+#include "storage/bfz.h"
+#include "utils/memutils.h"
+#include "utils/resowner.h"
+
+#ifdef HAVE_LIBLZ4
+
+#include <lz4frame.h>
+
+/*
+ * LZ4F allocates its contexts with malloc, and liblz4 does not export the
+ * functions that take custom allocators. A work file is not closed when the
+ * query errors out, so every context is tracked here, in TopMemoryContext,
+ * and freed when the resource owner it was created under is released.
+ */
+typedef struct bfz_lz4_context
+{
+	LZ4F_compressionContext_t cctx;
+	LZ4F_decompressionContext_t dctx;
+	ResourceOwner owner;
+
+	struct bfz_lz4_context *prev;
+	struct bfz_lz4_context *next;
+} bfz_lz4_context;
+
+static bfz_lz4_context *open_lz4_contexts = NULL;
+static bool lz4_resowner_callback_registered = false;
+
+struct bfz_lz4_freeable_stuff
+{
+	struct bfz_freeable_stuff super;
+
+	/* true if compressing, false if decompressing */
+	bool		compressing;
+
+	/* true once any data has been written to the current frame */
+	bool		started;
+
+	bool		eof_in;
+	bool		eof_out;
+
+	bfz_lz4_context *ctx;
+
+	/*
+	 * Compressed data. When compressing, the output of the compressor is
+	 * staged here before it is written to the file. When decompressing,
+	 * buf[in_pos .. in_size) is the part not yet consumed.
+	 */
+	int			in_pos;
+	int			in_size;
+	int			buf_size;
+	char	   *buf;
+};
+
+/* This file implements bfz compression algorithm "lz4". */
+
+static const LZ4F_preferences_t bfz_lz4_preferences = {
+	{LZ4F_max64KB, LZ4F_blockLinked, LZ4F_noContentChecksum},
+	0,							/* compressionLevel: fast */
+	0,							/* autoFlush */
+};
+
+/*
+ * bfz_lz4_free_context
+ *	Free the LZ4F contexts and forget about them.
+ */
+static void
+bfz_lz4_free_context(bfz_lz4_context *ctx)
+{
+	if (ctx->cctx != NULL)
+		LZ4F_freeCompressionContext(ctx->cctx);
+	if (ctx->dctx != NULL)
+		LZ4F_freeDecompressionContext(ctx->dctx);
+
+	if (ctx->prev)
+		ctx->prev->next = ctx->next;
+	else
+		open_lz4_contexts = ctx->next;
+	if (ctx->next)
+		ctx->next->prev = ctx->prev;
+
+	pfree(ctx);
+}
+
+/*
+ * Callback function, to free the contexts of files that were not closed
+ * when their resource owner goes away, e.g. at abort.
+ */
+static void
+bfz_lz4_free_callback(ResourceReleasePhase phase,
+					  bool isCommit,
+					  bool isTopLevel,
+					  void *arg)
+{
+	bfz_lz4_context *curr;
+	bfz_lz4_context *next;
+
+	if (phase != RESOURCE_RELEASE_AFTER_LOCKS)
+		return;
+
+	next = open_lz4_contexts;
+	while (next)
+	{
+		curr = next;
+		next = curr->next;
+
+		if (curr->owner == CurrentResourceOwner)
+			bfz_lz4_free_context(curr);
+	}
+}
+
+/*
+ * bfz_lz4_write_buf
+ *	Write the first 'have' bytes of the staging buffer to the file.
+ */
+static void
+bfz_lz4_write_buf(bfz_t *thiz, int have)
+{
+	struct bfz_lz4_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	int			written = 0;
+
+	while (have > 0)
+	{
+		int			n = FileWrite(thiz->file, fs->buf + written, have);
+
+		if (n < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write to temporary file: %m")));
+		written += n;
+		have -= n;
+	}
+}
+
+/*
+ * bfz_lz4_close_ex
+ *	Close buffers etc. Does not close the underlying file!
+ */
+static void
+bfz_lz4_close_ex(bfz_t *thiz)
+{
+	struct bfz_lz4_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+
+	if (NULL != fs)
+	{
+		if (fs->compressing && fs->started)
+		{
+			size_t		n;
+
+			/* Flush all remaining output and the frame epilogue */
+			n = LZ4F_compressEnd(fs->ctx->cctx, fs->buf, fs->buf_size, NULL);
+			if (LZ4F_isError(n))
+				ereport(ERROR,
+						(errmsg("lz4 compression failed"),
+						 errdetail("%s", LZ4F_getErrorName(n))));
+
+			bfz_lz4_write_buf(thiz, (int) n);
+		}
+
+		bfz_lz4_free_context(fs->ctx);
+
+		pfree(fs->buf);
+		pfree(fs);
+		thiz->freeable_stuff = NULL;
+	}
+}
+
+/*
+ * bfz_lz4_write_ex
+ *	 Write data to an opened compressed file.
+ *	 An exception is thrown if the data cannot be written for any reason.
+ */
+static void
+bfz_lz4_write_ex(bfz_t *thiz, const char *buffer, int size)
+{
+	struct bfz_lz4_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+
+	if (!fs->started)
+	{
+		size_t		n;
+
+		n = LZ4F_compressBegin(fs->ctx->cctx, fs->buf, fs->buf_size,
+							   &bfz_lz4_preferences);
+		if (LZ4F_isError(n))
+			ereport(ERROR,
+					(errmsg("lz4 compression failed"),
+					 errdetail("%s", LZ4F_getErrorName(n))));
+
+		bfz_lz4_write_buf(thiz, (int) n);
+		fs->started = true;
+	}
+
+	/*
+	 * The staging buffer is sized for one BFZ block of input, so compress
+	 * in chunks of at most that size.
+	 */
+	while (size > 0)
+	{
+		int			chunk = Min(size, BFZ_BUFFER_SIZE);
+		size_t		n;
+
+		n = LZ4F_compressUpdate(fs->ctx->cctx, fs->buf, fs->buf_size,
+								buffer, chunk, NULL);
+		if (LZ4F_isError(n))
+			ereport(ERROR,
+					(errmsg("lz4 compression failed"),
+					 errdetail("%s", LZ4F_getErrorName(n))));
+
+		bfz_lz4_write_buf(thiz, (int) n);
+
+		buffer += chunk;
+		size -= chunk;
+	}
+}
+
+/*
+ * bfz_lz4_read_ex
+ *	Read data from an already opened compressed file.
+ *
+ *	The buffer pointer must be valid and have at least size bytes.
+ *	An exception is thrown if the data cannot be read for any reason.
+ *
+ * The buffer is filled completely, unless the end of the file is reached.
+ */
+static int
+bfz_lz4_read_ex(bfz_t *thiz, char *buffer, int size)
+{
+	struct bfz_lz4_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	int			out_pos = 0;
+
+	while (out_pos < size)
+	{
+		size_t		dst_size;
+		size_t		src_size;
+		size_t		ret;
+
+		/*
+		 * Fill up our input buffer from the input file.
+		 */
+		if (fs->in_pos == fs->in_size && !fs->eof_in)
+		{
+			int			s;
+
+			bfz_readahead(thiz);
+			s = FileRead(thiz->file, fs->buf, fs->buf_size);
+
+			if (s == 0)
+			{
+				/* no more data to read */
+				fs->eof_in = true;
+			}
+			if (s < 0)
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("could not read from temporary file: %m")));
+
+			fs->in_pos = 0;
+			fs->in_size = s;
+		}
+
+		/*
+		 * End of input file, and lz4 agrees that we're at the end of a
+		 * frame.
+		 */
+		if (fs->eof_in && fs->in_pos == fs->in_size && fs->eof_out)
+			break;
+
+		/*
+		 * Decompress. This is done even when all input has been consumed,
+		 * since the context may still hold decompressed data that did not
+		 * fit in the output buffer the last time. A new frame is started
+		 * automatically after the previous one has ended.
+		 */
+		dst_size = size - out_pos;
+		src_size = fs->in_size - fs->in_pos;
+		ret = LZ4F_decompress(fs->ctx->dctx,
+							  buffer + out_pos, &dst_size,
+							  fs->buf + fs->in_pos, &src_size,
+							  NULL);
+		if (LZ4F_isError(ret))
+			ereport(ERROR,
+					(errmsg("could not uncompress data from temporary file"),
+					 errdetail("%s", LZ4F_getErrorName(ret))));
+
+		fs->in_pos += (int) src_size;
+		out_pos += (int) dst_size;
+		fs->eof_out = (ret == 0);
+
+		if (fs->eof_in && fs->in_pos == fs->in_size && !fs->eof_out &&
+			dst_size == 0)
+		{
+			/* No more input, but we are in the middle of a frame */
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("unexpected end of temporary file")));
+		}
+	}
+
+	return out_pos;
+}
+
+/*
+ * bfz_lz4_init
+ *	Initialize the lz4 subsystem for a file.
+ *
+ *	The underlying file descriptor fd should already be opened
+ *	and valid. Memory for our buffers is allocated in the current
+ *	memory context.
+ */
+void
+bfz_lz4_init(bfz_t *thiz)
+{
+	struct bfz_lz4_freeable_stuff *fs = palloc(sizeof *fs);
+	bfz_lz4_context *ctx;
+	LZ4F_errorCode_t err;
+
+	fs->started = false;
+	fs->eof_in = false;
+	fs->eof_out = true;
+	fs->compressing = (thiz->mode == BFZ_MODE_APPEND);
+	fs->in_pos = fs->in_size = 0;
+
+	if (!lz4_resowner_callback_registered)
+	{
+		RegisterResourceReleaseCallback(bfz_lz4_free_callback, NULL);
+		lz4_resowner_callback_registered = true;
+	}
+
+	ctx = MemoryContextAlloc(TopMemoryContext, sizeof(*ctx));
+	ctx->cctx = NULL;
+	ctx->dctx = NULL;
+	ctx->owner = CurrentResourceOwner;
+	ctx->prev = NULL;
+	ctx->next = open_lz4_contexts;
+	if (open_lz4_contexts)
+		open_lz4_contexts->prev = ctx;
+	open_lz4_contexts = ctx;
+	fs->ctx = ctx;
+
+	if (fs->compressing)
+	{
+		/*
+		 * writing a compressed file
+		 */
+		err = LZ4F_createCompressionContext(&ctx->cctx, LZ4F_VERSION);
+		fs->buf_size = (int) Max(LZ4F_compressBound(BFZ_BUFFER_SIZE, &bfz_lz4_preferences),
+								 LZ4F_HEADER_SIZE_MAX);
+	}
+	else
+	{
+		/*
+		 * reading a compressed file
+		 */
+		err = LZ4F_createDecompressionContext(&ctx->dctx, LZ4F_VERSION);
+		fs->buf_size = BFZ_BUFFER_SIZE;
+	}
+
+	if (LZ4F_isError(err))
+		ereport(ERROR,
+				(errmsg("lz4 context initialization failed"),
+				 errdetail("%s", LZ4F_getErrorName(err))));
+
+	fs->buf = palloc(fs->buf_size);
+
+	thiz->freeable_stuff = &fs->super;
+	fs->super.read_ex = bfz_lz4_read_ex;
+	fs->super.write_ex = bfz_lz4_write_ex;
+	fs->super.close_ex = bfz_lz4_close_ex;
+}
+
+#endif							/* HAVE_LIBLZ4 */
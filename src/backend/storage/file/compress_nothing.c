@@ -26,6 +26,8 @@ bfz_nothing_read_ex(bfz_t * thiz, char *buffer, int size)
 {
 	int			orig_size = size;
 
+	bfz_readahead(thiz);
+
 	while (size)
 	{
 		int			i = FileRead(thiz->file, buffer, size);
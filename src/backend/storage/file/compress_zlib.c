@@ -165,7 +165,10 @@ bfz_zlib_read_ex(bfz_t *thiz, char *buffer, int size)
 		 */
 		if (fs->s.avail_in == 0 && !fs->eof_in)
 		{
-			int			s = FileRead(thiz->file, (char *) fs->buf, COMPRESSION_BUFFER_SIZE);
+			int			s;
+
+			bfz_readahead(thiz);
+			s = FileRead(thiz->file, (char *) fs->buf, COMPRESSION_BUFFER_SIZE);
 
 			if (s == 0)
 			{
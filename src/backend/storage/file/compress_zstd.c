@@ -0,0 +1,309 @@
+/* compress_zstd.c */
+#include "postgres.h"
+
+#include "storage/bfz.h"
+#include "utils/memutils.h"
+
+#ifdef HAVE_LIBZSTD
+
+/* for ZSTD_customMem and the ZSTD_create*Stream_advanced() functions */
+#define ZSTD_STATIC_LINKING_ONLY
+#include <zstd.h>
+
+/*
+ * Compression level used for work files. Work files are written once and
+ * read back once or twice, so we favour speed over compression ratio.
+ */
+#define BFZ_ZSTD_LEVEL		1
+
+struct bfz_zstd_freeable_stuff
+{
+	struct bfz_freeable_stuff super;
+
+	/* true if compressing, false if decompressing */
+	bool		compressing;
+
+	/* true once any data has been written to the current frame */
+	bool		started;
+
+	bool		eof_in;
+	bool		eof_out;
+
+	ZSTD_CStream *cstream;
+	ZSTD_DStream *dstream;
+
+	/*
+	 * Compressed data. When compressing, the output of the compressor is
+	 * staged here before it is written to the file. When decompressing,
+	 * 'in' describes the part of the buffer not yet consumed.
+	 */
+	ZSTD_inBuffer in;
+	int			buf_size;
+	char	   *buf;
+};
+
+/* This file implements bfz compression algorithm "zstd". */
+
+/*
+ * bfz_zstd_write_buf
+ *	Write the first 'have' bytes of the staging buffer to the file.
+ */
+static void
+bfz_zstd_write_buf(bfz_t *thiz, int have)
+{
+	struct bfz_zstd_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	int			written = 0;
+
+	while (have > 0)
+	{
+		int			n = FileWrite(thiz->file, fs->buf + written, have);
+
+		if (n < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write to temporary file: %m")));
+		written += n;
+		have -= n;
+	}
+}
+
+/*
+ * bfz_zstd_close_ex
+ *	Close buffers etc. Does not close the underlying file!
+ */
+static void
+bfz_zstd_close_ex(bfz_t *thiz)
+{
+	struct bfz_zstd_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+
+	if (NULL != fs)
+	{
+		if (fs->compressing && fs->started)
+		{
+			size_t		remaining;
+
+			/* Flush all remaining output and the frame epilogue */
+			do
+			{
+				ZSTD_outBuffer output = {fs->buf, fs->buf_size, 0};
+
+				remaining = ZSTD_endStream(fs->cstream, &output);
+				if (ZSTD_isError(remaining))
+					ereport(ERROR,
+							(errmsg("zstd compression failed"),
+							 errdetail("%s", ZSTD_getErrorName(remaining))));
+
+				bfz_zstd_write_buf(thiz, (int) output.pos);
+			} while (remaining > 0);
+		}
+
+		if (fs->compressing)
+			ZSTD_freeCStream(fs->cstream);
+		else
+			ZSTD_freeDStream(fs->dstream);
+
+		pfree(fs->buf);
+		pfree(fs);
+		thiz->freeable_stuff = NULL;
+	}
+}
+
+/*
+ * bfz_zstd_write_ex
+ *	 Write data to an opened compressed file.
+ *	 An exception is thrown if the data cannot be written for any reason.
+ */
+static void
+bfz_zstd_write_ex(bfz_t *thiz, const char *buffer, int size)
+{
+	struct bfz_zstd_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	ZSTD_inBuffer input = {buffer, size, 0};
+
+	fs->started = true;
+
+	/* Compress until the input buffer is empty */
+	while (input.pos < input.size)
+	{
+		ZSTD_outBuffer output = {fs->buf, fs->buf_size, 0};
+		size_t		ret;
+
+		ret = ZSTD_compressStream(fs->cstream, &output, &input);
+		if (ZSTD_isError(ret))
+			ereport(ERROR,
+					(errmsg("zstd compression failed"),
+					 errdetail("%s", ZSTD_getErrorName(ret))));
+
+		bfz_zstd_write_buf(thiz, (int) output.pos);
+	}
+}
+
+/*
+ * bfz_zstd_read_ex
+ *	Read data from an already opened compressed file.
+ *
+ *	The buffer pointer must be valid and have at least size bytes.
+ *	An exception is thrown if the data cannot be read for any reason.
+ *
+ * The buffer is filled completely, unless the end of the file is reached.
+ */
+static int
+bfz_zstd_read_ex(bfz_t *thiz, char *buffer, int size)
+{
+	struct bfz_zstd_freeable_stuff *fs = (void *) thiz->freeable_stuff;
+	ZSTD_outBuffer output = {buffer, size, 0};
+
+	while (output.pos < output.size)
+	{
+		size_t		ret;
+		size_t		prev_pos = output.pos;
+
+		/*
+		 * Fill up our input buffer from the input file.
+		 */
+		if (fs->in.pos == fs->in.size && !fs->eof_in)
+		{
+			int			s;
+
+			bfz_readahead(thiz);
+			s = FileRead(thiz->file, fs->buf, fs->buf_size);
+
+			if (s == 0)
+			{
+				/* no more data to read */
+				fs->eof_in = true;
+			}
+			if (s < 0)
+				ereport(ERROR,
+						(errcode_for_file_access(),
+						 errmsg("could not read from temporary file: %m")));
+
+			fs->in.src = fs->buf;
+			fs->in.size = s;
+			fs->in.pos = 0;
+		}
+
+		/*
+		 * End of input file, and zstd agrees that we're at the end of a
+		 * frame.
+		 */
+		if (fs->eof_in && fs->in.pos == fs->in.size && fs->eof_out)
+			break;
+
+		/*
+		 * Decompress. This is done even when all input has been consumed,
+		 * since the stream may still hold decompressed data that did not
+		 * fit in the output buffer the last time. The stream moves on to the
+		 * next frame by itself when one ends, so files appended to in several
+		 * sessions work too.
+		 */
+		ret = ZSTD_decompressStream(fs->dstream, &output, &fs->in);
+		if (ZSTD_isError(ret))
+			ereport(ERROR,
+					(errmsg("could not uncompress data from temporary file"),
+					 errdetail("%s", ZSTD_getErrorName(ret))));
+
+		fs->eof_out = (ret == 0);
+
+		if (fs->eof_in && fs->in.pos == fs->in.size && !fs->eof_out &&
+			output.pos == prev_pos)
+		{
+			/* No more input, but we are in the middle of a frame */
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("unexpected end of temporary file")));
+		}
+	}
+
+	return (int) output.pos;
+}
+
+/*
+ * The zstd streams allocate their state with palloc, in the memory context
+ * the file was opened in, like compress_zlib.c does. A work file is not
+ * closed when the query errors out, so malloc'd state would be leaked.
+ */
+static void *
+zstd_alloc(void *opaque, size_t size)
+{
+	if (size > MaxAllocSize)
+		return NULL;
+
+	return MemoryContextAlloc((MemoryContext) opaque, size);
+}
+
+static void
+zstd_free(void *opaque, void *address)
+{
+	pfree(address);
+}
+
+/*
+ * bfz_zstd_init
+ *	Initialize the zstd subsystem for a file.
+ *
+ *	The underlying file descriptor fd should already be opened
+ *	and valid. Memory for our buffers is allocated in the current
+ *	memory context.
+ */
+void
+bfz_zstd_init(bfz_t *thiz)
+{
+	struct bfz_zstd_freeable_stuff *fs = palloc(sizeof *fs);
+	ZSTD_customMem mem = {zstd_alloc, zstd_free, CurrentMemoryContext};
+	size_t		ret;
+
+	fs->started = false;
+	fs->eof_in = false;
+	fs->eof_out = true;
+	fs->compressing = (thiz->mode == BFZ_MODE_APPEND);
+	fs->cstream = NULL;
+	fs->dstream = NULL;
+
+	if (fs->compressing)
+	{
+		/*
+		 * writing a compressed file
+		 */
+		fs->cstream = ZSTD_createCStream_advanced(mem);
+		if (fs->cstream == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_OUT_OF_MEMORY),
+					 errmsg("out of memory"),
+					 errdetail("Failed to create zstd compression stream.")));
+
+		ret = ZSTD_initCStream(fs->cstream, BFZ_ZSTD_LEVEL);
+		fs->buf_size = (int) ZSTD_CStreamOutSize();
+	}
+	else
+	{
+		/*
+		 * reading a compressed file
+		 */
+		fs->dstream = ZSTD_createDStream_advanced(mem);
+		if (fs->dstream == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_OUT_OF_MEMORY),
+					 errmsg("out of memory"),
+					 errdetail("Failed to create zstd decompression stream.")));
+
+		ret = ZSTD_initDStream(fs->dstream);
+		fs->buf_size = (int) ZSTD_DStreamInSize();
+	}
+
+	if (ZSTD_isError(ret))
+		ereport(ERROR,
+				(errmsg("zstd stream initialization failed"),
+				 errdetail("%s", ZSTD_getErrorName(ret))));
+
+	fs->buf = palloc(fs->buf_size);
+	fs->in.src = fs->buf;
+	fs->in.size = 0;
+	fs->in.pos = 0;
+
+	thiz->freeable_stuff = &fs->super;
+	fs->super.read_ex = bfz_zstd_read_ex;
+	fs->super.write_ex = bfz_zstd_write_ex;
+	fs->super.close_ex = bfz_zstd_close_ex;
+}
+
+#endif							/* HAVE_LIBZSTD */
@@ -57,6 +57,7 @@
 #include "cdb/memquota.h"
 #include "executor/instrument.h"
 #include "executor/spi.h"
+#include "utils/mdsharedcache.h"
 #include "utils/workfile_mgr.h"
 #include "utils/session_state.h"
 
@@ -129,6 +130,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 		size = add_size(size, LockShmemSize());
 		size = add_size(size, PredicateLockShmemSize());
 		size = add_size(size, workfile_mgr_shmem_size());
+		size = add_size(size, MDSharedCacheShmemSize());
 		if (Gp_role == GP_ROLE_DISPATCH)
 			size = add_size(size, AppendOnlyWriterShmemSize());
 
@@ -324,6 +326,7 @@ CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
 	SyncScanShmemInit();
 	AsyncShmemInit();
 	workfile_mgr_cache_init();
+	MDSharedCacheShmemInit();
 	BackendCancelShmemInit();
 
 	/*
@@ -21,6 +21,7 @@
 #include "storage/proc.h"
 #include "storage/sinvaladt.h"
 #include "utils/inval.h"
+#include "utils/mdsharedcache.h"
 
 #include "cdb/cdbtm.h"          /* DtxContext */
 
@@ -62,7 +63,21 @@ static void ProcessCatchupEvent(void);
 void
 SendSharedInvalidMessages(const SharedInvalidationMessage *msgs, int n)
 {
-	SIInsertDataEntries(msgs, n);
+	/*
+	 * The objects of the shared ORCA metadata cache that the messages make
+	 * stale are dropped while the messages are queued, so that no backend
+	 * can find them after it has received the messages, nor miss the
+	 * messages after finding the objects gone.
+	 */
+	if (MDSharedCacheEnabled())
+	{
+		LWLockAcquire(MDSharedCacheLock, LW_EXCLUSIVE);
+		SIInsertDataEntries(msgs, n);
+		MDSharedCacheInvalidate(msgs, n);
+		LWLockRelease(MDSharedCacheLock);
+	}
+	else
+		SIInsertDataEntries(msgs, n);
 }
 
 /*
@@ -1005,6 +1005,29 @@ CommandEndInvalidationMessages(void)
 }
 
 
+/*
+ * TransactionHasPendingInvalidations
+ *		Has the current transaction, or one of its open subtransactions,
+ *		registered invalidation messages that other backends haven't
+ *		received yet? That is, does it see catalog changes of its own?
+ */
+bool
+TransactionHasPendingInvalidations(void)
+{
+	TransInvalidationInfo *info;
+
+	for (info = transInvalInfo; info != NULL; info = info->parent)
+	{
+		if (info->CurrentCmdInvalidMsgs.cclist != NULL ||
+			info->CurrentCmdInvalidMsgs.rclist != NULL ||
+			info->PriorCmdInvalidMsgs.cclist != NULL ||
+			info->PriorCmdInvalidMsgs.rclist != NULL)
+			return true;
+	}
+
+	return false;
+}
+
 /*
  * CacheInvalidateHeapTuple
  *		Register the given tuple for invalidation at end of command
@@ -0,0 +1,595 @@
+/*-------------------------------------------------------------------------
+ *
+ * mdsharedcache.c
+ *	  Metadata objects of the ORCA optimizer, shared by all backends.
+ *
+ * Each backend keeps the metadata objects that ORCA has looked up in its
+ * own metadata cache (CMDCache). A fresh backend, or one whose cache was
+ * reset, has to build every relation, type, function and statistics object
+ * from the catalogs again. With optimizer_mdcache_shared_size set, the
+ * objects are also kept here, in shared memory on the master, in the DXL
+ * form in which the metadata provider hands them to ORCA. A backend that
+ * misses in its own cache then parses the DXL instead of walking the
+ * catalogs. Objects are keyed by database and mdid string.
+ *
+ * Invalidation piggybacks on the shared invalidation messages. Every object
+ * records the relations and syscache entries it was built from, and while
+ * a backend queues invalidation messages, under MDSharedCacheLock, the
+ * objects the messages refer to are dropped (see SendSharedInvalidMessages).
+ * Messages for catalogs whose entries cannot be mapped to objects, like
+ * pg_operator or the partitioning catalogs, drop all objects of the
+ * database.
+ *
+ * That leaves objects built from catalog entries that changed while the
+ * object was being built. Every batch of messages that could drop objects
+ * bumps a generation counter. Before building an object, a backend reads
+ * the counter, and then processes pending invalidation messages, so that
+ * it sees every change whose messages had been queued by then. The object
+ * is only added if the counter hasn't moved since.
+ *
+ * A backend whose transaction changed the catalogs does not use the shared
+ * objects at all, since they do not reflect its own changes, and the
+ * objects it builds may reflect changes that are never committed.
+ *
+ * The objects are stored one after another in a ring buffer, and when it
+ * is full, the oldest ones are evicted. Dropped objects leave a hole until
+ * the ring wraps around to them.
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/utils/cache/mdsharedcache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "cdb/cdbvars.h"
+#include "miscadmin.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/guc.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/mdsharedcache.h"
+#include "utils/syscache.h"
+
+/* Objects larger than this fraction of the ring are not shared */
+#define MDSHAREDCACHE_MAX_OBJECT_FRACTION 4
+
+/* Expected average size of an object, to size the hash table */
+#define MDSHAREDCACHE_AVG_OBJECT_SIZE 512
+
+typedef struct MDSharedCacheKey
+{
+	Oid			dbid;
+	char		name[MDSHAREDCACHE_NAMELEN];
+} MDSharedCacheKey;
+
+/* Hash table entry of an object */
+typedef struct MDSharedCacheEntry
+{
+	MDSharedCacheKey key;		/* hash key, must be first */
+	MDCacheObjectKey object;
+	uint32		offset;			/* of its record in the ring */
+	int			nsyscache;
+	MDSharedCacheSyscacheDep syscache[MDSHAREDCACHE_MAX_SYSCACHE_DEPS];
+	int			nrels;
+	int			len;			/* of the DXL, without terminating NUL */
+} MDSharedCacheEntry;
+
+/*
+ * An object in the ring. The header is followed by the OIDs of the
+ * relations the object depends on, and by the NUL-terminated DXL.
+ */
+typedef struct MDSharedCacheRecord
+{
+	uint32		size;			/* of the whole record, MAXALIGN'd */
+	bool		live;			/* false once the object has been dropped */
+	MDSharedCacheKey key;
+} MDSharedCacheRecord;
+
+#define MDSHAREDCACHE_RECORD_RELS(rec) \
+	((Oid *) ((char *) (rec) + MAXALIGN(sizeof(MDSharedCacheRecord))))
+
+/* Shared state of the cache, protected by MDSharedCacheLock */
+typedef struct MDSharedCacheControl
+{
+	uint64		generation;
+	uint32		ringSize;
+	uint32		head;			/* where the next record goes */
+	uint32		tail;			/* oldest record */
+	uint32		wrapEnd;		/* end of the records before the ring wrapped */
+	int			nrecords;
+} MDSharedCacheControl;
+
+static MDSharedCacheControl *MDSharedCache = NULL;
+static HTAB *MDSharedCacheHash = NULL;
+static char *MDSharedCacheRing = NULL;
+
+/*
+ * Syscaches that the metadata objects are built from, but whose entries
+ * cannot be mapped to objects; any change to them drops all objects of the
+ * database. Keep in sync with register_mdcache_invalidation_callbacks() in
+ * gpdbwrappers.cpp.
+ */
+static const int mdsharedcache_flush_caches[] = {
+	AMOPOPID,
+	CASTSOURCETARGET,
+	OPEROID,
+	OPFAMILYOID,
+	PARTOID,
+	PARTRULEOID
+};
+
+static long
+MDSharedCacheMaxObjects(void)
+{
+	return Max(((long) optimizer_mdcache_shared_size * 1024L) /
+			   MDSHAREDCACHE_AVG_OBJECT_SIZE, 64);
+}
+
+/*
+ * Estimate the shared memory space needed.
+ */
+Size
+MDSharedCacheShmemSize(void)
+{
+	Size		size;
+
+	if (Gp_role != GP_ROLE_DISPATCH || optimizer_mdcache_shared_size <= 0)
+		return 0;
+
+	size = MAXALIGN(sizeof(MDSharedCacheControl));
+	size = add_size(size, mul_size((Size) optimizer_mdcache_shared_size, 1024));
+	size = add_size(size, hash_estimate_size(MDSharedCacheMaxObjects(),
+											 sizeof(MDSharedCacheEntry)));
+
+	return size;
+}
+
+/*
+ * Allocate and initialize the shared memory of the cache, or attach to it.
+ */
+void
+MDSharedCacheShmemInit(void)
+{
+	HASHCTL		info;
+	bool		found;
+	Size		ringSize;
+
+	if (Gp_role != GP_ROLE_DISPATCH || optimizer_mdcache_shared_size <= 0)
+		return;
+
+	ringSize = (Size) optimizer_mdcache_shared_size * 1024;
+
+	MDSharedCache = (MDSharedCacheControl *)
+		ShmemInitStruct("ORCA Shared Metadata Cache",
+						MAXALIGN(sizeof(MDSharedCacheControl)) + ringSize,
+						&found);
+	MDSharedCacheRing = (char *) MDSharedCache +
+		MAXALIGN(sizeof(MDSharedCacheControl));
+
+	if (!found)
+	{
+		MemSet(MDSharedCache, 0, sizeof(MDSharedCacheControl));
+		MDSharedCache->ringSize = (uint32) ringSize;
+		MDSharedCache->wrapEnd = (uint32) ringSize;
+	}
+
+	MemSet(&info, 0, sizeof(info));
+	info.keysize = sizeof(MDSharedCacheKey);
+	info.entrysize = sizeof(MDSharedCacheEntry);
+	info.hash = tag_hash;
+
+	MDSharedCacheHash = ShmemInitHash("ORCA Shared Metadata Cache Hash",
+									  MDSharedCacheMaxObjects(),
+									  MDSharedCacheMaxObjects(),
+									  &info,
+									  HASH_ELEM | HASH_FUNCTION |
+									  HASH_FIXED_SIZE);
+}
+
+/*
+ * Is the cache configured?
+ */
+bool
+MDSharedCacheEnabled(void)
+{
+	return MDSharedCache != NULL;
+}
+
+/*
+ * Can the current transaction look up and add objects?
+ */
+bool
+MDSharedCacheUsable(void)
+{
+	return MDSharedCacheEnabled() && !TransactionHasPendingInvalidations();
+}
+
+/*
+ * Return the generation to pass to MDSharedCacheInsert() for an object that
+ * is about to be built. The caller must process pending invalidation
+ * messages after this, before reading the catalogs.
+ */
+uint64
+MDSharedCacheGeneration(void)
+{
+	uint64		generation;
+
+	Assert(MDSharedCacheEnabled());
+
+	LWLockAcquire(MDSharedCacheLock, LW_SHARED);
+	generation = MDSharedCache->generation;
+	LWLockRelease(MDSharedCacheLock);
+
+	return generation;
+}
+
+static void
+MDSharedCacheMakeKey(MDSharedCacheKey *key, const char *name)
+{
+	MemSet(key, 0, sizeof(MDSharedCacheKey));
+	key->dbid = MyDatabaseId;
+	strlcpy(key->name, name, MDSHAREDCACHE_NAMELEN);
+}
+
+/*
+ * Look up an object in the cache.
+ *
+ * Returns a palloc'd copy of its DXL, and the key to register it under for
+ * invalidation of the backend's own cache in *object; or NULL if the object
+ * is not in the cache.
+ */
+char *
+MDSharedCacheLookup(const char *name, MDCacheObjectKey *object)
+{
+	MDSharedCacheKey key;
+	MDSharedCacheEntry *entry;
+	char	   *data = NULL;
+
+	Assert(MDSharedCacheEnabled());
+
+	if (strlen(name) >= MDSHAREDCACHE_NAMELEN)
+		return NULL;
+	MDSharedCacheMakeKey(&key, name);
+
+	LWLockAcquire(MDSharedCacheLock, LW_SHARED);
+
+	entry = (MDSharedCacheEntry *) hash_search(MDSharedCacheHash, &key,
+											   HASH_FIND, NULL);
+	if (entry != NULL)
+	{
+		MDSharedCacheRecord *rec;
+
+		rec = (MDSharedCacheRecord *) (MDSharedCacheRing + entry->offset);
+		Assert(rec->live);
+
+		data = palloc(entry->len + 1);
+		memcpy(data, (char *) (MDSHAREDCACHE_RECORD_RELS(rec) + entry->nrels),
+			   entry->len + 1);
+		*object = entry->object;
+	}
+
+	LWLockRelease(MDSharedCacheLock);
+
+	return data;
+}
+
+/*
+ * Remove an object from the hash table, leaving its record in the ring as a
+ * hole. Caller holds MDSharedCacheLock exclusively.
+ */
+static void
+MDSharedCacheDrop(MDSharedCacheEntry *entry)
+{
+	MDSharedCacheRecord *rec;
+
+	rec = (MDSharedCacheRecord *) (MDSharedCacheRing + entry->offset);
+	rec->live = false;
+
+	hash_search(MDSharedCacheHash, &entry->key, HASH_REMOVE, NULL);
+}
+
+/*
+ * Evict the oldest record in the ring. Caller holds MDSharedCacheLock
+ * exclusively.
+ */
+static void
+MDSharedCacheEvictOldest(void)
+{
+	MDSharedCacheControl *ctl = MDSharedCache;
+	MDSharedCacheRecord *rec;
+
+	Assert(ctl->nrecords > 0);
+
+	rec = (MDSharedCacheRecord *) (MDSharedCacheRing + ctl->tail);
+	if (rec->live)
+		hash_search(MDSharedCacheHash, &rec->key, HASH_REMOVE, NULL);
+
+	ctl->tail += rec->size;
+	ctl->nrecords--;
+
+	if (ctl->nrecords == 0)
+	{
+		ctl->head = ctl->tail = 0;
+		ctl->wrapEnd = ctl->ringSize;
+	}
+	else if (ctl->tail == ctl->wrapEnd)
+	{
+		ctl->tail = 0;
+		ctl->wrapEnd = ctl->ringSize;
+	}
+}
+
+/*
+ * Make room for a record of the given size at the head of the ring, evicting
+ * the oldest records as needed, and return its offset. Caller holds
+ * MDSharedCacheLock exclusively.
+ */
+static uint32
+MDSharedCacheAllocRecord(uint32 size)
+{
+	MDSharedCacheControl *ctl = MDSharedCache;
+
+	Assert(size <= ctl->ringSize);
+
+	for (;;)
+	{
+		uint32		offset;
+
+		if (ctl->nrecords == 0 || ctl->head > ctl->tail)
+		{
+			/* free space from head to the end, and before tail */
+			if (ctl->ringSize - ctl->head >= size)
+			{
+				offset = ctl->head;
+				ctl->head += size;
+				ctl->nrecords++;
+				return offset;
+			}
+
+			/* wrap around, leaving the end of the ring unused for now */
+			ctl->wrapEnd = ctl->head;
+			ctl->head = 0;
+			continue;
+		}
+
+		/* free space from head to tail */
+		if (ctl->tail - ctl->head >= size)
+		{
+			offset = ctl->head;
+			ctl->head += size;
+			ctl->nrecords++;
+			return offset;
+		}
+
+		MDSharedCacheEvictOldest();
+	}
+}
+
+/*
+ * Add an object to the cache, unless invalidation messages that could make
+ * it stale have been queued since the generation was read.
+ */
+void
+MDSharedCacheInsert(const char *name, const MDCacheObjectKey *object,
+					const MDSharedCacheDeps *deps, const char *data,
+					uint64 generation)
+{
+	MDSharedCacheKey key;
+	MDSharedCacheEntry *entry;
+	MDSharedCacheRecord *rec;
+	Size		len = strlen(data);
+	Size		size;
+	bool		found;
+
+	Assert(MDSharedCacheEnabled());
+	Assert(deps->nsyscache <= MDSHAREDCACHE_MAX_SYSCACHE_DEPS);
+
+	if (strlen(name) >= MDSHAREDCACHE_NAMELEN)
+		return;
+
+	size = MAXALIGN(sizeof(MDSharedCacheRecord)) +
+		MAXALIGN(deps->nrels * sizeof(Oid) + len + 1);
+	if (size > MDSharedCache->ringSize / MDSHAREDCACHE_MAX_OBJECT_FRACTION)
+		return;
+
+	MDSharedCacheMakeKey(&key, name);
+
+	LWLockAcquire(MDSharedCacheLock, LW_EXCLUSIVE);
+
+	if (MDSharedCache->generation != generation)
+	{
+		LWLockRelease(MDSharedCacheLock);
+		return;
+	}
+
+	for (;;)
+	{
+		entry = (MDSharedCacheEntry *) hash_search(MDSharedCacheHash, &key,
+												   HASH_ENTER_NULL, &found);
+		if (entry != NULL || MDSharedCache->nrecords == 0)
+			break;
+		MDSharedCacheEvictOldest();
+	}
+
+	/* another backend was faster, or the hash table is full */
+	if (entry == NULL || found)
+	{
+		LWLockRelease(MDSharedCacheLock);
+		return;
+	}
+
+	/* evicting can't touch the new entry, it has no record yet */
+	entry->offset = MDSharedCacheAllocRecord((uint32) size);
+	entry->object = *object;
+	entry->nsyscache = deps->nsyscache;
+	memcpy(entry->syscache, deps->syscache,
+		   deps->nsyscache * sizeof(MDSharedCacheSyscacheDep));
+	entry->nrels = deps->nrels;
+	entry->len = (int) len;
+
+	rec = (MDSharedCacheRecord *) (MDSharedCacheRing + entry->offset);
+	rec->size = (uint32) size;
+	rec->live = true;
+	rec->key = key;
+	memcpy(MDSHAREDCACHE_RECORD_RELS(rec), deps->rels,
+		   deps->nrels * sizeof(Oid));
+	memcpy((char *) (MDSHAREDCACHE_RECORD_RELS(rec) + deps->nrels), data,
+		   len + 1);
+
+	LWLockRelease(MDSharedCacheLock);
+}
+
+static int
+oid_cmp(const void *a, const void *b)
+{
+	Oid			oa = *(const Oid *) a;
+	Oid			ob = *(const Oid *) b;
+
+	return (oa < ob) ? -1 : (oa > ob) ? 1 : 0;
+}
+
+static int
+syscache_dep_cmp(const void *a, const void *b)
+{
+	const MDSharedCacheSyscacheDep *da = (const MDSharedCacheSyscacheDep *) a;
+	const MDSharedCacheSyscacheDep *db = (const MDSharedCacheSyscacheDep *) b;
+
+	if (da->cacheid != db->cacheid)
+		return (da->cacheid < db->cacheid) ? -1 : 1;
+	return (da->hashvalue < db->hashvalue) ? -1 :
+		(da->hashvalue > db->hashvalue) ? 1 : 0;
+}
+
+static bool
+MDSharedCacheIsFlushCache(int cacheid)
+{
+	int			i;
+
+	for (i = 0; i < lengthof(mdsharedcache_flush_caches); i++)
+	{
+		if (mdsharedcache_flush_caches[i] == cacheid)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Drop the objects that the invalidation messages being queued refer to.
+ *
+ * Called from SendSharedInvalidMessages(), with MDSharedCacheLock held
+ * exclusively across queueing the messages and dropping the objects, so
+ * that no backend can look up a stale object in between. Only the messages
+ * of the current database are looked at; objects are built from database
+ * local catalogs only.
+ */
+void
+MDSharedCacheInvalidate(const SharedInvalidationMessage *msgs, int n)
+{
+	Oid		   *rels;
+	MDSharedCacheSyscacheDep *syscache;
+	int			nrels = 0;
+	int			nsyscache = 0;
+	bool		flush = false;
+	HASH_SEQ_STATUS status;
+	MDSharedCacheEntry *entry;
+	int			i;
+
+	Assert(LWLockHeldExclusiveByMe(MDSharedCacheLock));
+
+	rels = palloc(n * sizeof(Oid));
+	syscache = palloc(n * sizeof(MDSharedCacheSyscacheDep));
+
+	for (i = 0; i < n && !flush; i++)
+	{
+		const SharedInvalidationMessage *msg = &msgs[i];
+
+		if (msg->id >= 0)
+		{
+			if (msg->cc.dbId != MyDatabaseId)
+				continue;
+			if (MDSharedCacheIsFlushCache(msg->id))
+				flush = true;
+			else
+			{
+				syscache[nsyscache].cacheid = msg->id;
+				syscache[nsyscache].hashvalue = msg->cc.hashValue;
+				nsyscache++;
+			}
+		}
+		else if (msg->id == SHAREDINVALCATALOG_ID)
+		{
+			if (msg->cat.dbId == MyDatabaseId)
+				flush = true;
+		}
+		else if (msg->id == SHAREDINVALRELCACHE_ID)
+		{
+			if (msg->rc.dbId != MyDatabaseId)
+				continue;
+			if (!OidIsValid(msg->rc.relId))
+				flush = true;
+			else
+				rels[nrels++] = msg->rc.relId;
+		}
+	}
+
+	if (!flush && nrels == 0 && nsyscache == 0)
+	{
+		pfree(rels);
+		pfree(syscache);
+		return;
+	}
+
+	qsort(rels, nrels, sizeof(Oid), oid_cmp);
+	qsort(syscache, nsyscache, sizeof(MDSharedCacheSyscacheDep),
+		  syscache_dep_cmp);
+
+	/* removing the current entry is OK during a seq scan */
+	hash_seq_init(&status, MDSharedCacheHash);
+	while ((entry = (MDSharedCacheEntry *) hash_seq_search(&status)) != NULL)
+	{
+		bool		drop = false;
+
+		if (entry->key.dbid != MyDatabaseId)
+			continue;
+
+		if (flush)
+			drop = true;
+
+		for (i = 0; i < entry->nsyscache && !drop; i++)
+		{
+			if (bsearch(&entry->syscache[i], syscache, nsyscache,
+						sizeof(MDSharedCacheSyscacheDep),
+						syscache_dep_cmp) != NULL)
+				drop = true;
+		}
+
+		if (!drop && nrels > 0)
+		{
+			MDSharedCacheRecord *rec;
+			Oid		   *deprels;
+
+			rec = (MDSharedCacheRecord *) (MDSharedCacheRing + entry->offset);
+			deprels = MDSHAREDCACHE_RECORD_RELS(rec);
+			for (i = 0; i < entry->nrels && !drop; i++)
+			{
+				if (bsearch(&deprels[i], rels, nrels, sizeof(Oid),
+							oid_cmp) != NULL)
+					drop = true;
+			}
+		}
+
+		if (drop)
+			MDSharedCacheDrop(entry);
+	}
+
+	/* objects being built right now may be stale */
+	MDSharedCache->generation++;
+
+	pfree(rels);
+	pfree(syscache);
+}
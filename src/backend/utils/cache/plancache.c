@@ -34,6 +34,16 @@
  * just to invalidate all plans.  We expect updates on those catalogs to
  * be infrequent enough that more-detailed tracking is not worth the effort.
  *
+ * GPDB: ORCA can't plan over query parameters, so with optimizer=on, the
+ * custom plans of a prepared statement are ORCA plans with the parameter
+ * values folded in as constants.  Rather than optimizing the statement again
+ * on every execution, the latest optimizer_plan_cache_size of them are kept
+ * in the CachedPlanSource's value_plans along with the values they were made
+ * for, and reused when it is executed with the same values again.  Same
+ * values have the same selectivity, so ORCA would choose the same plan again
+ * unless the statement's dependencies change, which invalidates the kept
+ * plans just like the generic plan.
+ *
  *
  * Portions Copyright (c) 1996-2012, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -59,7 +69,10 @@
 #include "storage/lmgr.h"
 #include "tcop/pquery.h"
 #include "tcop/utility.h"
+#include "utils/datum.h"
+#include "utils/guc.h"
 #include "utils/inval.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/snapmgr.h"
 #include "utils/syscache.h"
@@ -74,6 +87,13 @@
 static CachedPlanSource *first_saved_plan = NULL;
 
 static void ReleaseGenericPlan(CachedPlanSource *plansource);
+static void ReleaseValuePlans(CachedPlanSource *plansource);
+static bool use_value_plans(CachedPlanSource *plansource,
+				ParamListInfo boundParams, IntoClause *intoClause);
+static CachedPlan *GetValuePlan(CachedPlanSource *plansource,
+			 ParamListInfo boundParams);
+static void SaveValuePlan(CachedPlanSource *plansource, CachedPlan *plan,
+			  ParamListInfo boundParams);
 static List *RevalidateCachedQuery(CachedPlanSource *plansource, IntoClause *intoClause);
 static bool CheckCachedPlan(CachedPlanSource *plansource);
 static CachedPlan *BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
@@ -88,6 +108,10 @@ static void ScanQueryForLocks(Query *parsetree, bool acquire);
 static bool ScanQueryWalker(Node *node, bool *acquire);
 static bool plan_list_is_transient(List *stmt_list);
 static bool plan_list_is_oneoff(List *stmt_list);
+static bool plan_list_is_optimizer(List *stmt_list);
+static bool plan_list_depends_on_rel(List *stmt_list, Oid relid);
+static bool plan_list_depends_on_item(List *stmt_list, int cacheid,
+						  uint32 hashvalue);
 static TupleDesc PlanCacheComputeResultDesc(List *stmt_list);
 static void PlanCacheRelCallback(Datum arg, Oid relid);
 static void PlanCacheFuncCallback(Datum arg, int cacheid, uint32 hashvalue);
@@ -192,6 +216,9 @@ CreateCachedPlan(Node *raw_parse_tree,
 	plansource->generic_cost = -1;
 	plansource->total_custom_cost = 0;
 	plansource->num_custom_plans = 0;
+	plansource->value_plans = NIL;
+	plansource->num_value_plan_hits = 0;
+	plansource->num_value_plan_misses = 0;
 
 	MemoryContextSwitchTo(oldcxt);
 
@@ -406,6 +433,7 @@ DropCachedPlan(CachedPlanSource *plansource)
 
 	/* Decrement generic CachePlan's refcount and drop if no longer needed */
 	ReleaseGenericPlan(plansource);
+	ReleaseValuePlans(plansource);
 
 	/*
 	 * Remove the CachedPlanSource and all subsidiary data (including the
@@ -431,6 +459,23 @@ ReleaseGenericPlan(CachedPlanSource *plansource)
 	}
 }
 
+/*
+ * ReleaseValuePlans: release a CachedPlanSource's plans for specific
+ * parameter values, if any.
+ */
+static void
+ReleaseValuePlans(CachedPlanSource *plansource)
+{
+	while (plansource->value_plans != NIL)
+	{
+		CachedPlan *plan = (CachedPlan *) linitial(plansource->value_plans);
+
+		Assert(plan->magic == CACHEDPLAN_MAGIC);
+		plansource->value_plans = list_delete_first(plansource->value_plans);
+		ReleaseCachedPlan(plan, false);
+	}
+}
+
 /*
  * RevalidateCachedQuery: ensure validity of analyzed-and-rewritten query tree.
  *
@@ -507,6 +552,7 @@ RevalidateCachedQuery(CachedPlanSource *plansource, IntoClause *intoClause)
 
 	/* Drop the generic plan reference if any */
 	ReleaseGenericPlan(plansource);
+	ReleaseValuePlans(plansource);
 
 	/*
 	 * Now re-do parse analysis and rewrite.  This not incidentally acquires
@@ -862,6 +908,7 @@ BuildCachedPlan(CachedPlanSource *plansource, List *qlist,
 		plan->saved_xmin = InvalidTransactionId;
 	plan->refcount = 0;
 	plan->context = plan_context;
+	plan->boundParams = NULL;
 	plan->is_saved = false;
 	plan->is_valid = true;
 
@@ -918,6 +965,151 @@ choose_custom_plan(CachedPlanSource *plansource, ParamListInfo boundParams, Into
 	return true;
 }
 
+/*
+ * use_value_plans: should custom plans be looked up in, and added to, the
+ * CachedPlanSource's plans for specific parameter values?
+ *
+ * Only saved CachedPlanSources are examined for sinval events, so only their
+ * plans can be kept.  Parameters fetched by a hook may not all be known yet.
+ */
+static bool
+use_value_plans(CachedPlanSource *plansource, ParamListInfo boundParams,
+				IntoClause *intoClause)
+{
+	return optimizer &&
+		optimizer_plan_cache_size > 0 &&
+		plansource->is_saved &&
+		intoClause == NULL &&
+		boundParams != NULL &&
+		boundParams->paramFetch == NULL &&
+		boundParams->numParams > 0;
+}
+
+/*
+ * Are two sets of parameter values the same?
+ */
+static bool
+param_values_equal(ParamListInfo a, ParamListInfo b)
+{
+	int			i;
+
+	if (a->numParams != b->numParams)
+		return false;
+
+	for (i = 0; i < a->numParams; i++)
+	{
+		ParamExternData *pa = &a->params[i];
+		ParamExternData *pb = &b->params[i];
+		int16		typlen;
+		bool		typbyval;
+
+		if (pa->ptype != pb->ptype || pa->isnull != pb->isnull)
+			return false;
+		if (pa->isnull || !OidIsValid(pa->ptype))
+			continue;
+
+		get_typlenbyval(pa->ptype, &typlen, &typbyval);
+		if (!datumIsEqual(pa->value, pb->value, typbyval, typlen))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * GetValuePlan: find a valid plan for the given parameter values among the
+ * CachedPlanSource's plans for specific parameter values.
+ *
+ * This checks the plan's validity like CheckCachedPlan does for the generic
+ * plan; on success, we have acquired the locks needed to run the plan.
+ */
+static CachedPlan *
+GetValuePlan(CachedPlanSource *plansource, ParamListInfo boundParams)
+{
+	ListCell   *lc;
+	ListCell   *prev = NULL;
+
+	for (lc = list_head(plansource->value_plans); lc != NULL; prev = lc, lc = lnext(lc))
+	{
+		CachedPlan *plan = (CachedPlan *) lfirst(lc);
+		MemoryContext oldcxt;
+
+		Assert(plan->magic == CACHEDPLAN_MAGIC);
+		if (!param_values_equal(plan->boundParams, boundParams))
+			continue;
+
+		if (plan->is_valid)
+		{
+			AcquireExecutorLocks(plan->stmt_list, true);
+
+			if (plan->is_valid &&
+				TransactionIdIsValid(plan->saved_xmin) &&
+				!TransactionIdEquals(plan->saved_xmin, TransactionXmin))
+				plan->is_valid = false;
+
+			if (plan->is_valid)
+			{
+				/* Move it to the front, so that it is evicted last */
+				plansource->value_plans =
+					list_delete_cell(plansource->value_plans, lc, prev);
+				oldcxt = MemoryContextSwitchTo(plansource->context);
+				plansource->value_plans = lcons(plan, plansource->value_plans);
+				MemoryContextSwitchTo(oldcxt);
+
+				return plan;
+			}
+
+			AcquireExecutorLocks(plan->stmt_list, false);
+		}
+
+		/* Plan has been invalidated, so unlink it and release it */
+		plansource->value_plans =
+			list_delete_cell(plansource->value_plans, lc, prev);
+		ReleaseCachedPlan(plan, false);
+
+		/* There is at most one plan for each set of values */
+		break;
+	}
+
+	return NULL;
+}
+
+/*
+ * SaveValuePlan: keep a newly built custom plan for reuse with the same
+ * parameter values, if ORCA made it.
+ *
+ * One-off and transient plans are not kept, as they must not be reused
+ * anyway.  If there are more than optimizer_plan_cache_size plans, the least
+ * recently used ones are released.
+ */
+static void
+SaveValuePlan(CachedPlanSource *plansource, CachedPlan *plan,
+			  ParamListInfo boundParams)
+{
+	MemoryContext oldcxt;
+
+	if (!plan_list_is_optimizer(plan->stmt_list) ||
+		TransactionIdIsValid(plan->saved_xmin))
+		return;
+
+	oldcxt = MemoryContextSwitchTo(plan->context);
+	plan->boundParams = copyParamList(boundParams);
+	MemoryContextSwitchTo(plansource->context);
+	plansource->value_plans = lcons(plan, plansource->value_plans);
+	MemoryContextSwitchTo(oldcxt);
+	plan->refcount++;
+
+	while (list_length(plansource->value_plans) > optimizer_plan_cache_size)
+	{
+		CachedPlan *evicted = (CachedPlan *) llast(plansource->value_plans);
+
+		plansource->value_plans =
+			list_truncate(plansource->value_plans,
+						  list_length(plansource->value_plans) - 1);
+		ReleaseCachedPlan(evicted, false);
+	}
+}
+
 /*
  * cached_plan_cost: calculate estimated cost of a plan
  */
@@ -1042,13 +1234,33 @@ GetCachedPlan(CachedPlanSource *plansource, ParamListInfo boundParams,
 
 	if (customplan)
 	{
-		/* Build a custom plan */
-		plan = BuildCachedPlan(plansource, qlist, boundParams, intoClause);
-		/* Accumulate total costs of custom plans, but 'ware overflow */
-		if (plansource->num_custom_plans < INT_MAX)
+		bool		value_plans = use_value_plans(plansource, boundParams,
+												  intoClause);
+
+		/* GPDB: reuse a plan made for the same values, if we have one */
+		plan = NULL;
+		if (value_plans)
 		{
-			plansource->total_custom_cost += cached_plan_cost(plan);
-			plansource->num_custom_plans++;
+			plan = GetValuePlan(plansource, boundParams);
+			if (plan)
+				plansource->num_value_plan_hits++;
+			else
+				plansource->num_value_plan_misses++;
+		}
+
+		if (!plan)
+		{
+			/* Build a custom plan */
+			plan = BuildCachedPlan(plansource, qlist, boundParams, intoClause);
+			/* Accumulate total costs of custom plans, but 'ware overflow */
+			if (plansource->num_custom_plans < INT_MAX)
+			{
+				plansource->total_custom_cost += cached_plan_cost(plan);
+				plansource->num_custom_plans++;
+			}
+
+			if (value_plans)
+				SaveValuePlan(plansource, plan, boundParams);
 		}
 	}
 
@@ -1533,6 +1745,82 @@ plan_list_is_oneoff(List *stmt_list)
 	return false;
 }
 
+/*
+ * plan_list_is_optimizer: check if any of the plans in the list were made
+ * by ORCA.
+ */
+static bool
+plan_list_is_optimizer(List *stmt_list)
+{
+	ListCell   *lc;
+
+	foreach(lc, stmt_list)
+	{
+		PlannedStmt *plannedstmt = (PlannedStmt *) lfirst(lc);
+
+		if (!IsA(plannedstmt, PlannedStmt))
+			continue;			/* Ignore utility statements */
+
+		if (plannedstmt->planGen == PLANGEN_OPTIMIZER)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * plan_list_depends_on_rel: check if any of the plans in the list depend on
+ * the given rel, or on any rel at all if relid == InvalidOid.
+ */
+static bool
+plan_list_depends_on_rel(List *stmt_list, Oid relid)
+{
+	ListCell   *lc;
+
+	foreach(lc, stmt_list)
+	{
+		PlannedStmt *plannedstmt = (PlannedStmt *) lfirst(lc);
+
+		if (!IsA(plannedstmt, PlannedStmt))
+			continue;			/* Ignore utility statements */
+		if ((relid == InvalidOid) ? plannedstmt->relationOids != NIL :
+			list_member_oid(plannedstmt->relationOids, relid))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * plan_list_depends_on_item: check if any of the plans in the list depend
+ * on the object with the given hash value in the given syscache, or on any
+ * member of the cache if hashvalue == 0.
+ */
+static bool
+plan_list_depends_on_item(List *stmt_list, int cacheid, uint32 hashvalue)
+{
+	ListCell   *lc;
+
+	foreach(lc, stmt_list)
+	{
+		PlannedStmt *plannedstmt = (PlannedStmt *) lfirst(lc);
+		ListCell   *lc2;
+
+		if (!IsA(plannedstmt, PlannedStmt))
+			continue;			/* Ignore utility statements */
+		foreach(lc2, plannedstmt->invalItems)
+		{
+			PlanInvalItem *item = (PlanInvalItem *) lfirst(lc2);
+
+			if (item->cacheId == cacheid &&
+				(hashvalue == 0 || item->hashValue == hashvalue))
+				return true;
+		}
+	}
+
+	return false;
+}
+
 /*
  * PlanCacheComputeResultDesc: given a list of analyzed-and-rewritten Queries,
  * determine the result tupledesc it will produce.	Returns NULL if the
@@ -1628,6 +1916,21 @@ PlanCacheRelCallback(Datum arg, Oid relid)
 				}
 			}
 		}
+
+		/* GPDB: and so could the plans for specific parameter values */
+		if (plansource->is_valid)
+		{
+			ListCell   *lc;
+
+			foreach(lc, plansource->value_plans)
+			{
+				CachedPlan *plan = (CachedPlan *) lfirst(lc);
+
+				if (plan->is_valid &&
+					plan_list_depends_on_rel(plan->stmt_list, relid))
+					plan->is_valid = false;
+			}
+		}
 	}
 }
 
@@ -1708,6 +2011,20 @@ PlanCacheFuncCallback(Datum arg, int cacheid, uint32 hashvalue)
 					break;		/* out of stmt_list scan */
 			}
 		}
+
+		/* GPDB: and so could the plans for specific parameter values */
+		if (plansource->is_valid)
+		{
+			foreach(lc, plansource->value_plans)
+			{
+				CachedPlan *plan = (CachedPlan *) lfirst(lc);
+
+				if (plan->is_valid &&
+					plan_list_depends_on_item(plan->stmt_list, cacheid,
+											  hashvalue))
+					plan->is_valid = false;
+			}
+		}
 	}
 }
 
@@ -31,6 +31,7 @@
 #include "cdb/cdbappendonlystoragewrite.h"
 #include "utils/datumstream.h"
 #include "utils/guc.h"
+#include "utils/typcache.h"
 #include "catalog/pg_compression.h"
 #include "utils/faultinjector.h"
 
@@ -302,7 +303,30 @@ datumstreamwrite_put(
 					 bool null,
 					 void **toFree)
 {
-	return DatumStreamBlockWrite_Put(&acc->blockWrite, d, null, toFree);
+	int			result;
+
+	result = DatumStreamBlockWrite_Put(&acc->blockWrite, d, null, toFree);
+
+	/* Maintain the zone map of the block, if the datum went in */
+	if (acc->zonemap && result >= 0)
+	{
+		if (null)
+			acc->zonemapNullCount++;
+		else if (!acc->zonemapHasMinMax)
+		{
+			acc->zonemapMin = d;
+			acc->zonemapMax = d;
+			acc->zonemapHasMinMax = true;
+		}
+		else if (DatumGetInt32(FunctionCall2(&acc->zonemapCmp, d,
+											 acc->zonemapMin)) < 0)
+			acc->zonemapMin = d;
+		else if (DatumGetInt32(FunctionCall2(&acc->zonemapCmp, d,
+											 acc->zonemapMax)) > 0)
+			acc->zonemapMax = d;
+	}
+
+	return result;
 }
 
 int
@@ -348,12 +372,23 @@ is_deltarange_compression_supported(Form_pg_attribute attr)
 	return false;
 }
 
+/*
+ * Dictionary encoding is tried for variable-length types, when enabled by
+ * gp_appendonly_dictionary_encoding.
+ */
+static bool
+is_dictionary_encoding_supported(Form_pg_attribute attr)
+{
+	return gp_appendonly_dictionary_encoding && attr->attlen == -1;
+}
+
 static void
 init_datumstream_info(
 					  DatumStreamTypeInfo * typeInfo, //OUTPUT
 					  DatumStreamVersion * datumStreamVersion, //OUTPUT
 					  bool *rle_compression, //OUTPUT
 					  bool *delta_compression, //OUTPUT
+					  bool *dictionary_compression, //OUTPUT
 					  AppendOnlyStorageAttributes *ao_attr, //OUTPUT
 					  int32 * maxAoBlockSize, //OUTPUT
 					  char *compName,
@@ -378,6 +413,7 @@ init_datumstream_info(
 	 */
 	*rle_compression = false;
 	*delta_compression = false;
+	*dictionary_compression = false;
 
 	ao_attr->compress = false;
 	ao_attr->compressType = NULL;
@@ -447,6 +483,11 @@ init_datumstream_info(
 		 */
 		*delta_compression = is_deltarange_compression_supported(attr);
 
+		/*
+		 * And dictionary encoding of low-cardinality variable-length columns.
+		 */
+		*dictionary_compression = is_dictionary_encoding_supported(attr);
+
 	}
 	else if (compName == NULL || pg_strcasecmp(compName, "none") == 0)
 	{
@@ -510,6 +551,7 @@ create_datumstreamwrite(
 						  &acc->datumStreamVersion,
 						  &acc->rle_want_compression,
 						  &acc->delta_want_compression,
+						  &acc->dictionary_want_compression,
 						  &acc->ao_attr,
 						  &acc->maxAoBlockSize,
 						  compName,
@@ -568,6 +610,19 @@ create_datumstreamwrite(
 	acc->ao_write.verifyWriteCompressionState = verifyBlockCompressionState;
 	acc->title = title;
 
+	if (attr->attbyval)
+	{
+		TypeCacheEntry *typentry;
+
+		typentry = lookup_type_cache(attr->atttypid, TYPECACHE_CMP_PROC_FINFO);
+		if (OidIsValid(typentry->cmp_proc_finfo.fn_oid))
+		{
+			fmgr_info_copy(&acc->zonemapCmp, &typentry->cmp_proc_finfo,
+						   CurrentMemoryContext);
+			acc->zonemap = true;
+		}
+	}
+
 	/*
 	 * Temporarily set the firstRowNum for the block so that we can
 	 * calculate the correct header length.
@@ -614,6 +669,7 @@ create_datumstreamwrite(
 							   acc->datumStreamVersion,
 							   acc->rle_want_compression,
 							   acc->delta_want_compression,
+							   acc->dictionary_want_compression,
 							   initialMaxDatumPerBlock,
 							   maxDatumPerBlock,
 							   acc->maxAoBlockSize - acc->maxAoHeaderSize,
@@ -648,6 +704,7 @@ create_datumstreamread(
 						  &acc->datumStreamVersion,
 						  &acc->rle_can_have_compression,
 						  &acc->delta_can_have_compression,
+						  &acc->dictionary_can_have_compression,
 						  &acc->ao_attr,
 						  &acc->maxAoBlockSize,
 						  compName,
@@ -990,14 +1047,41 @@ datumstreamwrite_block(DatumStreamWrite *acc,
 			/* Never reaches here. */
 	}
 
-	/* Insert an entry to the block directory */
-	AppendOnlyBlockDirectory_InsertEntry(
-		blockDirectory,
-		columnGroupNo,
-		acc->blockFirstRowNum,
-		AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
-		itemCount,
-		addColAction);
+	/* Insert an entry to the block directory, with the block's zone map */
+	if (acc->zonemap)
+	{
+		MinipageEntryStats stats;
+
+		MemSet(&stats, 0, sizeof(stats));
+		stats.flags = MINIPAGE_STATS_VALID;
+		if (acc->zonemapHasMinMax)
+		{
+			stats.minValue = acc->zonemapMin;
+			stats.maxValue = acc->zonemapMax;
+			stats.flags |= MINIPAGE_STATS_HAS_MINMAX;
+		}
+		stats.nullCount = acc->zonemapNullCount;
+
+		AppendOnlyBlockDirectory_InsertEntryWithStats(
+			blockDirectory,
+			columnGroupNo,
+			acc->blockFirstRowNum,
+			AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
+			itemCount,
+			addColAction,
+			&stats);
+
+		acc->zonemapHasMinMax = false;
+		acc->zonemapNullCount = 0;
+	}
+	else
+		AppendOnlyBlockDirectory_InsertEntry(
+			blockDirectory,
+			columnGroupNo,
+			acc->blockFirstRowNum,
+			AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
+			itemCount,
+			addColAction);
 
 	return writesz;
 }
@@ -1179,6 +1263,16 @@ datumstreamread_block_content(DatumStreamRead * acc)
 		Assert(!acc->getBlockInfo.isLarge);
 
 		if (acc->getBlockInfo.isCompressed)
+		{
+			/*
+			 * A worker thread may already have decompressed the block; its
+			 * buffer stays valid until the next block is read.
+			 */
+			acc->buffer_beginp =
+				AppendOnlyStorageRead_DecompressedContent(&acc->ao_read);
+		}
+
+		if (acc->getBlockInfo.isCompressed && acc->buffer_beginp == NULL)
 		{
 			/* Compressed, need to decompress to our own buffer.  */
 			if (acc->large_object_buffer_size < acc->getBlockInfo.contentLen)
@@ -1207,7 +1301,7 @@ datumstreamread_block_content(DatumStreamRead * acc)
 
 			acc->buffer_beginp = acc->large_object_buffer;
 		}
-		else
+		else if (!acc->getBlockInfo.isCompressed)
 		{
 			acc->buffer_beginp = AppendOnlyStorageRead_GetBuffer(&acc->ao_read);
 		}
@@ -1283,10 +1377,15 @@ datumstreamread_block_content(DatumStreamRead * acc)
 }
 
 
+/*
+ * Read the header of the next block, without its content. Returns -1 at
+ * the end of the file.
+ *
+ * The caller must follow up with either datumstreamread_block_content()
+ * or datumstreamread_block_skip().
+ */
 int
-datumstreamread_block(DatumStreamRead * acc,
-					  AppendOnlyBlockDirectory *blockDirectory,
-					  int colGroupNo)
+datumstreamread_block_header(DatumStreamRead * acc)
 {
 	bool		readOK = false;
 
@@ -1344,6 +1443,32 @@ datumstreamread_block(DatumStreamRead * acc,
 			 acc->blockFileOffset,
 			 acc->blockRowCount);
 
+	return 0;
+}
+
+/*
+ * Skip over the block whose header was just read, without reading or
+ * decompressing its content. The stream is left with no datums, so the
+ * next datumstreamread_advance() asks for the following block.
+ */
+void
+datumstreamread_block_skip(DatumStreamRead * acc)
+{
+	AppendOnlyStorageRead_SkipCurrentBlock(&acc->ao_read);
+
+	acc->largeObjectState = DatumStreamLargeObjectState_None;
+	acc->blockRead.logical_row_count = 0;
+	acc->blockRead.nth = 0;
+}
+
+int
+datumstreamread_block(DatumStreamRead * acc,
+					  AppendOnlyBlockDirectory *blockDirectory,
+					  int colGroupNo)
+{
+	if (datumstreamread_block_header(acc) < 0)
+		return -1;
+
 	datumstreamread_block_content(acc);
 
 	if (blockDirectory)
@@ -1532,46 +1657,11 @@ datumstreamread_find_block(DatumStreamRead * datumStream,
 		if (rowNum <= datumStreamFetchDesc->currentBlock.lastRowNum)
 		{
 			/*
-			 * Found the block that contains the row.
-			 * Read the block content if it was not read above.
+			 * Found the block that contains the row. Its content is left
+			 * unread, with gotContents false; the caller reads it only if it
+			 * needs the datum, and not when it just checks that the row
+			 * exists.
 			 */
-			if (!isOldBlockFormat)
-			{
-				if (datumStreamFetchDesc->currentBlock.gotContents)
-				{
-					ereport(ERROR,
-							(errmsg("Unexpected internal error,"
-									" block content was already read."
-									" datumstream_find_block filePathName %s"
-									" fileOffset " INT64_FORMAT
-									" firstRowNum " INT64_FORMAT
-									" rowCnt %u lastRowNum " INT64_FORMAT
-								 " ndatum %u contentLen %d gotContents true",
-							  datumStream->ao_read.bufferedRead.filePathName,
-							   datumStreamFetchDesc->currentBlock.fileOffset,
-									datumStream->getBlockInfo.firstRow,
-									datumStream->getBlockInfo.rowCnt,
-							   datumStreamFetchDesc->currentBlock.lastRowNum,
-									datumStream->blockRead.logical_row_count,
-									datumStream->getBlockInfo.contentLen
-									)));
-				}
-				if (Debug_appendonly_print_datumstream)
-					elog(LOG,
-						 "datumstream_find_block filePathName %s fileOffset " INT64_FORMAT " firstRowNum " INT64_FORMAT " "
-						 "rowCnt %u lastRowNum " INT64_FORMAT " "
-						 "ndatum %u contentLen %d ",
-						 datumStream->ao_read.bufferedRead.filePathName,
-						 datumStreamFetchDesc->currentBlock.fileOffset,
-						 datumStream->getBlockInfo.firstRow,
-						 datumStream->getBlockInfo.rowCnt,
-						 datumStreamFetchDesc->currentBlock.lastRowNum,
-						 datumStream->blockRead.logical_row_count,
-						 datumStream->getBlockInfo.contentLen);
-
-				datumstreamread_block_content(datumStream);
-				datumStreamFetchDesc->currentBlock.gotContents = true;
-			}
 			break;
 		}
 
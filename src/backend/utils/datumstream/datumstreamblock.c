@@ -13,6 +13,7 @@
  */
 
 #include "postgres.h"
+#include "access/hash.h"
 #include "access/tupmacs.h"
 #include "access/tuptoaster.h"
 #include "utils/datumstreamblock.h"
@@ -402,7 +403,12 @@ void
 DatumStreamBlockRead_Finish(
 							DatumStreamBlockRead * dsr)
 {
-	/* Place holder. */
+	if (dsr->dictionary_entries != NULL)
+	{
+		pfree(dsr->dictionary_entries);
+		dsr->dictionary_entries = NULL;
+		dsr->dictionary_entries_maxcount = 0;
+	}
 }
 
 /*
@@ -607,6 +613,56 @@ DatumStreamBlockRead_ResetDense(DatumStreamBlockRead * dsr)
 
 	dsr->delta_block_was_compressed = false;
 	dsr->delta_item = false;
+
+	dsr->dictionary_block_was_encoded = false;
+	dsr->dictionary_count = 0;
+	dsr->dictionary_code_size = 0;
+	dsr->dictionary_codesp = NULL;
+}
+
+/*
+ * Find the beginning of each of the dictionary_count datums in the datum
+ * area of a block with dictionary encoding. The datums are laid out the
+ * same way as the datums of any other block.
+ */
+static void
+DatumStreamBlockRead_LoadDictionary(DatumStreamBlockRead * dsr)
+{
+	uint8	   *p;
+	int32		i;
+
+	Assert(dsr->typeInfo.datumlen == -1);
+
+	if (dsr->dictionary_count > dsr->dictionary_entries_maxcount)
+	{
+		MemoryContext oldCtxt;
+
+		oldCtxt = MemoryContextSwitchTo(dsr->memctxt);
+		if (dsr->dictionary_entries != NULL)
+			pfree(dsr->dictionary_entries);
+		dsr->dictionary_entries =
+			(uint8 **) palloc(DATUMSTREAM_DICTIONARY_MAX_COUNT * sizeof(uint8 *));
+		dsr->dictionary_entries_maxcount = DATUMSTREAM_DICTIONARY_MAX_COUNT;
+		MemoryContextSwitchTo(oldCtxt);
+	}
+
+	p = dsr->datum_beginp;
+	for (i = 0; i < dsr->dictionary_count; i++)
+	{
+		if (i > 0 && *p == 0)
+			p = (uint8 *) att_align_nominal(p, dsr->typeInfo.align);
+
+		if (p >= dsr->datum_afterp)
+			ereport(ERROR,
+					(errmsg("Datum stream block read dictionary item %d of %d is beyond the end of the datum area",
+							i,
+							dsr->dictionary_count),
+					 errdetail_datumstreamblockread(dsr),
+					 errcontext_datumstreamblockread(dsr)));
+
+		dsr->dictionary_entries[i] = p;
+		p += VARSIZE_ANY(p);
+	}
 }
 
 void
@@ -628,6 +684,7 @@ DatumStreamBlockRead_GetReadyDense(
 	DatumStreamBlock_Dense *blockDense;
 	DatumStreamBlock_Rle_Extension *rleExtension;
 	DatumStreamBlock_Delta_Extension *deltaExtension;
+	DatumStreamBlock_Dictionary_Extension *dictionaryExtension;
 
 	/*
 	 * PERFORMANCE EXPERIMENT: Only do integrity and trace checking for DEBUG
@@ -716,6 +773,31 @@ DatumStreamBlockRead_GetReadyDense(
 		deltaExtension = NULL;
 	}
 
+	/* Dictionary */
+	dsr->dictionary_block_was_encoded = ((blockDense->orig_4_bytes.flags & DSB_HAS_DICTIONARY_ENCODING) != 0);
+	if (dsr->dictionary_block_was_encoded)
+	{
+		dictionaryExtension = (DatumStreamBlock_Dictionary_Extension *) p;
+		p += sizeof(DatumStreamBlock_Dictionary_Extension);
+
+		dsr->dictionary_count = dictionaryExtension->dictionary_count;
+		dsr->dictionary_code_size = dictionaryExtension->code_size;
+
+		if (dsr->dictionary_count <= 0 ||
+			dsr->dictionary_count > DATUMSTREAM_DICTIONARY_MAX_COUNT ||
+			(dsr->dictionary_code_size != 1 && dsr->dictionary_code_size != 2))
+			ereport(ERROR,
+					(errmsg("Bad datum stream Dense block dictionary (dictionary count %d, code size %d)",
+							dsr->dictionary_count,
+							dsr->dictionary_code_size),
+					 errdetail_datumstreamblockread(dsr),
+					 errcontext_datumstreamblockread(dsr)));
+	}
+	else
+	{
+		dictionaryExtension = NULL;
+	}
+
 	/* Set up acc */
 	dsr->nth = -1;				/* put it before first entry.  Caller will
 								 * advance */
@@ -940,6 +1022,45 @@ DatumStreamBlockRead_GetReadyDense(
 					 errcontext_datumstreamblockread(dsr)));
 		}
 	}
+
+	if (dsr->dictionary_block_was_encoded)
+	{
+		/*
+		 * Dictionary encoding was used for this block.  The codes come last
+		 * in the meta-data, and the datum area is the dictionary.
+		 */
+		dsr->dictionary_codesp = p;
+		p += dsr->physical_datum_count * dsr->dictionary_code_size;
+
+		unalignedHeaderSize = p - dsr->buffer_beginp;
+		alignedHeaderSize = MAXALIGN(unalignedHeaderSize);
+
+		dsr->datum_beginp = dsr->buffer_beginp + alignedHeaderSize;
+		dsr->datum_afterp = dsr->datum_beginp + dsr->physical_data_size;
+
+		DatumStreamBlockRead_LoadDictionary(dsr);
+
+		if (Debug_appendonly_print_scan)
+		{
+			ereport(LOG,
+					(errmsg("Datum stream block read unpack Dense with dictionary encoding "
+							"(logical row count %d, physical datum count %d, physical data size = %d, "
+							"dictionary count %d, code size %d, "
+						 "unaligned header size %d, aligned header size %d, "
+							"datum begin %p, datum after %p)",
+							dsr->logical_row_count,
+							dsr->physical_datum_count,
+							dsr->physical_data_size,
+							dsr->dictionary_count,
+							dsr->dictionary_code_size,
+							unalignedHeaderSize,
+							alignedHeaderSize,
+							dsr->datum_beginp,
+							dsr->datum_afterp),
+					 errdetail_datumstreamblockread(dsr),
+					 errcontext_datumstreamblockread(dsr)));
+		}
+	}
 	dsr->datump = dsr->datum_beginp;
 }
 
@@ -3625,6 +3746,7 @@ DatumStreamBlockWrite_GetReady(
 				dsw->compare_item = 0;
 			}
 
+			dsw->dictionary_has_compression = false;
 			break;
 
 		default:
@@ -3761,6 +3883,138 @@ DatumStreamBlockWrite_BlockOrig(
 	return writesz;
 }
 
+/*
+ * Size of the open addressing hash table used to find the distinct datums of
+ * a block. Twice the largest dictionary keeps the probe sequences short.
+ */
+#define DATUMSTREAM_DICTIONARY_HASH_SIZE (2 * DATUMSTREAM_DICTIONARY_MAX_COUNT)
+
+/*
+ * Try to dictionary encode the variable-length datums of the block being
+ * formatted: collect its distinct physical datums into dictionary_buffer,
+ * and the code of each physical datum into dictionary_codes.
+ *
+ * Returns true, with dictionary_has_compression set, when the block has
+ * few enough distinct values for the dictionary plus the codes to be
+ * smaller than the datums themselves.
+ */
+static bool
+DatumStreamBlockWrite_DictionaryEncode(DatumStreamBlockWrite * dsw)
+{
+	uint8	   *p;
+	uint8	   *afterp;
+	uint8	   *out;
+	int32		physicalDataSize;
+	int32		encodedSize;
+	int32		i;
+
+	Assert(dsw->typeInfo->datumlen == -1);
+	Assert(!dsw->delta_has_compression);
+
+	dsw->dictionary_has_compression = false;
+
+	physicalDataSize = dsw->datump - dsw->datum_buffer;
+	if (dsw->physical_datum_count < 2)
+		return false;
+
+	if (dsw->dictionary_buffer == NULL)
+	{
+		MemoryContext oldCtxt;
+
+		oldCtxt = MemoryContextSwitchTo(dsw->memctxt);
+		dsw->dictionary_buffer = palloc(dsw->datum_buffer_size);
+		dsw->dictionary_entries =
+			palloc(DATUMSTREAM_DICTIONARY_MAX_COUNT * sizeof(uint8 *));
+		dsw->dictionary_hash =
+			palloc(DATUMSTREAM_DICTIONARY_HASH_SIZE * sizeof(int16));
+		MemoryContextSwitchTo(oldCtxt);
+	}
+	if (dsw->physical_datum_count > dsw->dictionary_codes_maxcount)
+	{
+		MemoryContext oldCtxt;
+
+		oldCtxt = MemoryContextSwitchTo(dsw->memctxt);
+		if (dsw->dictionary_codes != NULL)
+			pfree(dsw->dictionary_codes);
+		dsw->dictionary_codes_maxcount =
+			Max(dsw->physical_datum_count, dsw->initialMaxDatumPerBlock);
+		dsw->dictionary_codes =
+			palloc(dsw->dictionary_codes_maxcount * sizeof(uint16));
+		MemoryContextSwitchTo(oldCtxt);
+	}
+
+	memset(dsw->dictionary_hash, -1,
+		   DATUMSTREAM_DICTIONARY_HASH_SIZE * sizeof(int16));
+	dsw->dictionary_count = 0;
+
+	p = dsw->datum_buffer;
+	afterp = dsw->datump;
+	out = dsw->dictionary_buffer;
+	for (i = 0; i < dsw->physical_datum_count; i++)
+	{
+		uint8	   *item;
+		int32		itemLen;
+		uint32		h;
+		int32		code;
+
+		/* Skip any zero padding after the previous item, as the reader does */
+		if (i > 0 && *p == 0)
+			p = (uint8 *) att_align_nominal(p, dsw->typeInfo->align);
+		Assert(p < afterp);
+
+		item = p;
+		itemLen = VARSIZE_ANY(item);
+		p += itemLen;
+
+		h = DatumGetUInt32(hash_any(item, itemLen)) &
+			(DATUMSTREAM_DICTIONARY_HASH_SIZE - 1);
+		while ((code = dsw->dictionary_hash[h]) >= 0)
+		{
+			uint8	   *entry = dsw->dictionary_entries[code];
+
+			if (VARSIZE_ANY(entry) == itemLen &&
+				memcmp(entry, item, itemLen) == 0)
+				break;
+			h = (h + 1) & (DATUMSTREAM_DICTIONARY_HASH_SIZE - 1);
+		}
+
+		if (code < 0)
+		{
+			if (dsw->dictionary_count >= DATUMSTREAM_DICTIONARY_MAX_COUNT)
+				return false;
+
+			/* Same layout rule as DatumStreamBlockWrite_PutDense */
+			if (!VARATT_IS_SHORT(item))
+				out = (uint8 *) att_align_zero((char *) out, dsw->typeInfo->align);
+
+			memcpy(out, item, itemLen);
+			code = dsw->dictionary_count++;
+			dsw->dictionary_entries[code] = out;
+			dsw->dictionary_hash[h] = code;
+			out += itemLen;
+		}
+
+		dsw->dictionary_codes[i] = (uint16) code;
+	}
+	Assert(p == afterp);
+
+	dsw->dictionary_code_size = (dsw->dictionary_count <= 256 ? 1 : 2);
+	dsw->dictionary_data_size = out - dsw->dictionary_buffer;
+
+	/*
+	 * Only worth it if it saves space, with room to spare for the alignment
+	 * padding after the codes.
+	 */
+	encodedSize = sizeof(DatumStreamBlock_Dictionary_Extension) +
+		dsw->physical_datum_count * dsw->dictionary_code_size +
+		dsw->dictionary_data_size + MAXIMUM_ALIGNOF;
+	if (encodedSize >= physicalDataSize)
+		return false;
+
+	dsw->dictionary_has_compression = true;
+	return true;
+}
+
 static int64
 DatumStreamBlockWrite_BlockDense(
 								 DatumStreamBlockWrite * dsw,
@@ -3771,10 +4025,12 @@ DatumStreamBlockWrite_BlockDense(
 	DatumStreamBlock_Dense dense;
 	DatumStreamBlock_Rle_Extension rle_extension;
 	DatumStreamBlock_Delta_Extension delta_extension;
+	DatumStreamBlock_Dictionary_Extension dictionary_extension;
 	int32		headerSize;
 	int32		nullSize;
 	int32		rleSize;
 	int32		deltaSize;
+	int32		dictionarySize;
 	int32		metadataSize;
 	int32		metadataMaxAlignSize;
 	int32		nullPadSize;
@@ -3797,6 +4053,9 @@ DatumStreamBlockWrite_BlockDense(
 		DatumStreamBlockWrite_RleFinalizeRepeatCountSize(dsw);
 	}
 
+	if (dsw->dictionary_want_compression)
+		DatumStreamBlockWrite_DictionaryEncode(dsw);
+
 	p = buffer;
 
 	/* First fill in orig header portion */
@@ -3812,9 +4071,18 @@ DatumStreamBlockWrite_BlockDense(
 		dense.orig_4_bytes.flags |= DSB_HAS_DELTA_COMPRESSION;
 	}
 
+	if (dsw->dictionary_has_compression)
+	{
+		dense.orig_4_bytes.version = DatumStreamVersion_Dense_Dictionary;
+		dense.orig_4_bytes.flags |= DSB_HAS_DICTIONARY_ENCODING;
+	}
+
 	dense.logical_row_count = dsw->nth;
 	dense.physical_datum_count = dsw->physical_datum_count;
-	dense.physical_data_size = dsw->datump - dsw->datum_buffer;
+	if (dsw->dictionary_has_compression)
+		dense.physical_data_size = dsw->dictionary_data_size;
+	else
+		dense.physical_data_size = dsw->datump - dsw->datum_buffer;
 
 	headerSize = sizeof(DatumStreamBlock_Dense);
 
@@ -3913,10 +4181,28 @@ DatumStreamBlockWrite_BlockDense(
 		deltaSize = 0;
 	}
 
+	/*
+	 * Add in extra DatumStreamBlock_Dictionary struct and codes...
+	 */
+
+	if (dsw->dictionary_has_compression)
+	{
+		headerSize += sizeof(DatumStreamBlock_Dictionary_Extension);
+
+		dictionary_extension.dictionary_count = dsw->dictionary_count;
+		dictionary_extension.code_size = dsw->dictionary_code_size;
+
+		dictionarySize = dsw->physical_datum_count * dsw->dictionary_code_size;
+	}
+	else
+	{
+		dictionarySize = 0;
+	}
+
 	/*
 	 * Align headers and meta-data (e.g. NULL bit-maps, etc).
 	 */
-	metadataSize = headerSize + nullSize + rleSize + deltaSize;
+	metadataSize = headerSize + nullSize + rleSize + deltaSize + dictionarySize;
 	metadataMaxAlignSize = MAXALIGN(metadataSize);
 
 	memcpy(p, &dense, sizeof(DatumStreamBlock_Dense));
@@ -3934,6 +4220,12 @@ DatumStreamBlockWrite_BlockDense(
 		p += sizeof(DatumStreamBlock_Delta_Extension);
 	}
 
+	if (dsw->dictionary_has_compression)
+	{
+		memcpy(p, &dictionary_extension, sizeof(DatumStreamBlock_Dictionary_Extension));
+		p += sizeof(DatumStreamBlock_Dictionary_Extension);
+	}
+
 	if (dsw->has_null)
 	{
 		memcpy(p, dsw->null_bitmap_buffer, DatumStreamBitMapWrite_Size(&dsw->null_bitmap));
@@ -3997,6 +4289,19 @@ DatumStreamBlockWrite_BlockDense(
 		}
 	}
 
+	/* Add dictionary codes, low byte first */
+	if (dsw->dictionary_has_compression)
+	{
+		int			i;
+
+		for (i = 0; i < dsw->physical_datum_count; i++)
+		{
+			*(p++) = dsw->dictionary_codes[i] & 0xFF;
+			if (dsw->dictionary_code_size == 2)
+				*(p++) = dsw->dictionary_codes[i] >> 8;
+		}
+	}
+
 	/*
 	 * Were our meta-data size calculations correct?
 	 */
@@ -4038,7 +4343,10 @@ DatumStreamBlockWrite_BlockDense(
 				 errcontext_datumstreamblockwrite(dsw)));
 	}
 
-	memcpy(p, dsw->datum_buffer, dense.physical_data_size);
+	if (dsw->dictionary_has_compression)
+		memcpy(p, dsw->dictionary_buffer, dense.physical_data_size);
+	else
+		memcpy(p, dsw->datum_buffer, dense.physical_data_size);
 	p += dense.physical_data_size;
 
 	/* Calculate write size. */
@@ -4157,6 +4465,21 @@ DatumStreamBlockWrite_BlockDense(
 			}
 		}
 
+		if (dsw->dictionary_has_compression)
+		{
+			ereport(LOG,
+					(errmsg("Datum stream write Dense block formatted with dictionary encoding "
+							"(physical datum count %d, dictionary count %d, code size %d, "
+							"dictionary size %d, datums size %d)",
+							dsw->physical_datum_count,
+							dsw->dictionary_count,
+							dsw->dictionary_code_size,
+							dsw->dictionary_data_size,
+							(int32) (dsw->datump - dsw->datum_buffer)),
+					 errdetail_datumstreamblockwrite(dsw),
+					 errcontext_datumstreamblockwrite(dsw)));
+		}
+
 		if (dsw->delta_has_compression)
 		{
 			ereport(LOG,
@@ -4232,6 +4555,7 @@ DatumStreamBlockWrite_Init(
 						   DatumStreamVersion datumStreamVersion,
 						   bool rle_want_compression,
 						   bool delta_want_compression,
+						   bool dictionary_want_compression,
 						   int32 initialMaxDatumPerBlock,
 						   int32 maxDatumPerBlock,
 						   int32 maxDataBlockSize,
@@ -4248,6 +4572,7 @@ DatumStreamBlockWrite_Init(
 
 	dsw->rle_want_compression = rle_want_compression;
 	dsw->delta_want_compression = delta_want_compression;
+	dsw->dictionary_want_compression = dictionary_want_compression;
 
 	dsw->initialMaxDatumPerBlock = initialMaxDatumPerBlock;
 	dsw->maxDatumPerBlock = maxDatumPerBlock;
@@ -4458,6 +4783,18 @@ DatumStreamBlockWrite_Finish(
 	if (dsw->delta_sign != NULL)
 		pfree(dsw->delta_sign);
 
+	if (dsw->dictionary_buffer != NULL)
+		pfree(dsw->dictionary_buffer);
+
+	if (dsw->dictionary_entries != NULL)
+		pfree(dsw->dictionary_entries);
+
+	if (dsw->dictionary_hash != NULL)
+		pfree(dsw->dictionary_hash);
+
+	if (dsw->dictionary_codes != NULL)
+		pfree(dsw->dictionary_codes);
+
 	MemoryContextSwitchTo(oldCtxt);
 }
 
@@ -4896,13 +5233,16 @@ DatumStreamBlock_IntegrityCheckDense(
 	bool		hasNull;
 	bool		hasRleCompression;
 	bool		hasDeltaCompression;
+	bool		hasDictionaryEncoding;
 
 	int32		alignedHeaderSize;
 	int32		deltaOnCount;
 	DatumStreamBlock_Delta_Extension *deltaExtension;
 	DatumStreamBlock_Rle_Extension *rleExtension;
+	DatumStreamBlock_Dictionary_Extension *dictionaryExtension;
 
 	deltaExtension = NULL;
+	dictionaryExtension = NULL;
 	rleExtension = NULL;
 
 	alignedHeaderSize = 0;
@@ -4922,7 +5262,8 @@ DatumStreamBlock_IntegrityCheckDense(
 	p = buffer + headerSize;
 
 	if ((blockDense->orig_4_bytes.version != DatumStreamVersion_Dense) &&
-	 (blockDense->orig_4_bytes.version != DatumStreamVersion_Dense_Enhanced))
+	 (blockDense->orig_4_bytes.version != DatumStreamVersion_Dense_Enhanced) &&
+		(blockDense->orig_4_bytes.version != DatumStreamVersion_Dense_Dictionary))
 	{
 		ereport(ERROR,
 				(errmsg("Bad datum stream Dense block version.  Found %d and expected %d",
@@ -4932,6 +5273,22 @@ DatumStreamBlock_IntegrityCheckDense(
 				 errcontextCallback(errcontextArg)));
 	}
 
+	/*
+	 * The dictionary encoding flag comes with its own block version, so it is
+	 * never taken for a reserved flag.
+	 */
+	if (((blockDense->orig_4_bytes.flags & DSB_HAS_DICTIONARY_ENCODING) != 0) !=
+		(blockDense->orig_4_bytes.version == DatumStreamVersion_Dense_Dictionary))
+	{
+		ereport(ERROR,
+				(errmsg("Bad datum stream Dense block version %d for dictionary encoding flag %s",
+						blockDense->orig_4_bytes.version,
+						((blockDense->orig_4_bytes.flags & DSB_HAS_DICTIONARY_ENCODING) != 0 ?
+						 "set" : "not set")),
+				 errdetailCallback(errdetailArg),
+				 errcontextCallback(errcontextArg)));
+	}
+
 	if (minimalIntegrityChecks)
 	{
 		return;
@@ -4942,6 +5299,19 @@ DatumStreamBlock_IntegrityCheckDense(
 	hasNull = ((blockDense->orig_4_bytes.flags & DSB_HAS_NULLBITMAP) != 0);
 	hasRleCompression = ((blockDense->orig_4_bytes.flags & DSB_HAS_RLE_COMPRESSION) != 0);
 	hasDeltaCompression = ((blockDense->orig_4_bytes.flags & DSB_HAS_DELTA_COMPRESSION) != 0);
+	hasDictionaryEncoding = ((blockDense->orig_4_bytes.flags & DSB_HAS_DICTIONARY_ENCODING) != 0);
+
+	if (hasDictionaryEncoding &&
+		(typeInfo->datumlen != -1 || hasDeltaCompression))
+	{
+		ereport(ERROR,
+				(errmsg("Dictionary encoding is only expected for variable-length items without DELTA compression "
+						"(datum length %d, DELTA compression %s)",
+						typeInfo->datumlen,
+						(hasDeltaCompression ? "true" : "false")),
+				 errdetailCallback(errdetailArg),
+				 errcontextCallback(errcontextArg)));
+	}
 
 	/*
 	 * Verify logical row count.
@@ -5018,8 +5388,12 @@ DatumStreamBlock_IntegrityCheckDense(
 
 		/*
 		 * This check will make it safer to do multiplication of datum count and datum length.
+		 *
+		 * With dictionary encoding the datums are codes, and only the
+		 * distinct values are in the datum area.
 		 */
-		if (blockDense->physical_datum_count > blockDense->physical_data_size)
+		if (!hasDictionaryEncoding &&
+			blockDense->physical_datum_count > blockDense->physical_data_size)
 		{
 			ereport(ERROR,
 					(errmsg("More physical items %d than physical bytes %d",
@@ -5091,6 +5465,24 @@ DatumStreamBlock_IntegrityCheckDense(
 		{
 			deltaOnCount = 0;
 		}
+
+		if (hasDictionaryEncoding)
+		{
+			headerSize += sizeof(DatumStreamBlock_Dictionary_Extension);
+
+			if (bufferSize < headerSize)
+			{
+				ereport(ERROR,
+						(errmsg("Bad datum stream dictionary block header extension size. Found %d and expected the size to be at least %d",
+								bufferSize,
+								headerSize),
+						 errdetailCallback(errdetailArg),
+						 errcontextCallback(errcontextArg)));
+			}
+
+			dictionaryExtension = (DatumStreamBlock_Dictionary_Extension *) p;
+			p += sizeof(DatumStreamBlock_Dictionary_Extension);
+		}
 		total_datum_count = blockDense->physical_datum_count + deltaOnCount;
 
 		if (!hasNull)
@@ -5265,6 +5657,23 @@ DatumStreamBlock_IntegrityCheckDense(
 			deltaExtension = (DatumStreamBlock_Delta_Extension *) p;
 			p += sizeof(DatumStreamBlock_Delta_Extension);
 		}
+		if (hasDictionaryEncoding)
+		{
+			headerSize += sizeof(DatumStreamBlock_Dictionary_Extension);
+
+			if (bufferSize < headerSize)
+			{
+				ereport(ERROR,
+						(errmsg("Bad datum stream dictionary block header extension size. Found %d and expected the size to be at least %d",
+								bufferSize,
+								headerSize),
+						 errdetailCallback(errdetailArg),
+						 errcontextCallback(errcontextArg)));
+			}
+
+			dictionaryExtension = (DatumStreamBlock_Dictionary_Extension *) p;
+			p += sizeof(DatumStreamBlock_Dictionary_Extension);
+		}
 
 		if (!hasNull)
 		{
@@ -5430,13 +5839,75 @@ DatumStreamBlock_IntegrityCheckDense(
 												  errcontextArg);
 	}
 
+	if (hasDictionaryEncoding)
+	{
+		int32		codesSize;
+		int32		i;
+
+		Assert(dictionaryExtension != NULL);
+		if (dictionaryExtension->dictionary_count <= 0 ||
+			dictionaryExtension->dictionary_count > DATUMSTREAM_DICTIONARY_MAX_COUNT ||
+			dictionaryExtension->dictionary_count > blockDense->physical_datum_count ||
+			(dictionaryExtension->code_size != 1 && dictionaryExtension->code_size != 2))
+		{
+			ereport(ERROR,
+					(errmsg("Bad datum stream dictionary (dictionary count %d, code size %d, physical datum count %d)",
+							dictionaryExtension->dictionary_count,
+							dictionaryExtension->code_size,
+							blockDense->physical_datum_count),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+
+		/*
+		 * The codes come last in the meta-data.
+		 */
+		codesSize = blockDense->physical_datum_count * dictionaryExtension->code_size;
+		headerSize += codesSize;
+		alignedHeaderSize = MAXALIGN(headerSize);
+
+		if (bufferSize < alignedHeaderSize + blockDense->physical_data_size)
+		{
+			ereport(ERROR,
+					(errmsg("Expected header size %d including dictionary codes plus physical data size %d is larger than buffer size %d",
+							alignedHeaderSize,
+							blockDense->physical_data_size,
+							bufferSize),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
+
+		for (i = 0; i < blockDense->physical_datum_count; i++)
+		{
+			int32		code;
+
+			if (dictionaryExtension->code_size == 1)
+				code = p[i];
+			else
+				code = p[2 * i] | (p[2 * i + 1] << 8);
+
+			if (code >= dictionaryExtension->dictionary_count)
+			{
+				ereport(ERROR,
+						(errmsg("Dictionary code %d of physical datum %d is out of range (dictionary count %d)",
+								code,
+								i,
+								dictionaryExtension->dictionary_count),
+						 errdetailCallback(errdetailArg),
+						 errcontextCallback(errcontextArg)));
+			}
+		}
+	}
+
 	if (typeInfo->datumlen == -1)
 	{
+		int32		varlenaCount;
+
 		/*
 		 * Variable-length items.
 		 */
 
-		DatumStreamBlock_IntegrityCheckVarlena(
+		varlenaCount = DatumStreamBlock_IntegrityCheckVarlena(
 											   buffer + alignedHeaderSize,
 											   blockDense->physical_data_size,
 											blockDense->orig_4_bytes.version,
@@ -5445,6 +5916,17 @@ DatumStreamBlock_IntegrityCheckDense(
 											   errdetailArg,
 											   errcontextCallback,
 											   errcontextArg);
+
+		if (hasDictionaryEncoding &&
+			varlenaCount != dictionaryExtension->dictionary_count)
+		{
+			ereport(ERROR,
+					(errmsg("Dictionary item count does not match (found %d, expected %d)",
+							varlenaCount,
+							dictionaryExtension->dictionary_count),
+					 errdetailCallback(errdetailArg),
+					 errcontextCallback(errcontextArg)));
+		}
 	}
 }
 
@@ -5459,6 +5941,8 @@ DatumStreamVersion_String(DatumStreamVersion datumStreamVersion)
 			return "Dense";
 		case DatumStreamVersion_Dense_Enhanced:
 			return "Dense_Enhanced";
+		case DatumStreamVersion_Dense_Dictionary:
+			return "Dense_Dictionary";
 		default:
 			return "Unknown";
 	}
@@ -489,7 +489,6 @@ static int	wal_block_size;
 static int	wal_segment_size;
 static bool	data_checksums;
 static bool integer_datetimes;
-static int	effective_io_concurrency;
 
 /* should be static, but commands/variable.c needs to get at this */
 char	   *role_string;
@@ -77,6 +77,7 @@ static bool check_optimizer(bool *newval, void **extra, GucSource source);
 static bool check_verify_gpfdists_cert(bool *newval, void **extra, GucSource source);
 static bool check_dispatch_log_stats(bool *newval, void **extra, GucSource source);
 static bool check_gp_hashagg_default_nbatches(int *newval, void **extra, GucSource source);
+static bool check_optimizer_search_memory_budget(int *newval, void **extra, GucSource source);
 
 /* Helper function for guc setter */
 bool gpvars_check_gp_resqueue_priority_default_value(char **newval,
@@ -142,7 +143,11 @@ int			gp_max_local_distributed_cache = 1024;
 bool		gp_appendonly_verify_block_checksums = true;
 bool		gp_appendonly_verify_write_block = false;
 bool		gp_appendonly_compaction = true;
+bool		gp_appendonly_zonemap_skip = true;
+bool		gp_appendonly_late_materialization = true;
+bool		gp_appendonly_dictionary_encoding = true;
 int			gp_appendonly_compaction_threshold = 0;
+int			gp_appendonly_decompress_workers = 0;
 bool		gp_heap_require_relhasoids_match = true;
 bool		Debug_appendonly_rezero_quicklz_compress_scratch = false;
 bool		Debug_appendonly_rezero_quicklz_decompress_scratch = false;
@@ -352,6 +357,11 @@ int			optimizer_minidump;
 int			optimizer_cost_model;
 bool		optimizer_metadata_caching;
 int			optimizer_mdcache_size;
+int			optimizer_mdcache_shared_size;
+int			optimizer_stats_cache_size;
+int			optimizer_plan_cache_size;
+int			optimizer_search_time_budget;
+int			optimizer_search_memory_budget;
 bool		optimizer_use_gpdb_allocators;
 
 /* Optimizer debugging GUCs */
@@ -484,6 +494,7 @@ bool		gp_external_enable_filter_pushdown = true;
 /* Executor */
 bool		gp_enable_mk_sort = true;
 bool		gp_enable_motion_mk_sort = true;
+bool		gp_enable_mk_sort_radix = true;
 
 static const struct config_enum_entry gp_log_format_options[] = {
 	{"text", 0},
@@ -929,6 +940,18 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_enable_mk_sort_radix", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enable radix partitioning in multi-key sort."),
+			gettext_noop("Large in-memory sorts on an int4 or text leading key are "
+						 "split into cache-sized buckets before they are quicksorted."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_enable_mk_sort_radix,
+		true,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_enable_motion_mk_sort", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enable multi-key sort in sorted motion recv."),
@@ -1109,6 +1132,39 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_zonemap_skip", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Skip append-only columnar blocks that the per-block min/max recorded in the block directory rule out."),
+			NULL,
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_appendonly_zonemap_skip,
+		true,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_late_materialization", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Evaluate the quals of append-only columnar scans before reading the other columns."),
+			NULL,
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_appendonly_late_materialization,
+		true,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_appendonly_dictionary_encoding", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Dictionary encode low-cardinality variable-length columns of RLE_TYPE compressed append-only columnar tables."),
+			NULL,
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_appendonly_dictionary_encoding,
+		true,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_heap_require_relhasoids_match", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Issue an error on discovery of a mismatch between relhasoids and a tuple header."),
@@ -3233,6 +3289,17 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_decompress_workers", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Number of threads that decompress the next blocks of the columns of an append-only columnar table scan ahead of the scan."),
+			gettext_noop("Zero decompresses every block in the scan itself."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_appendonly_decompress_workers,
+		0, 0, 64,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_workfile_max_entries", PGC_POSTMASTER, RESOURCES,
 			gettext_noop("Sets the maximum number of entries that can be stored in the workfile directory"),
@@ -3839,6 +3906,17 @@ struct config_int ConfigureNamesInt_gp[] =
 		check_gp_hashagg_default_nbatches, NULL, NULL
 	},
 
+	{
+		{"gp_hashagg_stream_bypass_rows", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Number of input rows after which a streaming bottom hashagg checks whether grouping pays off."),
+			gettext_noop("0 disables the check."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_hashagg_stream_bypass_rows,
+		100000, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_motion_slice_noop", PGC_USERSET, GP_ARRAY_TUNING,
 			gettext_noop("Make motion nodes in certain slices noop"),
@@ -4062,6 +4140,18 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_workfile_prefetch_blocks", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Number of blocks to read ahead when scanning a compressed or "
+						 "uncompressed executor work file."),
+			gettext_noop("Zero disables read-ahead of work files."),
+			GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_workfile_prefetch_blocks,
+		8, 0, 1024,
+		NULL, NULL, NULL
+	},
+
 	/* for pljava */
 	{
 		{"pljava_statement_cache_size", PGC_SUSET, CUSTOM_OPTIONS,
@@ -4246,6 +4336,64 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"optimizer_mdcache_shared_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the size of the MDCache shared by all sessions."),
+			gettext_noop("Metadata objects looked up by one session are kept in shared memory on the master, for other sessions to use. 0 disables sharing."),
+			GUC_UNIT_KB
+		},
+		&optimizer_mdcache_shared_size,
+		0, 0, INT_MAX / 1024,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"optimizer_stats_cache_size", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the size of the cache of column statistics translated for the optimizer."),
+			gettext_noop("Histograms translated from pg_statistic are kept across queries until the statistics change. 0 disables the cache."),
+			GUC_UNIT_KB | GUC_GPDB_ADDOPT
+		},
+		&optimizer_stats_cache_size,
+		16384, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"optimizer_plan_cache_size", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the number of plans made by the optimizer for specific parameter values that are kept for each prepared statement."),
+			gettext_noop("A kept plan is reused when the statement is executed with the same parameter values again. 0 disables reuse."),
+			GUC_GPDB_ADDOPT
+		},
+		&optimizer_plan_cache_size,
+		8, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"optimizer_search_time_budget", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the time the optimizer may spend searching for a plan."),
+			gettext_noop("When it runs out, the search is stopped and the query is optimized again with a cheaper join order search, "
+						 "which is not bounded by the budget. 0 disables the limit."),
+			GUC_UNIT_MS | GUC_GPDB_ADDOPT
+		},
+		&optimizer_search_time_budget,
+		0, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"optimizer_search_memory_budget", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the memory the optimizer may allocate while searching for a plan."),
+			gettext_noop("When it runs out, the search is stopped and the query is optimized again with a cheaper join order search, "
+						 "which is not bounded by the budget. 0 disables the limit. "
+						 "Only optimizer_use_gpdb_allocators counts the memory, so it has no effect without it."),
+			GUC_UNIT_KB | GUC_GPDB_ADDOPT
+		},
+		&optimizer_search_memory_budget,
+		0, 0, MAX_KILOBYTES,
+		check_optimizer_search_memory_budget, NULL, NULL
+	},
+
 	{
 		{"memory_profiler_dataset_size", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Set the size in GB"),
@@ -4353,6 +4501,17 @@ struct config_real ConfigureNamesReal_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_hashagg_stream_bypass_ratio", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Groups per input row above which a streaming bottom hashagg stops grouping."),
+			gettext_noop("See gp_hashagg_stream_bypass_rows."),
+			GUC_NO_SHOW_ALL | GUC_NOT_IN_SAMPLE | GUC_GPDB_ADDOPT
+		},
+		&gp_hashagg_stream_bypass_ratio,
+		0.8, 0.0, 1.0,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_workfile_limit_per_segment", PGC_POSTMASTER, RESOURCES,
 			gettext_noop("Maximum disk space (in KB) used for workfiles per segment."),
@@ -4536,7 +4695,8 @@ struct config_string ConfigureNamesString_gp[] =
 	{
 		{"gp_workfile_compress_algorithm", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Specify the compression algorithm that work files in the query executor use."),
-			gettext_noop("Valid values are \"NONE\", \"ZLIB\"."),
+			gettext_noop("Valid values are \"NONE\", \"ZLIB\" and, if the server was "
+						 "built with support for them, \"ZSTD\" and \"LZ4\"."),
 			GUC_GPDB_ADDOPT
 		},
 		&gp_workfile_compress_algorithm_str,
@@ -5254,6 +5414,23 @@ check_gp_hashagg_default_nbatches(int *newval, void **extra, GucSource source)
 	}
 }
 
+/*
+ * The optimizer's memory is only counted when it allocates through GPDB, so a
+ * memory budget can't be kept without optimizer_use_gpdb_allocators.
+ */
+static bool
+check_optimizer_search_memory_budget(int *newval, void **extra, GucSource source)
+{
+	if (*newval > 0 && !optimizer_use_gpdb_allocators &&
+		source >= PGC_S_INTERACTIVE)
+	{
+		GUC_check_errmsg("cannot set \"optimizer_search_memory_budget\" when \"optimizer_use_gpdb_allocators\" is off");
+		return false;
+	}
+
+	return true;
+}
+
 /*
  * Malloc a new string representing current storage_opts.
  */
@@ -26,6 +26,12 @@
  */
 uint64 OptimizerOutstandingMemoryBalance = 0;
 
+/*
+ * The highest OptimizerOutstandingMemoryBalance since the last
+ * ResetOptimizerMemoryHighWaterMark(), for profiling the optimizer.
+ */
+static uint64 OptimizerMemoryHighWaterMark = 0;
+
 /*
  * Allocation & Deallocation functions for GPOS
  *
@@ -42,6 +48,8 @@ Ext_OptimizerAlloc(size_t size)
 
 	MemoryAccounting_Allocate(ActiveMemoryAccountId, size);
 	OptimizerOutstandingMemoryBalance += size;
+	if (OptimizerOutstandingMemoryBalance > OptimizerMemoryHighWaterMark)
+		OptimizerMemoryHighWaterMark = OptimizerOutstandingMemoryBalance;
 	return gp_malloc(size);
 }
 
@@ -61,3 +69,18 @@ GetOptimizerOutstandingMemoryBalance()
 	return OptimizerOutstandingMemoryBalance;
 }
 
+/*
+ * Start tracking the highest outstanding balance from the current one
+ */
+void
+ResetOptimizerMemoryHighWaterMark()
+{
+	OptimizerMemoryHighWaterMark = OptimizerOutstandingMemoryBalance;
+}
+
+uint64
+GetOptimizerMemoryHighWaterMark()
+{
+	return OptimizerMemoryHighWaterMark;
+}
+
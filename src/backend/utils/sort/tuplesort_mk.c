@@ -517,6 +517,7 @@ static void tuplesort_inmem_limit_insert(Tuplesortstate_mk *state, MKEntry *e);
 static void tuplesort_inmem_nolimit_insert(Tuplesortstate_mk *state, MKEntry *e);
 static void tuplesort_heap_insert(Tuplesortstate_mk *state, MKEntry *e);
 static void tuplesort_limit_sort(Tuplesortstate_mk *state);
+static bool tuplesort_limit_reject(Tuplesortstate_mk *state, TupleTableSlot *slot);
 
 static void tupsort_refcnt(void *vp, int ref);
 
@@ -1149,9 +1150,17 @@ tuplesort_set_instrument_mk(Tuplesortstate_mk *state,
 void
 tuplesort_puttupleslot_mk(Tuplesortstate_mk *state, TupleTableSlot *slot)
 {
-	MemoryContext oldcontext = MemoryContextSwitchTo(state->sortcontext);
+	MemoryContext oldcontext;
 	MKEntry		e;
 
+	if (state->mkheap != NULL && state->status == TSS_INITIAL &&
+		tuplesort_limit_reject(state, slot))
+	{
+		state->totalNumTuples++;
+		return;
+	}
+
+	oldcontext = MemoryContextSwitchTo(state->sortcontext);
 	mke_blank(&e);
 
 	COPYTUP(state, &e, (void *) slot);
@@ -1382,7 +1391,7 @@ tuplesort_performsort_mk(Tuplesortstate_mk *state)
 			 * amount of memory.  Just qsort 'em and we're done.
 			 */
 			if (!state->mkctxt.bounded)
-				mk_qsort(state->entries, state->entry_count, &state->mkctxt);
+				mk_radix_qsort(state->entries, state->entry_count, &state->mkctxt);
 			else
 				tuplesort_limit_sort(state);
 
@@ -3172,6 +3181,45 @@ tupsort_compare_datum(MKEntry *v1, MKEntry *v2, MKLvContext *lvctxt, MKContext *
 	return 0;
 }
 
+/**
+ * Return byte 'depth' of the radix key of an entry prepared for the given
+ *	 level.  Ordering entries by their radix key bytes agrees with
+ *	 tupsort_compare_datum(), including the direction of the sort.
+ *
+ * Only INT32 (depth 0..3), CHAR and TEXT levels have a radix key.  For the
+ *	 latter, the key is the strxfrm'ed string; the caller must not ask for a
+ *	 byte beyond the terminating NUL.
+ */
+int
+tupsort_radix_digit(MKEntry *e, MKLvContext *lvctxt, int depth)
+{
+	int			digit;
+
+	Assert(!mke_is_null(e));
+
+	if (lvctxt->lvtype == MKLV_TYPE_INT32)
+	{
+		/* flip the sign bit, so that unsigned byte order is integer order */
+		uint32		u = ((uint32) DatumGetInt32(e->d)) ^ 0x80000000;
+
+		Assert(depth >= 0 && depth < 4);
+		digit = (u >> (24 - 8 * depth)) & 0xFF;
+	}
+	else
+	{
+		refcnt_locale_str *p = (refcnt_locale_str *) DatumGetPointer(e->d);
+
+		Assert(lvctxt->lvtype == MKLV_TYPE_CHAR ||
+			   lvctxt->lvtype == MKLV_TYPE_TEXT);
+		Assert(depth < 1 || p->data[p->xfrm_pos + depth - 1] != '\0');
+
+		/* strcmp() compares as unsigned char, and so do we */
+		digit = (unsigned char) p->data[p->xfrm_pos + depth];
+	}
+
+	return ((lvctxt->scanKey.sk_flags & SK_BT_DESC) != 0) ? 0xFF - digit : digit;
+}
+
 void
 tupsort_cpfr(MKEntry *dst, MKEntry *src, MKLvContext *lvctxt)
 {
@@ -3683,6 +3731,43 @@ tuplesort_inmem_limit_insert(Tuplesortstate_mk *state, MKEntry *entry)
 	}
 }
 
+/*
+ * tuplesort_limit_reject
+ *	 Can this input tuple be thrown away without inserting it in the LIMIT heap?
+ *
+ *	 Once we keep the top LIMIT tuples in a heap, the top of the heap is the
+ *	 worst of them, and a tuple that sorts after it on the first key cannot
+ *	 be in the result.  Checking that on the slot saves forming, preparing
+ *	 and freeing a tuple that tuplesort_inmem_limit_insert would reject
+ *	 anyway, which is the fate of almost every tuple fed to a top-N sort.
+ *	 Ties on the first key still go through the heap.
+ */
+static bool
+tuplesort_limit_reject(Tuplesortstate_mk *state, TupleTableSlot *slot)
+{
+	MKLvContext *lvctxt = state->mkctxt.lvctxt;
+	MKEntry    *top;
+	Datum		d;
+	Datum		topd;
+	bool		isnull;
+	bool		topnull;
+
+	Assert(state->mkctxt.bounded);
+
+	top = mkheap_peek(state->mkheap);
+	if (top == NULL || state->mkctxt.fetchForPrep == NULL)
+		return false;
+
+	d = slot_getattr(slot, lvctxt->attno, &isnull);
+	topd = (state->mkctxt.fetchForPrep) (top, &state->mkctxt, lvctxt, &topnull);
+
+	return inlineApplySortFunction(&lvctxt->scanKey.sk_func,
+								   lvctxt->scanKey.sk_flags,
+								   lvctxt->scanKey.sk_collation,
+								   d, isnull,
+								   topd, topnull) > 0;
+}
+
 /*
  * tuplesort_inmem_nolimit_insert
  *	 Adds a tuple for sorting when we are regular (no LIMIT) sort and we (still) fit in memory
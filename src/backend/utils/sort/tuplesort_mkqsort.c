@@ -20,9 +20,11 @@
 
 #include "postgres.h"
 #include "access/genam.h"
+#include "access/nbtree.h"
 #include "utils/tuplesort.h"
 #include "utils/tuplesort_mk.h"
 #include "utils/tuplesort_mk_details.h"
+#include "cdb/cdbvars.h"
 
 #include "miscadmin.h"
 
@@ -348,6 +350,165 @@ void mk_qsort_impl(MKEntry *a, int left, int right, int lv, bool lvdown, MKConte
 #endif
 }
 
+/*
+ * Radix partitioning.
+ *
+ * Quicksorting a large array makes about log2(n) passes over memory that is
+ * much bigger than the CPU caches.  When the first sort key is an int4 or a
+ * strxfrm'ed string, we instead first distribute the entries in place into
+ * 256 buckets on the leading byte of the key (MSD "American flag" radix
+ * sort), and then do the same on the next byte for the buckets that are
+ * still large.  Once a bucket fits in cache, or we run out of key bytes,
+ * it is handed to mk_qsort_impl, which also takes care of the remaining
+ * levels and of unique sort.  NULLs go to their own bucket before or after
+ * the others.
+ *
+ * The result is ordered exactly like mk_qsort's.
+ */
+#define MK_RADIX_PART_SIZE		((int) ((256 * 1024) / sizeof(MKEntry)))
+#define MK_RADIX_NBUCKETS		(256 + 2)
+#define MK_RADIX_TEXT_DEPTH		8
+
+static inline int mk_radix_bucket(MKEntry *e, MKLvContext *lvctxt, int depth)
+{
+	switch (mke_get_nullbits(e))
+	{
+		case MKE_CF_NullFirst:
+			return 0;
+		case MKE_CF_NullLast:
+			return MK_RADIX_NBUCKETS - 1;
+		default:
+			return 1 + tupsort_radix_digit(e, lvctxt, depth);
+	}
+}
+
+/**
+ * Are all the radix key bytes of the entries with this digit at this depth
+ * used up?  If so, the entries can only be told apart by mk_qsort_impl.
+ */
+static inline bool mk_radix_digit_is_last(MKLvContext *lvctxt, int depth, int digit)
+{
+	if (lvctxt->lvtype == MKLV_TYPE_INT32)
+		return depth == 3;
+
+	/* The string ended here: the raw byte was the terminating NUL */
+	if (digit == (((lvctxt->scanKey.sk_flags & SK_BT_DESC) != 0) ? 0xFF : 0))
+		return true;
+
+	return depth == MK_RADIX_TEXT_DEPTH - 1;
+}
+
+/**
+ * Sort a[left..right], already prepared at level 0, by radix partitioning
+ * on byte 'depth' of the level 0 key.
+ *
+ * bkt is scratch space parallel to a, used to remember the bucket of each
+ * entry while they are being moved around.
+ */
+static void mk_radix_partition(MKEntry *a, uint16 *bkt, int left, int right, int depth, MKContext *ctxt)
+{
+	MKLvContext *lvctxt = ctxt->lvctxt;
+	int count[MK_RADIX_NBUCKETS];
+	int next[MK_RADIX_NBUCKETS];
+	int end[MK_RADIX_NBUCKETS];
+	int b;
+	int i;
+	int pos;
+
+	CHECK_FOR_INTERRUPTS();
+
+	if (QueryFinishPending)
+		return;
+
+	/* Count the entries in each bucket */
+	memset(count, 0, sizeof(count));
+	for (i = left; i <= right; i++)
+	{
+		bkt[i] = mk_radix_bucket(a + i, lvctxt, depth);
+		count[bkt[i]]++;
+	}
+
+	pos = left;
+	for (b = 0; b < MK_RADIX_NBUCKETS; b++)
+	{
+		next[b] = pos;
+		pos += count[b];
+		end[b] = pos;
+	}
+
+	/*
+	 * Move every entry to its bucket.  Each swap puts at least one entry in
+	 * its final place, so this is linear.
+	 */
+	for (b = 0; b < MK_RADIX_NBUCKETS; b++)
+	{
+		while (next[b] < end[b])
+		{
+			int t;
+
+			i = next[b];
+			t = bkt[i];
+
+			if (t == b)
+				next[b]++;
+			else
+			{
+				int j = next[t]++;
+				uint16 tmp = bkt[i];
+
+				mkqs_swap(a, i, j);
+				bkt[i] = bkt[j];
+				bkt[j] = tmp;
+			}
+		}
+	}
+
+	/* Finish each bucket, on the next byte or with a quicksort */
+	pos = left;
+	for (b = 0; b < MK_RADIX_NBUCKETS; b++)
+	{
+		if (count[b] > 1)
+		{
+			if (b == 0 || b == MK_RADIX_NBUCKETS - 1 ||
+				count[b] <= MK_RADIX_PART_SIZE ||
+				mk_radix_digit_is_last(lvctxt, depth, b - 1))
+				mk_qsort_impl(a, pos, pos + count[b] - 1, 0, false, ctxt, false);
+			else
+				mk_radix_partition(a, bkt, pos, pos + count[b] - 1, depth + 1, ctxt);
+		}
+		pos += count[b];
+	}
+}
+
+/**
+ * Sort the n entries of a, like mk_qsort, using radix partitioning on the
+ * first key when that is possible and worthwhile.
+ */
+void mk_radix_qsort(MKEntry *a, int n, MKContext *ctxt)
+{
+	MKLvType lvtype = ctxt->lvctxt[0].lvtype;
+	uint16 *bkt;
+
+	if (!gp_enable_mk_sort_radix ||
+		n <= MK_RADIX_PART_SIZE ||
+		!(lvtype == MKLV_TYPE_INT32 ||
+		  ((lvtype == MKLV_TYPE_CHAR || lvtype == MKLV_TYPE_TEXT) && ctxt->fetchForPrep)))
+	{
+		mk_qsort(a, n, ctxt);
+		return;
+	}
+
+	mk_prepare_array(a, 0, n-1, 0, ctxt);
+
+	bkt = (uint16 *) palloc(n * sizeof(uint16));
+	mk_radix_partition(a, bkt, 0, n-1, 0, ctxt);
+	pfree(bkt);
+
+#ifdef MKQSORT_VERIFY
+	mkqsort_verify(a, 0, n-1, ctxt);
+#endif
+}
+
 #ifdef MKQSORT_VERIFY 
 static int mkqsort_comp_entry_all_lv(MKEntry *a, MKEntry *b, MKContext *mkctxt)
 {
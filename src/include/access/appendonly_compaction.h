@@ -14,6 +14,7 @@
 #define APPENDONLY_COMPACTION_H
 
 #include "nodes/pg_list.h"
+#include "access/appendonly_sortkey.h"
 #include "access/appendonly_visimap.h"
 #include "utils/rel.h"
 #include "access/memtup.h"
@@ -21,6 +22,9 @@
 
 #define APPENDONLY_COMPACTION_SEGNO_INVALID (-1)
 
+struct AppendOnlyInsertDescData;
+struct AOCSInsertDescData;
+
 extern void AppendOnlyDrop(Relation aorel,
 			   List *compaction_segno);
 extern void AppendOnlyCompact(Relation aorel,
@@ -32,6 +36,10 @@ extern bool AppendOnlyCompaction_ShouldCompact(
 								   int segno,
 								   int64 segmentTotalTupcount,
 								   bool isFull);
+extern void AppendOnlyCompaction_WriteSorted(Relation aorel,
+								 AppendOnlySort *sort,
+								 struct AppendOnlyInsertDescData *aoInsertDesc,
+								 struct AOCSInsertDescData *aocsInsertDesc);
 extern void AppendOnlyThrowAwayTuple(Relation rel, MemTuple tuple,
 						 TupleTableSlot *slot, MemTupleBinding *mt_bind);
 extern void AppendOnlyTruncateToEOF(Relation aorel);
@@ -0,0 +1,56 @@
+/*------------------------------------------------------------------------------
+ *
+ * appendonly_sortkey
+ *   keep the rows of append-only tables with a sort key clustered.
+ *
+ * Copyright (c) 2013-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/access/appendonly_sortkey.h
+ *
+ *------------------------------------------------------------------------------
+ */
+#ifndef APPENDONLY_SORTKEY_H
+#define APPENDONLY_SORTKEY_H
+
+#include "access/tupdesc.h"
+#include "executor/tuptable.h"
+#include "utils/rel.h"
+
+/*
+ * Rows of a load, or of a compaction, sorted on the sort key of an
+ * append-only relation before they are written.
+ */
+typedef struct AppendOnlySort AppendOnlySort;
+
+/*
+ * Most sorts a load into a partitioned table keeps open at once, one per
+ * leaf partition it writes to. They share the load's work_mem.
+ */
+#define APPENDONLY_SORT_MAX_OPEN 8
+
+/*
+ * The "sortkey" storage option, a comma separated list of columns, or NULL
+ * if the relation has none.
+ */
+#define StdRdOptionsGetSortKey(opts) \
+	((opts)->sortkey != 0 ? (char *) (opts) + (opts)->sortkey : NULL)
+
+#define RelationGetAppendOnlySortKey(relation) \
+	((relation)->rd_options != NULL ? \
+	 StdRdOptionsGetSortKey((StdRdOptions *) (relation)->rd_options) : NULL)
+
+extern void AppendOnlySortKey_Validate(const char *sortkey, TupleDesc tupdesc);
+extern bool AppendOnlySortKey_HasColumn(const char *sortkey,
+										const char *colname);
+extern char *AppendOnlySortKey_RenameColumn(const char *sortkey,
+											const char *oldname,
+											const char *newname);
+
+extern AppendOnlySort *AppendOnlySort_Begin(Relation rel, int workMem);
+extern void AppendOnlySort_Put(AppendOnlySort *sort, TupleTableSlot *slot);
+extern bool AppendOnlySort_Next(AppendOnlySort *sort, TupleTableSlot *slot);
+extern void AppendOnlySort_End(AppendOnlySort *sort);
+
+#endif   /* APPENDONLY_SORTKEY_H */
@@ -35,6 +35,58 @@
 #define APPENDONLY_VISIMAP_MAX_RANGE 32768
 #define APPENDONLY_VISIMAP_MAX_BITMAP_SIZE 4096
 
+/*
+ * One visibility map entry of the segment file cache, i.e. the visibility of
+ * APPENDONLY_VISIMAP_MAX_RANGE rows starting at firstRowNum. Ranges without
+ * an entry, or with an entry that hides no row, are not in the cache.
+ */
+typedef struct AppendOnlyVisimapCacheRange
+{
+	int64		firstRowNum;
+
+	/*
+	 * Bitmap of the hidden rows, by offset from firstRowNum. NULL if every
+	 * row of the range is hidden, or if the bitmap did not fit in the memory
+	 * budget of the cache (see 'cached').
+	 */
+	Bitmapset  *bitmap;
+
+	bool		allHidden;
+
+	/*
+	 * false if the range is not fully hidden and its bitmap was left out to
+	 * stay within work_mem. The entry is then looked up the usual way.
+	 */
+	bool		cached;
+} AppendOnlyVisimapCacheRange;
+
+/*
+ * Visibility information of a whole segment file, loaded at once by
+ * AppendOnlyVisimap_LoadSegmentFile() for sequential scans, which would
+ * otherwise do one index lookup per range of rows. The ranges are sorted by
+ * firstRowNum.
+ */
+typedef struct AppendOnlyVisimapSegmentCache
+{
+	/*
+	 * Segment file number of the cached information. -1 if nothing is
+	 * cached.
+	 */
+	int32		segmentFileNum;
+
+	AppendOnlyVisimapCacheRange *ranges;
+	int			numRanges;
+
+	/* Index of the range found by the last lookup */
+	int			currentRange;
+
+	/* true if some range is fully hidden */
+	bool		hasHiddenRanges;
+
+	/* Memory context of the cached information, reset on every load */
+	MemoryContext memoryContext;
+} AppendOnlyVisimapSegmentCache;
+
 /*
  * Data structure for the ao visibility map processing.
  *
@@ -57,6 +109,11 @@ typedef struct AppendOnlyVisimap
 	 */
 	AppendOnlyVisimapStore visimapStore;
 
+	/*
+	 * Preloaded visibility information of the segment file being scanned.
+	 */
+	AppendOnlyVisimapSegmentCache segmentCache;
+
 } AppendOnlyVisimap;
 
 /*
@@ -113,6 +170,15 @@ void AppendOnlyVisimap_Finish(
 						 AppendOnlyVisimap *visiMap,
 						 LOCKMODE lockmode);
 
+void AppendOnlyVisimap_LoadSegmentFile(
+								  AppendOnlyVisimap *visiMap,
+								  int segno);
+
+int64 AppendOnlyVisimap_GetNextVisibleRowNum(
+									   AppendOnlyVisimap *visiMap,
+									   int segno,
+									   int64 rowNum);
+
 void AppendOnlyVisimap_DeleteSegmentFile(
 									AppendOnlyVisimap *visiMap,
 									int segno);
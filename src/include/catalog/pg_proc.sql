@@ -74,6 +74,10 @@
 
  CREATE FUNCTION pg_dist_wait_status(OUT segid int4, OUT waiter_dxid xid, OUT holder_dxid xid, OUT holdTillEndXact bool) RETURNS SETOF pg_catalog.record LANGUAGE internal VOLATILE AS 'pg_dist_wait_status' WITH (OID=6036, DESCRIPTION="waiting relation information");
 
+ CREATE FUNCTION gp_prepared_statement_plan_cache(OUT name text, OUT statement text, OUT cached_plans int4, OUT hits int8, OUT misses int8) RETURNS SETOF pg_catalog.record LANGUAGE internal STABLE AS 'gp_prepared_statement_plan_cache' WITH (OID=7021, DESCRIPTION="statistics: optimizer plans kept for specific parameter values of prepared statements");
+
+ CREATE FUNCTION gp_optimizer_profile(OUT queries int8, OUT query_to_dxl_ms float8, OUT metadata_ms float8, OUT search_ms float8, OUT dxl_to_plan_ms float8, OUT const_eval_ms float8, OUT peak_memory_kb int8, OUT md_fetches int8, OUT md_shared_cache_hits int8, OUT const_exprs int8) RETURNS pg_catalog.record LANGUAGE internal VOLATILE AS 'gp_optimizer_profile' WITH (OID=7040, DESCRIPTION="statistics: time and memory spent by the optimizer in this session, peak memory is NULL unless optimizer_use_gpdb_allocators is on");
+
  CREATE FUNCTION pg_resqueue_status() RETURNS SETOF record LANGUAGE internal VOLATILE STRICT AS 'pg_resqueue_status' WITH (OID=6030, DESCRIPTION="Return resource queue information");
 
  CREATE FUNCTION pg_resqueue_status_kv() RETURNS SETOF record LANGUAGE internal VOLATILE STRICT AS 'pg_resqueue_status_kv' WITH (OID=6069, DESCRIPTION="Return resource queue information");
@@ -22,7 +22,7 @@
 
    WARNING: DO NOT MODIFY THE FOLLOWING SECTION: 
    Generated by catullus.pl version 8
-   on Mon Sep  3 23:10:02 2018
+   on Mon Oct 19 19:52:34 2026
 
    Please make your changes in pg_proc.sql
 */
@@ -168,6 +168,14 @@ DESCR("statistics: information about resource groups");
 DATA(insert OID = 6036 ( pg_dist_wait_status  PGNSP PGUID 12 1 1000 0 0 f f f f f t v 0 0 2249 "" "{23,28,28,16}" "{o,o,o,o}" "{segid,waiter_dxid,holder_dxid,holdTillEndXact}" _null_ pg_dist_wait_status _null_ _null_ _null_ n a ));
 DESCR("waiting relation information");
 
+/* gp_prepared_statement_plan_cache(OUT name text, OUT statement text, OUT cached_plans int4, OUT hits int8, OUT misses int8) => SETOF pg_catalog.record */
+DATA(insert OID = 7021 ( gp_prepared_statement_plan_cache  PGNSP PGUID 12 1 1000 0 0 f f f f f t s 0 0 2249 "" "{25,25,23,20,20}" "{o,o,o,o,o}" "{name,statement,cached_plans,hits,misses}" _null_ gp_prepared_statement_plan_cache _null_ _null_ _null_ n a ));
+DESCR("statistics: optimizer plans kept for specific parameter values of prepared statements");
+
+/* gp_optimizer_profile(OUT queries int8, OUT query_to_dxl_ms float8, OUT metadata_ms float8, OUT search_ms float8, OUT dxl_to_plan_ms float8, OUT const_eval_ms float8, OUT peak_memory_kb int8, OUT md_fetches int8, OUT md_shared_cache_hits int8, OUT const_exprs int8) => pg_catalog.record */
+DATA(insert OID = 7040 ( gp_optimizer_profile  PGNSP PGUID 12 1 0 0 0 f f f f f f v 0 0 2249 "" "{20,701,701,701,701,701,20,20,20,20}" "{o,o,o,o,o,o,o,o,o,o}" "{queries,query_to_dxl_ms,metadata_ms,search_ms,dxl_to_plan_ms,const_eval_ms,peak_memory_kb,md_fetches,md_shared_cache_hits,const_exprs}" _null_ gp_optimizer_profile _null_ _null_ _null_ n a ));
+DESCR("statistics: time and memory spent by the optimizer in this session, peak memory is NULL unless optimizer_use_gpdb_allocators is on");
+
 /* pg_resqueue_status() => SETOF record */
 DATA(insert OID = 6030 ( pg_resqueue_status  PGNSP PGUID 12 1 1000 0 0 f f f f t t v 0 0 2249 "" _null_ _null_ _null_ _null_ pg_resqueue_status _null_ _null_ _null_ n a ));
 DESCR("Return resource queue information");
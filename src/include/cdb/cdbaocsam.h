@@ -41,6 +41,11 @@
 struct DatumStream;
 struct AOCSFileSegInfo;
 
+/*
+ * Maximum number of rows decoded at a time by aocs_getnext_batch().
+ */
+#define AOCS_SCAN_BATCH_SIZE 1024
+
 typedef struct AOCSInsertDescData
 {
 	Relation	aoi_rel;
@@ -67,10 +72,52 @@ typedef struct AOCSInsertDescData
 	 * Certain statistics are then counted differently.
 	 */ 
 	bool update_mode;
+
+	/*
+	 * Rows passed to aocs_insert_values_multi that are not yet in the
+	 * column streams, transposed into one array of values per column.  They
+	 * already have their row numbers: the last bufferRows sequences up to
+	 * lastSequence.  By-reference values are copied into bufferDatumContext.
+	 */
+	MemoryContext bufferContext;
+	MemoryContext bufferDatumContext;
+	Datum	  **bufferValues;
+	bool	  **bufferNulls;
+	int			bufferRows;
+	Size		bufferSize;
+
+	/*
+	 * Memory reserved for the buffers out of AOCS_INSERT_BUFFER_TOTAL_SIZE,
+	 * 0 while they are not allocated, and the subtransaction that allocated
+	 * them.
+	 */
+	Size		bufferReserved;
+	SubTransactionId bufferSubid;
 } AOCSInsertDescData;
 
+/*
+ * aocs_insert_values_multi writes the buffered rows out once this many rows,
+ * or this many bytes of by-reference values, have been buffered.
+ */
+#define AOCS_INSERT_BUFFER_ROWS 1000
+#define AOCS_INSERT_BUFFER_SIZE (1024 * 1024)
+
+/*
+ * Most memory the buffers of all the insert descs of a backend may take,
+ * e.g. of the partitions loaded by one statement. Beyond it, the buffers of
+ * the least recently used insert desc are written out and freed.
+ */
+#define AOCS_INSERT_BUFFER_TOTAL_SIZE (16 * 1024 * 1024)
+
 typedef AOCSInsertDescData *AOCSInsertDesc;
 
+/*
+ * Row filter for late materialization, see aocs_set_filter(). Called with the
+ * filter columns of a row stored in the filter slot; returns true if the row
+ * qualifies.
+ */
+typedef bool (*AOCSScanFilter) (void *arg);
+
 /*
  * used for scan of append only relations using BufferedRead and VarBlocks
  */
@@ -126,6 +173,65 @@ typedef struct AOCSScanDescData
 
 	AppendOnlyVisimap visibilityMap;
 
+	/*
+	 * The current batch of decoded rows, filled by aocs_getnext_batch().
+	 *
+	 * Values are stored column-at-a-time: batch_values[i] and batch_isnull[i]
+	 * hold the rows of column proj_atts[i]. Only the rows listed in the
+	 * selection vector batch_sel (the ones visible according to the visimap)
+	 * have been decoded. By-reference values point into the datum stream
+	 * buffers, so they stay valid only until the next batch is read.
+	 */
+	Datum	  **batch_values;
+	bool	  **batch_isnull;
+	AOTupleId  *batch_tids;
+	int		   *batch_sel;
+	int			batch_nrows;	/* rows in the batch, visible or not */
+	int			batch_nsel;		/* entries in batch_sel */
+	int			batch_next;		/* next batch_sel entry for aocs_getnext */
+
+	/*
+	 * Zone map keys, set by aocs_set_zonemap_keys(). Blocks that the zone
+	 * maps in the block directory show to hold no row satisfying all the
+	 * keys are skipped without being read.
+	 */
+	int			num_zonemap_keys;
+	ScanKey		zonemap_keys;
+	bool	   *zonemap_proj;	/* columns that have a key */
+	AppendOnlyBlockDirectory zonemapDirectory;
+
+	/*
+	 * Rows below skip_until in the current segment file are known not to
+	 * qualify, because of the zone maps or because the visimap hides them.
+	 */
+	int64		skip_until;
+
+	/*
+	 * Dictionary keys, set by aocs_set_dictionary_keys(). In a block with
+	 * dictionary encoding, the keys on its column are evaluated once per
+	 * distinct value, and rows whose code fails them are dropped from the
+	 * batch before the remaining columns are decoded.
+	 */
+	int			num_dictionary_keys;
+	ScanKey		dictionary_keys;
+	bool	  **dictionary_match;	/* per column with a key, by code */
+	int64	   *dictionary_block;	/* block dictionary_match was built for */
+	MemoryContext dictionary_context;
+
+	/*
+	 * Late materialization, set up by aocs_set_filter(). The columns the
+	 * filter needs come first in proj_atts, num_filter_atts of them. When
+	 * batch_late is set, only those columns are decoded into the batch, and
+	 * batch_sel lists just the rows that passed the filter; the other
+	 * projected columns are fetched by aocs_getnext for those rows only,
+	 * skipping the blocks in between without reading them.
+	 */
+	int			num_filter_atts;
+	AOCSScanFilter filter;
+	void	   *filter_arg;
+	TupleTableSlot *filter_slot;
+	bool		batch_late;
+
 }	AOCSScanDescData;
 
 typedef AOCSScanDescData *AOCSScanDesc;
@@ -212,18 +318,29 @@ extern void aocs_rescan(AOCSScanDesc scan);
 extern void aocs_endscan(AOCSScanDesc scan);
 
 extern void aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot);
+extern int aocs_getnext_batch(AOCSScanDesc scan, ScanDirection direction);
+extern void aocs_set_zonemap_keys(AOCSScanDesc scan, int nkeys, ScanKey keys);
+extern void aocs_set_dictionary_keys(AOCSScanDesc scan, int nkeys, ScanKey keys);
+extern void aocs_set_filter(AOCSScanDesc scan, bool *filter_proj,
+				AOCSScanFilter filter, void *arg, TupleTableSlot *slot);
 extern AOCSInsertDesc aocs_insert_init(Relation rel, int segno, bool update_mode);
 extern Oid aocs_insert_values(AOCSInsertDesc idesc, Datum *d, bool *null, AOTupleId *aoTupleId);
+extern void aocs_insert_values_multi(AOCSInsertDesc idesc, int nrows,
+						 Datum **values, bool **nulls, AOTupleId *aoTupleIds);
+extern void aocs_insert_flush(AOCSInsertDesc idesc);
 static inline Oid aocs_insert(AOCSInsertDesc idesc, TupleTableSlot *slot)
 {
-	Oid oid;
+	Datum *values;
+	bool *nulls;
 	AOTupleId aotid;
 
 	slot_getallattrs(slot);
-	oid = aocs_insert_values(idesc, slot_get_values(slot), slot_get_isnull(slot), &aotid);
+	values = slot_get_values(slot);
+	nulls = slot_get_isnull(slot);
+	aocs_insert_values_multi(idesc, 1, &values, &nulls, &aotid);
 	slot_set_ctid(slot, (ItemPointer)&aotid);
 
-	return oid;
+	return InvalidOid;
 }
 extern void aocs_insert_finish(AOCSInsertDesc idesc);
 extern AOCSFetchDesc aocs_fetch_init(Relation relation,
@@ -22,6 +22,32 @@
 extern int gp_blockdirectory_entry_min_range;
 extern int gp_blockdirectory_minipage_size;
 
+/*
+ * Zone map of a minipage entry: the smallest and largest non-NULL value,
+ * and the number of NULLs, in the blocks covered by the entry. Only kept
+ * for columns of pass-by-value types that have a default btree opclass;
+ * minValue and maxValue are Datums of the column's type.
+ *
+ * The zone maps are stored after the entries of a minipage, which takes
+ * 32 bytes on top of the 24 of each entry. Only minipages with at least one
+ * zone map pay for it: they are written as version MINIPAGE_VERSION_STATS,
+ * and the others stay in the original version 0 format, which minipages
+ * written before zone maps share. Binaries from before zone maps ignore the
+ * version and cannot read the larger minipages, hence the catversion bump
+ * that came with them.
+ */
+typedef struct MinipageEntryStats
+{
+	Datum minValue;
+	Datum maxValue;
+	int64 nullCount;
+	int32 flags;
+	int32 padding;
+} MinipageEntryStats;
+
+#define MINIPAGE_STATS_VALID		0x01	/* the stats cover every row */
+#define MINIPAGE_STATS_HAS_MINMAX	0x02	/* minValue/maxValue are set */
+
 typedef struct AppendOnlyBlockDirectoryEntry
 {
 	/*
@@ -36,6 +62,11 @@ typedef struct AppendOnlyBlockDirectoryEntry
 		int64		lastRowNum;
 	} range;
 
+	/*
+	 * The zone map of the entry. flags is 0 if the entry has none.
+	 */
+	MinipageEntryStats stats;
+
 } AppendOnlyBlockDirectoryEntry;
 
 /*
@@ -50,6 +81,9 @@ typedef struct MinipageEntry
 
 /*
  * Define a varlena type for a minipage.
+ *
+ * A version MINIPAGE_VERSION_STATS minipage stores nEntry MinipageEntryStats
+ * right after its nEntry entries.
  */
 typedef struct Minipage
 {
@@ -62,6 +96,8 @@ typedef struct Minipage
 	MinipageEntry entry[1];
 } Minipage;
 
+#define MINIPAGE_VERSION_STATS 1
+
 /*
  * Define the relevant info for a minipage for each
  * column group.
@@ -69,6 +105,7 @@ typedef struct Minipage
 typedef struct MinipagePerColumnGroup
 {
 	Minipage *minipage;
+	MinipageEntryStats *stats;	/* zone maps of the entries */
 	uint32 numMinipageEntries;
 	ItemPointerData tupleTid;
 } MinipagePerColumnGroup;
@@ -199,6 +236,14 @@ extern bool AppendOnlyBlockDirectory_InsertEntry(
 	int64 fileOffset,
 	int64 rowCount,
 	bool addColAction);
+extern bool AppendOnlyBlockDirectory_InsertEntryWithStats(
+	AppendOnlyBlockDirectory *blockDirectory,
+	int columnGroupNo,
+	int64 firstRowNum,
+	int64 fileOffset,
+	int64 rowCount,
+	bool addColAction,
+	MinipageEntryStats *stats);
 extern bool AppendOnlyBlockDirectory_addCol_InsertEntry(
 	AppendOnlyBlockDirectory *blockDirectory,
 	int columnGroupNo,
@@ -0,0 +1,49 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbappendonlydecompress.h
+ *	  Decompress Append-Only Storage blocks in worker threads.
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/cdb/cdbappendonlydecompress.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef CDBAPPENDONLYDECOMPRESS_H
+#define CDBAPPENDONLYDECOMPRESS_H
+
+typedef struct AppendOnlyDecompressJob AppendOnlyDecompressJob;
+
+/*
+ * Can blocks compressed with compressType be decompressed by the worker
+ * threads?  False when gp_appendonly_decompress_workers is zero.
+ */
+extern bool AppendOnlyDecompress_Supported(char *compressType);
+
+/*
+ * Hand a compressed block to the worker threads.  The compressed bytes are
+ * copied, so the caller's buffer can be reused right away.
+ *
+ * Returns NULL when no worker thread could be started; the caller then
+ * decompresses the block itself.
+ */
+extern AppendOnlyDecompressJob *AppendOnlyDecompress_Start(
+						   char *compressType,
+						   uint8 *compressed,
+						   int32 compressedLen,
+						   int32 uncompressedLen);
+
+/*
+ * Wait for the job to finish and return the decompressed content.  The
+ * content stays valid until the job is released.
+ */
+extern uint8 *AppendOnlyDecompress_Finish(AppendOnlyDecompressJob *job);
+
+/*
+ * Release the job and its buffers, waiting for a worker still busy with it.
+ */
+extern void AppendOnlyDecompress_Release(AppendOnlyDecompressJob *job);
+
+#endif   /* CDBAPPENDONLYDECOMPRESS_H */
@@ -189,6 +189,25 @@ typedef struct AppendOnlyStorageRead
 										 * pointers. The array index
 										 * corresponds to COMP_FUNC_*	*/
 
+	/*
+	 * Decompression ahead, see AppendOnlyStorageRead_SetDecompressAhead.
+	 *
+	 * When haveAhead is set, the header of the block after the current one
+	 * has already been read into aheadCurrent (aheadFound tells whether
+	 * there was one), and aheadJob, if not NULL, is decompressing it.  Once
+	 * that block becomes the current one its job is currentJob, and once
+	 * its decompressed content has been handed out by
+	 * AppendOnlyStorageRead_DecompressedContent it is lentJob, until the
+	 * content of the following block is asked for.
+	 */
+	bool		decompressAhead;
+	bool		haveAhead;
+	bool		aheadFound;
+	AppendOnlyStorageReadCurrent aheadCurrent;
+	struct AppendOnlyDecompressJob *aheadJob;
+	struct AppendOnlyDecompressJob *currentJob;
+	struct AppendOnlyDecompressJob *lentJob;
+
 } AppendOnlyStorageRead;
 
 extern void AppendOnlyStorageRead_Init(AppendOnlyStorageRead *storageRead,
@@ -196,6 +215,9 @@ extern void AppendOnlyStorageRead_Init(AppendOnlyStorageRead *storageRead,
 						   int32 maxBufferLen,
 						   char *relationName, char *title,
 						   AppendOnlyStorageAttributes *storageAttributes);
+extern void AppendOnlyStorageRead_SetPrefetchDepth(AppendOnlyStorageRead *storageRead,
+									   int prefetchDepth);
+extern void AppendOnlyStorageRead_SetDecompressAhead(AppendOnlyStorageRead *storageRead);
 
 extern char *AppendOnlyStorageRead_RelationName(AppendOnlyStorageRead *storageRead);
 extern char *AppendOnlyStorageRead_SegmentFileName(AppendOnlyStorageRead *storageRead);
@@ -221,6 +243,7 @@ extern int64 AppendOnlyStorageRead_OverallBlockLen(AppendOnlyStorageRead *storag
 extern uint8 *AppendOnlyStorageRead_GetBuffer(AppendOnlyStorageRead *storageRead);
 extern void AppendOnlyStorageRead_Content(AppendOnlyStorageRead *storageRead,
 							  uint8 *contentOut, int32 contentLen);
+extern uint8 *AppendOnlyStorageRead_DecompressedContent(AppendOnlyStorageRead *storageRead);
 extern void AppendOnlyStorageRead_SkipCurrentBlock(AppendOnlyStorageRead *storageRead);
 
 extern char *AppendOnlyStorageRead_ContextStr(AppendOnlyStorageRead *storageRead);
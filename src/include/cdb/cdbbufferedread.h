@@ -76,6 +76,18 @@ typedef struct BufferedRead
 	bool				haveTemporaryLimitInEffect;
 	int64				temporaryLimitFileLen;
 
+	/*
+	 * Readahead support.
+	 */
+	int64				prefetchLen;
+	int64				prefetchPosition;
+							/*
+							 * How many bytes past the current large read the
+							 * operating system is asked to read ahead (zero
+							 * disables it), and the position up to which it
+							 * has already been asked in the current file.
+							 */
+
 } BufferedRead;
 
 /*
@@ -101,6 +113,14 @@ extern void BufferedReadInit(
     int32                maxLargeReadLen,
     char				 *relationName);
 
+/*
+ * Set how many bytes past the current large read to ask the operating system
+ * to read ahead.  Zero disables readahead.
+ */
+extern void BufferedReadSetPrefetch(
+    BufferedRead         *bufferedRead,
+    int64                prefetchLen);
+
 /*
  * Takes an open file handle for the next file.
  */
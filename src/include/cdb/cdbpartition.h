@@ -251,6 +251,9 @@ extern List *rel_get_part_path1(Oid relid);
 extern int
 countLeafPartTables(Oid rootOid);
 
+extern List *
+rel_partition_default_levels(Oid rootOid);
+
 extern void
 findPartitionMetadataEntry(List *partsMetadata, Oid partOid, PartitionNode **partsAndRules,
 							PartitionAccessMethods **accessMethods);
@@ -742,6 +742,7 @@ extern bool gp_enable_sort_distinct;
 /* Greenplum MK Sort */
 extern bool gp_enable_mk_sort;
 extern bool gp_enable_motion_mk_sort;
+extern bool gp_enable_mk_sort_radix;
 
 #ifdef USE_ASSERT_CHECKING
 extern bool gp_mk_sort_check;
@@ -786,6 +787,15 @@ extern bool gp_hashagg_streambottom;
  */
 extern int gp_hashagg_default_nbatches;
 
+/*
+ * A streaming bottom hashagg that has formed more than
+ * gp_hashagg_stream_bypass_ratio groups per input row after
+ * gp_hashagg_stream_bypass_rows rows stops grouping, and passes its
+ * remaining input rows on one by one.
+ */
+extern int gp_hashagg_stream_bypass_rows;
+extern double gp_hashagg_stream_bypass_ratio;
+
 /* Get statistics for partitioned parent from a child */
 extern bool 	gp_statistics_pullup_from_child_partition;
 
@@ -832,6 +842,7 @@ extern int gp_workfile_limit_files_per_query;
 extern int gp_workfile_caching_loglevel;
 extern int gp_sessionstate_loglevel;
 extern int gp_workfile_bytes_to_checksum;
+extern int gp_workfile_prefetch_blocks;
 /* The type of work files that HashJoin should use */
 extern int gp_workfile_type_hashjoin;
 
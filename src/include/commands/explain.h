@@ -14,6 +14,7 @@
 #define EXPLAIN_H
 
 #include "executor/executor.h"
+#include "optimizer/optprofile.h"
 
 typedef enum ExplainFormat
 {
@@ -33,6 +34,7 @@ typedef struct ExplainState
 	bool		buffers;		/* print buffer usage */
 	bool		dxl;			/* CDB: print DXL */
 	bool		timing;			/* print timing */
+	bool		optimizer_profile;	/* CDB: print ORCA's profile */
 	ExplainFormat format;		/* output format */
 	/* other states */
 	PlannedStmt *pstmt;			/* top of plan */
@@ -45,6 +47,9 @@ typedef struct ExplainState
     Slice          *currentSlice;   /* slice whose nodes we are visiting */
 
 	PlanState  *parentPlanState;
+
+	/* CDB: profile of the optimization of the plan, if done by ORCA */
+	OptimizerProfile *optprofile;
 } ExplainState;
 
 /* Hook for plugins to get control in ExplainOneQuery() */
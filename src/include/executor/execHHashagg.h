@@ -205,6 +205,9 @@ typedef struct HashAggTable
 
 	bool is_spilling; /* indicate that spilling happened for this batch. */
 	bool expandable;  /* hash table buckets still have space to grow */
+	uint64 num_stream_groups; /* groups created over all streaming passes */
+	bool stream_bypass; /* streaming gave up grouping, see agg_hash_initial_pass */
+	uint64 num_bypass_tuples; /* input tuples passed through since then */
 	struct TupleTableSlot *prev_slot; /* a slot that is read previously. */
 
 	/* Statistics used for EXPLAIN ANALYZE */
@@ -215,6 +218,7 @@ typedef struct HashAggTable
 extern HashAggTable *create_agg_hash_table(AggState *aggstate);
 extern bool agg_hash_initial_pass(AggState *aggstate);
 extern bool agg_hash_stream(AggState *aggstate);
+extern void agg_hash_begin_bypass(AggState *aggstate);
 extern bool agg_hash_next_pass(AggState *aggstate);
 extern bool agg_hash_continue_pass(AggState *aggstate);
 extern void destroy_agg_hash_table(AggState *aggstate);
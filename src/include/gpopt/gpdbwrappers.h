@@ -20,6 +20,8 @@
 #include "utils/faultinjector.h"
 #include "parser/parse_coerce.h"
 #include "utils/lsyscache.h"
+#include "utils/mdsharedcache.h"
+#include "optimizer/optprofile.h"
 
 // fwd declarations
 typedef struct SysScanDescData *SysScanDesc;
@@ -47,6 +49,7 @@ struct LogicalIndexes;
 struct LogicalIndexInfo;
 struct ParseState;
 struct DefElem;
+typedef struct ConstExprEvalContext ConstExprEvalContext;
 struct GpPolicy;
 struct PartitionSelector;
 struct SelectedParts;
@@ -159,6 +162,10 @@ namespace gpdb {
 	// extract nodes with specific tag from a plan tree
 	List *ExtractNodesPlan(Plan *pl, int node_tag, bool descend_into_subqueries);
 
+	// collect the paramids of the Params in a plan tree, taking those below
+	// the known plan nodes from their allParam
+	Bitmapset *ExtractPlanParamIds(Plan *pl, Plan **known, int num_known);
+
 	// extract nodes with specific tag from an expression tree
 	List *ExtractNodesExpression(Node *node, int node_tag, bool descend_into_subqueries);
 	
@@ -243,8 +250,18 @@ namespace gpdb {
 	// get the list of check constraints for a given relation
 	List *GetCheckConstraintOids(Oid rel_oid);
 
-	// part constraint expression tree
-	Node *GetRelationPartContraints(Oid rel_oid, List **default_levels);
+	// part constraint expression tree; between StartPartConstraintCache and
+	// EndPartConstraintCache it is merged once per relation and shared, so
+	// it must not be modified
+	Node *GetRelationPartContraints(Oid rel_oid);
+
+	// reuse the part constraints merged during an optimization
+	void StartPartConstraintCache(void);
+	void EndPartConstraintCache(void);
+
+	// levels of a partitioned table that have a default partition, without
+	// building its part constraint
+	List *GetRelationPartDefaultLevels(Oid rel_oid);
 
 	// get the cast function for the specified source and destination types
 	bool GetCastFunc(Oid src_oid, Oid dest_oid, bool *is_binary_coercible, Oid *cast_fn_oid, CoercionPathType *pathtype);
@@ -614,6 +631,16 @@ namespace gpdb {
 	// returns the result of evaluating 'expr' as an Expr. Caller keeps ownership of 'expr'
 	// and takes ownership of the result 
 	Expr *EvaluateExpr(Expr *expr, Oid result_type, int32 typmod);
+
+	// create a context to evaluate many constant expressions in
+	ConstExprEvalContext *CreateConstExprEvalContext();
+
+	// returns the results of evaluating the constant expressions in 'exprs' as a list
+	// of Consts, reusing the results of expressions evaluated earlier in 'cxt'
+	List *EvaluateExprs(ConstExprEvalContext *cxt, List *exprs);
+
+	// free a context to evaluate constant expressions in
+	void FreeConstExprEvalContext(ConstExprEvalContext *cxt);
 	
 	// interpret the value of "With oids" option from a list of defelems
 	bool InterpretOidsOption(List *options);
@@ -640,14 +667,69 @@ namespace gpdb {
 	// table has been changed?)
 	bool MDCacheNeedsReset(void);
 
+	// remember that the metadata cache holds an object, so that it can be
+	// evicted when the catalog entries it was built from change
+	void MDCacheRegisterObject(int mdid_type, Oid oid, int32 pos, Oid relid);
+
+	// return the MDCacheObjectKeys of the objects in the metadata cache
+	// whose catalog entries changed since the last call
+	List *MDCacheInvalidatedObjects(void);
+
+	// can the metadata cache shared by all backends be used?
+	bool MDSharedCacheUsable(void);
+
+	// look up an object in the shared metadata cache by its mdid string;
+	// returns its DXL, or NULL
+	char *MDSharedCacheLookup(const char *name, MDCacheObjectKey *object);
+
+	// get ready to build an object for the shared metadata cache; returns
+	// the generation to pass to MDSharedCacheInsert()
+	uint64 MDSharedCacheStartBuild(void);
+
+	// add an object to the shared metadata cache
+	void MDSharedCacheInsert(const char *name, const MDCacheObjectKey *object, const char *dxl, uint64 generation);
+
+	// return the OIDs of the tables a query refers to, without duplicates
+	List *GetQueryRelationOids(Query *query);
+
 	// functions for tracking ORCA memory consumption
 	void *OptimizerAlloc(size_t size);
 
 	void OptimizerFree(void *ptr);
 
-	// returns true if a query cancel is requested in GPDB
+	// returns true if a query cancel is requested in GPDB, or if the
+	// optimization budget is exceeded while it is enforced
 	bool IsAbortRequested(void);
 
+	// start measuring the time and memory used by an optimization; 0 means
+	// no limit
+	void StartOptimizerBudget(int time_ms, int memory_kb);
+
+	// abort the optimization once the budget is exceeded?
+	void EnforceOptimizerBudget(bool enforce);
+
+	// returns true if the optimization has used up its budget
+	bool IsOptimizerBudgetExceeded(void);
+
+	// stop measuring the optimization
+	void EndOptimizerBudget(void);
+
+	// start profiling the phases of an optimization
+	void BeginOptimizerProfile(void);
+
+	// finish profiling an optimization and add it to the session's totals
+	void EndOptimizerProfile(void);
+
+	// enter and leave a phase of the optimization, timed from 'start'
+	void StartOptimizerPhase(OptimizerPhase phase, instr_time *start);
+	void EndOptimizerPhase(OptimizerPhase phase, instr_time *start);
+
+	// count an object fetched by the MD provider
+	void CountOptimizerMDFetch(bool shared_hit);
+
+	// count constant expressions evaluated for the optimizer
+	void CountOptimizerConstExprs(int nexprs);
+
 	GpPolicy *MakeGpPolicy(MemoryContext mcxt, GpPolicyType ptype, int nattrs);
 
 } //namespace gpdb
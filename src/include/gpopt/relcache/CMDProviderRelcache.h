@@ -20,12 +20,16 @@
 
 #include "gpos/base.h"
 #include "gpos/string/CWStringBase.h"
+#include "gpos/string/CWStringDynamic.h"
 
 #include "naucrates/md/CSystemId.h"
+#include "naucrates/md/IMDCacheObject.h"
 #include "naucrates/md/IMDId.h"
 #include "naucrates/md/IMDProvider.h"
 
 // fwd decl
+struct MDCacheObjectKey;
+
 namespace gpopt
 {
 	class CMDAccessor;
@@ -52,6 +56,21 @@ namespace gpmd
 			// private copy ctor
 			CMDProviderRelcache(const CMDProviderRelcache&);
 
+			// key of a retrieved object for invalidation of the MD cache
+			static
+			BOOL GetObjectKey(IMDId *mdid, IMDCacheObject *md_obj, MDCacheObjectKey *key);
+
+			// name of an object in the MD cache shared by all backends
+			static
+			BOOL GetSharedCacheName(IMDId *mdid, CHAR *name);
+
+			// look up an object in the MD cache shared by all backends
+			static
+			BOOL LookupShared(IMDId *md_id, CHAR *name, CHAR **dxl, uint64 *generation);
+
+			// build an object from the catalogs
+			IMDCacheObject *BuildObject(IMemoryPool *mp, CMDAccessor *md_accessor, IMDId *md_id, const CHAR *shared_name, uint64 generation, CWStringDynamic **str) const;
+
 		public:
 			// ctor/dtor
 			explicit
@@ -65,6 +84,10 @@ namespace gpmd
 			virtual
 			CWStringBase *GetMDObjDXLStr(IMemoryPool *mp, CMDAccessor *md_accessor, IMDId *md_id) const;
 
+			// returns the requested metadata object itself, for adding it to
+			// the MD cache without a DXL round-trip
+			IMDCacheObject *GetMDObj(IMemoryPool *mp, CMDAccessor *md_accessor, IMDId *md_id) const;
+
 			// return the mdid for the requested type
 			virtual
 			IMDId *MDId
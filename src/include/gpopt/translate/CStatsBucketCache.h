@@ -0,0 +1,151 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2019 Pivotal Software, Inc.
+//
+//	@filename:
+//		CStatsBucketCache.h
+//
+//	@doc:
+//		Cache of the histogram buckets translated from pg_statistic entries
+//
+//	@test:
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPDXL_CStatsBucketCache_H
+#define GPDXL_CStatsBucketCache_H
+
+#include "gpos/base.h"
+#include "gpos/common/CDouble.h"
+#include "gpos/common/CHashMap.h"
+
+#include "naucrates/md/CDXLColStats.h"
+
+// fwd declaration
+struct HeapTupleData;
+
+namespace gpdxl
+{
+	using namespace gpos;
+	using namespace gpmd;
+
+	//---------------------------------------------------------------------------
+	//	@class:
+	//		CStatsBucketCache
+	//
+	//	@doc:
+	//		Histogram buckets of column statistics, translated from the MCVs and
+	//		histogram of a pg_statistic entry, kept for the life of the backend.
+	//		Unlike the MD cache, it is not reset when the catalogs change: the
+	//		entries are keyed by the version of the pg_statistic tuple they
+	//		were built from, so a new ANALYZE simply misses. When the cache
+	//		outgrows optimizer_stats_cache_size, it is emptied.
+	//
+	//---------------------------------------------------------------------------
+	class CStatsBucketCache
+	{
+		private:
+
+			// version of the pg_statistic entry of a column
+			struct SStatsKey
+			{
+				OID m_rel_oid;
+				INT m_attno;
+				ULONG m_xmin;
+				ULONG m_block;
+				ULONG m_offset;
+				ULONG m_data_hash;
+
+				static
+				ULONG HashValue(const SStatsKey *key);
+
+				static
+				BOOL Equals(const SStatsKey *key_a, const SStatsKey *key_b);
+			};
+
+			// buckets built from a pg_statistic entry, along with the inputs
+			// they were built from that don't come from the entry itself
+			struct SStatsEntry
+			{
+				OID m_att_type;
+				CDouble m_num_distinct;
+				CDouble m_null_freq;
+				CDXLBucketArray *m_buckets;
+
+				SStatsEntry
+					(
+					OID att_type,
+					CDouble num_distinct,
+					CDouble null_freq,
+					CDXLBucketArray *buckets
+					)
+					:
+					m_att_type(att_type),
+					m_num_distinct(num_distinct),
+					m_null_freq(null_freq),
+					m_buckets(buckets)
+				{}
+
+				~SStatsEntry()
+				{
+					m_buckets->Release();
+				}
+			};
+
+			typedef CHashMap<SStatsKey, SStatsEntry, SStatsKey::HashValue, SStatsKey::Equals,
+						CleanupDelete<SStatsKey>, CleanupDelete<SStatsEntry> > StatsKeyToEntryMap;
+
+			// memory pool of the cached buckets
+			static
+			IMemoryPool *m_mp;
+
+			// cached buckets by pg_statistic entry
+			static
+			StatsKeyToEntryMap *m_entries;
+
+			static
+			void InitKey(SStatsKey *key, OID rel_oid, INT attno, const HeapTupleData *stats_tup);
+
+		public:
+
+			// memory pool to build buckets to be cached in, or NULL if the
+			// cache is disabled; empties the cache if it is full
+			static
+			IMemoryPool *GetMemoryPool();
+
+			// cached buckets of a column for the given pg_statistic tuple, or
+			// NULL; also returns the null frequency normalized along with
+			// the MCVs of the buckets
+			static
+			CDXLBucketArray *Lookup
+				(
+				OID rel_oid,
+				INT attno,
+				const HeapTupleData *stats_tup,
+				OID att_type,
+				CDouble num_distinct,
+				CDouble *null_freq
+				);
+
+			// cache the buckets of a column, built in the cache's memory pool
+			static
+			void Insert
+				(
+				OID rel_oid,
+				INT attno,
+				const HeapTupleData *stats_tup,
+				OID att_type,
+				CDouble num_distinct,
+				CDouble null_freq,
+				CDXLBucketArray *buckets
+				);
+
+			// free the cache
+			static
+			void Shutdown();
+	};
+}
+
+#endif // !GPDXL_CStatsBucketCache_H
+
+// EOF
@@ -156,6 +156,12 @@ namespace gpdxl
 			// partition selector counter
 			ULONG m_partition_selector_counter;
 
+			// plan nodes whose allParam is set, indexed by plan node id
+			Plan **m_param_plans;
+
+			// size of m_param_plans
+			ULONG m_param_plans_size;
+
 			// private copy ctor
 			CTranslatorDXLToPlStmt(const CTranslatorDXLToPlStmt&);
 
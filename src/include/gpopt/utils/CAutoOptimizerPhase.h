@@ -0,0 +1,65 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2019 Pivotal Software, Inc.
+//
+//	@filename:
+//		CAutoOptimizerPhase.h
+//
+//	@doc:
+//		Timer of a phase of an optimization, for the optimizer profile
+//
+//	@test:
+//
+//---------------------------------------------------------------------------
+
+#ifndef GPOPT_CAutoOptimizerPhase_H
+#define GPOPT_CAutoOptimizerPhase_H
+
+#include "gpopt/gpdbwrappers.h"
+
+namespace gpdxl
+{
+	//---------------------------------------------------------------------------
+	//	@class:
+	//		CAutoOptimizerPhase
+	//
+	//	@doc:
+	//		Times the scope it is declared in as a phase of the optimization.
+	//		Being a destructor, leaving the phase also happens when an
+	//		exception unwinds the scope.
+	//
+	//---------------------------------------------------------------------------
+	class CAutoOptimizerPhase
+	{
+		private:
+
+			OptimizerPhase m_phase;
+
+			instr_time m_start;
+
+			// private copy ctor
+			CAutoOptimizerPhase(const CAutoOptimizerPhase &);
+
+		public:
+
+			explicit
+			CAutoOptimizerPhase
+				(
+				OptimizerPhase phase
+				)
+				:
+				m_phase(phase)
+			{
+				gpdb::StartOptimizerPhase(m_phase, &m_start);
+			}
+
+			~CAutoOptimizerPhase()
+			{
+				gpdb::EndOptimizerPhase(m_phase, &m_start);
+			}
+	};
+}
+
+#endif // !GPOPT_CAutoOptimizerPhase_H
+
+// EOF
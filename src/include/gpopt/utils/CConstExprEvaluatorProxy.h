@@ -22,9 +22,12 @@
 #include "gpopt/translate/CMappingColIdVar.h"
 #include "gpopt/translate/CTranslatorDXLToScalar.h"
 
+#include "naucrates/dxl/operators/CDXLNode.h"
+
+typedef struct ConstExprEvalContext ConstExprEvalContext;
+
 namespace gpdxl
 {
-	class CDXLNode;
 
 	//---------------------------------------------------------------------------
 	//	@class:
@@ -86,6 +89,13 @@ namespace gpdxl
 			// translator for the DXL input -> GPDB Expr
 			CTranslatorDXLToScalar m_dxl2scalar_translator;
 
+			// executor context the expressions are evaluated in, NULL until
+			// the first evaluation
+			ConstExprEvalContext *m_eval_cxt;
+
+			// translate the result of an evaluation to DXL
+			CDXLNode *TranslateResultToDXL(Expr *result);
+
 		public:
 			// ctor
 			CConstExprEvaluatorProxy
@@ -97,15 +107,14 @@ namespace gpdxl
 				m_mp(mp),
 				m_emptymapcidvar(m_mp),
 				m_md_accessor(md_accessor),
-				m_dxl2scalar_translator(m_mp, m_md_accessor, 0)
+				m_dxl2scalar_translator(m_mp, m_md_accessor, 0),
+				m_eval_cxt(NULL)
 			{
 			}
 
 			// dtor
 			virtual
-			~CConstExprEvaluatorProxy()
-			{
-			}
+			~CConstExprEvaluatorProxy();
 
 			// evaluate given constant expressionand return the DXL representation of the result.
 			// if the expression has variables, an error is thrown.
@@ -113,6 +122,11 @@ namespace gpdxl
 			virtual
 			CDXLNode *EvaluateExpr(const CDXLNode *expr);
 
+			// evaluate the given constant expressions together and return the DXL
+			// representations of the results, in the same order.
+			// caller keeps ownership of 'exprs' and takes ownership of the returned array
+			CDXLNodeArray *EvaluateExprs(const CDXLNodeArray *exprs);
+
 			// returns true iff the evaluator can evaluate constant expressions without subqueries
 			virtual
 			BOOL FCanEvalExpressions()
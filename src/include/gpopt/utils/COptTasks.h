@@ -19,6 +19,7 @@
 
 #include "gpopt/base/CColRef.h"
 #include "gpopt/search/CSearchStage.h"
+#include "naucrates/dxl/operators/CDXLNode.h"
 
 
 
@@ -34,6 +35,11 @@ namespace gpdxl
 	class CDXLNode;
 }
 
+namespace gpmd
+{
+	class CMDProviderRelcache;
+}
+
 namespace gpopt
 {
 	class CExpression;
@@ -41,6 +47,7 @@ namespace gpopt
 	class CQueryContext;
 	class COptimizerConfig;
 	class ICostModel;
+	class IConstExprEvaluator;
 }
 
 struct PlannedStmt;
@@ -130,6 +137,35 @@ class COptTasks
 		static
 		void* OptimizeTask(void *ptr);
 
+		// evict the MD cache objects whose catalog entries have changed
+		static
+		void EvictInvalidatedMDObjects(IMemoryPool *mp);
+
+		// add the metadata of the relations of a query to the MD cache
+		static
+		void CacheQueryMDObjects(IMemoryPool *mp, CMDAccessor *md_accessor, gpmd::CMDProviderRelcache *relcache_provider, Query *query);
+
+		// trace flags that make the optimizer search a cheaper join order
+		// space than configured, or NULL if there is none
+		static
+		CBitSet *GetBudgetFallbackTraceflags(IMemoryPool *mp);
+
+		// optimize a query DXL, keeping to the optimization budget
+		static
+		CDXLNode *OptimizeWithinBudget
+			(
+			IMemoryPool *mp,
+			CMDAccessor *md_accessor,
+			CDXLNode *query_dxl,
+			CDXLNodeArray *query_output_dxlnode_array,
+			CDXLNodeArray *cte_dxlnode_array,
+			IConstExprEvaluator *expr_evaluator,
+			ULONG num_segments,
+			CSearchStageArray *search_strategy_arr,
+			COptimizerConfig *optimizer_config,
+			BOOL *budget_exceeded // output : set to true if the plan comes from the cheaper search
+			);
+
 		// translate a DXL tree into a planned statement
 		static
 		PlannedStmt *ConvertToPlanStmtFromDXL(IMemoryPool *mp, CMDAccessor *md_accessor, const CDXLNode *dxlnode, bool can_set_tag);
@@ -29,18 +29,22 @@ extern "C" {
 #include "executor/nodeMotion.h"
 #include "parser/parsetree.h"
 #include "utils/inval.h"
+#include "utils/mdsharedcache.h"
 #include "utils/lsyscache.h"
 #include "utils/syscache.h"
 #include "utils/datum.h"
+#include "utils/timestamp.h"
 #include "utils/array.h"
 #include "utils/builtins.h"
 #include "optimizer/walkers.h"
+#include "optimizer/optprofile.h"
 #include "parser/parse_expr.h"
 #include "parser/parse_relation.h"
 #include "parser/parse_clause.h"
 #include "parser/parse_oper.h"
 
 #include "catalog/namespace.h"
+#include "catalog/pg_inherits_fn.h"
 #include "catalog/pg_exttable.h"
 #include "cdb/cdbpartition.h"
 #include "cdb/partitionselection.h"
@@ -362,6 +362,7 @@ typedef struct ResultRelInfo
 
 	struct AppendOnlyInsertDescData *ri_aoInsertDesc;
 	struct AOCSInsertDescData *ri_aocsInsertDesc;
+	struct AppendOnlySort *ri_aoSort;	/* rows held back for the sort key */
 	struct ExternalInsertDescData *ri_extInsertDesc;
 
 	RelationDeleteDesc ri_deleteDesc;
@@ -565,6 +566,9 @@ typedef struct EState
 	/* AO fileseg info for target relation */
 	List	   *es_result_aosegnos;
 
+	/* ResultRelInfos holding rows back for a sort key, oldest first */
+	List	   *es_aoSorts;
+
 	TupleTableSlot *es_trig_tuple_slot; /* for trigger output tuples */
 	TupleTableSlot *es_trig_oldtup_slot;		/* for TriggerEnabled */
 	TupleTableSlot *es_trig_newtup_slot;		/* for TriggerEnabled */
@@ -2001,6 +2005,7 @@ typedef struct BitmapAppendOnlyScanState
 	int			baos_cindex;
 	bool		baos_lossy;
 	int			baos_ntuples;
+	bool		baos_nocolumns;	/* no Vars in tlist or qual */
 	bool        isAORow; /* If this is for AO Row tables. */
 } BitmapAppendOnlyScanState;
 
@@ -2029,6 +2034,7 @@ typedef struct BitmapTableScanState
 	bool						isLossyBitmapPage;
 	bool						recheckTuples;
 	bool						needNewBitmapPage;
+	bool						noColumnsNeeded;	/* no Vars in tlist or qual */
 	void						*iterator;
 } BitmapTableScanState;
 
@@ -2242,6 +2248,26 @@ typedef struct AOCSScanOpaqueData
 	bool	   *proj;
 	int			ncol;
 
+	/*
+	 * Simple "column op constant" quals, used to skip blocks using the zone
+	 * maps in the block directory.
+	 */
+	int			nzonemapkeys;
+	ScanKey		zonemapkeys;
+
+	/*
+	 * "column op constant" quals on variable-length columns, evaluated on the
+	 * dictionary of dictionary encoded blocks.
+	 */
+	int			ndictionarykeys;
+	ScanKey		dictionarykeys;
+
+	/*
+	 * The columns the quals need, when they are evaluated by the scan itself
+	 * before the other columns are read. NULL if they are not.
+	 */
+	bool	   *filter_proj;
+
 	struct AOCSScanDescData *scandesc;
 } AOCSScanOpaqueData;
 
@@ -2592,6 +2618,7 @@ typedef enum HashAggStatus
 	HASHAGG_IN_A_PASS,
 	HASHAGG_BETWEEN_PASSES,
 	HASHAGG_STREAMING,
+	HASHAGG_STREAM_BYPASS,
 	HASHAGG_END_OF_PASSES
 } HashAggStatus;
 
@@ -80,6 +80,8 @@ typedef struct PlannedStmt
 
 	bool		simplyUpdatable; /* can be used with CURRENT OF? */
 
+	bool		budgetExceeded;	/* did the optimizer cut its search short? */
+
 	struct Plan *planTree;		/* tree of Plan nodes */
 
 	List	   *rtable;			/* list of RangeTblEntry nodes */
@@ -177,6 +177,7 @@ struct StreamBMIterator
 	void			   *opaque;		/* for the implementation in bitmap.c */
 
 	PagetableEntry	   *nextentry;	/* for IndexStream, a pointer to the next cached entry */
+	PagetableEntry	   *inputentries;	/* for OpStream, a page from each input */
 	BlockNumber			nextblock;	/* block number we're up to */
 	PagetableEntry		entry;		/* storage for a page of tids in this stream bitmap */
 
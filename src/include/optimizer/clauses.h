@@ -119,6 +119,12 @@ extern Query *inline_set_returning_function(PlannerInfo *root,
 extern Expr *evaluate_expr(Expr *expr, Oid result_type, int32 result_typmod,
 			  Oid result_collation);
 
+typedef struct ConstExprEvalContext ConstExprEvalContext;
+
+extern ConstExprEvalContext *CreateConstExprEvalContext(void);
+extern List *evaluate_exprs(ConstExprEvalContext *cxt, List *exprs);
+extern void FreeConstExprEvalContext(ConstExprEvalContext *cxt);
+
 extern bool is_grouping_extension(CanonicalGroupingSets *grpsets);
 extern bool contain_extended_grouping(List *grp);
 
@@ -0,0 +1,66 @@
+/*-------------------------------------------------------------------------
+ *
+ * optprofile.h
+ *	  Per-phase profile of the optimizations done by ORCA
+ *
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ * src/include/optimizer/optprofile.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef OPTPROFILE_H
+#define OPTPROFILE_H
+
+#include "portability/instr_time.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Phases of an optimization. Fetching metadata and evaluating constant
+ * expressions happen while the query is translated or the plan is searched
+ * for, so their time is also part of those phases.
+ */
+typedef enum OptimizerPhase
+{
+	OPTIMIZER_PHASE_QUERY_TO_DXL,
+	OPTIMIZER_PHASE_METADATA,
+	OPTIMIZER_PHASE_SEARCH,
+	OPTIMIZER_PHASE_DXL_TO_PLSTMT,
+	OPTIMIZER_PHASE_CONST_EVAL,
+	NUM_OPTIMIZER_PHASES
+} OptimizerPhase;
+
+typedef struct OptimizerProfile
+{
+	double		phase_time[NUM_OPTIMIZER_PHASES];	/* wall time, in ms */
+	uint64		peak_memory;	/* most optimizer memory in use, in bytes,
+								 * above that in use at the start; 0 unless
+								 * OptimizerProfilePeakMemoryKnown() */
+	int64		md_fetches;		/* objects fetched by the MD provider, i.e.
+								 * misses of the ORCA MD cache */
+	int64		md_shared_hits; /* of which found in the shared MD cache */
+	int64		const_exprs;	/* constant expressions evaluated */
+} OptimizerProfile;
+
+extern void OptimizerProfileBegin(void);
+extern void OptimizerProfileEnd(void);
+
+extern void OptimizerProfileStartPhase(OptimizerPhase phase, instr_time *start);
+extern void OptimizerProfileEndPhase(OptimizerPhase phase, instr_time *start);
+
+extern void OptimizerProfileCountMDFetch(bool shared_hit);
+extern void OptimizerProfileCountConstExprs(int nexprs);
+
+extern uint64 OptimizerProfileCount(void);
+extern const OptimizerProfile *OptimizerProfileLast(void);
+extern bool OptimizerProfilePeakMemoryKnown(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif   /* OPTPROFILE_H */
@@ -53,6 +53,7 @@ extern "C" {
  */
 extern List *extract_nodes(PlannerGlobal *glob, Node *node, int nodeTag);
 extern List *extract_nodes_plan(Plan *pl, int nodeTag, bool descendIntoSubqueries);
+extern Bitmapset *extract_plan_paramids(Plan *pl, Plan **known, int nknown);
 extern List *extract_nodes_expression(Node *node, int nodeTag, bool descendIntoSubqueries);
 extern int find_nodes(Node *node, List *nodeTags);
 extern int check_collation(Node *node);
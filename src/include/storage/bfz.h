@@ -59,14 +59,23 @@ typedef struct bfz
 	int64 numBlocks;
 	int64 blockNo;
 	int64 chosenBlockNo;
+
+	/*
+	 * File offset up to which read-ahead has been requested from the
+	 * kernel while scanning. See bfz_readahead().
+	 */
+	int64 prefetchPos;
 }	bfz_t;
 
 /* These functions are internal to bfz. */
 extern void bfz_nothing_init(bfz_t * thiz);
 extern void bfz_zlib_init(bfz_t * thiz);
+extern void bfz_zstd_init(bfz_t * thiz);
+extern void bfz_lz4_init(bfz_t * thiz);
 extern void bfz_lzop_init(bfz_t * thiz);
 extern void bfz_write_ex(bfz_t * thiz, const char *buffer, int size);
 extern int	bfz_read_ex(bfz_t * thiz, char *buffer, int size);
+extern void bfz_readahead(bfz_t * thiz);
 
 /* These functions are interface to bfz. */
 extern int	bfz_string_to_compression(const char *string);
@@ -53,6 +53,7 @@ extern bool zero_damaged_pages;
 extern int	bgwriter_lru_maxpages;
 extern double bgwriter_lru_multiplier;
 extern bool track_io_timing;
+extern int	effective_io_concurrency;
 extern int	target_prefetch_pages;
 extern bool bgwriter_flush_all_buffers;
 
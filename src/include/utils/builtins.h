@@ -1264,6 +1264,10 @@ extern Datum pg_extension_config_dump(PG_FUNCTION_ARGS);
 
 /* commands/prepare.c */
 extern Datum pg_prepared_statement(PG_FUNCTION_ARGS);
+extern Datum gp_prepared_statement_plan_cache(PG_FUNCTION_ARGS);
+
+/* optimizer/util/optprofile.c */
+extern Datum gp_optimizer_profile(PG_FUNCTION_ARGS);
 
 /* utils/mmgr/portalmem.c */
 extern Datum pg_cursor(PG_FUNCTION_ARGS);
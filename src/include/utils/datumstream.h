@@ -50,6 +50,7 @@ typedef struct DatumStreamWrite
 
 	bool		rle_want_compression;
 	bool		delta_want_compression;
+	bool		dictionary_want_compression;
 
 	int32		maxAoBlockSize;
 	int32		maxAoHeaderSize;
@@ -65,6 +66,19 @@ typedef struct DatumStreamWrite
 
 	DatumStreamBlockWrite blockWrite;
 
+	/*
+	 * Zone map of the block being filled: the smallest and largest non-NULL
+	 * datum put into it so far, and the number of NULLs. It is recorded in
+	 * the block directory along with the block. Only kept for pass-by-value
+	 * types that have a default btree opclass.
+	 */
+	bool		zonemap;
+	FmgrInfo	zonemapCmp;
+	bool		zonemapHasMinMax;
+	Datum		zonemapMin;
+	Datum		zonemapMax;
+	int64		zonemapNullCount;
+
 	/*
 	 * EOFs of current segment file.
 	 */
@@ -157,6 +171,7 @@ typedef struct DatumStreamRead
 
 	bool		rle_can_have_compression;
 	bool		delta_can_have_compression;
+	bool		dictionary_can_have_compression;
 
 	int32		maxAoBlockSize;
 	int32		maxDataBlockSize;
@@ -242,6 +257,54 @@ datumstreamread_nth(DatumStreamRead * acc)
 	}
 }
 
+/*
+ * Number of datums left in the current block after the current one, i.e. how
+ * many more times datumstreamread_advance can succeed before the next block
+ * has to be read.
+ */
+inline static int
+datumstreamread_remaining(DatumStreamRead * acc)
+{
+	if (acc->largeObjectState == DatumStreamLargeObjectState_None)
+		return acc->blockRead.logical_row_count - (acc->blockRead.nth + 1);
+	else
+		return 0;
+}
+
+/*
+ * Is the current block dictionary encoded? Then datumstreamread_code gives
+ * the dictionary code of each non-NULL datum, and datumstreamread_dictionary
+ * the value of each code.
+ */
+inline static bool
+datumstreamread_has_dictionary(DatumStreamRead * acc)
+{
+	return (acc->largeObjectState == DatumStreamLargeObjectState_None &&
+			acc->blockRead.dictionary_block_was_encoded);
+}
+
+inline static int32
+datumstreamread_dictionary_count(DatumStreamRead * acc)
+{
+	Assert(datumstreamread_has_dictionary(acc));
+	return acc->blockRead.dictionary_count;
+}
+
+inline static Datum
+datumstreamread_dictionary(DatumStreamRead * acc, int32 code)
+{
+	Assert(datumstreamread_has_dictionary(acc));
+	Assert(code >= 0 && code < acc->blockRead.dictionary_count);
+	return PointerGetDatum(acc->blockRead.dictionary_entries[code]);
+}
+
+inline static int32
+datumstreamread_code(DatumStreamRead * acc)
+{
+	Assert(datumstreamread_has_dictionary(acc));
+	return DatumStreamBlockRead_DictionaryCode(&acc->blockRead);
+}
+
 /* ------------------------------------------------------------------------------ */
 
 extern int datumstreamwrite_put(
@@ -308,6 +371,8 @@ extern int64 datumstreamwrite_lob(DatumStreamWrite *ds,
 extern int	datumstreamread_block(DatumStreamRead * ds,
 								  AppendOnlyBlockDirectory *blockDirectory,
 								  int colGroupNo);
+extern int	datumstreamread_block_header(DatumStreamRead * ds);
+extern void datumstreamread_block_skip(DatumStreamRead * ds);
 extern void datumstreamread_find(DatumStreamRead * datumStream,
 					 int32 rowNumInBlock);
 extern void datumstreamread_rewind_block(DatumStreamRead * datumStream);
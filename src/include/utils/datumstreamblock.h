@@ -33,6 +33,13 @@ typedef enum DatumStreamVersion
 												 * Delta Range done by this
 												 * module. */
 
+	DatumStreamVersion_Dense_Dictionary = 3,	/* Version of the Dense blocks
+												 * of a Dense_Enhanced stream
+												 * that use dictionary
+												 * encoding, so that readers
+												 * that don't know it reject
+												 * them. */
+
 	MaxDatumStreamVersion		/* must always be last */
 }	DatumStreamVersion;
 
@@ -196,6 +203,36 @@ typedef struct DatumStreamBlock_Delta_Extension
 	 */
 }	DatumStreamBlock_Delta_Extension;
 
+/*
+ * Datum Stream Block extension to DatumStreamBlock_Dense with dictionary
+ * encoding. Only used for variable-length types, so never together with
+ * DeltaRange. Blocks that have it are written as version
+ * DatumStreamVersion_Dense_Dictionary.
+ *
+ * The datum area holds each distinct physical datum of the block once, and
+ * an array of codes, one per physical datum, follows the other meta-data.
+ * A code is the index of the datum's value in the datum area.
+ * 8 bytes more.
+ */
+typedef struct DatumStreamBlock_Dictionary_Extension
+{
+	int32		dictionary_count;
+	/*
+	 * Number of distinct datums in the datum area.
+	 */
+
+	int32		code_size;
+	/*
+	 * Size of each code, 1 or 2 bytes.
+	 */
+}	DatumStreamBlock_Dictionary_Extension;
+
+/*
+ * Largest dictionary that is tried for a block. Dictionaries are meant
+ * for low-cardinality columns; beyond this the codes rarely pay off.
+ */
+#define DATUMSTREAM_DICTIONARY_MAX_COUNT 4096
+
 
 /* Flags */
 enum
@@ -203,6 +240,8 @@ enum
 	DSB_HAS_NULLBITMAP = 0x1,
 	DSB_HAS_RLE_COMPRESSION = 0x2,
 	DSB_HAS_DELTA_COMPRESSION = 0x4,
+	DSB_HAS_DICTIONARY_ENCODING = 0x8,	/* only in DatumStreamVersion_Dense_Dictionary
+										 * blocks */
 };
 
 typedef struct DatumStreamBitMapWrite
@@ -1057,6 +1096,14 @@ typedef struct DatumStreamBlockWrite
 	int32		deltas_count;
 	int32		deltas_current_size;
 
+	/* Dictionary encoding variables */
+	bool		dictionary_want_compression;
+	bool		dictionary_has_compression;
+
+	int32		dictionary_count;
+	int32		dictionary_code_size;
+	int32		dictionary_data_size;
+
 	/* Common buffers */
 	MemoryContext memctxt;
 
@@ -1082,6 +1129,13 @@ typedef struct DatumStreamBlockWrite
 	bool	   *delta_sign;
 	int32		deltas_maxcount;
 
+	/* Dictionary encoding buffers, allocated on first use */
+	uint8	   *dictionary_buffer;
+	uint8	  **dictionary_entries;
+	int16	   *dictionary_hash;
+	uint16	   *dictionary_codes;
+	int32		dictionary_codes_maxcount;
+
 	/* EOF of current file */
 	int64		savings;
 	int64		remember_savings;
@@ -1164,6 +1218,14 @@ typedef struct DatumStreamBlockRead
 	bool		delta_block_was_compressed;
 	DatumStreamBitMapRead delta_bitmap;
 
+	/* Dictionary variables */
+	bool		dictionary_block_was_encoded;
+	int32		dictionary_count;
+	int32		dictionary_code_size;
+	uint8	   *dictionary_codesp;
+	uint8	  **dictionary_entries;
+	int32		dictionary_entries_maxcount;
+
 	/*
 	 * Keep less frequently accessed fields down here for possible better CPU data cache
 	 * performance.
@@ -1718,6 +1780,34 @@ DatumStreamBlockRead_AdvanceDenseDelta(DatumStreamBlockRead * dsr)
 	return DELTA_COMPRESSION_OK;
 }
 
+/*
+ * Code of physical datum 'index' of a block with dictionary encoding.
+ * Codes are not aligned, and 2 byte codes are stored low byte first.
+ */
+inline static int32
+DatumStreamBlockRead_DictionaryCodeAt(DatumStreamBlockRead * dsr, int32 index)
+{
+	Assert(dsr->dictionary_block_was_encoded);
+	Assert(index >= 0 && index < dsr->physical_datum_count);
+
+	if (dsr->dictionary_code_size == 1)
+		return dsr->dictionary_codesp[index];
+	else
+		return dsr->dictionary_codesp[2 * index] |
+			(dsr->dictionary_codesp[2 * index + 1] << 8);
+}
+
+/*
+ * Dictionary code of the current item. Only valid for a non-NULL item of a
+ * block with dictionary encoding. Items with the same code have the same
+ * value, so a predicate can be evaluated once per code.
+ */
+inline static int32
+DatumStreamBlockRead_DictionaryCode(DatumStreamBlockRead * dsr)
+{
+	return DatumStreamBlockRead_DictionaryCodeAt(dsr, dsr->physical_datum_index);
+}
+
 inline static int
 DatumStreamBlockRead_AdvanceDense(DatumStreamBlockRead * dsr)
 {
@@ -1924,6 +2014,16 @@ DatumStreamBlockRead_AdvanceDense(DatumStreamBlockRead * dsr)
 	++dsr->physical_datum_index;
 	//Initially, -1.
 
+	if (dsr->dictionary_block_was_encoded)
+	{
+		/*
+		 * The item is a code.  Point at its value in the dictionary.
+		 */
+		dsr->datump = dsr->dictionary_entries[
+			DatumStreamBlockRead_DictionaryCodeAt(dsr, dsr->physical_datum_index)];
+		return 1;
+	}
+
 		if (dsr->physical_datum_index == 0)
 	{
 		/* Pre-positioned by block read to first item. */
@@ -2152,6 +2252,7 @@ extern void DatumStreamBlockWrite_Init(
 						   DatumStreamVersion datumStreamVersion,
 						   bool rle_want_compression,
 						   bool delta_want_compression,
+						   bool dictionary_want_compression,
 						   int32 initialMaxDatumPerBlock,
 						   int32 maxDatumPerBlock,
 						   int32 maxDataBlockSize,
@@ -26,6 +26,12 @@ Ext_OptimizerAlloc(size_t size);
 extern uint64
 GetOptimizerOutstandingMemoryBalance(void);
 
+extern void
+ResetOptimizerMemoryHighWaterMark(void);
+
+extern uint64
+GetOptimizerMemoryHighWaterMark(void);
+
 
 #ifdef __cplusplus
 }
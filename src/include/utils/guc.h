@@ -243,6 +243,10 @@ extern bool gp_local_distributed_cache_stats;
 extern bool gp_appendonly_verify_block_checksums;
 extern bool gp_appendonly_verify_write_block;
 extern bool gp_appendonly_compaction;
+extern bool gp_appendonly_zonemap_skip;
+extern bool gp_appendonly_late_materialization;
+extern bool gp_appendonly_dictionary_encoding;
+extern int	gp_appendonly_decompress_workers;
 
 /*
  * Threshold of the ratio of dirty data in a segment file
@@ -411,6 +415,11 @@ extern int optimizer_minidump;
 extern int  optimizer_cost_model;
 extern bool optimizer_metadata_caching;
 extern int	optimizer_mdcache_size;
+extern int	optimizer_mdcache_shared_size;
+extern int	optimizer_stats_cache_size;
+extern int	optimizer_plan_cache_size;
+extern int	optimizer_search_time_budget;
+extern int	optimizer_search_memory_budget;
 
 /* Optimizer debugging GUCs */
 extern bool optimizer_print_query;
@@ -581,6 +590,7 @@ extern IndexCheckType gp_indexcheck_vacuum;
 #define SOPT_COMPLEVEL     "compresslevel"
 #define SOPT_CHECKSUM      "checksum"
 #define SOPT_ORIENTATION   "orientation"
+#define SOPT_SORTKEY       "sortkey"
 /* Max number of chars needed to hold value of a storage option. */
 #define MAX_SOPT_VALUE_LEN 15
 
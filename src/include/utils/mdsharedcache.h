@@ -0,0 +1,73 @@
+/*-------------------------------------------------------------------------
+ *
+ * mdsharedcache.h
+ *	  Metadata objects of the ORCA optimizer, shared by all backends.
+ *
+ * Portions Copyright (c) 2012-Present Pivotal Software, Inc.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/utils/mdsharedcache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef MDSHAREDCACHE_H
+#define MDSHAREDCACHE_H
+
+#include "storage/sinval.h"
+
+/*
+ * An object in the metadata cache, built from the catalog entries of a GPDB
+ * object.
+ */
+typedef struct MDCacheObjectKey
+{
+	int			mdid_type;		/* IMDId::EMDIdType of the object's mdid */
+	Oid			oid;			/* object, or relation of statistics */
+	int32		pos;			/* column position, for column statistics */
+	Oid			relid;			/* relation whose relcache invalidation
+								 * invalidates the object, if any */
+} MDCacheObjectKey;
+
+/* Max length of the name of a shared object, i.e. of its mdid string */
+#define MDSHAREDCACHE_NAMELEN 64
+
+#define MDSHAREDCACHE_MAX_SYSCACHE_DEPS 4
+
+/* A syscache entry that a shared object was built from */
+typedef struct MDSharedCacheSyscacheDep
+{
+	int			cacheid;
+	uint32		hashvalue;
+} MDSharedCacheSyscacheDep;
+
+/*
+ * The catalog entries a shared object was built from. The object is dropped
+ * when a relcache invalidation for one of the relations, or a syscache
+ * invalidation for one of the syscache entries, is sent.
+ */
+typedef struct MDSharedCacheDeps
+{
+	int			nsyscache;
+	MDSharedCacheSyscacheDep syscache[MDSHAREDCACHE_MAX_SYSCACHE_DEPS];
+	int			nrels;
+	Oid		   *rels;
+} MDSharedCacheDeps;
+
+extern Size MDSharedCacheShmemSize(void);
+extern void MDSharedCacheShmemInit(void);
+
+extern bool MDSharedCacheEnabled(void);
+extern bool MDSharedCacheUsable(void);
+extern uint64 MDSharedCacheGeneration(void);
+
+extern char *MDSharedCacheLookup(const char *name, MDCacheObjectKey *object);
+extern void MDSharedCacheInsert(const char *name,
+					const MDCacheObjectKey *object,
+					const MDSharedCacheDeps *deps,
+					const char *data,
+					uint64 generation);
+extern void MDSharedCacheInvalidate(const SharedInvalidationMessage *msgs,
+						int n);
+
+#endif   /* MDSHAREDCACHE_H */
@@ -100,6 +100,10 @@ typedef struct CachedPlanSource
 	double		generic_cost;	/* cost of generic plan, or -1 if not known */
 	double		total_custom_cost;		/* total cost of custom plans so far */
 	int			num_custom_plans;		/* number of plans included in total */
+	/* GPDB: custom plans made by ORCA, kept for reuse with the same values */
+	List	   *value_plans;	/* CachedPlans, most recently used first */
+	int64		num_value_plan_hits;	/* executions that reused one */
+	int64		num_value_plan_misses;	/* executions that had to plan */
 } CachedPlanSource;
 
 /*
@@ -122,6 +126,8 @@ typedef struct CachedPlan
 	int			generation;		/* parent's generation number for this plan */
 	int			refcount;		/* count of live references to this struct */
 	MemoryContext context;		/* context containing this CachedPlan */
+	ParamListInfo boundParams;	/* GPDB: parameter values of a custom plan
+								 * kept in value_plans, else NULL */
 } CachedPlan;
 
 
@@ -215,6 +215,8 @@ typedef struct StdRdOptions
 	bool		checksum;		/* checksum (AO rels only) */
 	bool 		columnstore;	/* columnstore (AO only) */
 	char		orientation[NAMEDATALEN]; /* orientation (AO only) */
+	int			sortkey;		/* sort key columns, offset of the string
+								 * in this struct or 0 (AO only) */
 	bool		security_barrier;		/* for views */
 } StdRdOptions;
 
@@ -317,6 +317,7 @@ static inline void mk_prepare_array(MKEntry *a, int i, int j, int32 lv, struct M
 
 extern void tupsort_cpfr(MKEntry *dst, MKEntry *src, MKLvContext *ctxt);
 extern int tupsort_compare_datum(MKEntry *v1, MKEntry *v2, MKLvContext *ctxt, MKContext *mkContext);
+extern int tupsort_radix_digit(MKEntry *e, MKLvContext *ctxt, int depth);
 
 extern void create_mksort_context(
         MKContext *mkctxt,
@@ -331,6 +332,7 @@ static inline void mk_qsort(MKEntry* a, int n, MKContext *ctxt)
 {
     mk_qsort_impl(a, 0, n-1, 0, true, ctxt, false);
 }
+extern void mk_radix_qsort(MKEntry *a, int n, MKContext *ctxt);
 
 /* MK Heap stuff */
 typedef bool (*MKFlagPtrReader) (void *ctxt, MKEntry *e);
@@ -0,0 +1,18 @@
+--
+-- Optimize a query with an IN list of 10000 numeric literals over the
+-- partitioning column, which makes ORCA fold many constant expressions
+-- while it selects the partitions.
+--
+SET optimizer = on;
+CREATE FUNCTION orca_const_fold_count() RETURNS bigint AS $$
+DECLARE
+	result bigint;
+BEGIN
+	EXECUTE 'SELECT count(*) FROM orca_md_parts WHERE b IN (' ||
+		(SELECT string_agg(i || '::numeric', ', ') FROM generate_series(0, 9999) i) ||
+		')' INTO result;
+	RETURN result;
+END;
+$$ LANGUAGE plpgsql;
+SELECT orca_const_fold_count();
+DROP FUNCTION orca_const_fold_count();
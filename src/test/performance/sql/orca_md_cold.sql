@@ -0,0 +1,6 @@
+--
+-- Optimize a query over the partitioned table with ORCA in a new session,
+-- whose metadata cache is empty.
+--
+SET optimizer = on;
+SELECT count(*) FROM orca_md_parts WHERE b = 42;
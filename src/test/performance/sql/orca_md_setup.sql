@@ -0,0 +1,9 @@
+--
+-- Create a range partitioned table with 5000 partitions, whose metadata is
+-- the bulk of the work of optimizing a query over it with ORCA.
+--
+CREATE TABLE orca_md_parts (a int, b int)
+DISTRIBUTED BY (a)
+PARTITION BY RANGE (b) (START (0) END (5000) EVERY (1));
+INSERT INTO orca_md_parts SELECT i, i % 5000 FROM generate_series(1, 50000) i;
+ANALYZE orca_md_parts;
@@ -0,0 +1,7 @@
+--
+-- Optimize the same query twice in a new session. The second time, the
+-- metadata is in the cache already.
+--
+SET optimizer = on;
+SELECT count(*) FROM orca_md_parts WHERE b = 42;
+SELECT count(*) FROM orca_md_parts WHERE b = 42;
@@ -0,0 +1,11 @@
+--
+-- Create a table with an int key in random order, a text key with many
+-- duplicates and a long common prefix, and a low-cardinality int.
+--
+CREATE TABLE sort_input AS
+SELECT (hashint4(i) % 100000000) AS a,
+       'order#' || (hashint4(i) % 500000) AS b,
+       i % 100 AS c
+FROM generate_series(1, 5000000) i
+DISTRIBUTED BY (c);
+ANALYZE sort_input;
@@ -0,0 +1,7 @@
+--
+-- Sort every row in memory on a text key, with
+-- gp_enable_mk_sort_radix = off.
+--
+SET statement_mem = '1GB';
+SET gp_enable_mk_sort_radix = off;
+SELECT count(*) FROM (SELECT b FROM sort_input ORDER BY b OFFSET 0) t;
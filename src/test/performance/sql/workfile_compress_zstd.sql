@@ -0,0 +1,8 @@
+--
+-- Spill a HashAgg with one group per row to work files compressed with
+-- gp_workfile_compress_algorithm = 'zstd'.
+--
+SET statement_mem = '10MB';
+SET enable_groupagg = off;
+SET gp_workfile_compress_algorithm = 'zstd';
+SELECT count(*) FROM (SELECT a, d, e, count(*) FROM workfile_spill GROUP BY a, d, e) t;
@@ -0,0 +1,14 @@
+--
+-- Create a table whose rows look like typical spilled tuples: a unique
+-- key, a few low-cardinality integers and dates, and some text.
+--
+CREATE TABLE workfile_spill AS
+SELECT i AS a,
+       i % 1000 AS b,
+       date '2000-01-01' + (i % 3650) AS c,
+       'customer#' || (i % 100000) AS d,
+       repeat('x', 40) || i AS e,
+       (i % 10000) / 100.0 AS f
+FROM generate_series(1, 5000000) i
+DISTRIBUTED BY (a);
+ANALYZE workfile_spill;
@@ -198,6 +198,28 @@ select count(1) from bm b1, bm b2 where b1.dist_col = b2.dist_col;
 with bm as (select * from bmcrash where (btree_col1 like 'abcde%') AND bitmap_col in ('999', '888'))
 select count(1) from bm b1, bm b2 where b1.dist_col = b2.dist_col;
 
+-- count(*) over bitmap index scans needs no column, so the rows are only
+-- checked for existence and visibility; their blocks are not decompressed.
+CREATE TABLE bm_count_ao (a int, b int, c text)
+WITH (appendonly=true, compresstype=zlib) DISTRIBUTED BY (a);
+CREATE TABLE bm_count_aocs (a int, b int, c text)
+WITH (appendonly=true, orientation=column, compresstype=zlib) DISTRIBUTED BY (a);
+CREATE INDEX bm_count_ao_b ON bm_count_ao USING bitmap (b);
+CREATE INDEX bm_count_ao_c ON bm_count_ao USING bitmap (c);
+CREATE INDEX bm_count_aocs_b ON bm_count_aocs USING bitmap (b);
+CREATE INDEX bm_count_aocs_c ON bm_count_aocs USING bitmap (c);
+INSERT INTO bm_count_ao SELECT i, i % 10, 'c' || (i % 7) FROM generate_series(1, 10000) i;
+INSERT INTO bm_count_aocs SELECT * FROM bm_count_ao;
+DELETE FROM bm_count_ao WHERE a <= 1000;
+DELETE FROM bm_count_aocs WHERE a <= 1000;
+
+select count(*) from bm_count_ao where b = 3 and c = 'c5';
+select count(*) from bm_count_ao where b = 3 or c = 'c5';
+select count(*), count(a) from bm_count_ao where b = 3;
+select count(*) from bm_count_aocs where b = 3 and c = 'c5';
+select count(*) from bm_count_aocs where b = 3 or c = 'c5';
+select count(*), count(a) from bm_count_aocs where b = 3;
+
 -- start_ignore
 drop schema bm_ao cascade;
 -- end_ignore
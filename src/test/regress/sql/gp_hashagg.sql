@@ -89,3 +89,42 @@ set enable_sort=off;
 -- use a Sort + Group, because nohash_int type is not hashable.
 select normal_int from hashagg_test2 group by normal_int;
 select nohash_int from hashagg_test2 group by nohash_int;
+
+--
+-- A streaming bottom hashagg that hardly reduces its input stops grouping
+-- and passes the remaining rows through. Check that the plan is a two stage
+-- hashagg, that its bottom stage did stop grouping, and that the results
+-- are still right.
+--
+create table hashagg_bypass(a int, b int, c numeric) distributed by (a);
+insert into hashagg_bypass select i, i % 5000, i from generate_series(1, 10000) i;
+create function hashagg_bypassed(query text) returns bool as
+$$
+declare
+	line text;
+begin
+	for line in execute 'explain analyze ' || query loop
+		if line like '%rows through without grouping%' then
+			return true;
+		end if;
+	end loop;
+	return false;
+end;
+$$ language plpgsql;
+set optimizer=off;
+set enable_sort=off;
+set gp_hashagg_streambottom=on;
+set gp_eager_two_phase_agg=on;
+set gp_hashagg_stream_bypass_rows=100;
+explain (costs off) select b, count(*), sum(c) from hashagg_bypass group by b;
+select hashagg_bypassed('select b, count(*), sum(c) from hashagg_bypass group by b');
+select count(*), sum(cnt), sum(s) from (select b, count(*) cnt, sum(c) s from hashagg_bypass group by b) t;
+select b, count(*), sum(c) from hashagg_bypass group by b order by b limit 3;
+-- With the bypass disabled, the bottom stage groups every row
+set gp_hashagg_stream_bypass_rows=0;
+select hashagg_bypassed('select b, count(*), sum(c) from hashagg_bypass group by b');
+reset gp_hashagg_stream_bypass_rows;
+reset gp_eager_two_phase_agg;
+reset gp_hashagg_streambottom;
+reset enable_sort;
+reset optimizer;
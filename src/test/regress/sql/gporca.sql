@@ -1964,6 +1964,109 @@ EXPLAIN SELECT a FROM ggg WHERE a NOT IN (NULL, '');
 
 EXPLAIN SELECT a FROM ggg WHERE a IN (NULL, 'x');
 
+-- Catalog changes evict only the metadata cache objects built from the
+-- changed entries; the queries after them must see the changes.
+CREATE TABLE mdcache_inval (a int, b int) DISTRIBUTED BY (a);
+INSERT INTO mdcache_inval VALUES (1, 1), (2, 2);
+CREATE FUNCTION mdcache_inval_f(int) RETURNS int AS 'SELECT $1 + 1' LANGUAGE SQL IMMUTABLE;
+SELECT a, b, mdcache_inval_f(b) FROM mdcache_inval ORDER BY a;
+CREATE TEMP TABLE mdcache_inval_tmp (c int);
+ANALYZE mdcache_inval_tmp;
+ALTER TABLE mdcache_inval ADD COLUMN c int DEFAULT 3;
+CREATE OR REPLACE FUNCTION mdcache_inval_f(int) RETURNS int AS 'SELECT $1 + 10' LANGUAGE SQL IMMUTABLE;
+SELECT a, b, c, mdcache_inval_f(b) FROM mdcache_inval ORDER BY a;
+
+-- Executions of a prepared statement with the same parameter values reuse
+-- the plan the optimizer built for them.
+CREATE TABLE plancache_values (a int, b int) DISTRIBUTED BY (a);
+INSERT INTO plancache_values SELECT i, i % 3 FROM generate_series(1, 30) i;
+PREPARE plancache_values_q(int) AS SELECT count(*) FROM plancache_values WHERE b = $1;
+EXECUTE plancache_values_q(1);
+EXECUTE plancache_values_q(1);
+EXECUTE plancache_values_q(1);
+EXECUTE plancache_values_q(2);
+SELECT name, cached_plans, hits, misses, hit_rate FROM gp_prepared_statement_plan_cache;
+DEALLOCATE plancache_values_q;
+
+-- With a search budget too small for the configured join order search, the
+-- plan of a cheaper search is used, and EXPLAIN says so.
+CREATE TABLE budget_t1 (a int, b int) DISTRIBUTED BY (a);
+CREATE TABLE budget_t2 (a int, b int) DISTRIBUTED BY (a);
+CREATE TABLE budget_t3 (a int, b int) DISTRIBUTED BY (a);
+INSERT INTO budget_t1 SELECT i, i FROM generate_series(1, 10) i;
+INSERT INTO budget_t2 SELECT i, i FROM generate_series(1, 10) i;
+INSERT INTO budget_t3 SELECT i, i FROM generate_series(1, 10) i;
+CREATE FUNCTION budget_explain(query text) RETURNS SETOF text AS $$
+DECLARE
+	line text;
+BEGIN
+	FOR line IN EXECUTE 'EXPLAIN ' || query LOOP
+		IF line LIKE '%Optimizer Budget%' THEN
+			RETURN NEXT line;
+		END IF;
+	END LOOP;
+END;
+$$ LANGUAGE plpgsql;
+SET optimizer_search_time_budget = 1;
+SELECT count(*) FROM budget_t1 JOIN budget_t2 USING (a) JOIN budget_t3 USING (a);
+SELECT budget_explain('SELECT count(*) FROM budget_t1 JOIN budget_t2 USING (a) JOIN budget_t3 USING (a)');
+RESET optimizer_search_time_budget;
+SELECT budget_explain('SELECT count(*) FROM budget_t1 JOIN budget_t2 USING (a) JOIN budget_t3 USING (a)');
+
+-- The part constraint of a partitioned table is merged into as few ranges as
+-- possible, whatever the order the parts were added in.
+CREATE TABLE part_merge (a int, b int) DISTRIBUTED BY (a)
+PARTITION BY RANGE (b) (PARTITION p2 START (20) END (30), PARTITION p3 START (30) END (40));
+ALTER TABLE part_merge ADD PARTITION p1 START (10) END (20);
+ALTER TABLE part_merge ADD DEFAULT PARTITION pother;
+INSERT INTO part_merge SELECT i, i FROM generate_series(0, 49) i;
+CREATE INDEX part_merge_b ON part_merge (b);
+SELECT count(*) FROM part_merge WHERE b BETWEEN 15 AND 35;
+SELECT count(*) FROM part_merge WHERE b < 5 OR b > 45;
+SELECT count(*) FROM (SELECT tableoid FROM part_merge GROUP BY tableoid) s;
+-- The merged constraint covers the parts added out of order, so with table
+-- scans disabled the index serves the whole range across them.
+CREATE FUNCTION part_merge_scans(query text, OUT index_scan bool, OUT table_scan bool) AS $$
+DECLARE
+	line text;
+BEGIN
+	index_scan := false;
+	table_scan := false;
+	FOR line IN EXECUTE 'EXPLAIN ' || query LOOP
+		IF line ~ 'Index Scan|Bitmap' THEN
+			index_scan := true;
+		ELSIF line ~ 'Seq Scan|Table Scan' THEN
+			table_scan := true;
+		END IF;
+	END LOOP;
+END;
+$$ LANGUAGE plpgsql;
+SET enable_seqscan = off;
+SET optimizer_enable_dynamictablescan = off;
+SELECT * FROM part_merge_scans('SELECT * FROM part_merge WHERE b BETWEEN 15 AND 35');
+RESET optimizer_enable_dynamictablescan;
+RESET enable_seqscan;
+
+-- EXPLAIN (optimizer_profile) shows where the optimizer spent its time and
+-- memory, and gp_optimizer_profile sums it up for the session. The numbers
+-- vary from run to run, and the peak memory is unknown unless
+-- optimizer_use_gpdb_allocators is on, so only the labels are checked.
+CREATE FUNCTION profile_explain(query text) RETURNS SETOF text AS $$
+DECLARE
+	line text;
+BEGIN
+	FOR line IN EXECUTE 'EXPLAIN (optimizer_profile) ' || query LOOP
+		IF line ~ 'Optimizer (Profile|Metadata|Constant Evaluation|Peak Memory)' THEN
+			RETURN NEXT regexp_replace(line, '[0-9.]+(kB)?|unknown', 'N', 'g');
+		END IF;
+	END LOOP;
+END;
+$$ LANGUAGE plpgsql;
+SELECT profile_explain('SELECT count(*) FROM budget_t1 JOIN budget_t2 USING (a) WHERE budget_t1.b IN (1, 2, 3)');
+SELECT queries > 0 AS profiled, md_fetches >= md_shared_cache_hits AS fetches,
+       search_ms >= 0 AND (peak_memory_kb >= 0 OR peak_memory_kb IS NULL) AS measured
+FROM gp_optimizer_profile;
+
 -- start_ignore
 DROP SCHEMA orca CASCADE;
 -- end_ignore
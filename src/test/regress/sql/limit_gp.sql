@@ -28,6 +28,20 @@ SELECT dkey, substring(tval from 1 for 2) as str  from (SELECT * from mksort_lim
 
 DROP TABLE  mksort_limit_test_table;
 
+-- Top-N sorts throw away most input rows by comparing them with the worst
+-- row kept so far on the first sort key. Check that ties on that key,
+-- NULLs and descending order are still handled correctly.
+CREATE TABLE mksort_topn(a int, b int) DISTRIBUTED BY (b);
+INSERT INTO mksort_topn SELECT i % 7, i FROM generate_series(1, 1000) i;
+INSERT INTO mksort_topn VALUES (NULL, 0), (NULL, 1001);
+
+SELECT a, b FROM mksort_topn ORDER BY a, b LIMIT 5;
+SELECT a, b FROM mksort_topn ORDER BY a DESC, b LIMIT 5;
+SELECT a, b FROM mksort_topn ORDER BY a NULLS FIRST, b DESC LIMIT 3;
+SELECT a, b FROM mksort_topn ORDER BY a DESC NULLS LAST, b DESC LIMIT 3;
+
+DROP TABLE mksort_topn;
+
 -- Check invalid things in LIMIT
 
 select * from generate_series(1,10) g limit g;
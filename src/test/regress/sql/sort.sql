@@ -110,3 +110,85 @@ select col1, col2, col3, col4, col5 from gpsort_alltypes order by col1, col2, co
 select col1, col2, col3, col4, col5 from gpsort_alltypes order by col3 desc, col2 asc, col1, col4, col5;
 select col1, col2, col3, col4, col5 from gpsort_alltypes order by col5 desc, col3 asc, col2 desc, col4 asc, col1 desc;
 
+-- Radix partitioning of large in-memory sorts. Sort enough rows that every
+-- segment has more than one radix partition, and check the order the rows
+-- come back in row by row, with plain comparison operators.
+create or replace function sort_schema.radix_cmp(a anyelement, b anyelement,
+	descending bool, nulls_first bool) returns int as
+$$
+begin
+	if a is null and b is null then
+		return 0;
+	elsif a is null then
+		return case when nulls_first then -1 else 1 end;
+	elsif b is null then
+		return case when nulls_first then 1 else -1 end;
+	elsif a = b then
+		return 0;
+	elsif (a < b) <> descending then
+		return -1;
+	else
+		return 1;
+	end if;
+end;
+$$ language plpgsql;
+
+-- Count the rows (k, k2) of q, and those that do not follow the row before
+-- them in k order, ties broken by k2 ascending, or that repeat it if unique.
+create or replace function sort_schema.radix_misordered(q text, keytype anyelement,
+	descending bool, nulls_first bool, is_unique bool,
+	out nrows bigint, out misordered bigint) as
+$$
+declare
+	k keytype%TYPE;
+	k2 int4;
+	prev_k keytype%TYPE;
+	prev_k2 int4;
+	c int;
+begin
+	nrows := 0;
+	misordered := 0;
+	for k, k2 in execute q loop
+		if nrows > 0 then
+			c := sort_schema.radix_cmp(prev_k, k, descending, nulls_first);
+			if c = 0 then
+				c := sort_schema.radix_cmp(prev_k2, k2, false, false);
+			end if;
+			if c > 0 or (c = 0 and is_unique) then
+				misordered := misordered + 1;
+			end if;
+		end if;
+		prev_k := k;
+		prev_k2 := k2;
+		nrows := nrows + 1;
+	end loop;
+end;
+$$ language plpgsql;
+
+-- k has negative and positive values, t has keys that are prefixes of
+-- others, down to 'radix' itself, and four rows each.
+create table radix_sort(k int4, t text, k2 int4) distributed by (k2);
+insert into radix_sort
+select case when i % 97 = 0 then null else (i * 7919) % 200000 - 100000 end,
+       case when i % 89 = 0 then null
+            else 'radix' || coalesce(nullif(i % 50000, 0)::text, '') end,
+       i
+from generate_series(1, 200000) i;
+
+set gp_enable_mk_sort = on;
+set gp_enable_mk_sort_radix = on;
+select * from sort_schema.radix_misordered('select k, k2 from radix_sort order by k, k2', null::int4, false, false, false);
+select * from sort_schema.radix_misordered('select k, k2 from radix_sort order by k nulls first, k2', null::int4, false, true, false);
+select * from sort_schema.radix_misordered('select k, k2 from radix_sort order by k desc, k2', null::int4, true, true, false);
+select * from sort_schema.radix_misordered('select k, k2 from radix_sort order by k desc nulls last, k2', null::int4, true, false, false);
+select * from sort_schema.radix_misordered('select t, k2 from radix_sort order by t, k2', null::text, false, false, false);
+select * from sort_schema.radix_misordered('select t, k2 from radix_sort order by t nulls first, k2', null::text, false, true, false);
+select * from sort_schema.radix_misordered('select t, k2 from radix_sort order by t desc, k2', null::text, true, true, false);
+select * from sort_schema.radix_misordered('select t, k2 from radix_sort order by t desc nulls last, k2', null::text, true, false, false);
+-- about 1000 rows per key, told apart by the second key
+select * from sort_schema.radix_misordered('select k % 100, k2 from radix_sort order by k % 100, k2', null::int4, false, false, false);
+set enable_hashagg = off;
+select * from sort_schema.radix_misordered('select distinct k / 100, 0 from radix_sort order by 1', null::int4, false, false, true);
+select * from sort_schema.radix_misordered('select distinct t, 0 from radix_sort order by 1', null::text, false, false, true);
+reset enable_hashagg;
+reset gp_enable_mk_sort_radix;